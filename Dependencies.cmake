@@ -5,6 +5,15 @@ include(cmake/CPM.cmake)
 function(tilebox_setup_dependencies)
   # NOTE: https://cmake.org/cmake/help/latest/module/FindX11.html
   find_package(X11 REQUIRED)
+  if (NOT X11_X11_xcb_FOUND OR NOT X11_xcb_FOUND)
+    message(FATAL_ERROR "libX11-xcb and libxcb are required for the asynchronous request API")
+  endif ()
+  if (NOT X11_Xi_FOUND)
+    message(FATAL_ERROR "libXi is required for XInput2 raw motion and smooth scrolling")
+  endif ()
+  if (NOT X11_Xrandr_FOUND OR NOT X11_Xinerama_FOUND)
+    message(FATAL_ERROR "libXrandr and libXinerama are required for monitor geometry")
+  endif ()
 
   # NOTE: https://cmake.org/cmake/help/latest/module/FindFontconfig.html
   find_package(Fontconfig REQUIRED)
@@ -29,6 +38,23 @@ function(tilebox_setup_dependencies)
     endif ()
   endif ()
 
+  if (tilebox_ENABLE_BENCHMARKS)
+    if (NOT TARGET benchmark::benchmark)
+      cpmaddpackage(NAME
+        benchmark
+        GITHUB_REPOSITORY
+        google/benchmark
+        GIT_TAG
+        v1.9.0
+        VERSION
+        1.9.0
+        OPTIONS
+        "BENCHMARK_ENABLE_TESTING OFF"
+        "BENCHMARK_ENABLE_INSTALL OFF"
+        "BENCHMARK_ENABLE_GTEST_TESTS OFF")
+    endif ()
+  endif ()
+
   if (NOT TARGET etl::etl)
     cpmaddpackage("gh:thebashpotato/etl#v0.8.4")
   endif ()
@@ -35,6 +35,7 @@ macro(tilebox_setup_options)
     option(tilebox_ENABLE_CPPCHECK "Enable cpp-check analysis" OFF)
     option(tilebox_ENABLE_PCH "Enable precompiled headers" OFF)
     option(tilebox_ENABLE_CACHE "Enable ccache" OFF)
+    option(tilebox_ENABLE_BENCHMARKS "Build the Google Benchmark targets" OFF)
   else()
     option(tilebox_ENABLE_IPO "Enable IPO/LTO" OFF)
     option(tilebox_WARNINGS_AS_ERRORS "Treat Warnings As Errors" OFF)
@@ -51,6 +52,7 @@ macro(tilebox_setup_options)
     option(tilebox_ENABLE_CPPCHECK "Enable cpp-check analysis" OFF)
     option(tilebox_ENABLE_PCH "Enable precompiled headers" OFF)
     option(tilebox_ENABLE_CACHE "Enable ccache" ON)
+    option(tilebox_ENABLE_BENCHMARKS "Build the Google Benchmark targets" OFF)
   endif()
 
   if(NOT PROJECT_IS_TOP_LEVEL)
@@ -68,7 +70,8 @@ macro(tilebox_setup_options)
       tilebox_ENABLE_CPPCHECK
       tilebox_ENABLE_COVERAGE
       tilebox_ENABLE_PCH
-      tilebox_ENABLE_CACHE)
+      tilebox_ENABLE_CACHE
+      tilebox_ENABLE_BENCHMARKS)
   endif()
 endmacro()
 
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <etl.hpp>
+#include <tilebox/x11/atoms.hpp>
 #include <tilebox/x11/display.hpp>
+#include <tilebox/x11/property_cache.hpp>
 
 #include <X11/X.h>
 
 #include <array>
-#include <cstddef>
 #include <cstdint>
-#include <tuple>
+#include <span>
+#include <string_view>
 #include <type_traits>
 
 namespace Tbwm
@@ -65,8 +67,29 @@ class AtomManager
         ClientList,
     };
 
+    /// @brief Supported atoms naming property types
+    enum class Type : std::uint8_t
+    {
+        // UTF-8 encoded text, the type of _NET_WM_NAME.
+        Utf8String,
+    };
+
     using WmAtomIterator = etl::EnumerationIterator<Wm, Wm::Protocols, Wm::TakeFocus>;
     using NetAtomIterator = etl::EnumerationIterator<Net, Net::WmName, Net::ClientList>;
+    using TypeAtomIterator = etl::EnumerationIterator<Type, Type::Utf8String, Type::Utf8String>;
+
+    // Indexed by Wm, Net and Type respectively
+    static constexpr std::array<const char *, WmAtomIterator::size()> kWmAtomNames = {
+        "WM_PROTOCOLS", "WM_DELETE_WINDOW", "WM_STATE", "WM_TAKE_FOCUS"};
+    static constexpr std::array<const char *, NetAtomIterator::size()> kNetAtomNames = {
+        "_NET_WM_NAME", "_NET_WM_STATE", "_NET_WM_STATE_FULL_SCREEN", "_NET_WM_WINDOW_TYPE",
+        "_NET_WM_WINDOW_TYPE_DIALOG", "_NET_ACTIVE_WINDOW", "_NET_SUPPORTED", "_NET_SUPPORTING_WM_CHECK",
+        "_NET_CLIENT_LIST"};
+    static constexpr std::array<const char *, TypeAtomIterator::size()> kTypeAtomNames = {"UTF8_STRING"};
+
+    using WmAtoms = Tilebox::X11AtomRegistry<Wm, kWmAtomNames>;
+    using NetAtoms = Tilebox::X11AtomRegistry<Net, kNetAtomNames>;
+    using TypeAtoms = Tilebox::X11AtomRegistry<Type, kTypeAtomNames>;
 
     [[nodiscard]] static auto ToUnderlying(const Wm atom) noexcept -> std::uint8_t
     {
@@ -86,17 +109,21 @@ class AtomManager
 
     [[nodiscard]] auto GetNetAtom(const Net net_atom) const noexcept -> Atom;
 
-    [[nodiscard]] auto GetNetAtomArrayInfo() noexcept -> std::tuple<std::uint64_t *, std::size_t>;
+    /// @brief Gets every supported Net atom, the value of _NET_SUPPORTED.
+    [[nodiscard]] auto GetNetAtoms() const noexcept -> std::span<const Atom>;
 
     [[nodiscard]] auto GetUtf8Atom() const noexcept -> Atom;
 
-  private:
-    void Init(const Tilebox::X11DisplaySharedResource &dpy) noexcept;
+    /// @brief Gets the name of a supported atom without a server query, empty for any other atom.
+    [[nodiscard]] auto GetAtomName(Atom atom) const noexcept -> std::string_view;
+
+    /// @brief Gets the interned atoms Tilebox::X11PropertyCache decodes properties with.
+    [[nodiscard]] auto GetPropertyAtoms() const noexcept -> Tilebox::X11PropertyAtoms;
 
   private:
-    std::array<Atom, WmAtomIterator::size()> m_wm_atoms{};
-    std::array<Atom, NetAtomIterator::size()> m_net_atoms{};
-    Atom m_utf8_string_atom{};
+    WmAtoms m_wm_atoms;
+    NetAtoms m_net_atoms;
+    TypeAtoms m_type_atoms;
 };
 
 } // namespace Tbwm
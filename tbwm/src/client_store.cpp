@@ -0,0 +1,342 @@
+#include "client_store.hpp"
+
+#include <X11/X.h>
+#include <tilebox/geometry.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Tbwm
+{
+
+ClientStore::ClientStore(const std::uint32_t workspaces, const std::size_t capacity) : m_workspaces(workspaces)
+{
+    Reserve(capacity);
+}
+
+auto ClientStore::Reserve(const std::size_t count) -> void
+{
+    while (Capacity() < count)
+    {
+        AddPage();
+    }
+    m_by_window.Reserve(Capacity());
+}
+
+auto ClientStore::Size() const noexcept -> std::size_t
+{
+    return m_size;
+}
+
+auto ClientStore::Capacity() const noexcept -> std::size_t
+{
+    return m_pages.size() * kPageSize;
+}
+
+auto ClientStore::Workspaces() const noexcept -> std::uint32_t
+{
+    return static_cast<std::uint32_t>(m_workspaces.size());
+}
+
+auto ClientStore::Manage(const Window window, const std::uint32_t workspace) -> ClientHandle
+{
+    if (window == None || workspace >= m_workspaces.size() || m_by_window.Contains(window))
+    {
+        return {};
+    }
+
+    if (m_free == kNil)
+    {
+        AddPage();
+        m_by_window.Reserve(Capacity());
+    }
+
+    const std::uint32_t index = m_free;
+    m_free = LinkOf(index, ClientOrder::Focus).next;
+
+    Page &page = PageOf(index);
+    const std::uint32_t slot = index % kPageSize;
+    page.live[slot] = true;
+    page.links[slot] = {};
+    ClientLayout &layout = page.layout[slot];
+    layout = ClientLayout{};
+    layout.window = window;
+    layout.workspace = workspace;
+    m_by_window.InsertOrAssign(window, index);
+    ++m_size;
+
+    LinkLast(ClientOrder::Focus, index);
+    LinkFirst(ClientOrder::Stack, index);
+    LinkLast(ClientOrder::Workspace, index);
+    return HandleOf(index);
+}
+
+auto ClientStore::Unmanage(const ClientHandle client) noexcept -> bool
+{
+    if (!IsValid(client))
+    {
+        return false;
+    }
+
+    const std::uint32_t index = client.index;
+    for (const ClientOrder order : {ClientOrder::Focus, ClientOrder::Stack, ClientOrder::Workspace})
+    {
+        Unlink(order, index);
+    }
+
+    Page &page = PageOf(index);
+    const std::uint32_t slot = index % kPageSize;
+    m_by_window.Erase(page.layout[slot].window);
+
+    // Strings are cleared rather than replaced so the next client of the slot reuses their buffers
+    ClientInfo &info = page.info[slot];
+    info.title.clear();
+    info.class_hint.instance.clear();
+    info.class_hint.name.clear();
+    info.size_hints = {};
+    info.transient_for = None;
+
+    page.live[slot] = false;
+    ++page.generation[slot];
+    LinkOf(index, ClientOrder::Focus).next = m_free;
+    m_free = index;
+    --m_size;
+    return true;
+}
+
+auto ClientStore::Find(const Window window) const noexcept -> ClientHandle
+{
+    const std::uint32_t *index = m_by_window.Find(window);
+    return index != nullptr ? HandleOf(*index) : ClientHandle{};
+}
+
+auto ClientStore::IsValid(const ClientHandle client) const noexcept -> bool
+{
+    return client.index < Capacity() && IsLive(client.index) &&
+           PageOf(client.index).generation[client.index % kPageSize] == client.generation;
+}
+
+auto ClientStore::Layout(const ClientHandle client) noexcept -> ClientLayout *
+{
+    return IsValid(client) ? &PageOf(client.index).layout[client.index % kPageSize] : nullptr;
+}
+
+auto ClientStore::Layout(const ClientHandle client) const noexcept -> const ClientLayout *
+{
+    return IsValid(client) ? &PageOf(client.index).layout[client.index % kPageSize] : nullptr;
+}
+
+auto ClientStore::Info(const ClientHandle client) noexcept -> ClientInfo *
+{
+    return IsValid(client) ? &PageOf(client.index).info[client.index % kPageSize] : nullptr;
+}
+
+auto ClientStore::Info(const ClientHandle client) const noexcept -> const ClientInfo *
+{
+    return IsValid(client) ? &PageOf(client.index).info[client.index % kPageSize] : nullptr;
+}
+
+auto ClientStore::Focus(const ClientHandle client) noexcept -> bool
+{
+    if (!IsValid(client))
+    {
+        return false;
+    }
+
+    Unlink(ClientOrder::Focus, client.index);
+    LinkFirst(ClientOrder::Focus, client.index);
+    return true;
+}
+
+auto ClientStore::Focused() const noexcept -> ClientHandle
+{
+    return First(ClientOrder::Focus);
+}
+
+auto ClientStore::Raise(const ClientHandle client) noexcept -> bool
+{
+    if (!IsValid(client))
+    {
+        return false;
+    }
+
+    Unlink(ClientOrder::Stack, client.index);
+    LinkFirst(ClientOrder::Stack, client.index);
+    return true;
+}
+
+auto ClientStore::Lower(const ClientHandle client) noexcept -> bool
+{
+    if (!IsValid(client))
+    {
+        return false;
+    }
+
+    Unlink(ClientOrder::Stack, client.index);
+    LinkLast(ClientOrder::Stack, client.index);
+    return true;
+}
+
+auto ClientStore::PlaceAbove(const ClientHandle client, const ClientHandle sibling) noexcept -> bool
+{
+    if (!IsValid(client) || !IsValid(sibling) || client == sibling)
+    {
+        return false;
+    }
+
+    // The stack runs top to bottom, right above the sibling is right before it
+    Unlink(ClientOrder::Stack, client.index);
+    LinkBefore(ClientOrder::Stack, client.index, sibling.index);
+    return true;
+}
+
+auto ClientStore::MoveToWorkspace(const ClientHandle client, const std::uint32_t workspace) noexcept -> bool
+{
+    if (!IsValid(client) || workspace >= m_workspaces.size())
+    {
+        return false;
+    }
+
+    Unlink(ClientOrder::Workspace, client.index);
+    PageOf(client.index).layout[client.index % kPageSize].workspace = workspace;
+    LinkLast(ClientOrder::Workspace, client.index);
+    return true;
+}
+
+auto ClientStore::First(const ClientOrder order, const std::uint32_t workspace) const noexcept -> ClientHandle
+{
+    const ListHead *head = Head(order, workspace);
+    return head != nullptr && head->first != kNil ? HandleOf(head->first) : ClientHandle{};
+}
+
+auto ClientStore::Last(const ClientOrder order, const std::uint32_t workspace) const noexcept -> ClientHandle
+{
+    const ListHead *head = Head(order, workspace);
+    return head != nullptr && head->last != kNil ? HandleOf(head->last) : ClientHandle{};
+}
+
+auto ClientStore::Next(const ClientOrder order, const ClientHandle client) const noexcept -> ClientHandle
+{
+    if (!IsValid(client))
+    {
+        return {};
+    }
+
+    const std::uint32_t next = LinkOf(client.index, order).next;
+    return next != kNil ? HandleOf(next) : ClientHandle{};
+}
+
+auto ClientStore::Prev(const ClientOrder order, const ClientHandle client) const noexcept -> ClientHandle
+{
+    if (!IsValid(client))
+    {
+        return {};
+    }
+
+    const std::uint32_t prev = LinkOf(client.index, order).prev;
+    return prev != kNil ? HandleOf(prev) : ClientHandle{};
+}
+
+/// Private
+
+auto ClientStore::PageOf(const std::uint32_t index) const noexcept -> Page &
+{
+    return *m_pages[index / kPageSize];
+}
+
+auto ClientStore::IsLive(const std::uint32_t index) const noexcept -> bool
+{
+    return PageOf(index).live[index % kPageSize];
+}
+
+auto ClientStore::HandleOf(const std::uint32_t index) const noexcept -> ClientHandle
+{
+    return {.index = index, .generation = PageOf(index).generation[index % kPageSize]};
+}
+
+auto ClientStore::LinkOf(const std::uint32_t index, const ClientOrder order) const noexcept -> Link &
+{
+    return PageOf(index).links[index % kPageSize][static_cast<std::size_t>(order)];
+}
+
+auto ClientStore::Head(const ClientOrder order, const std::uint32_t workspace) const noexcept -> const ListHead *
+{
+    switch (order)
+    {
+    case ClientOrder::Focus:
+        return &m_focus;
+    case ClientOrder::Stack:
+        return &m_stack;
+    case ClientOrder::Workspace:
+        return workspace < m_workspaces.size() ? &m_workspaces[workspace] : nullptr;
+    }
+    return nullptr;
+}
+
+auto ClientStore::Head(const ClientOrder order, const std::uint32_t workspace) noexcept -> ListHead *
+{
+    return const_cast<ListHead *>(std::as_const(*this).Head(order, workspace)); // NOLINT
+}
+
+auto ClientStore::HeadOf(const ClientOrder order, const std::uint32_t index) noexcept -> ListHead &
+{
+    return *Head(order, PageOf(index).layout[index % kPageSize].workspace);
+}
+
+auto ClientStore::AddPage() -> void
+{
+    // Slots of the new page are chained in index order, so clients fill pages front to back
+    const auto first = static_cast<std::uint32_t>(Capacity());
+    m_pages.push_back(std::make_unique<Page>());
+    for (std::uint32_t i = kPageSize; i-- > 0;)
+    {
+        LinkOf(first + i, ClientOrder::Focus).next = m_free;
+        m_free = first + i;
+    }
+}
+
+auto ClientStore::Unlink(const ClientOrder order, const std::uint32_t index) noexcept -> void
+{
+    ListHead &head = HeadOf(order, index);
+    Link &link = LinkOf(index, order);
+    (link.prev != kNil ? LinkOf(link.prev, order).next : head.first) = link.next;
+    (link.next != kNil ? LinkOf(link.next, order).prev : head.last) = link.prev;
+    link = {};
+}
+
+auto ClientStore::LinkFirst(const ClientOrder order, const std::uint32_t index) noexcept -> void
+{
+    ListHead &head = HeadOf(order, index);
+    if (head.first == kNil)
+    {
+        LinkOf(index, order) = {};
+        head.first = index;
+        head.last = index;
+        return;
+    }
+    LinkBefore(order, index, head.first);
+}
+
+auto ClientStore::LinkLast(const ClientOrder order, const std::uint32_t index) noexcept -> void
+{
+    ListHead &head = HeadOf(order, index);
+    Link &link = LinkOf(index, order);
+    link = {.prev = head.last, .next = kNil};
+    (head.last != kNil ? LinkOf(head.last, order).next : head.first) = index;
+    head.last = index;
+}
+
+auto ClientStore::LinkBefore(const ClientOrder order, const std::uint32_t index, const std::uint32_t before) noexcept
+    -> void
+{
+    ListHead &head = HeadOf(order, index);
+    Link &link = LinkOf(index, order);
+    Link &next = LinkOf(before, order);
+    link = {.prev = next.prev, .next = before};
+    (next.prev != kNil ? LinkOf(next.prev, order).next : head.first) = index;
+    next.prev = index;
+}
+
+} // namespace Tbwm
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <tilebox/geometry.hpp>
+#include <tilebox/utils/flat_map.hpp>
+#include <tilebox/x11/property_cache.hpp>
+
+#include <X11/X.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Tbwm
+{
+
+/// @brief Generation checked reference to a managed client.
+///
+/// @details A handle outliving its client is detected rather than aliasing whichever client reuses the slot.
+struct ClientHandle
+{
+    static constexpr std::uint32_t kInvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t index{kInvalidIndex};
+    std::uint32_t generation{};
+
+    /// @brief Check whether the handle was ever issued, ClientStore::IsValid tells whether it still is
+    [[nodiscard]] auto IsSet() const noexcept -> bool
+    {
+        return index != kInvalidIndex;
+    }
+
+    [[nodiscard]] auto operator==(const ClientHandle &rhs) const noexcept -> bool = default;
+};
+
+/// @brief Fields a relayout reads and writes for every client, kept apart from ClientInfo so a layout pass only
+/// pulls these into cache.
+struct ClientLayout
+{
+    Window window{};
+    Tilebox::Rect rect;
+    std::uint32_t border_width{};
+    std::uint32_t workspace{};
+    bool floating{};
+    bool fullscreen{};
+    bool mapped{};
+    bool urgent{};
+};
+
+/// @brief Client metadata read on demand, e.g. for bars and rules.
+struct ClientInfo
+{
+    std::string title;
+    Tilebox::X11ClassHint class_hint;
+    Tilebox::X11SizeHints size_hints;
+    Window transient_for{};
+};
+
+/// @brief Orders a client is linked into.
+enum class ClientOrder : std::uint8_t
+{
+    /// @brief Most recently focused first.
+    Focus,
+
+    /// @brief Top of the stack first.
+    Stack,
+
+    /// @brief Layout order of the client's workspace.
+    Workspace,
+};
+
+/// @brief Every managed client of tbwm.
+///
+/// @details Records live in fixed size pages that never move, freed slots are reused before a new page is added, so
+/// Manage only allocates when more clients are managed than ever before, and not at all within Reserve'd capacity.
+/// Window lookup goes through an open addressing map. Focus, stacking and workspace order are intrusive doubly linked
+/// lists threaded through the records, Unmanage, Focus, Raise, Lower, PlaceAbove and MoveToWorkspace only relink.
+class ClientStore
+{
+  public:
+    static constexpr std::uint32_t kPageSize = 64;
+    static constexpr std::uint32_t kDefaultWorkspaces = 9;
+
+  public:
+    explicit ClientStore(std::uint32_t workspaces = kDefaultWorkspaces, std::size_t capacity = kPageSize);
+
+  public:
+    /// @brief Makes room for `count` clients, managing up to that many allocates nothing.
+    auto Reserve(std::size_t count) -> void;
+
+    /// @brief Gets the number of managed clients
+    [[nodiscard]] auto Size() const noexcept -> std::size_t;
+
+    /// @brief Gets the number of clients that can be managed without allocating
+    [[nodiscard]] auto Capacity() const noexcept -> std::size_t;
+
+    /// @brief Gets the number of workspaces
+    [[nodiscard]] auto Workspaces() const noexcept -> std::uint32_t;
+
+    /// @brief Starts managing `window`, on top of the stack, last on its workspace and least recently focused.
+    ///
+    /// @returns an unset handle if the window is None, already managed, or the workspace does not exist.
+    [[nodiscard]] auto Manage(Window window, std::uint32_t workspace) -> ClientHandle;
+
+    /// @brief Stops managing a client, unlinking it from every order.
+    ///
+    /// @returns false if the handle is stale.
+    auto Unmanage(ClientHandle client) noexcept -> bool;
+
+    /// @brief Finds the client managing `window`, an unset handle if none.
+    [[nodiscard]] auto Find(Window window) const noexcept -> ClientHandle;
+
+    /// @brief Check whether a handle still refers to a managed client
+    [[nodiscard]] auto IsValid(ClientHandle client) const noexcept -> bool;
+
+    /// @brief Gets the hot fields of a client, nullptr for a stale handle.
+    [[nodiscard]] auto Layout(ClientHandle client) noexcept -> ClientLayout *;
+    [[nodiscard]] auto Layout(ClientHandle client) const noexcept -> const ClientLayout *;
+
+    /// @brief Gets the metadata of a client, nullptr for a stale handle.
+    [[nodiscard]] auto Info(ClientHandle client) noexcept -> ClientInfo *;
+    [[nodiscard]] auto Info(ClientHandle client) const noexcept -> const ClientInfo *;
+
+    /// @brief Makes a client the most recently focused one.
+    auto Focus(ClientHandle client) noexcept -> bool;
+
+    /// @brief Gets the most recently focused client, an unset handle if none is managed.
+    [[nodiscard]] auto Focused() const noexcept -> ClientHandle;
+
+    /// @brief Moves a client to the top of the stack.
+    auto Raise(ClientHandle client) noexcept -> bool;
+
+    /// @brief Moves a client to the bottom of the stack.
+    auto Lower(ClientHandle client) noexcept -> bool;
+
+    /// @brief Moves a client in the stack to right above `sibling`.
+    auto PlaceAbove(ClientHandle client, ClientHandle sibling) noexcept -> bool;
+
+    /// @brief Moves a client to the end of another workspace's order.
+    auto MoveToWorkspace(ClientHandle client, std::uint32_t workspace) noexcept -> bool;
+
+    /// @brief Gets the first client of an order, an unset handle if the order is empty.
+    ///
+    /// @param workspace Only used for ClientOrder::Workspace.
+    [[nodiscard]] auto First(ClientOrder order, std::uint32_t workspace = 0) const noexcept -> ClientHandle;
+
+    /// @brief Gets the last client of an order, an unset handle if the order is empty.
+    [[nodiscard]] auto Last(ClientOrder order, std::uint32_t workspace = 0) const noexcept -> ClientHandle;
+
+    /// @brief Gets the client after `client` in an order, an unset handle at the end or for a stale handle.
+    [[nodiscard]] auto Next(ClientOrder order, ClientHandle client) const noexcept -> ClientHandle;
+
+    /// @brief Gets the client before `client` in an order, an unset handle at the start or for a stale handle.
+    [[nodiscard]] auto Prev(ClientOrder order, ClientHandle client) const noexcept -> ClientHandle;
+
+    /// @brief Calls `fn(handle, layout)` for every client in an order, first to last.
+    template <typename Fn> auto ForEach(ClientOrder order, std::uint32_t workspace, Fn &&fn) -> void
+    {
+        const ListHead *head = Head(order, workspace);
+        for (std::uint32_t i = head != nullptr ? head->first : kNil; i != kNil;)
+        {
+            const std::uint32_t next = LinkOf(i, order).next;
+            fn(HandleOf(i), PageOf(i).layout[i % kPageSize]);
+            i = next;
+        }
+    }
+
+  private:
+    static constexpr std::uint32_t kNil = ClientHandle::kInvalidIndex;
+    static constexpr std::size_t kOrders = 3;
+
+    struct Link
+    {
+        std::uint32_t prev{kNil};
+        std::uint32_t next{kNil};
+    };
+
+    struct ListHead
+    {
+        std::uint32_t first{kNil};
+        std::uint32_t last{kNil};
+    };
+
+    /// @brief Records of kPageSize clients, hot and cold fields in separate arrays.
+    struct Page
+    {
+        std::array<ClientLayout, kPageSize> layout{};
+        std::array<std::array<Link, kOrders>, kPageSize> links{};
+        std::array<std::uint32_t, kPageSize> generation{};
+        std::array<bool, kPageSize> live{};
+        std::array<ClientInfo, kPageSize> info{};
+    };
+
+  private:
+    /// @brief Gets the page holding a slot, pages are owned through pointers so constness does not carry over.
+    [[nodiscard]] auto PageOf(std::uint32_t index) const noexcept -> Page &;
+    [[nodiscard]] auto IsLive(std::uint32_t index) const noexcept -> bool;
+    [[nodiscard]] auto HandleOf(std::uint32_t index) const noexcept -> ClientHandle;
+    [[nodiscard]] auto LinkOf(std::uint32_t index, ClientOrder order) const noexcept -> Link &;
+    [[nodiscard]] auto Head(ClientOrder order, std::uint32_t workspace) const noexcept -> const ListHead *;
+    [[nodiscard]] auto Head(ClientOrder order, std::uint32_t workspace) noexcept -> ListHead *;
+    [[nodiscard]] auto HeadOf(ClientOrder order, std::uint32_t index) noexcept -> ListHead &;
+
+    auto AddPage() -> void;
+    auto Unlink(ClientOrder order, std::uint32_t index) noexcept -> void;
+    auto LinkFirst(ClientOrder order, std::uint32_t index) noexcept -> void;
+    auto LinkLast(ClientOrder order, std::uint32_t index) noexcept -> void;
+    auto LinkBefore(ClientOrder order, std::uint32_t index, std::uint32_t before) noexcept -> void;
+
+  private:
+    std::vector<std::unique_ptr<Page>> m_pages;
+    Tilebox::FlatMap<std::uint32_t> m_by_window;
+    ListHead m_focus;
+    ListHead m_stack;
+    std::vector<ListHead> m_workspaces;
+
+    /// @brief Free slots, linked through their focus link.
+    std::uint32_t m_free{kNil};
+    std::size_t m_size{};
+};
+
+} // namespace Tbwm
@@ -12,14 +12,20 @@
 #include <tilebox/draw/font.hpp>
 #include <tilebox/error.hpp>
 #include <tilebox/x11/display.hpp>
+#include <tilebox/x11/events.hpp>
+#include <tilebox/x11/monitors.hpp>
+#include <tilebox/x11/request_batch.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <signal.h> // NOLINT
+#include <span>
 #include <string_view>
 #include <sys/wait.h>
 #include <utility>
+#include <vector>
 
 using namespace etl;
 
@@ -58,7 +64,26 @@ auto WindowManager::Start() noexcept -> Result<Void, DynError>
             return Result<Void, DynError>(
                 std::make_shared<Tilebox::Error>("Another Window Manager is already running"));
         }
-        ProcessCleanup();
+
+        if (auto res = ProcessCleanup(); res.is_err())
+        {
+            return res;
+        }
+
+        if (auto res = WatchShutdownSignals(); res.is_err())
+        {
+            return res;
+        }
+
+        if (auto res = EnableLatencyReport(); res.is_err())
+        {
+            return res;
+        }
+
+        if (auto res = StartEventRecording(); res.is_err())
+        {
+            return res;
+        }
 
         if (auto res = Initialize(); res.is_err())
         {
@@ -66,6 +91,11 @@ auto WindowManager::Start() noexcept -> Result<Void, DynError>
         }
         Log::Debug("Running lib{} version {}", Tilebox::kTileboxName, Tilebox::kTileboxVersion);
         m_running = true;
+
+        if (auto res = m_event_loop.RunPolled(m_running); res.is_err())
+        {
+            return Result<Void, DynError>(std::make_shared<Tilebox::X11EventLoopError>(std::move(*res.err())));
+        }
     }
     return Result<Void, DynError>(Void());
 }
@@ -76,49 +106,121 @@ auto WindowManager::Start() noexcept -> Result<Void, DynError>
 
 WindowManager::WindowManager(Tilebox::X11DisplaySharedResource &&dpy, Tilebox::X11Draw &&draw,
                              std::string_view name) noexcept
-    : m_dpy(std::move(dpy)), m_draw(std::move(draw)), m_event_loop(m_dpy), m_atom_manager(m_dpy), m_name(name)
+    : m_dpy(std::move(dpy)), m_draw(std::move(draw)), m_event_loop(m_dpy), m_atom_manager(m_dpy),
+      m_property_cache(m_dpy, m_atom_manager.GetPropertyAtoms()), m_name(name)
 {
 }
 
 auto WindowManager::IsOtherWmRunning() const noexcept -> bool
 {
-    // Register startup error handler callback with the X server
-    g_error_handler_callback = XSetErrorHandler(WmStartupErrorHandler);
+    g_error_handler_callback = XSetErrorHandler(WmRuntimeErrorHandler);
 
     // This causes an error if some other window manager is currently running.
     // This works because only one client at a time can select SubstructureRedirectMask on the Root window.
     //
-    // If another which will trigger the WmStartupErrorHandler callback, which will set
-    // g_another_window_manager_is_running to true.
+    // The batch counts the error instead of the error handler, ending it syncs once.
+    Tilebox::X11RequestBatch batch(m_dpy, Tilebox::X11BatchErrors::Sync);
     XSelectInput(m_dpy->Raw(), m_dpy->GetDefaultRootWindow(), SubstructureRedirectMask);
-    m_dpy->Sync();
-
-    if (g_another_window_manager_is_running)
-    {
-        return true;
-    }
-
-    // If we make it here no startup error was triggered, swap out startup error handler with the runtime error handler
-    XSetErrorHandler(WmRuntimeErrorHandler);
-    m_dpy->Sync();
-    return false;
+    batch.End();
+    return batch.Errors() > 0;
 }
 
-void WindowManager::ProcessCleanup() noexcept
+auto WindowManager::ProcessCleanup() noexcept -> Result<Void, DynError>
 {
     struct sigaction sa{};
 
-    // Do not transform children into zombies when they terminate,
-    // this way child processes disappear automatically and no zombie is left behind for
-    // the parent to clean up.
+    // xinitrc may have left SIGCHLD ignored, in which case the kernel discards it before the signalfd sees it.
+    // Restore the default disposition, the event loop blocks the signal and reaps children when it arrives.
     sigemptyset(&sa.sa_mask);
-    sa.sa_flags = SA_NOCLDSTOP | SA_NOCLDWAIT | SA_RESTART;
-    sa.sa_handler = SIG_IGN;
+    sa.sa_flags = SA_NOCLDSTOP | SA_RESTART;
+    sa.sa_handler = SIG_DFL;
     sigaction(SIGCHLD, &sa, nullptr);
 
+    auto res = m_event_loop.WatchSignal(SIGCHLD, [](std::int32_t) -> void {
+        while (waitpid(-1, nullptr, WNOHANG) > 0) // NOLINT
+        {
+        }
+    });
+    if (res.is_err())
+    {
+        return Result<Void, DynError>(std::make_shared<Tilebox::X11EventLoopError>(std::move(*res.err())));
+    }
+
+    // Reap whatever exited before the signal was being watched
     while (waitpid(-1, nullptr, WNOHANG) > 0) // NOLINT
     {
     }
+    return Result<Void, DynError>(Void());
+}
+
+auto WindowManager::WatchShutdownSignals() noexcept -> Result<Void, DynError>
+{
+    for (const std::int32_t signal_number : {SIGTERM, SIGINT})
+    {
+        auto res = m_event_loop.WatchSignal(signal_number, [this](const std::int32_t signo) -> void {
+            Log::Info("Received signal {}, stopping the event loop", signo);
+            m_running = false;
+        });
+        if (res.is_err())
+        {
+            return Result<Void, DynError>(std::make_shared<Tilebox::X11EventLoopError>(std::move(*res.err())));
+        }
+    }
+    return Result<Void, DynError>(Void());
+}
+
+auto WindowManager::EnableLatencyReport() noexcept -> Result<Void, DynError>
+{
+    // Timestamping every event costs a clock read per event, so it stays off unless asked for
+    const char *enabled = std::getenv("TBWM_LATENCY_REPORT"); // NOLINT(concurrency-mt-unsafe)
+    if (enabled == nullptr || *enabled == '\0' || std::string_view(enabled) == "0")
+    {
+        return Result<Void, DynError>(Void());
+    }
+
+    m_event_loop.SetLatencyTracking(true);
+    m_event_loop.SetTrafficTracking(true);
+
+    auto res = m_event_loop.WatchSignal(SIGUSR1, [this](std::int32_t) -> void {
+        if (const auto *latency = m_event_loop.LatencyStats(); latency != nullptr)
+        {
+            Log::Info("Event latency since the last report:\n{}", latency->Report());
+            m_event_loop.ResetLatencyStats();
+        }
+        if (const auto *traffic = m_event_loop.TrafficStats(); traffic != nullptr)
+        {
+            const Tilebox::X11Traffic total = m_dpy->Traffic();
+            Log::Info("Protocol traffic since the last report, {} requests and {} round trips in total:\n{}",
+                      total.requests, total.round_trips, traffic->Report());
+            m_event_loop.ResetTrafficStats();
+        }
+    });
+    if (res.is_err())
+    {
+        return Result<Void, DynError>(std::make_shared<Tilebox::X11EventLoopError>(std::move(*res.err())));
+    }
+    Log::Info("Tracking event latency, send SIGUSR1 for a report");
+    return Result<Void, DynError>(Void());
+}
+
+auto WindowManager::StartEventRecording() noexcept -> Result<Void, DynError>
+{
+    const char *path = std::getenv("TBWM_RECORD_EVENTS"); // NOLINT(concurrency-mt-unsafe)
+    if (path == nullptr || *path == '\0')
+    {
+        return Result<Void, DynError>(Void());
+    }
+
+    auto res = Tilebox::X11EventRecorder::Create(path);
+    if (res.is_err())
+    {
+        return Result<Void, DynError>(std::make_shared<Tilebox::X11EventRecordError>(std::move(*res.err())));
+    }
+
+    m_event_recorder = std::make_unique<Tilebox::X11EventRecorder>(std::move(*res.ok()));
+    m_event_loop.SetEventRecorder(m_event_recorder.get());
+    Log::Info("Recording X events to {}", path);
+    return Result<Void, DynError>(Void());
 }
 
 void WindowManager::AdvertiseAsEWMHCapable() noexcept
@@ -128,7 +230,7 @@ void WindowManager::AdvertiseAsEWMHCapable() noexcept
     const Atom net_wm_name = m_atom_manager.GetNetAtom(AtomManager::Net::WmName);
     const Atom net_supported = m_atom_manager.GetNetAtom(AtomManager::Net::Supported);
     const Atom net_client_list = m_atom_manager.GetNetAtom(AtomManager::Net::ClientList);
-    const auto [net_atom_array_data, net_atom_array_size] = m_atom_manager.GetNetAtomArrayInfo();
+    const std::span<const Atom> net_atoms = m_atom_manager.GetNetAtoms();
 
     // Create a small, hidden window (1×1 pixels).
     // EWMH requires the window manager to have a special “check”
@@ -154,8 +256,8 @@ void WindowManager::AdvertiseAsEWMHCapable() noexcept
 
     // Advertise which EWMH features tbwm supports
     XChangeProperty(m_dpy->Raw(), m_dpy->GetRootWindow(), net_supported, XA_ATOM, 32, PropModeReplace,
-                    reinterpret_cast<const unsigned char *>(net_atom_array_data),
-                    static_cast<std::int32_t>(net_atom_array_size));
+                    reinterpret_cast<const unsigned char *>(net_atoms.data()),
+                    static_cast<std::int32_t>(net_atoms.size()));
 
     // Clear out the _NET_CLIENT_LIST property on the root window.
     // If there’s any leftover data from a previous window manager session, tbwm removes it. This property is later
@@ -163,6 +265,183 @@ void WindowManager::AdvertiseAsEWMHCapable() noexcept
     XDeleteProperty(m_dpy->Raw(), m_dpy->GetRootWindow(), net_client_list);
 }
 
+void WindowManager::WatchPropertyChanges() noexcept
+{
+    m_event_loop.SetPropertyCache(&m_property_cache);
+}
+
+void WindowManager::WatchClients() noexcept
+{
+    // Unmaps and destroys of managed windows are reported to the root window through SubstructureNotify
+    XSelectInput(m_dpy->Raw(), m_dpy->GetRootWindow(), SubstructureRedirectMask | SubstructureNotifyMask);
+
+    m_event_loop.RegisterEventHandler(Tilebox::X11EventType::X11MapRequest,
+                                      [this](XEvent *event) -> void { Manage(event->xmaprequest.window); });
+
+    // Synthetic unmaps are sent by clients withdrawing themselves, the real one follows
+    m_event_loop.RegisterEventHandler(Tilebox::X11EventType::X11UnmapNotify, [this](XEvent *event) -> void {
+        if (event->xunmap.send_event == False)
+        {
+            Unmanage(event->xunmap.window);
+        }
+    });
+
+    m_event_loop.RegisterEventHandler(Tilebox::X11EventType::X11DestroyNotify,
+                                      [this](XEvent *event) -> void { Unmanage(event->xdestroywindow.window); });
+}
+
+void WindowManager::Manage(const Window window) noexcept
+{
+    if (m_clients.Find(window).IsSet())
+    {
+        XMapWindow(m_dpy->Raw(), window);
+        return;
+    }
+
+    XWindowAttributes attributes{};
+    if (XGetWindowAttributes(m_dpy->Raw(), window, &attributes) == 0 || attributes.override_redirect != False)
+    {
+        return;
+    }
+
+    const ClientHandle client = m_clients.Manage(window, m_workspace);
+    if (ClientLayout *layout = m_clients.Layout(client); layout != nullptr)
+    {
+        layout->rect = Tilebox::Rect(Tilebox::Point(Tilebox::X(attributes.x), Tilebox::Y(attributes.y)),
+                                     Tilebox::Width(static_cast<std::uint32_t>(attributes.width)),
+                                     Tilebox::Height(static_cast<std::uint32_t>(attributes.height)));
+        layout->border_width = static_cast<std::uint32_t>(attributes.border_width);
+        layout->mapped = true;
+    }
+
+    // Property changes keep the property cache current for the client. It is tiled before being mapped, so it shows
+    // up in its tile right away.
+    XSelectInput(m_dpy->Raw(), window, PropertyChangeMask);
+    Arrange();
+    XMapWindow(m_dpy->Raw(), window);
+    UpdateClientList();
+    Focus(client);
+}
+
+void WindowManager::Unmanage(const Window window) noexcept
+{
+    const ClientHandle client = m_clients.Find(window);
+    if (!client.IsSet())
+    {
+        return;
+    }
+
+    // The layout only retiles from the first tile a count change moves, which assumes clients come and go at the
+    // end. Clients after this one shift down a tile, so every tile is recomputed.
+    if (m_clients.Next(ClientOrder::Workspace, client).IsSet())
+    {
+        m_layout.Invalidate();
+    }
+
+    const bool focused = m_clients.Focused() == client;
+    m_clients.Unmanage(client);
+    Arrange();
+    UpdateClientList();
+    if (focused)
+    {
+        Focus(m_clients.Focused());
+    }
+}
+
+void WindowManager::Focus(const ClientHandle client) noexcept
+{
+    const Atom net_active_window = m_atom_manager.GetNetAtom(AtomManager::Net::ActiveWindow);
+    const ClientLayout *layout = m_clients.Layout(client);
+    if (layout == nullptr)
+    {
+        XSetInputFocus(m_dpy->Raw(), PointerRoot, RevertToPointerRoot, CurrentTime);
+        XDeleteProperty(m_dpy->Raw(), m_dpy->GetRootWindow(), net_active_window);
+        return;
+    }
+
+    m_clients.Focus(client);
+    XSetInputFocus(m_dpy->Raw(), layout->window, RevertToPointerRoot, CurrentTime);
+    XChangeProperty(m_dpy->Raw(), m_dpy->GetRootWindow(), net_active_window, XA_WINDOW, 32, PropModeReplace,
+                    reinterpret_cast<const unsigned char *>(&layout->window), 1);
+}
+
+void WindowManager::WatchMonitors() noexcept
+{
+    const auto tile_primary = [this](const Tilebox::X11MonitorTable &monitors) -> void {
+        if (const Tilebox::X11Monitor *primary = monitors.Primary(); primary != nullptr)
+        {
+            Tilebox::LayoutParams params = m_layout.Params();
+            params.area = primary->geometry;
+            m_layout.SetParams(params);
+        }
+    };
+
+    tile_primary(m_dpy->Monitors());
+    if (!m_event_loop.WatchMonitors([this, tile_primary](const Tilebox::X11MonitorTable &monitors) -> void {
+            tile_primary(monitors);
+            Arrange();
+        }))
+    {
+        Log::Debug("RandR is not available, monitor changes are not followed");
+    }
+}
+
+void WindowManager::Arrange() noexcept
+{
+    m_tiled.clear();
+    m_clients.ForEach(ClientOrder::Workspace, m_workspace,
+                      [this](const ClientHandle client, const ClientLayout &layout) -> void {
+                          if (!layout.floating && !layout.fullscreen)
+                          {
+                              m_tiled.push_back(client);
+                          }
+                      });
+    m_tiles.resize(m_tiled.size());
+
+    // Only the tiles the layout recomputed moved, every other client keeps its geometry and is not configured
+    const Tilebox::LayoutChange change = m_layout.Arrange(m_tiles);
+    const std::uint32_t border = m_layout.Params().border;
+    Tilebox::X11RequestBatch batch(m_dpy);
+    for (std::size_t i = change.first; i < change.first + change.count; ++i)
+    {
+        ClientLayout *layout = m_clients.Layout(m_tiled[i]);
+        if (layout == nullptr)
+        {
+            continue;
+        }
+
+        layout->rect = m_tiles[i];
+        layout->border_width = border;
+        XWindowChanges changes{};
+        changes.x = layout->rect.GetX();
+        changes.y = layout->rect.GetY();
+        changes.width = static_cast<std::int32_t>(layout->rect.GetW());
+        changes.height = static_cast<std::int32_t>(layout->rect.GetH());
+        changes.border_width = static_cast<std::int32_t>(border);
+        XConfigureWindow(m_dpy->Raw(), layout->window, CWX | CWY | CWWidth | CWHeight | CWBorderWidth, &changes);
+    }
+    batch.End();
+}
+
+void WindowManager::UpdateClientList() noexcept
+{
+    // Every client is on exactly one workspace, each listed in the order its clients were managed. The buffer is
+    // kept, so managing only allocates when there are more clients than ever before.
+    m_client_list.clear();
+    for (std::uint32_t workspace = 0; workspace < m_clients.Workspaces(); ++workspace)
+    {
+        m_clients.ForEach(ClientOrder::Workspace, workspace,
+                          [this](ClientHandle /*client*/, const ClientLayout &layout) -> void {
+                              m_client_list.push_back(layout.window);
+                          });
+    }
+
+    const Atom net_client_list = m_atom_manager.GetNetAtom(AtomManager::Net::ClientList);
+    XChangeProperty(m_dpy->Raw(), m_dpy->GetRootWindow(), net_client_list, XA_WINDOW, 32, PropModeReplace,
+                    reinterpret_cast<const unsigned char *>(m_client_list.data()),
+                    static_cast<std::int32_t>(m_client_list.size()));
+}
+
 auto WindowManager::Initialize() noexcept -> Result<Void, DynError>
 {
     Log::Info("Initializing {}", m_name);
@@ -203,6 +482,9 @@ auto WindowManager::Initialize() noexcept -> Result<Void, DynError>
     }
 
     AdvertiseAsEWMHCapable();
+    WatchPropertyChanges();
+    WatchMonitors();
+    WatchClients();
 
     return Result<Void, DynError>(Void());
 }
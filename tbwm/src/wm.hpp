@@ -1,14 +1,23 @@
 #pragma once
 
 #include "atom_manager.hpp"
+#include "client_store.hpp"
 
 #include <etl.hpp>
 #include <tilebox/draw/draw.hpp>
 #include <tilebox/error.hpp>
+#include <tilebox/geometry.hpp>
+#include <tilebox/layout.hpp>
 #include <tilebox/x11/display.hpp>
 #include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/event_recorder.hpp>
+#include <tilebox/x11/monitors.hpp>
+#include <tilebox/x11/property_cache.hpp>
 
+#include <cstdint>
+#include <memory>
 #include <string_view>
+#include <vector>
 
 namespace Tbwm
 {
@@ -34,8 +43,22 @@ class WindowManager
     /// @returns true if another wm is running, false otherwise
     [[nodiscard]] auto IsOtherWmRunning() const noexcept -> bool;
 
-    /// @brief Clean up all zombie processes inherited from xinitrc, allows the kernel to reap all child processes
-    static void ProcessCleanup() noexcept;
+    /// @brief Clean up all zombie processes inherited from xinitrc, and reap every child that exits afterwards from
+    /// the event loop via SIGCHLD.
+    [[nodiscard]] auto ProcessCleanup() noexcept -> etl::Result<etl::Void, etl::DynError>;
+
+    /// @brief Stop the event loop on SIGTERM and SIGINT, so tbwm shuts down cleanly.
+    [[nodiscard]] auto WatchShutdownSignals() noexcept -> etl::Result<etl::Void, etl::DynError>;
+
+    /// @brief Track event latency and handler protocol traffic, log both on SIGUSR1 and clear them afterwards.
+    ///
+    /// @details Only done when the TBWM_LATENCY_REPORT environment variable is set to anything but 0.
+    [[nodiscard]] auto EnableLatencyReport() noexcept -> etl::Result<etl::Void, etl::DynError>;
+
+    /// @brief Record every X event to the file named by the TBWM_RECORD_EVENTS environment variable, if set.
+    ///
+    /// @details The recording can be replayed against the window manager logic with Tilebox::X11EventReplay.
+    [[nodiscard]] auto StartEventRecording() noexcept -> etl::Result<etl::Void, etl::DynError>;
 
     /// @brief Announces "I'm an EWMH compatible window manager" to the X11 ecosystem
     ///
@@ -47,6 +70,30 @@ class WindowManager
     /// @link https://specifications.freedesktop.org/wm-spec/latest/
     void AdvertiseAsEWMHCapable() noexcept;
 
+    /// @brief Keep the property cache in step with PropertyNotify and DestroyNotify.
+    void WatchPropertyChanges() noexcept;
+
+    /// @brief Manage windows as they ask to be mapped, and stop once they are unmapped or destroyed.
+    void WatchClients() noexcept;
+
+    /// @brief Start managing a window on the current workspace, map it and focus it.
+    void Manage(Window window) noexcept;
+
+    /// @brief Stop managing a window, focusing the most recently focused client left.
+    void Unmanage(Window window) noexcept;
+
+    /// @brief Give the input focus to a client, or to the root window for an unset or stale handle.
+    void Focus(ClientHandle client) noexcept;
+
+    /// @brief Publish every managed client in _NET_CLIENT_LIST.
+    void UpdateClientList() noexcept;
+
+    /// @brief Tile the primary monitor, and retile whenever the monitors change.
+    void WatchMonitors() noexcept;
+
+    /// @brief Tile the clients of the current workspace, configuring only the ones whose tile changed.
+    void Arrange() noexcept;
+
     /// @brief Initialize supported WM Atoms and EWMH Atoms, Fonts, Cursors and Color Schemes
     [[nodiscard]] auto Initialize() noexcept -> etl::Result<etl::Void, etl::DynError>;
 
@@ -58,8 +105,19 @@ class WindowManager
     Tilebox::X11DisplaySharedResource m_dpy;
     Tilebox::X11Draw m_draw;
     Tilebox::X11EventLoop m_event_loop;
+    std::unique_ptr<Tilebox::X11EventRecorder> m_event_recorder;
     AtomManager m_atom_manager;
+    Tilebox::X11PropertyCache m_property_cache;
+    ClientStore m_clients;
+    std::vector<Window> m_client_list;
+    Tilebox::TilingLayout m_layout;
+
+    /// @brief Tiled clients of the current workspace in layout order, and their tiles, reused by every Arrange.
+    std::vector<ClientHandle> m_tiled;
+    std::vector<Tilebox::Rect> m_tiles;
+
     Window m_ewmh_check_win{};
+    std::uint32_t m_workspace{};
     bool m_running{};
     std::string_view m_name;
 };
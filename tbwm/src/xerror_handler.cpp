@@ -11,12 +11,6 @@
 namespace Tbwm
 {
 
-auto WmStartupErrorHandler([[maybe_unused]] Display *dpy, [[maybe_unused]] XErrorEvent *ee) -> std::int32_t
-{
-    g_another_window_manager_is_running = true;
-    return -1;
-}
-
 auto WmRuntimeErrorHandler(Display *dpy, XErrorEvent *ee) -> std::int32_t
 {
     if (ee->error_code == BadWindow || (ee->request_code == X_SetInputFocus && ee->error_code == BadMatch) ||
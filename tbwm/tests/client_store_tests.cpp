@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include "client_store.hpp"
+
+#include <X11/X.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace Tbwm;
+
+namespace
+{
+
+/// @brief Heap allocations made by this test binary, read around code that must not allocate.
+std::size_t g_allocations = 0;
+
+/// @brief Gets the windows of an order first to last, checking that walking it backwards agrees.
+auto Windows(const ClientStore &store, const ClientOrder order, const std::uint32_t workspace = 0)
+    -> std::vector<Window>
+{
+    std::vector<Window> forward;
+    for (ClientHandle client = store.First(order, workspace); client.IsSet(); client = store.Next(order, client))
+    {
+        forward.push_back(store.Layout(client)->window);
+    }
+
+    std::vector<Window> backward;
+    for (ClientHandle client = store.Last(order, workspace); client.IsSet(); client = store.Prev(order, client))
+    {
+        backward.insert(backward.begin(), store.Layout(client)->window);
+    }
+    EXPECT_EQ(forward, backward);
+    return forward;
+}
+
+} // namespace
+
+// Out of line, so the compiler cannot pair an inlined free with an unrelated new expression and warn about it
+[[gnu::noinline]] auto operator new(const std::size_t size) -> void *
+{
+    ++g_allocations;
+    if (void *memory = std::malloc(size != 0 ? size : 1); memory != nullptr)
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] auto operator delete(void *memory) noexcept -> void
+{
+    std::free(memory);
+}
+
+[[gnu::noinline]] auto operator delete(void *memory, std::size_t /*size*/) noexcept -> void
+{
+    std::free(memory);
+}
+
+TEST(TbwmClientStoreTestSuite, VerifyStaleHandlesAfterUnmanage)
+{
+    ClientStore store;
+    ASSERT_FALSE(store.Manage(None, 0).IsSet());
+    ASSERT_FALSE(store.Manage(0x100, store.Workspaces()).IsSet());
+
+    const ClientHandle first = store.Manage(0x100, 0);
+    const ClientHandle second = store.Manage(0x200, 0);
+    ASSERT_TRUE(first.IsSet());
+    ASSERT_FALSE(store.Manage(0x100, 1).IsSet());
+    ASSERT_EQ(store.Find(0x100), first);
+    store.Info(first)->title = "editor";
+
+    ASSERT_TRUE(store.Unmanage(first));
+    ASSERT_EQ(store.Size(), 1);
+    ASSERT_FALSE(store.IsValid(first));
+    ASSERT_EQ(store.Layout(first), nullptr);
+    ASSERT_EQ(store.Info(first), nullptr);
+    ASSERT_FALSE(store.Find(0x100).IsSet());
+    ASSERT_FALSE(store.Unmanage(first));
+    ASSERT_FALSE(store.Focus(first));
+    ASSERT_FALSE(store.Raise(first));
+    ASSERT_FALSE(store.MoveToWorkspace(first, 1));
+    ASSERT_FALSE(store.Next(ClientOrder::Stack, first).IsSet());
+    ASSERT_EQ(Windows(store, ClientOrder::Focus), std::vector<Window>{0x200});
+
+    // The freed slot is reused, the old handle keeps failing rather than aliasing the new client
+    const ClientHandle reused = store.Manage(0x300, 0);
+    ASSERT_EQ(reused.index, first.index);
+    ASSERT_NE(reused.generation, first.generation);
+    ASSERT_FALSE(store.IsValid(first));
+    ASSERT_FALSE(store.PlaceAbove(first, second));
+    ASSERT_EQ(store.Layout(reused)->window, 0x300);
+    ASSERT_TRUE(store.Info(reused)->title.empty());
+    ASSERT_EQ(store.Find(0x300), reused);
+    ASSERT_TRUE(store.IsValid(second));
+}
+
+TEST(TbwmClientStoreTestSuite, VerifyFocusAndStackOrders)
+{
+    ClientStore store;
+    const ClientHandle a = store.Manage(0x100, 0);
+    const ClientHandle b = store.Manage(0x200, 0);
+    const ClientHandle c = store.Manage(0x300, 0);
+
+    // New clients are least recently focused and on top of the stack
+    ASSERT_EQ(Windows(store, ClientOrder::Focus), (std::vector<Window>{0x100, 0x200, 0x300}));
+    ASSERT_EQ(Windows(store, ClientOrder::Stack), (std::vector<Window>{0x300, 0x200, 0x100}));
+
+    ASSERT_TRUE(store.Focus(c));
+    ASSERT_EQ(store.Focused(), c);
+    ASSERT_TRUE(store.Focus(b));
+    ASSERT_EQ(Windows(store, ClientOrder::Focus), (std::vector<Window>{0x200, 0x300, 0x100}));
+
+    ASSERT_TRUE(store.Raise(a));
+    ASSERT_EQ(Windows(store, ClientOrder::Stack), (std::vector<Window>{0x100, 0x300, 0x200}));
+    ASSERT_TRUE(store.Lower(c));
+    ASSERT_EQ(Windows(store, ClientOrder::Stack), (std::vector<Window>{0x100, 0x200, 0x300}));
+    ASSERT_TRUE(store.PlaceAbove(c, b));
+    ASSERT_EQ(Windows(store, ClientOrder::Stack), (std::vector<Window>{0x100, 0x300, 0x200}));
+    ASSERT_TRUE(store.PlaceAbove(a, b));
+    ASSERT_EQ(Windows(store, ClientOrder::Stack), (std::vector<Window>{0x300, 0x100, 0x200}));
+    ASSERT_FALSE(store.PlaceAbove(a, a));
+
+    // Stacking and focus are independent orders
+    ASSERT_EQ(Windows(store, ClientOrder::Focus), (std::vector<Window>{0x200, 0x300, 0x100}));
+
+    // Unmanaging the focused client hands focus to the next most recent one
+    ASSERT_TRUE(store.Unmanage(b));
+    ASSERT_EQ(store.Focused(), c);
+    ASSERT_EQ(Windows(store, ClientOrder::Stack), (std::vector<Window>{0x300, 0x100}));
+    ASSERT_TRUE(store.Unmanage(a));
+    ASSERT_TRUE(store.Unmanage(c));
+    ASSERT_FALSE(store.Focused().IsSet());
+    ASSERT_TRUE(Windows(store, ClientOrder::Stack).empty());
+}
+
+TEST(TbwmClientStoreTestSuite, VerifyMoveToWorkspaceRelinks)
+{
+    ClientStore store(3);
+    const ClientHandle a = store.Manage(0x100, 0);
+    const ClientHandle b = store.Manage(0x200, 0);
+    const ClientHandle c = store.Manage(0x300, 1);
+    ASSERT_TRUE(store.Manage(0x400, 0).IsSet());
+    ASSERT_EQ(Windows(store, ClientOrder::Workspace, 0), (std::vector<Window>{0x100, 0x200, 0x400}));
+    ASSERT_EQ(Windows(store, ClientOrder::Workspace, 1), std::vector<Window>{0x300});
+    ASSERT_TRUE(Windows(store, ClientOrder::Workspace, 2).empty());
+
+    ASSERT_TRUE(store.MoveToWorkspace(b, 1));
+    ASSERT_EQ(store.Layout(b)->workspace, 1);
+    ASSERT_EQ(Windows(store, ClientOrder::Workspace, 0), (std::vector<Window>{0x100, 0x400}));
+    ASSERT_EQ(Windows(store, ClientOrder::Workspace, 1), (std::vector<Window>{0x300, 0x200}));
+
+    // Moving onto its own workspace sends a client to the end
+    ASSERT_TRUE(store.MoveToWorkspace(a, 0));
+    ASSERT_EQ(Windows(store, ClientOrder::Workspace, 0), (std::vector<Window>{0x400, 0x100}));
+
+    ASSERT_FALSE(store.MoveToWorkspace(a, 3));
+    ASSERT_EQ(store.Layout(a)->workspace, 0);
+    ASSERT_TRUE(Windows(store, ClientOrder::Workspace, 3).empty());
+
+    // Unmanage unlinks from the workspace the client was moved to
+    ASSERT_TRUE(store.Unmanage(c));
+    ASSERT_EQ(Windows(store, ClientOrder::Workspace, 1), std::vector<Window>{0x200});
+    ASSERT_EQ(Windows(store, ClientOrder::Focus), (std::vector<Window>{0x100, 0x200, 0x400}));
+}
+
+TEST(TbwmClientStoreTestSuite, VerifyManageAcrossPageBoundary)
+{
+    ClientStore store(1, ClientStore::kPageSize);
+    ASSERT_EQ(store.Capacity(), ClientStore::kPageSize);
+
+    std::vector<ClientHandle> clients;
+    for (Window window = 1; window <= ClientStore::kPageSize; ++window)
+    {
+        clients.push_back(store.Manage(window, 0));
+    }
+    ASSERT_EQ(store.Capacity(), ClientStore::kPageSize);
+    const ClientLayout *first_layout = store.Layout(clients.front());
+
+    // One past the capacity adds a page, records of the first one stay where they are
+    const ClientHandle spill = store.Manage(ClientStore::kPageSize + 1, 0);
+    ASSERT_EQ(spill.index, ClientStore::kPageSize);
+    ASSERT_EQ(store.Capacity(), 2 * ClientStore::kPageSize);
+    ASSERT_EQ(store.Layout(clients.front()), first_layout);
+    for (const ClientHandle client : clients)
+    {
+        ASSERT_TRUE(store.IsValid(client));
+    }
+    ASSERT_EQ(store.Find(ClientStore::kPageSize + 1), spill);
+    ASSERT_EQ(store.First(ClientOrder::Stack), spill);
+    ASSERT_EQ(store.Last(ClientOrder::Workspace), spill);
+
+    // Links across the boundary stay intact
+    const ClientHandle last_of_page = clients.back();
+    ASSERT_EQ(store.Next(ClientOrder::Workspace, last_of_page), spill);
+    ASSERT_TRUE(store.Unmanage(last_of_page));
+    ASSERT_EQ(store.Next(ClientOrder::Workspace, clients[clients.size() - 2]), spill);
+    ASSERT_EQ(store.Prev(ClientOrder::Stack, clients[clients.size() - 2]), spill);
+    ASSERT_EQ(Windows(store, ClientOrder::Workspace).size(), ClientStore::kPageSize);
+
+    // The slot freed in the first page is reused before the second page fills up
+    ASSERT_EQ(store.Manage(0x1000, 0).index, last_of_page.index);
+}
+
+TEST(TbwmClientStoreTestSuite, VerifyReservedCapacityDoesNotAllocate)
+{
+    constexpr std::size_t kClients = 200;
+    ClientStore store;
+    store.Reserve(kClients);
+    ASSERT_GE(store.Capacity(), kClients);
+    std::vector<ClientHandle> clients(kClients);
+
+    const std::size_t allocations = g_allocations;
+    for (std::size_t i = 0; i < kClients; ++i)
+    {
+        const auto window = static_cast<Window>(0x400000 + i);
+        clients[i] = store.Manage(window, static_cast<std::uint32_t>(i % store.Workspaces()));
+        store.Focus(clients[i]);
+    }
+    for (std::size_t i = 0; i < kClients; i += 2)
+    {
+        store.Raise(clients[i]);
+        store.MoveToWorkspace(clients[i], 0);
+        store.Unmanage(clients[i]);
+    }
+    for (std::size_t i = 0; i < kClients; i += 2)
+    {
+        clients[i] = store.Manage(static_cast<Window>(0x500000 + i), 1);
+    }
+    const std::size_t allocated = g_allocations - allocations;
+
+    ASSERT_EQ(allocated, 0);
+    ASSERT_EQ(store.Size(), kClients);
+    for (const ClientHandle client : clients)
+    {
+        ASSERT_TRUE(store.IsValid(client));
+    }
+}
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/events.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+using namespace Tilebox;
+
+namespace
+{
+
+constexpr std::size_t kEventCount = 1024;
+
+/// @brief Motion heavy event mix resembling a drag: mostly MotionNotify with crossing, button,
+/// expose, configure and property traffic sprinkled in, plus a few event types with no handler.
+auto BuildEventMix() -> std::array<XEvent, kEventCount>
+{
+    constexpr std::array<std::int32_t, 16> pattern = {
+        MotionNotify, MotionNotify, MotionNotify, MotionNotify, MotionNotify, MotionNotify, MotionNotify, MotionNotify,
+        EnterNotify, LeaveNotify, ButtonPress, ButtonRelease, Expose, PropertyNotify, FocusIn, ConfigureNotify};
+
+    std::array<XEvent, kEventCount> events{};
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        events[i].type = pattern[i % pattern.size()];
+    }
+    return events;
+}
+
+auto CountingHandler(std::uint64_t &counter)
+{
+    return [&counter](XEvent *event) -> void {
+        counter += static_cast<std::uint64_t>(event->type);
+        benchmark::DoNotOptimize(counter);
+    };
+}
+
+/// @brief The dispatch path X11EventLoop used before the flat table: a contains() and an at() hash lookup
+/// followed by a call through std::function.
+void BM_DispatchUnorderedMapStdFunction(benchmark::State &state)
+{
+    std::uint64_t counter = 0;
+    std::unordered_map<X11EventType, std::function<void(XEvent *)>> handlers;
+    for (const auto type : {X11EventType::X11MotionNotify, X11EventType::X11EnterNotify, X11EventType::X11LeaveNotify,
+                            X11EventType::X11ButtonPress, X11EventType::X11ButtonRelease, X11EventType::X11Expose,
+                            X11EventType::X11PropertyNotify})
+    {
+        handlers.emplace(type, CountingHandler(counter));
+    }
+
+    auto events = BuildEventMix();
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        XEvent &event = events[i++ % kEventCount];
+        if (const X11EventType event_type = EventFromXlibEvent(event.type); handlers.contains(event_type))
+        {
+            handlers.at(event_type)(&event);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatchUnorderedMapStdFunction);
+
+/// @brief The current X11EventLoop dispatch path, no X server needed.
+void BM_DispatchFlatTableInplaceFunction(benchmark::State &state)
+{
+    std::uint64_t counter = 0;
+    X11EventLoop loop(nullptr);
+    for (const auto type : {X11EventType::X11MotionNotify, X11EventType::X11EnterNotify, X11EventType::X11LeaveNotify,
+                            X11EventType::X11ButtonPress, X11EventType::X11ButtonRelease, X11EventType::X11Expose,
+                            X11EventType::X11PropertyNotify})
+    {
+        loop.RegisterEventHandler(type, CountingHandler(counter));
+    }
+
+    auto events = BuildEventMix();
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        loop.Dispatch(&events[i++ % kEventCount]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatchFlatTableInplaceFunction);
+
+} // namespace
@@ -0,0 +1,293 @@
+#include <benchmark/benchmark.h>
+
+#include <tilebox/geometry.hpp>
+#include <tilebox/layout.hpp>
+#include <tilebox/rect_batch.hpp>
+#include <tilebox/spatial_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+
+struct MonitorSetup
+{
+    const char *name;
+    std::vector<Rect> monitors;
+};
+
+/// @brief Monitor configurations selected by benchmark argument, laid out left to right as RandR reports them.
+auto Setup(const std::int64_t index) -> MonitorSetup
+{
+    const auto monitor = [](const std::int32_t x, const std::uint32_t w, const std::uint32_t h) {
+        return Rect(Point(X(x), Y(0)), Width(w), Height(h));
+    };
+
+    switch (index)
+    {
+    case 1:
+        return {"2x1080p", {monitor(0, 1920, 1080), monitor(1920, 1920, 1080)}};
+    case 2:
+        return {"4k+1440p", {monitor(0, 3840, 2160), monitor(3840, 2560, 1440)}};
+    case 3:
+        return {"3x1440p", {monitor(0, 2560, 1440), monitor(2560, 2560, 1440), monitor(5120, 2560, 1440)}};
+    default:
+        return {"1080p", {monitor(0, 1920, 1080)}};
+    }
+}
+
+constexpr std::int64_t kSetups = 4;
+
+/// @brief Bounding box of every monitor, what a SpatialIndex covers.
+auto Union(const std::vector<Rect> &monitors) -> Rect
+{
+    std::int32_t right = 0;
+    std::uint32_t bottom = 1;
+    for (const Rect &monitor : monitors)
+    {
+        right = std::max(right, monitor.GetX() + static_cast<std::int32_t>(monitor.GetW()));
+        bottom = std::max(bottom, monitor.GetH());
+    }
+    return {Width(static_cast<std::uint32_t>(right)), Height(bottom)};
+}
+
+/// @brief Floating window sized rects scattered over the monitors, the same for every run.
+auto RandomRects(const std::vector<Rect> &monitors, const std::size_t count) -> std::vector<Rect>
+{
+    const Rect bounds = Union(monitors);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<std::int32_t> x(0, static_cast<std::int32_t>(bounds.GetW()) - 1);
+    std::uniform_int_distribution<std::int32_t> y(0, static_cast<std::int32_t>(bounds.GetH()) - 1);
+    std::uniform_int_distribution<std::uint32_t> size(80, 900);
+
+    std::vector<Rect> rects;
+    rects.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        rects.emplace_back(Point(X(x(rng)), Y(y(rng))), Width(size(rng)), Height(size(rng)));
+    }
+    return rects;
+}
+
+auto RandomPoints(const std::vector<Rect> &monitors, const std::size_t count) -> std::vector<Point>
+{
+    const Rect bounds = Union(monitors);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::int32_t> x(0, static_cast<std::int32_t>(bounds.GetW()) - 1);
+    std::uniform_int_distribution<std::int32_t> y(0, static_cast<std::int32_t>(bounds.GetH()) - 1);
+
+    std::vector<Point> points;
+    points.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        points.emplace_back(X(x(rng)), Y(y(rng)));
+    }
+    return points;
+}
+
+/// @brief One layout and tile buffer per monitor, clients spread round robin.
+struct Screen
+{
+    std::vector<TilingLayout> layouts;
+    std::vector<std::vector<Rect>> tiles;
+
+    Screen(const LayoutKind kind, const std::vector<Rect> &monitors, const std::size_t clients)
+    {
+        for (std::size_t m = 0; m < monitors.size(); ++m)
+        {
+            layouts.emplace_back(kind, LayoutParams{.area = monitors[m], .masters = 1, .gap = 4, .border = 1});
+            tiles.emplace_back((clients / monitors.size()) + (m < clients % monitors.size() ? 1 : 0));
+        }
+    }
+};
+
+auto ClientsArgs(benchmark::internal::Benchmark *benchmark) -> void
+{
+    benchmark->ArgNames({"kind", "clients", "setup"});
+    for (std::int64_t kind = 0; kind <= static_cast<std::int64_t>(LayoutKind::CenteredMaster); ++kind)
+    {
+        for (std::int64_t setup = 0; setup < kSetups; ++setup)
+        {
+            for (const std::int64_t clients : {1, 10, 100, 1000, 10000})
+            {
+                benchmark->Args({kind, clients, setup});
+            }
+        }
+    }
+}
+
+auto RectArgs(benchmark::internal::Benchmark *benchmark) -> void
+{
+    benchmark->ArgNames({"rects", "setup"});
+    benchmark->ArgsProduct({benchmark::CreateRange(1, 10000, 10), {0, 3}});
+}
+
+/// @brief Every tile of every monitor from scratch, e.g. after switching layouts or workspaces.
+void BM_LayoutArrangeFull(benchmark::State &state)
+{
+    const MonitorSetup setup = Setup(state.range(2));
+    Screen screen(static_cast<LayoutKind>(state.range(0)), setup.monitors, static_cast<std::size_t>(state.range(1)));
+
+    for (auto _ : state)
+    {
+        for (std::size_t m = 0; m < screen.layouts.size(); ++m)
+        {
+            screen.layouts[m].Invalidate();
+            benchmark::DoNotOptimize(screen.layouts[m].Arrange(screen.tiles[m]));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    state.SetLabel(setup.name);
+}
+BENCHMARK(BM_LayoutArrangeFull)->Apply(ClientsArgs);
+
+/// @brief A client mapped on and then removed from the first monitor, relaid out incrementally each time.
+void BM_LayoutRelayoutInsertRemove(benchmark::State &state)
+{
+    const MonitorSetup setup = Setup(state.range(2));
+    Screen screen(static_cast<LayoutKind>(state.range(0)), setup.monitors, static_cast<std::size_t>(state.range(1)));
+    TilingLayout &layout = screen.layouts.front();
+    std::vector<Rect> &tiles = screen.tiles.front();
+    layout.Arrange(tiles);
+
+    std::size_t touched = 0;
+    for (auto _ : state)
+    {
+        tiles.emplace_back();
+        touched += layout.Arrange(tiles).count;
+        tiles.pop_back();
+        touched += layout.Arrange(tiles).count;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+    state.counters["tiles_per_change"] =
+        benchmark::Counter(static_cast<double>(touched) / 2, benchmark::Counter::kAvgIterations);
+    state.SetLabel(setup.name);
+}
+BENCHMARK(BM_LayoutRelayoutInsertRemove)->Apply(ClientsArgs);
+
+/// @brief Border both ShrinkIn benchmarks take off, wide enough that every rect actually changes.
+constexpr std::uint32_t kShrinkBorder = 2;
+
+/// @brief Border shrinking one Rect at a time, the baseline of the RectBatch kernel below.
+void BM_GeometryShrinkInRect(benchmark::State &state)
+{
+    const std::vector<Rect> rects =
+        RandomRects(Setup(state.range(1)).monitors, static_cast<std::size_t>(state.range(0)));
+    std::vector<Rect> out(rects.size());
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < rects.size(); ++i)
+        {
+            out[i] = rects[i].ShrinkIn(kShrinkBorder);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GeometryShrinkInRect)->Apply(RectArgs);
+
+void BM_GeometryShrinkInRectBatch(benchmark::State &state)
+{
+    const std::vector<Rect> rects =
+        RandomRects(Setup(state.range(1)).monitors, static_cast<std::size_t>(state.range(0)));
+    RectBatch pristine(rects.size());
+    for (const Rect &rect : rects)
+    {
+        pristine.Push(rect);
+    }
+    RectBatch batch = pristine;
+
+    for (auto _ : state)
+    {
+        // Shrinking works in place, so every iteration starts from a copy of the input. The copy reuses the arrays
+        // and reads the input once, as the baseline does writing into a separate vector.
+        batch = pristine;
+        batch.ShrinkIn(kShrinkBorder);
+        benchmark::DoNotOptimize(batch.Widths().data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GeometryShrinkInRectBatch)->Apply(RectArgs);
+
+/// @brief Window under the pointer by scanning every rect with Rect::ContainsPoint, topmost first as SpatialIndex
+/// stacks them, the last inserted on top.
+void BM_HitTestLinearScan(benchmark::State &state)
+{
+    const MonitorSetup setup = Setup(state.range(1));
+    const std::vector<Rect> rects = RandomRects(setup.monitors, static_cast<std::size_t>(state.range(0)));
+    const std::vector<Point> points = RandomPoints(setup.monitors, 1024);
+
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        const Point &point = points[i++ % points.size()];
+        std::optional<std::size_t> hit;
+        for (std::size_t r = rects.size(); r > 0 && !hit; --r)
+        {
+            if (rects[r - 1].ContainsPoint(point))
+            {
+                hit = r - 1;
+            }
+        }
+        benchmark::DoNotOptimize(hit);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(setup.name);
+}
+BENCHMARK(BM_HitTestLinearScan)->Apply(RectArgs);
+
+void BM_HitTestRectBatch(benchmark::State &state)
+{
+    const MonitorSetup setup = Setup(state.range(1));
+    const std::vector<Rect> rects = RandomRects(setup.monitors, static_cast<std::size_t>(state.range(0)));
+    const std::vector<Point> points = RandomPoints(setup.monitors, 1024);
+    RectBatch batch(rects.size());
+    for (const Rect &rect : rects)
+    {
+        batch.Push(rect);
+    }
+
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(batch.FindContaining(points[i++ % points.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(setup.name);
+}
+BENCHMARK(BM_HitTestRectBatch)->Apply(RectArgs);
+
+void BM_HitTestSpatialIndex(benchmark::State &state)
+{
+    const MonitorSetup setup = Setup(state.range(1));
+    const std::vector<Rect> rects = RandomRects(setup.monitors, static_cast<std::size_t>(state.range(0)));
+    const std::vector<Point> points = RandomPoints(setup.monitors, 1024);
+    SpatialIndex index(Union(setup.monitors));
+    for (std::size_t r = 0; r < rects.size(); ++r)
+    {
+        index.Insert(r + 1, rects[r]);
+    }
+
+    std::size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(index.TopmostAt(points[i++ % points.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(setup.name);
+}
+BENCHMARK(BM_HitTestSpatialIndex)->Apply(RectArgs);
+
+} // namespace
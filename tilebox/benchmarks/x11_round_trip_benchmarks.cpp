@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/xcb.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <xcb/xproto.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+
+auto OpenDisplay(benchmark::State &state) -> X11DisplaySharedResource
+{
+    if (auto dpy = X11Display::Create(); dpy.has_value())
+    {
+        return *dpy;
+    }
+    state.SkipWithError("Could not open x11 display");
+    return nullptr;
+}
+
+/// @brief What managing a window costs through Xlib: attributes, geometry and a property per window, every call
+/// blocks for its own round trip. Atoms are not compared, Xlib caches them client side.
+void BM_ManageWindowsXlib(benchmark::State &state)
+{
+    const auto dpy = OpenDisplay(state);
+    if (dpy == nullptr)
+    {
+        return;
+    }
+
+    const std::vector<Window> windows(static_cast<std::size_t>(state.range(0)), dpy->GetRootWindow());
+    const Atom wm_name = XInternAtom(dpy->Raw(), "_NET_WM_NAME", False);
+    const Atom utf8_string = XInternAtom(dpy->Raw(), "UTF8_STRING", False);
+    for (auto _ : state)
+    {
+        for (const Window window : windows)
+        {
+            XWindowAttributes attributes{};
+            benchmark::DoNotOptimize(XGetWindowAttributes(dpy->Raw(), window, &attributes));
+
+            Window root{};
+            std::int32_t x{};
+            std::int32_t y{};
+            std::uint32_t width{};
+            std::uint32_t height{};
+            std::uint32_t border{};
+            std::uint32_t depth{};
+            benchmark::DoNotOptimize(
+                XGetGeometry(dpy->Raw(), window, &root, &x, &y, &width, &height, &border, &depth));
+
+            Atom type{};
+            std::int32_t format{};
+            unsigned long items{};
+            unsigned long remaining{};
+            unsigned char *data = nullptr;
+            XGetWindowProperty(dpy->Raw(), window, wm_name, 0, 64, False, utf8_string, &type, &format, &items,
+                               &remaining, &data);
+            if (data != nullptr)
+            {
+                XFree(data);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["round_trips"] = static_cast<double>(state.range(0) * 3);
+}
+BENCHMARK(BM_ManageWindowsXlib)->Arg(1)->Arg(16)->Arg(64);
+
+/// @brief The same requests pipelined through cookies.
+void BM_ManageWindowsXcbCookies(benchmark::State &state)
+{
+    const auto dpy = OpenDisplay(state);
+    if (dpy == nullptr)
+    {
+        return;
+    }
+
+    const X11XcbConnection xcb = dpy->Xcb();
+    const std::vector<Window> windows(static_cast<std::size_t>(state.range(0)), dpy->GetRootWindow());
+    const Atom wm_name = XInternAtom(dpy->Raw(), "_NET_WM_NAME", False);
+    const Atom utf8_string = XInternAtom(dpy->Raw(), "UTF8_STRING", False);
+
+    struct Cookies
+    {
+        X11Cookie<xcb_get_window_attributes_reply_t> attributes;
+        X11Cookie<xcb_get_geometry_reply_t> geometry;
+        X11Cookie<xcb_get_property_reply_t> name;
+    };
+    std::vector<Cookies> cookies(windows.size());
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < windows.size(); ++i)
+        {
+            cookies[i].attributes = xcb.GetWindowAttributes(windows[i]);
+            cookies[i].geometry = xcb.GetGeometry(windows[i]);
+            cookies[i].name = xcb.GetProperty(windows[i], wm_name, utf8_string, 0, 64);
+        }
+        for (auto &window_cookies : cookies)
+        {
+            benchmark::DoNotOptimize(window_cookies.attributes.Get());
+            benchmark::DoNotOptimize(window_cookies.geometry.Get());
+            benchmark::DoNotOptimize(window_cookies.name.Get());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["round_trips"] = 1.0;
+}
+BENCHMARK(BM_ManageWindowsXcbCookies)->Arg(1)->Arg(16)->Arg(64);
+
+} // namespace
@@ -55,4 +55,43 @@ class X11CursorError final : public etl::BaseError
     }
 };
 
+class X11EventLoopError final : public etl::BaseError
+{
+  public:
+    explicit X11EventLoopError(const std::string_view &msg) noexcept : etl::BaseError(msg)
+    {
+    }
+
+    X11EventLoopError(const std::string_view &msg, const etl::SourceCodeLocation &slc) noexcept
+        : etl::BaseError(msg, slc)
+    {
+    }
+};
+
+class X11EventRecordError final : public etl::BaseError
+{
+  public:
+    explicit X11EventRecordError(const std::string_view &msg) noexcept : etl::BaseError(msg)
+    {
+    }
+
+    X11EventRecordError(const std::string_view &msg, const etl::SourceCodeLocation &slc) noexcept
+        : etl::BaseError(msg, slc)
+    {
+    }
+};
+
+class X11XInputError final : public etl::BaseError
+{
+  public:
+    explicit X11XInputError(const std::string_view &msg) noexcept : etl::BaseError(msg)
+    {
+    }
+
+    X11XInputError(const std::string_view &msg, const etl::SourceCodeLocation &slc) noexcept
+        : etl::BaseError(msg, slc)
+    {
+    }
+};
+
 } // namespace Tilebox
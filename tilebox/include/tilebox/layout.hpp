@@ -0,0 +1,108 @@
+#pragma once
+
+#include "tilebox/geometry.hpp"
+#include "tilebox/utils/attributes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Tilebox
+{
+
+/// @brief Arrangements a TilingLayout computes.
+enum class LayoutKind : std::uint8_t
+{
+    /// @brief Masters stacked in a column on the left, the other clients stacked on the right.
+    MasterStack,
+
+    /// @brief Rows of equally wide columns, the last row spread over the whole width.
+    Grid,
+
+    /// @brief Every client fills the whole area.
+    Monocle,
+
+    /// @brief One full height column per client.
+    Columns,
+
+    /// @brief Masters in the middle, the other clients alternating between a stack on the right and one on the left.
+    CenteredMaster,
+};
+
+struct TILEBOX_EXPORT LayoutParams
+{
+    /// @brief The area to tile, e.g. a monitor without its bar.
+    Rect area;
+
+    /// @brief Number of clients in the master area.
+    std::uint32_t masters{1};
+
+    /// @brief Share of the width the master area gets, in thousandths.
+    std::uint32_t master_permille{550};
+
+    /// @brief Pixels between tiles and around the area.
+    std::uint32_t gap{};
+
+    /// @brief Border width of the clients, tiles are the window geometry without it.
+    std::uint32_t border{};
+
+    [[nodiscard]] auto operator==(const LayoutParams &rhs) const noexcept -> bool = default;
+};
+
+/// @brief Tiles recomputed by TilingLayout::Arrange, all others kept their geometry.
+struct TILEBOX_EXPORT LayoutChange
+{
+    std::size_t first{};
+    std::size_t count{};
+};
+
+/// @brief Tiles clients into a caller owned buffer, one Rect per client in layout order.
+///
+/// @details Arrange never allocates. Lengths are split with integer arithmetic, the remainder going one pixel each to
+/// the first tiles, so tiles and gaps always add up to the area exactly. Tiles are X11 window geometry, the position
+/// of the outer border corner and the size inside the border, i.e. the cell shrunk in by the border width. The
+/// layout remembers the client count of its last Arrange, and when only the count changed it recomputes only the
+/// tiles that move, e.g. just the stack when a client joins the stack of a MasterStack layout.
+class TILEBOX_EXPORT TilingLayout
+{
+  public:
+    explicit TilingLayout(LayoutKind kind = LayoutKind::MasterStack, const LayoutParams &params = {}) noexcept;
+
+  public:
+    [[nodiscard]] auto Kind() const noexcept -> LayoutKind;
+    [[nodiscard]] auto Params() const noexcept -> const LayoutParams &;
+
+    /// @brief Switches the arrangement, the next Arrange recomputes every tile.
+    auto SetKind(LayoutKind kind) noexcept -> void;
+
+    /// @brief Changes area, masters, gaps or borders, the next Arrange recomputes every tile if any differs.
+    auto SetParams(const LayoutParams &params) noexcept -> void;
+
+    /// @brief Forces the next Arrange to recompute every tile, e.g. for a new buffer.
+    auto Invalidate() noexcept -> void;
+
+    /// @brief Computes a tile per entry of `tiles`.
+    ///
+    /// @details Tiles outside of the returned change are left untouched and keep what the previous Arrange wrote,
+    /// so the same buffer must be passed each time, resized to the client count, or Invalidate called.
+    ///
+    /// @returns the tiles written, the only ones to configure.
+    auto Arrange(std::span<Rect> tiles) noexcept -> LayoutChange;
+
+    /// @brief Computes the tile of the client at `index` out of `count`, without touching any state.
+    ///
+    /// @returns a default Rect if `index` is not below `count`, e.g. for a count of 0.
+    [[nodiscard]] auto TileOf(std::size_t index, std::size_t count) const noexcept -> Rect;
+
+  private:
+    /// @brief Index of the first tile whose geometry depends on the client count going from `before` to `after`.
+    [[nodiscard]] auto FirstAffected(std::size_t before, std::size_t after) const noexcept -> std::size_t;
+
+  private:
+    LayoutKind m_kind;
+    LayoutParams m_params;
+    std::size_t m_count{};
+    bool m_valid{};
+};
+
+} // namespace Tilebox
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "tilebox/geometry.hpp"
+#include "tilebox/utils/attributes.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace Tilebox
+{
+
+/// @brief Half open box of a Region, covering the pixels x1 <= x < x2 and y1 <= y < y2.
+struct TILEBOX_EXPORT RegionBox
+{
+    std::int32_t x1{};
+    std::int32_t y1{};
+    std::int32_t x2{};
+    std::int32_t y2{};
+
+    /// @brief Converts to the Rect covering the same pixels
+    [[nodiscard]] auto ToRect() const noexcept -> Rect;
+
+    [[nodiscard]] auto operator==(const RegionBox &rhs) const noexcept -> bool = default;
+};
+
+/// @brief Set of pixels stored as y-x banded boxes, as X11 and pixman regions are.
+///
+/// @details Boxes are sorted into horizontal bands, boxes of a band share their top and bottom and are sorted by x
+/// without touching, and vertically adjoining bands with the same x spans are merged, so every set of pixels has
+/// exactly one representation. Union, intersection and subtraction sweep both regions band by band in linear time.
+/// Up to kInlineBoxes boxes live inside the Region itself, only more complex regions allocate.
+///
+/// Unlike Rect::ContainsPoint a region covers pixels, a Rect of width w spans x to x + w - 1.
+class TILEBOX_EXPORT Region
+{
+  public:
+    static constexpr std::size_t kInlineBoxes = 8;
+
+  public:
+    /// @brief Builds an empty region
+    Region() noexcept = default;
+
+    /// @brief Builds the region covering `rect`, empty if it has no width or height
+    explicit Region(const Rect &rect) noexcept;
+
+    ~Region() = default;
+    Region(const Region &other);
+    auto operator=(const Region &other) -> Region &;
+    Region(Region &&other) noexcept;
+    auto operator=(Region &&other) noexcept -> Region &;
+
+  public:
+    /// @brief Check whether the region covers no pixel
+    [[nodiscard]] auto Empty() const noexcept -> bool;
+
+    /// @brief Gets the banded boxes, sorted top to bottom and left to right
+    [[nodiscard]] auto Boxes() const noexcept -> std::span<const RegionBox>;
+
+    /// @brief Gets the bounding box, all zeros for an empty region
+    [[nodiscard]] auto Extents() const noexcept -> const RegionBox &;
+
+    /// @brief Gets the number of pixels covered
+    [[nodiscard]] auto Area() const noexcept -> std::uint64_t;
+
+    /// @brief Removes every box, keeping allocated storage
+    auto Clear() noexcept -> void;
+
+    auto Union(const Region &other) -> Region &;
+    auto Union(const Rect &rect) -> Region &;
+    auto Intersect(const Region &other) -> Region &;
+    auto Intersect(const Rect &rect) -> Region &;
+    auto Subtract(const Region &other) -> Region &;
+    auto Subtract(const Rect &rect) -> Region &;
+
+    /// @brief Moves every box by (dx, dy)
+    auto Translate(std::int32_t dx, std::int32_t dy) noexcept -> void;
+
+    /// @brief Check whether the pixel at `point` is covered
+    [[nodiscard]] auto ContainsPoint(const Point &point) const noexcept -> bool;
+
+    /// @brief Check whether every pixel of `rect` is covered, e.g. whether windows above occlude a window entirely
+    [[nodiscard]] auto ContainsRect(const Rect &rect) const -> bool;
+
+    /// @brief Check whether any pixel of `rect` is covered
+    [[nodiscard]] auto Intersects(const Rect &rect) const noexcept -> bool;
+
+    [[nodiscard]] auto operator==(const Region &rhs) const noexcept -> bool;
+
+  private:
+    enum class Operation : std::uint8_t
+    {
+        Union,
+        Intersect,
+        Subtract,
+    };
+
+  private:
+    [[nodiscard]] static auto Combine(const Region &lhs, const Region &rhs, Operation operation) -> Region;
+
+    [[nodiscard]] auto Data() noexcept -> RegionBox *;
+    [[nodiscard]] auto Data() const noexcept -> const RegionBox *;
+
+    auto Push(const RegionBox &box) -> void;
+
+    /// @brief Appends a band, merging it into the previous band if they adjoin with the same x spans.
+    ///
+    /// @param spans Boxes of the band in x order, only their x coordinates are used.
+    auto AppendBand(std::span<const RegionBox> spans, std::int32_t y1, std::int32_t y2) -> void;
+
+    /// @brief Merges the band starting at `band` into the previous one if possible.
+    auto Coalesce(std::size_t band) noexcept -> void;
+
+    auto UpdateExtents() noexcept -> void;
+
+  private:
+    std::array<RegionBox, kInlineBoxes> m_inline{};
+    std::unique_ptr<RegionBox[]> m_heap;
+    std::uint32_t m_size{};
+    std::uint32_t m_capacity{kInlineBoxes};
+
+    /// @brief Start of the last band, where the next appended band may be merged into.
+    std::uint32_t m_last_band{};
+    RegionBox m_extents;
+};
+
+} // namespace Tilebox
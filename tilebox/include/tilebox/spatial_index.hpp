@@ -0,0 +1,121 @@
+#pragma once
+
+#include "tilebox/geometry.hpp"
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/utils/flat_map.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Tilebox
+{
+
+/// @brief Uniform grid over the screen answering which window or monitor is under a point, without asking the
+/// server with XQueryPointer or XQueryTree.
+///
+/// @details Every cell lists the rects overlapping it, a point query only tests the rects of its cell. Rects reaching
+/// past the bounds are also kept in an overflow list, which answers points outside of the bounds. Rects are keyed by
+/// a non zero id such as a Window, and stacked by a layer, higher layers above lower ones, and within a layer by
+/// when they were inserted or restacked last, the latest on top. Points hit rects as in Rect::ContainsPoint, edges
+/// included.
+class TILEBOX_EXPORT SpatialIndex
+{
+  public:
+    using Id = FlatMap<std::uint32_t>::Key;
+
+    static constexpr std::uint32_t kDefaultCellSize = 256;
+
+  public:
+    /// @param bounds The area most points fall into, e.g. the union of all monitors.
+    /// @param cell_size Side length of a cell in pixels, about the size of the smallest common window works well.
+    explicit SpatialIndex(const Rect &bounds, std::uint32_t cell_size = kDefaultCellSize);
+
+  public:
+    /// @brief Gets the number of rects
+    [[nodiscard]] auto Size() const noexcept -> std::size_t;
+
+    /// @brief Gets the area covered by the grid
+    [[nodiscard]] auto Bounds() const noexcept -> const Rect &;
+
+    /// @brief Adds a rect on top of its layer.
+    ///
+    /// @returns false if the id is 0 or already present.
+    auto Insert(Id id, const Rect &rect, std::uint32_t layer = 0) -> bool;
+
+    /// @brief Updates the rect of an id, keeping its place in the stack, e.g. on ConfigureNotify.
+    ///
+    /// @returns false if the id is not present.
+    auto Move(Id id, const Rect &rect) -> bool;
+
+    /// @brief Puts an id on top of `layer`, e.g. when its window is raised.
+    ///
+    /// @returns false if the id is not present.
+    auto Restack(Id id, std::uint32_t layer) noexcept -> bool;
+
+    /// @returns false if the id is not present.
+    auto Remove(Id id) -> bool;
+
+    /// @brief Removes every rect, keeping the bounds.
+    auto Clear() -> void;
+
+    /// @brief Changes the bounds and cell size, reinserting every rect, e.g. after the monitors changed.
+    auto Rebuild(const Rect &bounds, std::uint32_t cell_size = kDefaultCellSize) -> void;
+
+    /// @brief Check whether an id is present
+    [[nodiscard]] auto Contains(Id id) const noexcept -> bool;
+
+    /// @brief Gets the rect of an id, if present.
+    [[nodiscard]] auto Find(Id id) const noexcept -> std::optional<Rect>;
+
+    /// @brief Gets the topmost rect containing `point`.
+    [[nodiscard]] auto TopmostAt(const Point &point) const noexcept -> std::optional<Id>;
+
+    /// @brief Replaces the content of `out` with every rect containing `point`, topmost first.
+    auto QueryPoint(const Point &point, std::vector<Id> &out) const -> void;
+
+  private:
+    struct Entry
+    {
+        Id id{};
+        Rect rect;
+        std::uint32_t layer{};
+        std::uint64_t stamp{};
+
+        /// @brief Cells covered, inclusive, none if first_row > last_row.
+        std::uint32_t first_column{1};
+        std::uint32_t last_column{};
+        std::uint32_t first_row{1};
+        std::uint32_t last_row{};
+        bool overflow{};
+    };
+
+  private:
+    [[nodiscard]] auto CellOf(const Point &point) const noexcept -> std::optional<std::size_t>;
+    [[nodiscard]] auto Candidates(const Point &point) const noexcept -> const std::vector<std::uint32_t> &;
+    [[nodiscard]] static auto IsAbove(const Entry &lhs, const Entry &rhs) noexcept -> bool;
+
+    auto Link(std::uint32_t slot) -> void;
+    auto Unlink(std::uint32_t slot) noexcept -> void;
+    auto Cover(Entry &entry) const noexcept -> void;
+
+  private:
+    Rect m_bounds;
+    std::uint32_t m_cell_size;
+    std::uint32_t m_columns{};
+    std::uint32_t m_rows{};
+
+    /// @brief Slots of the entries overlapping each cell, row major.
+    std::vector<std::vector<std::uint32_t>> m_cells;
+
+    /// @brief Slots of the entries reaching past the bounds.
+    std::vector<std::uint32_t> m_overflow;
+
+    std::vector<Entry> m_entries;
+    std::vector<std::uint32_t> m_free;
+    FlatMap<std::uint32_t> m_by_id;
+    std::uint64_t m_stamp{};
+};
+
+} // namespace Tilebox
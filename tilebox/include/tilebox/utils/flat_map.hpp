@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Tilebox
+{
+
+/// @brief Open addressing hash map from non zero 64 bit keys to values.
+///
+/// @details Linear probing over a power of two slot array with backward shift deletion, so lookups never walk
+/// tombstones. Key 0 marks an empty slot and can not be stored, which suits XIDs and keys derived from them.
+/// Only growth allocates, Reserve up front to keep inserts allocation free.
+///
+/// @note Pointers returned by Find and Insert are invalidated by any later Insert or Erase.
+template <typename Value> class FlatMap
+{
+  public:
+    using Key = std::uint64_t;
+
+    static constexpr Key kEmptyKey = 0;
+
+  public:
+    FlatMap() = default;
+
+    explicit FlatMap(const std::size_t capacity)
+    {
+        Reserve(capacity);
+    }
+
+  public:
+    /// @brief Gets the number of stored entries
+    [[nodiscard]] auto Size() const noexcept -> std::size_t
+    {
+        return m_size;
+    }
+
+    /// @brief Check whether the map holds no entries
+    [[nodiscard]] auto Empty() const noexcept -> bool
+    {
+        return m_size == 0;
+    }
+
+    /// @brief Makes room for `count` entries without further allocation.
+    auto Reserve(const std::size_t count) -> void
+    {
+        // Keep the load factor at or below 1/2 so probe sequences stay short.
+        const std::size_t wanted = std::bit_ceil(std::max<std::size_t>(count * 2, kMinSlots));
+        if (wanted > m_slots.size())
+        {
+            Rehash(wanted);
+        }
+    }
+
+    /// @brief Finds the value stored for `key`, nullptr if absent.
+    [[nodiscard]] auto Find(const Key key) noexcept -> Value *
+    {
+        if (m_size == 0 || key == kEmptyKey)
+        {
+            return nullptr;
+        }
+
+        for (std::size_t i = Home(key);; i = (i + 1) & m_mask)
+        {
+            Slot &slot = m_slots[i];
+            if (slot.key == key)
+            {
+                return &slot.value;
+            }
+            if (slot.key == kEmptyKey)
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    /// @brief Finds the value stored for `key`, nullptr if absent.
+    [[nodiscard]] auto Find(const Key key) const noexcept -> const Value *
+    {
+        return const_cast<FlatMap *>(this)->Find(key); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    /// @brief Check whether `key` is stored
+    [[nodiscard]] auto Contains(const Key key) const noexcept -> bool
+    {
+        return Find(key) != nullptr;
+    }
+
+    /// @brief Inserts `value` for `key`, or replaces the value already stored.
+    ///
+    /// @returns The stored value, or nullptr for the reserved empty key.
+    auto InsertOrAssign(const Key key, Value value) -> Value *
+    {
+        if (key == kEmptyKey)
+        {
+            return nullptr;
+        }
+
+        if (Value *existing = Find(key); existing != nullptr)
+        {
+            *existing = std::move(value);
+            return existing;
+        }
+
+        if ((m_size + 1) * 2 > m_slots.size())
+        {
+            Rehash(std::max(m_slots.size() * 2, kMinSlots));
+        }
+
+        Slot &slot = m_slots[FindEmptySlot(key)];
+        slot.key = key;
+        slot.value = std::move(value);
+        ++m_size;
+        return &slot.value;
+    }
+
+    /// @brief Removes `key` if present.
+    ///
+    /// @returns true if an entry was removed.
+    auto Erase(const Key key) -> bool
+    {
+        if (m_size == 0 || key == kEmptyKey)
+        {
+            return false;
+        }
+
+        std::size_t hole = Home(key);
+        while (m_slots[hole].key != key)
+        {
+            if (m_slots[hole].key == kEmptyKey)
+            {
+                return false;
+            }
+            hole = (hole + 1) & m_mask;
+        }
+
+        // Backward shift: pull later members of the probe run into the hole when their home slot allows it.
+        for (std::size_t next = (hole + 1) & m_mask; m_slots[next].key != kEmptyKey; next = (next + 1) & m_mask)
+        {
+            const std::size_t home = Home(m_slots[next].key);
+            if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+            {
+                m_slots[hole] = std::move(m_slots[next]);
+                hole = next;
+            }
+        }
+
+        m_slots[hole].key = kEmptyKey;
+        m_slots[hole].value = Value();
+        --m_size;
+        return true;
+    }
+
+    /// @brief Removes every entry, keeping the allocated slots.
+    auto Clear() -> void
+    {
+        for (Slot &slot : m_slots)
+        {
+            slot = Slot();
+        }
+        m_size = 0;
+    }
+
+    /// @brief Calls `fn(key, value)` for every entry, in unspecified order.
+    template <typename Fn> auto ForEach(Fn &&fn) -> void
+    {
+        for (Slot &slot : m_slots)
+        {
+            if (slot.key != kEmptyKey)
+            {
+                fn(slot.key, slot.value);
+            }
+        }
+    }
+
+  private:
+    struct Slot
+    {
+        Key key{kEmptyKey};
+        Value value{};
+    };
+
+    static constexpr std::size_t kMinSlots = 16;
+
+    [[nodiscard]] auto Home(const Key key) const noexcept -> std::size_t
+    {
+        // Fibonacci hashing, XIDs are sequential so the multiply spreads them over the upper bits.
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> m_shift) & m_mask;
+    }
+
+    [[nodiscard]] auto FindEmptySlot(const Key key) const noexcept -> std::size_t
+    {
+        std::size_t i = Home(key);
+        while (m_slots[i].key != kEmptyKey)
+        {
+            i = (i + 1) & m_mask;
+        }
+        return i;
+    }
+
+    auto Rehash(const std::size_t slot_count) -> void
+    {
+        std::vector<Slot> old = std::exchange(m_slots, std::vector<Slot>(slot_count));
+        m_mask = slot_count - 1;
+        m_shift = 64U - static_cast<std::uint32_t>(std::countr_zero(slot_count));
+        for (Slot &slot : old)
+        {
+            if (slot.key != kEmptyKey)
+            {
+                m_slots[FindEmptySlot(slot.key)] = std::move(slot);
+            }
+        }
+    }
+
+  private:
+    std::vector<Slot> m_slots;
+    std::size_t m_size{};
+    std::size_t m_mask{};
+    std::uint32_t m_shift{64};
+};
+
+} // namespace Tilebox
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Tilebox
+{
+
+/// @brief Default number of bytes an InplaceFunction reserves for its callable.
+///
+/// @details Enough for a lambda capturing `this` plus a few references or pointers, which covers every
+/// handler tilebox and tbwm register.
+inline constexpr std::size_t kInplaceFunctionCapacity = 32;
+
+template <typename Signature, std::size_t Capacity = kInplaceFunctionCapacity> class InplaceFunction;
+
+/// @brief A type erased callable wrapper similar to std::function, which never allocates.
+///
+/// @details The callable is stored inside a fixed size buffer, callables that do not fit are rejected at compile time
+/// rather than spilling onto the heap. Invoking goes through a single function pointer stored in the object itself.
+template <typename R, typename... Args, std::size_t Capacity> class InplaceFunction<R(Args...), Capacity>
+{
+  public:
+    InplaceFunction() noexcept = default;
+
+    InplaceFunction(std::nullptr_t) noexcept // NOLINT(google-explicit-constructor)
+    {
+    }
+
+    template <typename Callable>
+        requires(!std::is_same_v<std::decay_t<Callable>, InplaceFunction> &&
+                 std::is_invocable_r_v<R, std::decay_t<Callable> &, Args...>)
+    InplaceFunction(Callable &&callable) noexcept( // NOLINT(google-explicit-constructor)
+        std::is_nothrow_constructible_v<std::decay_t<Callable>, Callable>)
+    {
+        using Stored = std::decay_t<Callable>;
+
+        static_assert(sizeof(Stored) <= Capacity, "Callable is too large for this InplaceFunction capacity");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t), "Callable is over aligned");
+        static_assert(std::is_copy_constructible_v<Stored>, "Callable must be copy constructible");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>, "Callable must be nothrow move constructible");
+
+        ::new (static_cast<void *>(m_storage.data())) Stored(std::forward<Callable>(callable));
+        m_invoke = &Invoke<Stored>;
+        m_manage = &Manage<Stored>;
+    }
+
+    ~InplaceFunction()
+    {
+        Reset();
+    }
+
+    InplaceFunction(const InplaceFunction &rhs) : m_invoke(rhs.m_invoke), m_manage(rhs.m_manage)
+    {
+        if (m_manage != nullptr)
+        {
+            m_manage(Operation::Copy, m_storage.data(), rhs.m_storage.data());
+        }
+    }
+
+    InplaceFunction(InplaceFunction &&rhs) noexcept : m_invoke(rhs.m_invoke), m_manage(rhs.m_manage)
+    {
+        if (m_manage != nullptr)
+        {
+            m_manage(Operation::Move, m_storage.data(), rhs.m_storage.data());
+            rhs.Reset();
+        }
+    }
+
+  public:
+    auto operator=(const InplaceFunction &rhs) -> InplaceFunction &
+    {
+        if (this != &rhs)
+        {
+            InplaceFunction copy(rhs);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    auto operator=(InplaceFunction &&rhs) noexcept -> InplaceFunction &
+    {
+        if (this != &rhs)
+        {
+            Reset();
+            if (rhs.m_manage != nullptr)
+            {
+                rhs.m_manage(Operation::Move, m_storage.data(), rhs.m_storage.data());
+                m_invoke = rhs.m_invoke;
+                m_manage = rhs.m_manage;
+                rhs.Reset();
+            }
+        }
+        return *this;
+    }
+
+    auto operator=(std::nullptr_t) noexcept -> InplaceFunction &
+    {
+        Reset();
+        return *this;
+    }
+
+    /// @brief Check whether a callable is stored
+    [[nodiscard]] explicit operator bool() const noexcept
+    {
+        return m_invoke != nullptr;
+    }
+
+    /// @brief Invokes the stored callable, the caller must check operator bool first.
+    auto operator()(Args... args) const -> R
+    {
+        return m_invoke(m_storage.data(), std::forward<Args>(args)...);
+    }
+
+  private:
+    enum class Operation : std::uint8_t
+    {
+        Copy,
+        Move,
+        Destroy,
+    };
+
+    using InvokeFn = R (*)(void *, Args &&...);
+    using ManageFn = void (*)(Operation, void *, void *);
+
+    template <typename Stored> static auto Invoke(void *storage, Args &&...args) -> R
+    {
+        return std::invoke(*static_cast<Stored *>(storage), std::forward<Args>(args)...);
+    }
+
+    template <typename Stored> static auto Manage(const Operation op, void *dst, void *src) -> void
+    {
+        switch (op)
+        {
+        case Operation::Copy:
+            ::new (dst) Stored(*static_cast<const Stored *>(src));
+            break;
+        case Operation::Move:
+            ::new (dst) Stored(std::move(*static_cast<Stored *>(src)));
+            break;
+        case Operation::Destroy:
+            static_cast<Stored *>(dst)->~Stored();
+            break;
+        }
+    }
+
+    auto Reset() noexcept -> void
+    {
+        if (m_manage != nullptr)
+        {
+            m_manage(Operation::Destroy, m_storage.data(), nullptr);
+        }
+        m_invoke = nullptr;
+        m_manage = nullptr;
+    }
+
+  private:
+    alignas(std::max_align_t) mutable std::array<std::byte, Capacity> m_storage{};
+    InvokeFn m_invoke{};
+    ManageFn m_manage{};
+};
+
+} // namespace Tilebox
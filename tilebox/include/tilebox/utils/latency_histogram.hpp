@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Tilebox
+{
+
+/// @brief Fixed memory log-linear histogram of nanosecond durations.
+///
+/// @details Each power of two range is split into kSubBuckets linear buckets, so every recorded value is known to
+/// within 1/kSubBuckets (6.25%) of itself. Values below kSubBuckets are exact, values at or above 2^kMaxExponent ns
+/// (about 68 seconds) land in the last bucket. Recording is a bit scan and an increment, nothing ever allocates.
+class LatencyHistogram
+{
+  public:
+    static constexpr std::uint32_t kSubBucketBits = 4;
+    static constexpr std::uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+    static constexpr std::uint32_t kMaxExponent = 36;
+    static constexpr std::size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+  public:
+    /// @brief Records one value in nanoseconds.
+    auto Record(const std::uint64_t value) noexcept -> void
+    {
+        ++m_buckets[BucketIndex(value)];
+        ++m_count;
+        m_sum += value;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+
+    /// @brief Forgets every recorded value.
+    auto Reset() noexcept -> void
+    {
+        *this = LatencyHistogram();
+    }
+
+    /// @brief Gets the number of recorded values
+    [[nodiscard]] auto Count() const noexcept -> std::uint64_t
+    {
+        return m_count;
+    }
+
+    /// @brief Gets the smallest recorded value, 0 if empty
+    [[nodiscard]] auto Min() const noexcept -> std::uint64_t
+    {
+        return m_count == 0 ? 0 : m_min;
+    }
+
+    /// @brief Gets the largest recorded value, 0 if empty
+    [[nodiscard]] auto Max() const noexcept -> std::uint64_t
+    {
+        return m_max;
+    }
+
+    /// @brief Gets the exact mean of the recorded values, 0 if empty
+    [[nodiscard]] auto Mean() const noexcept -> std::uint64_t
+    {
+        return m_count == 0 ? 0 : m_sum / m_count;
+    }
+
+    /// @brief Gets the value below which `percentile` percent of the recorded values fall.
+    ///
+    /// @details Reports the upper bound of the bucket holding that rank, clamped to the exact maximum.
+    ///
+    /// @param percentile In the range [0, 100].
+    [[nodiscard]] auto ValueAtPercentile(const double percentile) const noexcept -> std::uint64_t
+    {
+        if (m_count == 0)
+        {
+            return 0;
+        }
+
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const auto rank = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(clamped / 100.0 * static_cast<double>(m_count) + 0.5));
+
+        std::uint64_t seen = 0;
+        for (std::size_t index = 0; index < m_buckets.size(); ++index)
+        {
+            seen += m_buckets[index];
+            if (seen >= rank)
+            {
+                return std::min(BucketUpperBound(index), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    /// @brief Maps a value to its bucket.
+    [[nodiscard]] static constexpr auto BucketIndex(const std::uint64_t value) noexcept -> std::size_t
+    {
+        if (value < kSubBuckets)
+        {
+            return static_cast<std::size_t>(value);
+        }
+
+        const auto exponent = static_cast<std::uint32_t>(std::bit_width(value)) - 1;
+        if (exponent >= kMaxExponent)
+        {
+            return kBucketCount - 1;
+        }
+
+        // The kSubBucketBits bits below the leading one select the linear bucket within the power of two range.
+        const std::uint32_t shift = exponent - kSubBucketBits;
+        const std::uint64_t mantissa = (value >> shift) - kSubBuckets;
+        return static_cast<std::size_t>((shift + 1) * kSubBuckets + mantissa);
+    }
+
+    /// @brief Gets the largest value that maps to `index`.
+    [[nodiscard]] static constexpr auto BucketUpperBound(const std::size_t index) noexcept -> std::uint64_t
+    {
+        if (index < kSubBuckets)
+        {
+            return index;
+        }
+        if (index >= kBucketCount - 1)
+        {
+            return std::numeric_limits<std::uint64_t>::max();
+        }
+
+        const auto shift = static_cast<std::uint32_t>(index / kSubBuckets) - 1;
+        const std::uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+        return lower + (1ULL << shift) - 1;
+    }
+
+  private:
+    std::array<std::uint64_t, kBucketCount> m_buckets{};
+    std::uint64_t m_count{};
+    std::uint64_t m_sum{};
+    std::uint64_t m_min{std::numeric_limits<std::uint64_t>::max()};
+    std::uint64_t m_max{};
+};
+
+} // namespace Tilebox
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace Tilebox
+{
+
+/// @brief Unbounded lock free FIFO queue for many producer threads and a single consumer thread.
+///
+/// @details Dmitry Vyukov's linked list design: a push is one allocation and one atomic exchange of the head, with
+/// no retry loop, so producers never wait on each other or on the consumer. The consumer owns the tail and never
+/// touches the head. Between a producer's exchange and linking its node the push is invisible, Pop reports the
+/// queue as empty during that window. Consumers that sleep therefore need a wake up signalled after Push returns.
+template <typename T> class MpscQueue
+{
+  public:
+    MpscQueue() noexcept : m_head(&m_stub), m_tail(&m_stub)
+    {
+    }
+
+    /// @brief Destroys every value still queued, only once no producer can push anymore.
+    ~MpscQueue()
+    {
+        while (Pop().has_value())
+        {
+        }
+        if (m_tail != &m_stub)
+        {
+            delete m_tail;
+        }
+    }
+
+    MpscQueue(const MpscQueue &rhs) = delete;
+    MpscQueue(MpscQueue &&rhs) = delete;
+
+  public:
+    auto operator=(const MpscQueue &rhs) -> MpscQueue & = delete;
+    auto operator=(MpscQueue &&rhs) -> MpscQueue & = delete;
+
+  public:
+    /// @brief Appends a value, safe to call from any thread.
+    auto Push(T value) -> void
+    {
+        auto *node = new Node{{nullptr}, std::move(value)};
+        Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /// @brief Removes the oldest value, consumer thread only.
+    ///
+    /// @returns std::nullopt if nothing is queued, or the next push is still being linked.
+    [[nodiscard]] auto Pop() -> std::optional<T>
+    {
+        // The tail node's value has already been consumed, its successor holds the next value and becomes the tail.
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        std::optional<T> value(std::move(next->value));
+        next->value.reset();
+        m_tail = next;
+        if (tail != &m_stub)
+        {
+            delete tail;
+        }
+        return value;
+    }
+
+    /// @brief Check whether a value is ready to pop, consumer thread only.
+    [[nodiscard]] auto Empty() const noexcept -> bool
+    {
+        return m_tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+  private:
+    struct Node
+    {
+        std::atomic<Node *> next;
+        std::optional<T> value;
+    };
+
+    /// @brief Keeps the producer and consumer ends on separate cache lines.
+    static constexpr std::size_t kCacheLineSize = 64;
+
+  private:
+    alignas(kCacheLineSize) std::atomic<Node *> m_head;
+    alignas(kCacheLineSize) Node *m_tail;
+    Node m_stub{{nullptr}, std::nullopt};
+};
+
+} // namespace Tilebox
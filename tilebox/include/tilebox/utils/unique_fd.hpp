@@ -0,0 +1,71 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <utility>
+
+namespace Tilebox
+{
+
+/// @brief RAII move only owner of a POSIX file descriptor, closes it on destruction.
+class UniqueFd
+{
+  public:
+    UniqueFd() noexcept = default;
+
+    explicit UniqueFd(const std::int32_t fd) noexcept : m_fd(fd)
+    {
+    }
+
+    ~UniqueFd()
+    {
+        Reset();
+    }
+
+    UniqueFd(UniqueFd &&rhs) noexcept : m_fd(std::exchange(rhs.m_fd, -1))
+    {
+    }
+
+    UniqueFd(const UniqueFd &rhs) = delete;
+
+  public:
+    auto operator=(UniqueFd &&rhs) noexcept -> UniqueFd &
+    {
+        if (this != &rhs)
+        {
+            Reset(std::exchange(rhs.m_fd, -1));
+        }
+        return *this;
+    }
+
+    auto operator=(const UniqueFd &rhs) -> UniqueFd & = delete;
+
+  public:
+    /// @brief Gets the raw descriptor, -1 when empty
+    [[nodiscard]] auto Get() const noexcept -> std::int32_t
+    {
+        return m_fd;
+    }
+
+    /// @brief Check whether a descriptor is owned
+    [[nodiscard]] auto IsValid() const noexcept -> bool
+    {
+        return m_fd >= 0;
+    }
+
+    /// @brief Closes the owned descriptor, if any, and takes ownership of `fd`
+    auto Reset(const std::int32_t fd = -1) noexcept -> void
+    {
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+        m_fd = fd;
+    }
+
+  private:
+    std::int32_t m_fd{-1};
+};
+
+} // namespace Tilebox
@@ -0,0 +1,400 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/xcb.hpp"
+
+#include <X11/X.h>
+#include <xcb/xcb.h>
+#include <xcb/xproto.h>
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Tilebox
+{
+
+////////////////////////////////////
+// Tasks
+////////////////////////////////////
+
+template <typename T = void> class X11Task;
+
+namespace Detail
+{
+
+template <typename T> struct X11TaskPromise;
+
+/// @brief Resumes whoever awaited the finished task, or returns to the resumer for root tasks.
+struct X11TaskFinalAwaiter
+{
+    [[nodiscard]] auto await_ready() const noexcept -> bool
+    {
+        return false;
+    }
+
+    template <typename Promise>
+    [[nodiscard]] auto await_suspend(std::coroutine_handle<Promise> handle) const noexcept -> std::coroutine_handle<>
+    {
+        if (const std::coroutine_handle<> continuation = handle.promise().continuation; continuation)
+        {
+            return continuation;
+        }
+        return std::noop_coroutine();
+    }
+
+    auto await_resume() const noexcept -> void
+    {
+    }
+};
+
+struct X11TaskPromiseBase
+{
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    [[nodiscard]] auto initial_suspend() const noexcept -> std::suspend_always
+    {
+        return {};
+    }
+
+    [[nodiscard]] auto final_suspend() const noexcept -> X11TaskFinalAwaiter
+    {
+        return {};
+    }
+
+    auto unhandled_exception() noexcept -> void
+    {
+        exception = std::current_exception();
+    }
+};
+
+template <typename T> struct X11TaskPromise : X11TaskPromiseBase
+{
+    std::optional<T> value;
+
+    [[nodiscard]] auto get_return_object() noexcept -> X11Task<T>;
+
+    template <typename U>
+        requires std::is_convertible_v<U, T>
+    auto return_value(U &&result) noexcept(std::is_nothrow_constructible_v<T, U>) -> void
+    {
+        value.emplace(std::forward<U>(result));
+    }
+
+    [[nodiscard]] auto Result() -> T
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+};
+
+template <> struct X11TaskPromise<void> : X11TaskPromiseBase
+{
+    [[nodiscard]] auto get_return_object() noexcept -> X11Task<void>;
+
+    auto return_void() const noexcept -> void
+    {
+    }
+
+    auto Result() const -> void
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+} // namespace Detail
+
+/// @brief Lazily started coroutine, the return type of every coroutine that awaits X replies.
+///
+/// @details Awaiting a task starts it and suspends the awaiter until it finishes, with symmetric transfer so long
+/// chains do not grow the stack. Top level tasks are started with X11AsyncConnection::Spawn, which keeps them alive
+/// until they finish. Exceptions escaping the coroutine are rethrown to the awaiter.
+template <typename T> class [[nodiscard]] X11Task
+{
+  public:
+    using promise_type = Detail::X11TaskPromise<T>;
+
+  public:
+    X11Task() noexcept = default;
+
+    explicit X11Task(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle)
+    {
+    }
+
+    ~X11Task()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    X11Task(X11Task &&rhs) noexcept : m_handle(std::exchange(rhs.m_handle, nullptr))
+    {
+    }
+
+    X11Task(const X11Task &rhs) = delete;
+
+  public:
+    auto operator=(X11Task &&rhs) noexcept -> X11Task &
+    {
+        if (this != &rhs)
+        {
+            X11Task old(std::move(*this));
+            m_handle = std::exchange(rhs.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    auto operator=(const X11Task &rhs) -> X11Task & = delete;
+
+  public:
+    /// @brief Check whether the coroutine ran to completion
+    [[nodiscard]] auto Done() const noexcept -> bool
+    {
+        return !m_handle || m_handle.done();
+    }
+
+    [[nodiscard]] auto operator co_await() const noexcept
+    {
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            [[nodiscard]] auto await_ready() const noexcept -> bool
+            {
+                return !handle || handle.done();
+            }
+
+            [[nodiscard]] auto await_suspend(std::coroutine_handle<> awaiting) const noexcept
+                -> std::coroutine_handle<>
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            auto await_resume() const -> T
+            {
+                return handle.promise().Result();
+            }
+        };
+        return Awaiter{m_handle};
+    }
+
+  private:
+    friend class X11AsyncConnection;
+
+    /// @brief Runs the coroutine until its first suspension point
+    auto Start() const -> void
+    {
+        if (m_handle && !m_handle.done())
+        {
+            m_handle.resume();
+        }
+    }
+
+    /// @brief Rethrows the exception that escaped a finished coroutine, if any
+    auto RethrowIfFailed() const -> void
+    {
+        if (m_handle && m_handle.promise().exception)
+        {
+            std::rethrow_exception(m_handle.promise().exception);
+        }
+    }
+
+  private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+template <typename T> auto Detail::X11TaskPromise<T>::get_return_object() noexcept -> X11Task<T>
+{
+    return X11Task<T>(std::coroutine_handle<X11TaskPromise<T>>::from_promise(*this));
+}
+
+inline auto Detail::X11TaskPromise<void>::get_return_object() noexcept -> X11Task<void>
+{
+    return X11Task<void>(std::coroutine_handle<X11TaskPromise<void>>::from_promise(*this));
+}
+
+////////////////////////////////////
+// Awaitable requests
+////////////////////////////////////
+
+class X11AsyncConnection;
+
+namespace Detail
+{
+
+/// @brief Type erased part of a reply awaiter, the connection resolves it once the reply arrived.
+class TILEBOX_EXPORT X11PendingReply
+{
+  public:
+    X11PendingReply(X11AsyncConnection *connection, std::uint32_t sequence) noexcept;
+
+    /// @brief Discards the reply of a request that was never awaited.
+    ~X11PendingReply();
+
+    X11PendingReply(X11PendingReply &&rhs) noexcept;
+    X11PendingReply(const X11PendingReply &rhs) = delete;
+
+  public:
+    auto operator=(X11PendingReply &&rhs) noexcept -> X11PendingReply & = delete;
+    auto operator=(const X11PendingReply &rhs) -> X11PendingReply & = delete;
+
+  public:
+    [[nodiscard]] auto await_ready() const noexcept -> bool
+    {
+        return m_resolved;
+    }
+
+    auto await_suspend(std::coroutine_handle<> awaiting) -> void;
+
+  protected:
+    [[nodiscard]] auto TakeReply() noexcept -> void *;
+
+  private:
+    friend class Tilebox::X11AsyncConnection;
+
+    X11AsyncConnection *m_connection{};
+    std::uint32_t m_sequence{};
+    void *m_reply{};
+    bool m_resolved{};
+};
+
+} // namespace Detail
+
+/// @brief Awaitable result of an asynchronous request.
+///
+/// @details The request is already queued when the awaitable is returned, awaiting only waits for its reply.
+/// Awaiting yields nullptr if the server answered with an error. Awaitables that are never awaited discard their
+/// reply. An awaitable must stay alive until it has been resumed, which coroutine locals and temporaries do.
+template <typename Reply> class [[nodiscard]] X11ReplyAwaiter : public Detail::X11PendingReply
+{
+  public:
+    using Detail::X11PendingReply::X11PendingReply;
+
+    [[nodiscard]] auto await_resume() noexcept -> X11ReplyPtr<Reply>
+    {
+        return X11ReplyPtr<Reply>(static_cast<Reply *>(TakeReply()));
+    }
+};
+
+////////////////////////////////////
+// Connection
+////////////////////////////////////
+
+/// @brief C++20 coroutine interface for X requests with replies.
+///
+/// @details Requests go out through X11Display::Xcb, so they share the socket and sequence numbers of the Xlib
+/// display while leaving Xft and every other Xlib user untouched. Issuing several requests before awaiting
+/// the first pipelines them: ten property fetches cost one round trip rather than ten.
+///
+/// Replies are matched by the event loop, X11EventLoop::RunPolled calls ProcessReplies once the X queue is drained
+/// and Flush before it sleeps. Outside of the loop, Drain blocks until every spawned task has finished.
+///
+/// @code
+/// auto Manage(X11AsyncConnection &x, Window window) -> X11Task<>
+/// {
+///     auto attributes = x.GetWindowAttributes(window);
+///     auto geometry = x.GetGeometry(window);
+///     auto name = x.GetProperty(window, XA_WM_NAME, XA_STRING, 0, 64);
+///     if (auto reply = co_await attributes; reply != nullptr && !reply->override_redirect) { ... }
+/// }
+///
+/// async.Spawn(Manage(async, event->xmaprequest.window));
+/// @endcode
+class TILEBOX_EXPORT X11AsyncConnection
+{
+  public:
+    /// @param dpy The display whose XCB connection carries the requests. Without one only tasks that never
+    /// issue a request can run, which is useful in tests.
+    explicit X11AsyncConnection(X11DisplaySharedResource dpy) noexcept;
+
+    /// @brief Destroys unfinished tasks and discards their outstanding replies.
+    ~X11AsyncConnection();
+
+    X11AsyncConnection(const X11AsyncConnection &rhs) = delete;
+    X11AsyncConnection(X11AsyncConnection &&rhs) = delete;
+
+  public:
+    auto operator=(const X11AsyncConnection &rhs) -> X11AsyncConnection & = delete;
+    auto operator=(X11AsyncConnection &&rhs) -> X11AsyncConnection & = delete;
+
+  public:
+    /// @brief Gets the XCB connection underneath the display
+    [[nodiscard]] auto Raw() const noexcept -> xcb_connection_t *;
+
+    /// @brief Starts a top level task, which runs until its first await and is kept alive until it finishes.
+    auto Spawn(X11Task<void> task) -> void;
+
+    /// @brief Gets the number of spawned tasks that have not finished
+    [[nodiscard]] auto RunningTasks() const noexcept -> std::size_t;
+
+    /// @brief Gets the number of awaited replies that have not arrived
+    [[nodiscard]] auto PendingReplies() const noexcept -> std::size_t;
+
+    /// @brief Resumes every coroutine whose reply has arrived, without blocking.
+    ///
+    /// @returns true if any coroutine was resumed.
+    auto ProcessReplies() -> bool;
+
+    /// @brief Sends every queued request to the server.
+    auto Flush() const noexcept -> void;
+
+    /// @brief Blocks until every spawned task has finished, for start up code and tests.
+    auto Drain() -> void;
+
+    ///////////////////////////////////////
+    /// Requests
+    ///////////////////////////////////////
+
+    [[nodiscard]] auto GetWindowAttributes(Window window) -> X11ReplyAwaiter<xcb_get_window_attributes_reply_t>;
+
+    [[nodiscard]] auto GetGeometry(Drawable drawable) -> X11ReplyAwaiter<xcb_get_geometry_reply_t>;
+
+    /// @param long_offset Offset into the property data in 32 bit units.
+    /// @param long_length Number of 32 bit units to fetch.
+    [[nodiscard]] auto GetProperty(Window window, Atom property, Atom type, std::uint32_t long_offset,
+                                   std::uint32_t long_length) -> X11ReplyAwaiter<xcb_get_property_reply_t>;
+
+    [[nodiscard]] auto InternAtom(std::string_view name, bool only_if_exists = false)
+        -> X11ReplyAwaiter<xcb_intern_atom_reply_t>;
+
+    [[nodiscard]] auto QueryTree(Window window) -> X11ReplyAwaiter<xcb_query_tree_reply_t>;
+
+  private:
+    friend class Detail::X11PendingReply;
+
+    struct Pending
+    {
+        std::uint32_t sequence;
+        Detail::X11PendingReply *reply;
+        std::coroutine_handle<> handle;
+    };
+
+    auto Enqueue(Detail::X11PendingReply *reply, std::coroutine_handle<> awaiting) -> void;
+    auto Forget(const Detail::X11PendingReply *reply) noexcept -> void;
+    auto Resume(std::size_t index, void *reply) -> void;
+    auto ReapTasks() -> void;
+
+  private:
+    X11DisplaySharedResource m_dpy;
+    X11XcbConnection m_xcb;
+    std::vector<Pending> m_pending;
+    std::vector<X11Task<void>> m_tasks;
+};
+
+} // namespace Tilebox
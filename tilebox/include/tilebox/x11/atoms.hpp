@@ -0,0 +1,195 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/x11/display.hpp"
+
+#include <X11/X.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace Tilebox
+{
+
+namespace Detail
+{
+
+/// @brief Interns every name with pipelined InternAtom requests, one round trip however many names there are.
+///
+/// @details The cookies of the requests in flight are kept in a vector, so this allocates and may throw.
+///
+/// @returns false if not connected or any name could not be interned, its atom is then None.
+TILEBOX_EXPORT auto X11InternAtoms(const X11DisplaySharedResource &dpy, std::span<const char *const> names,
+                                   std::span<Atom> atoms) -> bool;
+
+/// @brief Check whether a list of atom names is usable, no null, empty or duplicate names.
+template <std::size_t N> consteval auto X11AtomNamesValid(const std::array<const char *, N> &names) -> bool
+{
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        if (names[i] == nullptr || std::string_view(names[i]).empty())
+        {
+            return false;
+        }
+        for (std::size_t j = 0; j < i; ++j)
+        {
+            if (std::string_view(names[i]) == std::string_view(names[j]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace Detail
+
+/// @brief Atoms named by a constexpr list, looked up by the enum indexing that list.
+///
+/// @details The names are known at compile time, so looking up an atom is an array index and looking up the name of
+/// an atom needs no GetAtomName round trip. Several registries are interned together with X11InternAtoms.
+///
+/// @code
+/// enum class Net : std::uint8_t { WmName, ActiveWindow };
+/// inline constexpr std::array<const char *, 2> kNetNames = {"_NET_WM_NAME", "_NET_ACTIVE_WINDOW"};
+/// X11AtomRegistry<Net, kNetNames> net;
+/// net.Intern(dpy);
+/// const Atom active = net[Net::ActiveWindow];
+/// @endcode
+///
+/// @tparam Enum Enumeration whose values index `kNames`, starting at zero.
+/// @tparam kNames `std::array<const char *, N>` with static storage duration.
+template <typename Enum, const auto &kNames> class X11AtomRegistry
+{
+    static_assert(std::is_enum_v<Enum>, "atoms are indexed by an enumeration");
+    static_assert(Detail::X11AtomNamesValid(kNames), "atom names must be non empty and unique");
+
+  public:
+    static constexpr std::size_t kSize = std::size(kNames);
+
+  public:
+    /// @brief Gets the name of an atom without a server query.
+    [[nodiscard]] static constexpr auto Name(const Enum atom) noexcept -> std::string_view
+    {
+        return kNames[Index(atom)];
+    }
+
+    /// @brief Gets every name in enum order.
+    [[nodiscard]] static constexpr auto Names() noexcept -> const std::array<const char *, kSize> &
+    {
+        return kNames;
+    }
+
+  public:
+    /// @brief Interns every atom of the registry in one round trip.
+    ///
+    /// @returns false if not connected or an atom could not be interned.
+    auto Intern(const X11DisplaySharedResource &dpy) -> bool;
+
+    /// @brief Stores atoms interned elsewhere, in enum order.
+    auto Assign(std::span<const Atom, kSize> atoms) noexcept -> void
+    {
+        std::ranges::copy(atoms, m_atoms.begin());
+        for (std::size_t i = 0; i < kSize; ++i)
+        {
+            m_by_atom[i] = {m_atoms[i], static_cast<Enum>(i)};
+        }
+        std::ranges::sort(m_by_atom, {}, &std::pair<Atom, Enum>::first);
+    }
+
+    /// @brief Gets an atom, None until interned.
+    [[nodiscard]] auto Get(const Enum atom) const noexcept -> Atom
+    {
+        return m_atoms[Index(atom)];
+    }
+
+    [[nodiscard]] auto operator[](const Enum atom) const noexcept -> Atom
+    {
+        return Get(atom);
+    }
+
+    /// @brief Gets every atom in enum order, e.g. for _NET_SUPPORTED.
+    [[nodiscard]] auto Atoms() const noexcept -> std::span<const Atom, kSize>
+    {
+        return m_atoms;
+    }
+
+    /// @brief Finds the enum value of an interned atom.
+    [[nodiscard]] auto Find(const Atom atom) const noexcept -> std::optional<Enum>
+    {
+        if (atom == None)
+        {
+            return std::nullopt;
+        }
+
+        const auto it = std::ranges::lower_bound(m_by_atom, atom, {}, &std::pair<Atom, Enum>::first);
+        if (it == m_by_atom.end() || it->first != atom)
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    /// @brief Gets the name of an interned atom without a server query, empty if the registry does not hold it.
+    [[nodiscard]] auto NameOf(const Atom atom) const noexcept -> std::string_view
+    {
+        const std::optional<Enum> found = Find(atom);
+        return found.has_value() ? Name(*found) : std::string_view();
+    }
+
+    /// @brief Check whether a server atom is part of the registry
+    [[nodiscard]] auto Contains(const Atom atom) const noexcept -> bool
+    {
+        return Find(atom).has_value();
+    }
+
+  private:
+    [[nodiscard]] static constexpr auto Index(const Enum atom) noexcept -> std::size_t
+    {
+        return static_cast<std::size_t>(atom);
+    }
+
+  private:
+    std::array<Atom, kSize> m_atoms{};
+
+    /// @brief Sorted by atom for the reverse lookup.
+    std::array<std::pair<Atom, Enum>, kSize> m_by_atom{};
+};
+
+/// @brief Interns the atoms of every registry in one round trip.
+///
+/// @returns false if not connected or an atom could not be interned.
+template <typename... Registries>
+auto X11InternAtoms(const X11DisplaySharedResource &dpy, Registries &...registries) -> bool
+{
+    constexpr std::size_t total = (Registries::kSize + ...);
+    std::array<const char *, total> names{};
+    std::array<Atom, total> atoms{};
+
+    std::size_t offset = 0;
+    ((std::ranges::copy(Registries::Names(), names.begin() + static_cast<std::ptrdiff_t>(offset)),
+      offset += Registries::kSize),
+     ...);
+
+    const bool interned = Detail::X11InternAtoms(dpy, names, atoms);
+
+    offset = 0;
+    ((registries.Assign(std::span<const Atom, Registries::kSize>(atoms.data() + offset, Registries::kSize)),
+      offset += Registries::kSize),
+     ...);
+    return interned;
+}
+
+template <typename Enum, const auto &kNames>
+auto X11AtomRegistry<Enum, kNames>::Intern(const X11DisplaySharedResource &dpy) -> bool
+{
+    return X11InternAtoms(dpy, *this);
+}
+
+} // namespace Tilebox
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "tilebox/geometry.hpp"
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/utils/flat_map.hpp"
+#include "tilebox/utils/inplace_function.hpp"
+
+#include <X11/X.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Tilebox
+{
+
+/// @brief Called once per burst with the merged damage of a window, in window coordinates.
+///
+/// @details The rectangles may overlap, together they cover every exposed pixel. The span is only valid during the
+/// call.
+using X11DamageCallback = InplaceFunction<void(Window window, std::span<const Rect> damage)>;
+
+/// @brief Accumulates exposed rectangles into a small region per window, handing each window's region to its callback
+/// once the burst is over.
+///
+/// @details A region holds at most kMaxDamageRects rectangles. Every added rectangle is clipped to the window bounds
+/// when known, and rectangles whose bounding box covers no extra pixels are merged right away, which absorbs contained
+/// and adjoining rectangles. Past the limit, the pair whose bounding box wastes the fewest pixels is merged. Nothing
+/// here allocates after Track, so Expose floods stay cheap.
+class TILEBOX_EXPORT X11DamageTracker
+{
+  public:
+    /// @brief Rectangles kept per window before they are merged into bounding boxes.
+    static constexpr std::size_t kMaxDamageRects = 4;
+
+  public:
+    /// @brief Starts tracking a window, replacing its callback and dropping pending damage if already tracked.
+    auto Track(Window window, X11DamageCallback callback) -> void;
+
+    /// @brief Stops tracking a window, pending damage is dropped.
+    auto Untrack(Window window) -> void;
+
+    /// @brief Check whether a window is tracked
+    [[nodiscard]] auto IsTracked(Window window) const noexcept -> bool;
+
+    /// @brief Check whether no window is tracked
+    [[nodiscard]] auto Empty() const noexcept -> bool;
+
+    /// @brief Sets the window size damage is clipped to, pending damage included. Unknown until first set.
+    auto SetBounds(Window window, std::uint32_t width, std::uint32_t height) noexcept -> void;
+
+    /// @brief Adds an exposed rectangle of a window.
+    ///
+    /// @returns false if the window is not tracked.
+    auto Add(Window window, const Rect &rect) noexcept -> bool;
+
+    /// @brief Gets the number of rectangles pending for a window.
+    [[nodiscard]] auto Pending(Window window) const noexcept -> std::size_t;
+
+    /// @brief Check whether any window has damage pending
+    [[nodiscard]] auto HasPending() const noexcept -> bool;
+
+    /// @brief Hands the pending damage of a window to its callback, if any.
+    auto Flush(Window window) -> void;
+
+    /// @brief Hands the pending damage of every window to its callback.
+    auto FlushAll() -> void;
+
+  private:
+    /// @brief Half open box, easier to merge and clip than a Rect.
+    struct Box
+    {
+        std::int64_t x0;
+        std::int64_t y0;
+        std::int64_t x1;
+        std::int64_t y1;
+    };
+
+    struct WindowDamage
+    {
+        X11DamageCallback callback;
+        /// @brief One spare slot for the rectangle being added.
+        std::array<Box, kMaxDamageRects + 1> boxes{};
+        std::size_t count{};
+        std::uint32_t width{};
+        std::uint32_t height{};
+        bool has_bounds{};
+    };
+
+    static auto Clip(Box &box, const WindowDamage &damage) noexcept -> bool;
+    static auto Simplify(WindowDamage &damage) noexcept -> void;
+
+  private:
+    FlatMap<WindowDamage> m_windows;
+    std::size_t m_pending_windows{};
+    std::vector<Window> m_flush_scratch;
+};
+
+} // namespace Tilebox
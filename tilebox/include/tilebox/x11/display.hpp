@@ -2,6 +2,9 @@
 
 #include "tilebox/geometry.hpp"
 #include "tilebox/utils/attributes.hpp"
+#include "tilebox/x11/monitors.hpp"
+#include "tilebox/x11/traffic.hpp"
+#include "tilebox/x11/xcb.hpp"
 
 #include <X11/X.h>
 #include <X11/Xlib.h>
@@ -13,6 +16,13 @@
 namespace Tilebox
 {
 
+class X11RequestBatch;
+
+namespace Detail
+{
+struct X11BatchRegistry;
+} // namespace Detail
+
 struct TILEBOX_INTERNAL DisplayDeleter
 {
     auto operator()(Display *display) const noexcept -> void;
@@ -57,9 +67,47 @@ class TILEBOX_EXPORT X11Display
     /// @brief Gets the raw Display pointer
     [[nodiscard]] auto Raw() const noexcept -> Display *;
 
-    /// @brief Refreshes all internal display values.
+    /// @brief Gets the XCB connection underneath the display, for pipelined requests
+    ///
+    /// @details See X11XcbConnection, the returned handle is only valid as long as this display. Its requests and
+    /// blocking replies are counted in Traffic.
+    [[nodiscard]] auto Xcb() const noexcept -> X11XcbConnection;
+
+    /// @brief Gets a snapshot of the protocol traffic since the connection was opened.
+    ///
+    /// @details Request numbers come from `XNextRequest` and `LastKnownRequestProcessed`, flushed bytes from an
+    /// Xlib before flush hook, round trips from Sync and X11Cookie. Taking a snapshot makes no request, so two of
+    /// them can bracket any code path, see X11Traffic.
+    [[nodiscard]] auto Traffic() const noexcept -> X11Traffic;
+
+    /// @brief Refreshes all internal display values, the monitor table included.
     auto Refresh() noexcept -> void;
 
+    /// @brief Gets the monitors as last queried or updated, reading it makes no round trip.
+    [[nodiscard]] auto Monitors() const noexcept -> const X11MonitorTable &;
+
+    /// @brief Queries every monitor again.
+    ///
+    /// @details RandR 1.2 CRTCs are preferred, then Xinerama screens, then the whole screen as one monitor. Only
+    /// needed after events were missed, HandleMonitorEvent keeps the table current otherwise.
+    auto RefreshMonitors() noexcept -> void;
+
+    /// @brief Asks the server for RandR screen, CRTC and output change events on the root window.
+    ///
+    /// @returns false without RandR, the monitor table then stays as queried.
+    auto SelectMonitorEvents() noexcept -> bool;
+
+    /// @brief Applies one RandR event to the monitor table and screen size without a rescan.
+    ///
+    /// @details Disabled CRTCs drop their monitor, moved or resized ones update it in place and new ones are added.
+    /// Only screen changes cost a round trip, to learn the primary output.
+    ///
+    /// @returns true if the monitor table or the screen size changed, false for anything else.
+    auto HandleMonitorEvent(XEvent *event) noexcept -> bool;
+
+    /// @brief Gets the first RandR event number, -1 without RandR.
+    [[nodiscard]] auto MonitorEventBase() const noexcept -> std::int32_t;
+
     /// @brief Gets the active screen id
     [[nodiscard]] auto ScreenId() const noexcept -> std::int32_t;
 
@@ -90,16 +138,37 @@ class TILEBOX_EXPORT X11Display
     /// @brief flushes the output buffer and then waits until all requests have been received and processed by the X
     /// server.
     ///
-    /// @details Should be called before shutdown, calls `XSync`.
+    /// @details Should be called before shutdown, calls `XSync`. Inside an X11RequestBatch the sync is deferred to the
+    /// end of the outermost batch, unless events are discarded.
     ///
     /// @param discard Specifies whether the X server should discard all events in the event queue.
     auto Sync(const bool discard = false) const noexcept -> void;
 
+    /// @brief Flushes the output buffer without waiting for the server, calls `XFlush`.
+    ///
+    /// @details Does nothing inside an X11RequestBatch, the outermost batch flushes once it ends.
+    auto Flush() const noexcept -> void;
+
   private:
+    friend class X11RequestBatch;
+
     explicit X11Display(const std::optional<std::string> &display_name) noexcept;
 
+    [[nodiscard]] auto QueryRandrMonitors() noexcept -> bool;
+    [[nodiscard]] auto QueryXineramaMonitors() noexcept -> bool;
+
+    /// @brief Registers the before flush hook feeding the traffic counters.
+    auto WatchTraffic() noexcept -> void;
+
+    /// @brief Registers the error hook counting the errors of checked request batches.
+    auto WatchBatchErrors() noexcept -> void;
+
   private:
+    /// @brief Declared before the display so the hooks can still run while XCloseDisplay flushes.
+    std::shared_ptr<Detail::X11TrafficCounters> m_traffic;
+    std::shared_ptr<Detail::X11BatchRegistry> m_batches;
     std::shared_ptr<Display> m_dpy;
+    X11XcbConnection m_xcb;
     std::int32_t m_screen_id{};
     std::int32_t m_screen_width{};
     std::int32_t m_screen_height{};
@@ -107,6 +176,8 @@ class TILEBOX_EXPORT X11Display
     Window m_default_root_window{};
     Window m_root_window{};
     std::string m_server_vendor;
+    std::int32_t m_randr_event_base{-1};
+    X11MonitorTable m_monitors;
 };
 
 } // namespace Tilebox
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Tilebox
+{
+
+/// @brief Counters describing how much work event coalescing saved.
+struct TILEBOX_EXPORT X11CoalesceStats
+{
+    /// @brief Events pulled from the X queue in batches.
+    std::uint64_t dequeued{};
+
+    /// @brief MotionNotify events superseded by a later motion on the same window.
+    std::uint64_t motion{};
+
+    /// @brief ConfigureNotify events superseded by a later configure on the same window.
+    std::uint64_t configure{};
+
+    /// @brief Expose events folded into a later expose on the same window.
+    std::uint64_t expose{};
+
+    /// @brief Total number of events that were never dispatched.
+    [[nodiscard]] auto Coalesced() const noexcept -> std::uint64_t
+    {
+        return motion + configure + expose;
+    }
+};
+
+/// @brief Collapses superseded events in a batch pulled off the X queue.
+///
+/// @details Per window, only the last MotionNotify and the last ConfigureNotify of a run survive, and all Expose
+/// rectangles of a run are merged into the bounding box carried by the last Expose. A run ends where reordering would
+/// change meaning: key, button and crossing events end every motion run, while map, unmap, reparent and destroy end
+/// all runs of the window they affect. Survivors keep their relative order.
+class TILEBOX_EXPORT X11EventCoalescer
+{
+  public:
+    /// @brief Coalesces the batch in place.
+    ///
+    /// @details Scratch memory is kept between calls, so steady state batches do not allocate.
+    ///
+    /// @returns The number of surviving events, which are moved to the front of the batch in dispatch order.
+    [[nodiscard]] auto Coalesce(std::span<XEvent> batch) -> std::size_t;
+
+    /// @brief Toggles merging Expose rectangles, off for callers that accumulate damage themselves. On by default.
+    auto SetExposeMerging(bool enabled) noexcept -> void;
+
+    /// @brief Gets the counters accumulated since construction or the last ResetStats call.
+    [[nodiscard]] auto Stats() const noexcept -> const X11CoalesceStats &;
+
+    /// @brief Zeroes all counters.
+    auto ResetStats() noexcept -> void;
+
+  private:
+    struct Pending
+    {
+        Window window;
+        std::int32_t type;
+        std::size_t index;
+    };
+
+    [[nodiscard]] auto FindPending(Window window, std::int32_t type) noexcept -> Pending *;
+    auto DropPending(Window window) noexcept -> void;
+    auto DropPendingOfType(std::int32_t type) noexcept -> void;
+
+  private:
+    std::vector<Pending> m_pending;
+    std::vector<std::uint8_t> m_dropped;
+    X11CoalesceStats m_stats;
+    bool m_merge_expose{true};
+};
+
+} // namespace Tilebox
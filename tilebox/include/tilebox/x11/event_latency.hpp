@@ -0,0 +1,97 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/utils/latency_histogram.hpp"
+#include "tilebox/x11/events.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace Tilebox
+{
+
+/// @brief Maps X server timestamps onto the local steady clock.
+///
+/// @details The server stamps events in milliseconds on its own clock, which wraps every ~49.7 days. The offset
+/// between both clocks is estimated with a minimum filter: `received - server_time` is the true offset plus the time
+/// the event spent in transit and queued, so the smallest sample seen is the best estimate of the offset itself.
+/// The minimum is taken over the last one to two kOffsetWindow periods so the estimate follows clock drift.
+/// Queue latencies are therefore relative to the fastest recently delivered event, and carry the server's
+/// millisecond granularity.
+class TILEBOX_EXPORT X11ServerClock
+{
+  public:
+    static constexpr std::chrono::seconds kOffsetWindow{60};
+
+  public:
+    /// @brief Feeds one event timestamp and the local time it was dequeued at.
+    ///
+    /// @returns How long the event waited between being stamped by the server and being dequeued.
+    [[nodiscard]] auto QueueLatency(Time server_time, std::chrono::steady_clock::time_point dequeued) noexcept
+        -> std::chrono::nanoseconds;
+
+    /// @brief Forgets the calibration, e.g. after the server was reset.
+    auto Reset() noexcept -> void;
+
+  private:
+    static constexpr std::int64_t kNoOffset = std::numeric_limits<std::int64_t>::max();
+
+    bool m_synced{};
+    Time m_last_server_time{};
+    std::int64_t m_server_ms{};
+    std::int64_t m_window_start_ns{};
+    std::int64_t m_current_offset_ns{kNoOffset};
+    std::int64_t m_previous_offset_ns{kNoOffset};
+};
+
+/// @brief Queue latency and handler execution time histograms collected by X11EventLoop.
+///
+/// @details Queue latency is tracked for the input and crossing events (KeyPress up to LeaveNotify), which are the
+/// ones that carry a server timestamp of when the user acted. Handler execution time is tracked per event type.
+/// Synthetic events sent through SendEvent carry client chosen timestamps and are left out of the queue latency.
+class TILEBOX_EXPORT X11EventLatency
+{
+  public:
+    static constexpr std::size_t kEventTableSize = static_cast<std::size_t>(X11EventType::X11LASTEvent);
+
+  public:
+    /// @brief Check whether the queue latency of an Xlib event type is tracked
+    [[nodiscard]] static auto TracksQueueLatency(std::int32_t xlib_event_type) noexcept -> bool;
+
+    /// @brief Records the queue latency of an event dequeued at `dequeued`, untracked events are ignored.
+    auto RecordDequeue(const XEvent &event, std::chrono::steady_clock::time_point dequeued) noexcept -> void;
+
+    /// @brief Records how long the handler of one event took.
+    auto RecordHandler(std::size_t event_index, std::chrono::nanoseconds elapsed) noexcept -> void;
+
+    /// @brief Gets the queue latency histogram of an event type, empty for untracked types.
+    [[nodiscard]] auto QueueLatency(X11EventType event_type) const noexcept -> const LatencyHistogram &;
+
+    /// @brief Gets the handler execution time histogram of an event type.
+    [[nodiscard]] auto HandlerTime(X11EventType event_type) const noexcept -> const LatencyHistogram &;
+
+    /// @brief Clears every histogram, the clock calibration is kept.
+    auto Reset() noexcept -> void;
+
+    /// @brief Formats count, p50, p90, p99 and max in microseconds for every non empty histogram, one per line.
+    [[nodiscard]] auto Report() const -> std::string;
+
+  private:
+    static constexpr std::size_t kFirstQueueType = KeyPress;
+    static constexpr std::size_t kQueueTypeCount = LeaveNotify - KeyPress + 1;
+
+  private:
+    X11ServerClock m_clock;
+    LatencyHistogram m_empty;
+    std::array<LatencyHistogram, kQueueTypeCount> m_queue{};
+    std::array<LatencyHistogram, kEventTableSize> m_handler{};
+};
+
+} // namespace Tilebox
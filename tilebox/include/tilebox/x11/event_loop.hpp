@@ -1,49 +1,447 @@
 #pragma once
 
+#include "tilebox/error.hpp"
 #include "tilebox/utils/attributes.hpp"
+#include "tilebox/utils/flat_map.hpp"
+#include "tilebox/utils/inplace_function.hpp"
+#include "tilebox/utils/mpsc_queue.hpp"
+#include "tilebox/utils/unique_fd.hpp"
+#include "tilebox/x11/damage.hpp"
 #include "tilebox/x11/display.hpp"
+#include "tilebox/x11/event_coalescer.hpp"
+#include "tilebox/x11/event_latency.hpp"
 #include "tilebox/x11/events.hpp"
+#include "tilebox/x11/monitors.hpp"
+#include "tilebox/x11/traffic.hpp"
 
 #include <X11/Xlib.h>
+#include <etl.hpp>
 
-#include <functional>
-#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace Tilebox
 {
 
-using X11EventCallback = std::function<void(XEvent *event)>;
+class X11AsyncConnection;
+class X11EventRecorder;
+class X11PropertyCache;
+
+/// @brief Non allocating event handler callback, see InplaceFunction for the capture size limit.
+using X11EventCallback = InplaceFunction<void(XEvent *event)>;
+
+/// @brief Handler for one GenericEvent type of an extension, the cookie data is only valid during the call.
+using X11GenericEventCallback = InplaceFunction<void(const XGenericEventCookie &cookie)>;
+
+/// @brief Called after RandR events changed the monitor table or the screen size.
+using X11MonitorCallback = InplaceFunction<void(const X11MonitorTable &monitors)>;
+
+/// @brief Called from the loop thread every time a timer expires.
+using X11TimerCallback = InplaceFunction<void()>;
+
+/// @brief Called from the loop thread when a watched file descriptor is ready, with the ready epoll event bits.
+using X11FdCallback = InplaceFunction<void(std::uint32_t epoll_events)>;
+
+/// @brief Called from the loop thread once per delivered signal.
+using X11SignalCallback = InplaceFunction<void(std::int32_t signal_number)>;
+
+/// @brief Number of bytes a posted task may capture, room for a result string or vector next to a few pointers.
+inline constexpr std::size_t kPostedTaskCapacity = 64;
+
+/// @brief Work handed to the loop thread from any thread, see X11EventLoop::Post.
+using X11PostedTask = InplaceFunction<void(), kPostedTaskCapacity>;
+
+/// @brief Low priority work run on the loop thread once the X queue is drained, see X11EventLoop::ScheduleIdle.
+using X11IdleCallback = InplaceFunction<void()>;
+
+/// @brief Deduplicates idle work, any non zero value picked by the caller, e.g. one per kind of redraw.
+using X11IdleKey = std::uint64_t;
+
+/// @brief Identifies a timer registered with the event loop.
+using X11TimerId = std::int32_t;
 
 /// @brief Encapsulated, flexible abstraction of the X11 event loop
 /// with the ability to register event handlers for specific events.
 class TILEBOX_EXPORT X11EventLoop
 {
   public:
-    explicit X11EventLoop(X11DisplaySharedResource dpy) noexcept;
+    /// @brief One dispatch slot per core X11EventType, indexed directly by the Xlib event type.
+    static constexpr std::size_t kEventTableSize = static_cast<std::size_t>(X11EventType::X11LASTEvent);
+
+    /// @brief Time one idle slice may take unless changed with SetIdleBudget.
+    static constexpr std::chrono::microseconds kDefaultIdleBudget{2000};
+
+  public:
+    explicit X11EventLoop(X11DisplaySharedResource dpy);
     ~X11EventLoop() = default;
 
-    X11EventLoop(const X11EventLoop &other) noexcept = default;
-    auto operator=(const X11EventLoop &other) noexcept -> X11EventLoop & = default;
+    X11EventLoop(const X11EventLoop &other) = delete;
+    auto operator=(const X11EventLoop &other) -> X11EventLoop & = delete;
     X11EventLoop(X11EventLoop &&other) noexcept = default;
     auto operator=(X11EventLoop &&other) noexcept -> X11EventLoop & = default;
 
   public:
     /// @brief Register a handler callback function for a specific event.
     ///
+    /// @details Only the first handler registered for an event type is kept.
+    ///
     /// @param event_type The event type to listen for
     /// @param callback The callback function to call when the event is received
     void RegisterEventHandler(X11EventType event_type, X11EventCallback callback);
 
+    /// @brief Register a handler for one event type on one window, taking precedence over the global handler.
+    ///
+    /// @details The window is the one EventWindowFromXlibEvent extracts, so substructure events route to the child
+    /// they describe. Registering again for the same pair replaces the handler. All handlers of a window are removed
+    /// automatically once its DestroyNotify has been dispatched.
+    ///
+    /// @param event_type The event type to listen for
+    /// @param window The window the event must be about, None is ignored
+    /// @param callback The callback function to call when the event is received
+    void RegisterWindowEventHandler(X11EventType event_type, Window window, X11EventCallback callback);
+
+    /// @brief Removes the handler of one event type on one window, if any.
+    void UnregisterWindowEventHandler(X11EventType event_type, Window window);
+
+    /// @brief Removes every handler registered for a window.
+    void UnregisterWindowEventHandlers(Window window);
+
+    /// @brief Register a handler for one GenericEvent type of an extension, such as XInput2.
+    ///
+    /// @details Dispatch fetches the cookie data with XGetEventData only for registered types, and frees it with
+    /// XFreeEventData as soon as the handler returns, so handlers copy out what they need. Batched dispatch fetches
+    /// the data of every GenericEvent as it is dequeued instead, since dequeuing the rest of the batch would free it,
+    /// and frees it once the batch is dispatched. Takes precedence over a global X11GenericEvent handler, which finds
+    /// the data already fetched in batched mode. Registering again for the same pair replaces the handler.
+    ///
+    /// @param extension The major opcode of the extension, as reported by XQueryExtension.
+    /// @param evtype The extension specific event type.
+    /// @param callback The callback function to call when the event is received
+    void RegisterGenericEventHandler(std::int32_t extension, std::int32_t evtype, X11GenericEventCallback callback);
+
+    /// @brief Removes the handler of one GenericEvent type, if any.
+    void UnregisterGenericEventHandler(std::int32_t extension, std::int32_t evtype);
+
+    /// @brief Register a handler receiving the merged Expose and GraphicsExpose damage of a window.
+    ///
+    /// @details Exposed rectangles are accumulated per window, see X11DamageTracker, and handed over once an event
+    /// with `count == 0` arrives or the X queue drains, so a burst is repainted once. Bounds come from ConfigureNotify
+    /// when the window reports it. Expose events of the window no longer reach other handlers, and while any window is
+    /// tracked batched dispatch leaves exposes to the tracker instead of merging them into one bounding box. Removed
+    /// automatically once the window's DestroyNotify is dispatched.
+    ///
+    /// @param window The window whose exposes to accumulate, None is ignored
+    /// @param callback The callback function to call with the merged damage
+    void RegisterDamageHandler(Window window, X11DamageCallback callback);
+
+    /// @brief Stops accumulating damage for a window, pending damage is dropped.
+    void UnregisterDamageHandler(Window window);
+
+    /// @brief Hands every window's pending damage to its handler, Run does this whenever the X queue drains.
+    void FlushDamage();
+
+    /// @brief Keeps the display's monitor table current from RandR events.
+    ///
+    /// @details Selects the events on the root window, Dispatch then applies each one with
+    /// X11Display::HandleMonitorEvent before anything else sees it. Calling again replaces the callback.
+    ///
+    /// @param on_change Called after an event changed the monitors or the screen size, may be empty.
+    ///
+    /// @returns false without a display or without RandR.
+    auto WatchMonitors(X11MonitorCallback on_change = {}) -> bool;
+
+    /// @brief Calls the handler registered for the event's window and type, falling back to the global handler.
+    ///
+    /// @details The global path is a bounds check and a single indirect call, the per window path adds one open
+    /// addressing lookup, only for event types that have window handlers at all. Does not touch the display
+    /// connection, so it can be driven without an X server.
+    ///
+    /// @param event The event to dispatch, extension events outside the core range are ignored.
+    void Dispatch(XEvent *event);
+
+    /// @brief Opt into batched dispatch with event coalescing.
+    ///
+    /// @details When enabled, Run drains every event `XEventsQueued` reports after each wake up, and collapses
+    /// superseded MotionNotify, ConfigureNotify and Expose events per window before dispatching the rest in order.
+    /// See X11EventCoalescer for the exact rules. Disabled by default.
+    void SetEventBatching(bool enabled) noexcept;
+
+    /// @brief Check whether batched dispatch is enabled
+    [[nodiscard]] auto IsEventBatching() const noexcept -> bool;
+
+    /// @brief Gets how many events batched dispatch has coalesced away so far.
+    [[nodiscard]] auto CoalesceStats() const noexcept -> const X11CoalesceStats &;
+
+    /// @brief Opt into queue latency and handler execution time tracking.
+    ///
+    /// @details Adds two steady clock reads around every handler call and one per dequeued event, see
+    /// X11EventLatency for what is recorded. Histograms are allocated on enable and released on disable.
+    void SetLatencyTracking(bool enabled);
+
+    /// @brief Check whether latency tracking is enabled
+    [[nodiscard]] auto IsLatencyTracking() const noexcept -> bool;
+
+    /// @brief Gets the latency histograms, nullptr unless latency tracking is enabled.
+    [[nodiscard]] auto LatencyStats() const noexcept -> const X11EventLatency *;
+
+    /// @brief Clears the latency histograms, e.g. after dumping them.
+    void ResetLatencyStats() noexcept;
+
+    /// @brief Opt into attributing protocol traffic to the handlers causing it.
+    ///
+    /// @details Brackets every handler call with two X11Display::Traffic snapshots, which read a few counters and
+    /// make no request. See X11EventTraffic for what is attributed. The table is allocated on enable and released on
+    /// disable.
+    void SetTrafficTracking(bool enabled);
+
+    /// @brief Check whether traffic tracking is enabled
+    [[nodiscard]] auto IsTrafficTracking() const noexcept -> bool;
+
+    /// @brief Gets the per event type traffic, nullptr unless traffic tracking is enabled.
+    [[nodiscard]] auto TrafficStats() const noexcept -> const X11EventTraffic *;
+
+    /// @brief Clears the per event type traffic, e.g. after dumping it.
+    void ResetTrafficStats() noexcept;
+
+    /// @brief Attaches a recorder that receives every event as it is dequeued, before coalescing.
+    ///
+    /// @param recorder Not owned, must outlive the loop or be detached by passing nullptr.
+    void SetEventRecorder(X11EventRecorder *recorder) noexcept;
+
+    /// @brief Attaches a property cache that sees every PropertyNotify and DestroyNotify before any handler.
+    ///
+    /// @details Handlers registered for those events, global or per window, keep working and cannot starve the cache
+    /// of an invalidation, so a reused window id never reads properties of the destroyed window.
+    ///
+    /// @param cache Not owned, must outlive the loop or be detached by passing nullptr.
+    void SetPropertyCache(X11PropertyCache *cache) noexcept;
+
+    /// @brief Lets RunPolled resume coroutines awaiting replies on an asynchronous connection.
+    ///
+    /// @param async Not owned, must outlive the loop or be detached by passing nullptr.
+    void SetAsyncConnection(X11AsyncConnection *async) noexcept;
+
+    /// @brief Queues a task to run on the loop thread, safe to call from any thread.
+    ///
+    /// @details Lock free with one allocation per task, only the first post after the loop drained the queue writes
+    /// to the wake up eventfd. Run and RunPolled both wake up for posted tasks, so a task flipping the run flag stops
+    /// the loop right away. Tasks from one thread run in posting order. Tasks still queued when the loop is
+    /// destroyed are dropped, and the loop must not be moved while other threads may post.
+    void Post(X11PostedTask task);
+
+    /// @brief Schedules a callback to run once the X queue is fully drained, deduplicated by key.
+    ///
+    /// @details Scheduling a key that is already pending replaces its callback but keeps its place in line, so ten
+    /// redraw requests during an event burst cost one redraw. Pending callbacks run in scheduling order, in slices
+    /// bounded by SetIdleBudget with X events handled in between. Run and RunPolled do not sleep while idle work is
+    /// pending, so it always completes. Callbacks may schedule further idle work, which waits for the next slice.
+    ///
+    /// @param key Non zero, zero is ignored along with empty callbacks.
+    void ScheduleIdle(X11IdleKey key, X11IdleCallback callback);
+
+    /// @brief Drops pending idle work, unknown keys are ignored.
+    void CancelIdle(X11IdleKey key);
+
+    /// @brief Check whether idle work is pending for a key
+    [[nodiscard]] auto IsIdleScheduled(X11IdleKey key) const noexcept -> bool;
+
+    /// @brief Gets the number of pending idle callbacks
+    [[nodiscard]] auto PendingIdleWork() const noexcept -> std::size_t;
+
+    /// @brief Sets how long one idle slice may run before X events are checked again.
+    ///
+    /// @details The budget is checked between callbacks, at least one callback runs per slice.
+    void SetIdleBudget(std::chrono::microseconds budget) noexcept;
+
+    /// @brief Runs one slice of idle work, Run and RunPolled call this whenever the X queue is drained.
+    ///
+    /// @details Exposed for custom loops and tests, does not touch the display connection.
+    ///
+    /// @returns true if idle work is still pending afterwards.
+    auto RunIdleWork() -> bool;
+
     /// @brief Starts the event loop
     /// @details This function will block until an event is received, the user needs
-    /// should do substantial set up before calling this function.
+    /// should do substantial set up before calling this function. Posted tasks also wake it up, and get a turn
+    /// every few hundred events while a steady stream of events keeps the queue from draining.
     ///
     /// @param run_flag A flag to keep the loop (program) running, change too false to shut down the event loop.
-    void Run(const bool &run_flag) const;
+    void Run(const bool &run_flag);
+
+    ///////////////////////////////////////
+    /// Multiplexed (epoll) loop
+    ///////////////////////////////////////
+
+    /// @brief Adds a timerfd backed timer, only serviced by RunPolled.
+    ///
+    /// @param initial Delay before the first expiration, must be non zero.
+    /// @param interval Period of subsequent expirations, zero for a one shot timer.
+    /// @param callback Called on the loop thread per wake up, missed expirations are folded into one call.
+    ///
+    /// @returns The id to pass to RemoveTimer.
+    [[nodiscard]] auto AddTimer(std::chrono::milliseconds initial, std::chrono::milliseconds interval,
+                                X11TimerCallback callback) -> etl::Result<X11TimerId, X11EventLoopError>;
+
+    /// @brief Removes a timer and closes its timerfd, unknown ids are ignored.
+    void RemoveTimer(X11TimerId timer_id);
+
+    /// @brief Delivers a signal through a signalfd, only serviced by RunPolled.
+    ///
+    /// @details The signal is blocked for the calling thread, so call this before spawning any threads. Blocked
+    /// signals are inherited across fork and exec, child processes should restore their signal mask.
+    /// Watching an already watched signal replaces its callback.
+    [[nodiscard]] auto WatchSignal(std::int32_t signal_number, X11SignalCallback callback)
+        -> etl::Result<etl::Void, X11EventLoopError>;
+
+    /// @brief Watches a caller owned file descriptor, only serviced by RunPolled.
+    ///
+    /// @param fd The descriptor, ownership stays with the caller who must unwatch it before closing it.
+    /// @param epoll_events The epoll event bits to wait for, e.g. EPOLLIN.
+    /// @param callback Called on the loop thread with the ready event bits.
+    [[nodiscard]] auto WatchFileDescriptor(std::int32_t fd, std::uint32_t epoll_events, X11FdCallback callback)
+        -> etl::Result<etl::Void, X11EventLoopError>;
+
+    /// @brief Stops watching a caller owned file descriptor, unknown descriptors are ignored.
+    void UnwatchFileDescriptor(std::int32_t fd);
+
+    /// @brief Starts the event loop, multiplexing the X connection with timers, signals and watched descriptors.
+    ///
+    /// @details Sleeps in epoll_wait only once Xlib's internal queue and the socket are drained and the output
+    /// buffer is flushed, so the loop is idle with no wake ups when nothing happens. While a steady stream of events
+    /// keeps the queue from draining, the other sources are polled without blocking every few hundred events.
+    /// Honors SetEventBatching. Replies for an attached X11AsyncConnection are only serviced here, not by Run.
+    ///
+    /// @param run_flag A flag to keep the loop (program) running, change too false to shut down the event loop.
+    /// Flipping it from a timer, signal or descriptor callback takes effect immediately.
+    ///
+    /// @returns An error if epoll is unavailable or fails, Void once run_flag is false.
+    [[nodiscard]] auto RunPolled(const bool &run_flag) -> etl::Result<etl::Void, X11EventLoopError>;
+
+  private:
+    enum class PollSourceKind : std::uint8_t
+    {
+        Timer,
+        Signal,
+        FileDescriptor,
+    };
+
+    struct PollSource
+    {
+        std::int32_t fd;
+        PollSourceKind kind;
+        UniqueFd owned_fd;
+        X11TimerCallback on_timer;
+        X11FdCallback on_ready;
+    };
+
+    struct SignalWatch
+    {
+        std::int32_t signal_number;
+        X11SignalCallback callback;
+    };
+
+    struct IdleTask
+    {
+        X11IdleKey key;
+        X11IdleCallback callback;
+    };
+
+    /// @brief Shared with posting threads, heap allocated so its address survives moving the loop.
+    struct PostedTasks
+    {
+        UniqueFd wakeup_fd;
+        MpscQueue<X11PostedTask> queue;
+        std::atomic<bool> wakeup_pending;
+    };
+
+    [[nodiscard]] auto AddPollSource(std::int32_t fd, std::uint32_t epoll_events) -> bool;
+    [[nodiscard]] auto FindPollSource(std::int32_t fd) noexcept -> PollSource *;
+    void RemovePollSource(std::int32_t fd);
+    void DispatchPollSource(std::int32_t fd, std::uint32_t epoll_events);
+    void DispatchSignals();
+
+    /// @brief Makes the wake up descriptor readable, unless a wake up is already pending.
+    void WakeUp() noexcept;
+
+    /// @brief Runs the tasks posted so far, leaving the rest for another wake up past a per wake up limit.
+    void RunPostedTasks();
+
+    /// @brief Blocks until the X connection or the wake up descriptor is readable, or the timeout expires.
+    ///
+    /// @param timeout_ms As for poll, -1 waits indefinitely.
+    ///
+    /// @returns false if polling failed, the caller falls back to blocking in Xlib.
+    [[nodiscard]] auto WaitForInput(std::int32_t x_fd, std::int32_t timeout_ms) const noexcept -> bool;
+
+    /// @brief Drops consumed idle slots once they make up half of the queue.
+    void CompactIdleQueue();
+
+  private:
+    /// @brief Dispatches the next event, or the next batch when batching is enabled, blocking if none is queued.
+    ///
+    /// @returns The number of events taken off the queue.
+    auto DispatchNext(const bool &run_flag) -> std::size_t;
+
+    /// @brief Blocks for the next event, drains the rest of the queue, coalesces and dispatches the batch.
+    ///
+    /// @returns The number of events taken off the queue, including the ones coalesced away.
+    auto DispatchBatch(const bool &run_flag) -> std::size_t;
+
+    /// @brief Bookkeeping for an event just taken off the Xlib queue, before it is coalesced or dispatched.
+    void OnDequeued(const XEvent &event, std::chrono::steady_clock::time_point dequeued);
+
+    /// @brief Calls a handler, timing it and attributing its traffic when tracking is enabled.
+    template <typename Callback, typename Event>
+    void InvokeHandler(std::size_t index, const Callback &handler, Event &&event);
+
+    /// @brief Runs the handler registered for a GenericEvent cookie with its data fetched.
+    ///
+    /// @returns false if no handler is registered for the cookie's extension and type.
+    [[nodiscard]] auto DispatchGeneric(XEvent *event) -> bool;
+
+    /// @brief Feeds exposes, sizes and destruction of damage tracked windows to the tracker.
+    ///
+    /// @returns true if the event was an expose consumed by the tracker.
+    [[nodiscard]] auto TrackDamage(const XEvent &event) -> bool;
+
+    [[nodiscard]] static auto WindowHandlerKey(std::size_t index, Window window) noexcept -> std::uint64_t;
+
+    [[nodiscard]] static auto GenericHandlerKey(std::int32_t extension, std::int32_t evtype) noexcept
+        -> std::uint64_t;
 
   private:
     X11DisplaySharedResource _dpy;
-    std::unordered_map<X11EventType, X11EventCallback> _event_handlers;
+    std::array<X11EventCallback, kEventTableSize> _event_handlers{};
+    FlatMap<X11EventCallback> _window_handlers;
+    std::array<std::uint32_t, kEventTableSize> _window_handler_counts{};
+    FlatMap<X11GenericEventCallback> _generic_handlers;
+    X11DamageTracker _damage;
+    bool _watching_monitors{};
+    X11MonitorCallback _on_monitors_changed;
+    std::vector<XEvent> _batch;
+    X11EventCoalescer _coalescer;
+    bool _batching{};
+    std::unique_ptr<X11EventLatency> _latency;
+    std::unique_ptr<X11EventTraffic> _traffic;
+    X11EventRecorder *_recorder{};
+    X11PropertyCache *_property_cache{};
+    X11AsyncConnection *_async{};
+    std::unique_ptr<PostedTasks> _posted;
+    bool _posted_watched{};
+    std::vector<IdleTask> _idle;
+    std::size_t _idle_head{};
+    FlatMap<std::size_t> _idle_slots;
+    std::chrono::microseconds _idle_budget{kDefaultIdleBudget};
+    UniqueFd _epoll;
+    UniqueFd _signal_fd;
+    std::vector<PollSource> _poll_sources;
+    std::vector<SignalWatch> _signal_watches;
+    bool _x_connection_watched{};
 };
 
 } // namespace Tilebox
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "tilebox/error.hpp"
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/utils/unique_fd.hpp"
+#include "tilebox/x11/event_loop.hpp"
+
+#include <X11/Xlib.h>
+#include <etl.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace Tilebox
+{
+
+////////////////////////////////////
+// On disk format
+////////////////////////////////////
+
+/// @brief Leads every event recording.
+///
+/// @details A recording is this header followed by records back to back until the end of the file. Every record is
+/// an X11EventRecordHeader followed by `size` bytes of the XEvent, padded to a multiple of 8 bytes so records stay
+/// aligned when the file is memory mapped. Only the bytes of the event type's own Xlib struct are stored, which is
+/// less than half of sizeof(XEvent) for most events. Values use the recording machine's byte order, and
+/// `xevent_size` guards against replaying on a different Xlib ABI.
+struct TILEBOX_EXPORT X11EventRecordFileHeader
+{
+    static constexpr std::array<char, 8> kMagic = {'T', 'B', 'X', 'E', 'V', 'R', 'E', 'C'};
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t xevent_size;
+};
+
+/// @brief Precedes every recorded event.
+struct TILEBOX_EXPORT X11EventRecordHeader
+{
+    /// @brief Time the event was dequeued, relative to the first recorded event.
+    std::uint64_t timestamp_ns;
+
+    /// @brief Number of XEvent bytes that follow, excluding padding.
+    std::uint32_t size;
+
+    /// @brief The Xlib event type, duplicated so readers can skip records without decoding them.
+    std::int32_t type;
+};
+
+////////////////////////////////////
+// Recording
+////////////////////////////////////
+
+/// @brief Appends every event dequeued by an X11EventLoop to a recording file.
+///
+/// @details Attach with X11EventLoop::SetEventRecorder. Records are buffered in memory and written in large chunks,
+/// so recording costs a memcpy per event. The `display` pointer of every event is zeroed, it would be meaningless
+/// on replay. GenericEvents, e.g. XInput2 input, are skipped: their data lives outside the XEvent and is gone by
+/// replay time, so a recorded cookie could never be dispatched. SkippedEvents tells how many were left out.
+class TILEBOX_EXPORT X11EventRecorder
+{
+  public:
+    /// @brief Creates or truncates the recording at `path` and writes the file header.
+    [[nodiscard]] static auto Create(const std::string &path) noexcept
+        -> etl::Result<X11EventRecorder, X11EventRecordError>;
+
+    /// @brief Flushes buffered records, write errors are ignored at this point.
+    ~X11EventRecorder();
+
+    X11EventRecorder(X11EventRecorder &&rhs) noexcept = default;
+    X11EventRecorder(const X11EventRecorder &rhs) = delete;
+
+  public:
+    auto operator=(X11EventRecorder &&rhs) noexcept -> X11EventRecorder &;
+    auto operator=(const X11EventRecorder &rhs) -> X11EventRecorder & = delete;
+
+  public:
+    /// @brief Appends one event, stamped relative to the first recorded event.
+    ///
+    /// @details After a write error every further event is dropped, Flush reports the error.
+    auto Record(const XEvent &event, std::chrono::steady_clock::time_point dequeued) -> void;
+
+    /// @brief Writes every buffered record to the file.
+    [[nodiscard]] auto Flush() -> etl::Result<etl::Void, X11EventRecordError>;
+
+    /// @brief Gets the number of events recorded so far
+    [[nodiscard]] auto RecordedEvents() const noexcept -> std::uint64_t;
+
+    /// @brief Gets the number of GenericEvents left out of the recording so far
+    [[nodiscard]] auto SkippedEvents() const noexcept -> std::uint64_t;
+
+  private:
+    explicit X11EventRecorder(UniqueFd &&fd) noexcept;
+
+  private:
+    UniqueFd m_fd;
+    std::vector<std::byte> m_buffer;
+    std::optional<std::chrono::steady_clock::time_point> m_start;
+    std::uint64_t m_recorded{};
+    std::uint64_t m_skipped{};
+    bool m_failed{};
+};
+
+////////////////////////////////////
+// Replay
+////////////////////////////////////
+
+/// @brief How fast X11EventReplay::Play feeds events.
+enum class TILEBOX_EXPORT X11ReplaySpeed : std::uint8_t
+{
+    /// @brief Back to back, for benchmarks and profiling.
+    AsFastAsPossible,
+    /// @brief Keeping the recorded spacing between events.
+    RealTime,
+};
+
+/// @brief Reads a memory mapped event recording back.
+///
+/// @details Replay needs no X server for the dispatch side, events go straight through X11EventLoop::Dispatch.
+/// Handlers should use their own display connection rather than the (zeroed) `display` field of the event.
+class TILEBOX_EXPORT X11EventReplay
+{
+  public:
+    /// @brief Maps the recording at `path` and validates its header.
+    [[nodiscard]] static auto Open(const std::string &path) noexcept
+        -> etl::Result<X11EventReplay, X11EventRecordError>;
+
+    /// @brief Unmaps the recording
+    ~X11EventReplay();
+
+    X11EventReplay(X11EventReplay &&rhs) noexcept;
+    X11EventReplay(const X11EventReplay &rhs) = delete;
+
+  public:
+    auto operator=(X11EventReplay &&rhs) noexcept -> X11EventReplay &;
+    auto operator=(const X11EventReplay &rhs) -> X11EventReplay & = delete;
+
+  public:
+    /// @brief Reads the next event, bytes the record does not cover are zeroed.
+    ///
+    /// @returns false at the end of the recording, or at a truncated trailing record.
+    [[nodiscard]] auto Next(XEvent &event, std::chrono::nanoseconds &timestamp) noexcept -> bool;
+
+    /// @brief Starts reading from the first event again.
+    auto Rewind() noexcept -> void;
+
+    /// @brief Dispatches every remaining event through `loop`.
+    ///
+    /// @param run_flag Checked before every event, change to false to stop early.
+    ///
+    /// @returns The number of events dispatched.
+    auto Play(X11EventLoop &loop, X11ReplaySpeed speed, const bool &run_flag) -> std::uint64_t;
+
+  private:
+    X11EventReplay(const std::byte *data, std::size_t size) noexcept;
+
+  private:
+    const std::byte *m_data{};
+    std::size_t m_size{};
+    std::size_t m_offset{};
+};
+
+} // namespace Tilebox
+
+/// @brief Hi-jack the etl namespace to add a custom template specialization for Tilebox::X11EventRecorder
+template <typename ErrType> class etl::Result<Tilebox::X11EventRecorder, ErrType>
+{
+  public:
+    Result() noexcept = default;
+
+    explicit Result(Tilebox::X11EventRecorder &&value) noexcept : m_result(std::move(value)), m_is_ok(true)
+    {
+    }
+
+    explicit Result(const ErrType &error) noexcept : m_result(error)
+    {
+    }
+
+    explicit Result(ErrType &&error) noexcept : m_result(std::move(error))
+    {
+    }
+
+  public:
+    /// @brief Check if the union value is of the ok type
+    [[nodiscard]] auto is_ok() const noexcept -> bool
+    {
+        return m_is_ok;
+    }
+
+    /// @brief Check if the union value is of the error type
+    [[nodiscard]] auto is_err() const noexcept -> bool
+    {
+        return !m_is_ok;
+    }
+
+    /// @brief Moves the recorder out of the result
+    ///
+    /// @details The use should always use is_ok() before using ok()
+    ///
+    /// @return std::optional<Tilebox::X11EventRecorder> for safety, incase the user did not call
+    /// is_ok() before using this method.
+    [[nodiscard]] auto ok() noexcept -> std::optional<Tilebox::X11EventRecorder>
+    {
+        std::optional<Tilebox::X11EventRecorder> ret;
+        if (m_is_ok)
+        {
+            if (auto *value = std::get_if<Tilebox::X11EventRecorder>(&m_result))
+            {
+                ret.emplace(std::move(*value));
+            }
+        }
+        return ret;
+    }
+
+    /// @brief Check if the union value is of the error type
+    ///
+    /// @details The use should always use is_err() before using err()
+    ///
+    /// @return std::optional<ErrType> for safety, incase the user did not call
+    /// is_err() before using this method.
+    [[nodiscard]] auto err() const noexcept -> std::optional<ErrType>
+    {
+        std::optional<ErrType> ret;
+        if (!m_is_ok)
+        {
+            if (auto *err = std::get_if<ErrType>(&m_result))
+            {
+                ret.emplace(*err);
+            }
+        }
+        return ret;
+    }
+
+  private:
+    std::variant<Tilebox::X11EventRecorder, ErrType> m_result;
+    bool m_is_ok{};
+}; // namespace etl
+
+/// @brief Hi-jack the etl namespace to add a custom template specialization for Tilebox::X11EventReplay
+template <typename ErrType> class etl::Result<Tilebox::X11EventReplay, ErrType>
+{
+  public:
+    Result() noexcept = default;
+
+    explicit Result(Tilebox::X11EventReplay &&value) noexcept : m_result(std::move(value)), m_is_ok(true)
+    {
+    }
+
+    explicit Result(const ErrType &error) noexcept : m_result(error)
+    {
+    }
+
+    explicit Result(ErrType &&error) noexcept : m_result(std::move(error))
+    {
+    }
+
+  public:
+    /// @brief Check if the union value is of the ok type
+    [[nodiscard]] auto is_ok() const noexcept -> bool
+    {
+        return m_is_ok;
+    }
+
+    /// @brief Check if the union value is of the error type
+    [[nodiscard]] auto is_err() const noexcept -> bool
+    {
+        return !m_is_ok;
+    }
+
+    /// @brief Moves the replay out of the result
+    ///
+    /// @details The use should always use is_ok() before using ok()
+    ///
+    /// @return std::optional<Tilebox::X11EventReplay> for safety, incase the user did not call
+    /// is_ok() before using this method.
+    [[nodiscard]] auto ok() noexcept -> std::optional<Tilebox::X11EventReplay>
+    {
+        std::optional<Tilebox::X11EventReplay> ret;
+        if (m_is_ok)
+        {
+            if (auto *value = std::get_if<Tilebox::X11EventReplay>(&m_result))
+            {
+                ret.emplace(std::move(*value));
+            }
+        }
+        return ret;
+    }
+
+    /// @brief Check if the union value is of the error type
+    ///
+    /// @details The use should always use is_err() before using err()
+    ///
+    /// @return std::optional<ErrType> for safety, incase the user did not call
+    /// is_err() before using this method.
+    [[nodiscard]] auto err() const noexcept -> std::optional<ErrType>
+    {
+        std::optional<ErrType> ret;
+        if (!m_is_ok)
+        {
+            if (auto *err = std::get_if<ErrType>(&m_result))
+            {
+                ret.emplace(*err);
+            }
+        }
+        return ret;
+    }
+
+  private:
+    std::variant<Tilebox::X11EventReplay, ErrType> m_result;
+    bool m_is_ok{};
+}; // namespace etl
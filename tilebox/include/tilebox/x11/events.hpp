@@ -2,7 +2,11 @@
 
 #include "tilebox/utils/attributes.hpp"
 
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
 #include <cstdint>
+#include <string_view>
 
 namespace Tilebox
 {
@@ -100,4 +104,20 @@ TILEBOX_EXPORT [[nodiscard]] auto EventFromXlibEvent(std::int32_t event_type) no
 
 TILEBOX_EXPORT [[nodiscard]] auto EventToXlibEvent(X11EventType event_type) noexcept -> std::int32_t;
 
+/// @brief Gets the protocol name of an event type, e.g. "MotionNotify".
+TILEBOX_EXPORT [[nodiscard]] auto EventTypeName(X11EventType event_type) noexcept -> std::string_view;
+
+/// @brief Extracts the window an event is about.
+///
+/// @details For substructure events this is the child the event describes (e.g. `xmaprequest.window`,
+/// `xdestroywindow.window`) rather than the parent it was reported on, for exposures it is the drawable.
+///
+/// @returns None for events that carry no window, such as MappingNotify, KeymapNotify and GenericEvent.
+TILEBOX_EXPORT [[nodiscard]] auto EventWindowFromXlibEvent(const XEvent &event) noexcept -> Window;
+
+/// @brief Extracts the X server timestamp, in milliseconds, an event carries.
+///
+/// @returns CurrentTime for events without a timestamp.
+TILEBOX_EXPORT [[nodiscard]] auto EventTimeFromXlibEvent(const XEvent &event) noexcept -> Time;
+
 } // namespace Tilebox
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "tilebox/geometry.hpp"
+#include "tilebox/utils/attributes.hpp"
+
+#include <X11/X.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace Tilebox
+{
+
+/// @brief One physical monitor in root window coordinates.
+struct TILEBOX_EXPORT X11Monitor
+{
+    Rect geometry;
+
+    /// @brief The RandR CRTC driving the monitor, None when the geometry came from Xinerama or the screen.
+    XID crtc{};
+
+    /// @brief The first RandR output of the CRTC, None if unknown.
+    XID output{};
+
+    bool primary{};
+
+    [[nodiscard]] auto operator==(const X11Monitor &rhs) const noexcept -> bool = default;
+};
+
+/// @brief Compact, allocation free table of monitors with lookups by index and by point.
+///
+/// @details Monitors are kept sorted left to right, then top to bottom, so indices follow the physical layout. Every
+/// change rebuilds a grid over the distinct monitor edges, at most `2 * kMaxMonitors` per axis, whose cells name the
+/// monitor covering them. A point lookup is two searches over those few edges and one cell read, independent of where
+/// the point lies. Mirrored CRTCs showing the same area are listed once, preferring the primary one, but every CRTC
+/// is remembered so a mirror takes over once the listed CRTC is disabled or moves away.
+class TILEBOX_EXPORT X11MonitorTable
+{
+  public:
+    /// @brief Monitors beyond this are ignored, mirrors included.
+    static constexpr std::size_t kMaxMonitors = 16;
+
+  public:
+    /// @brief Gets the number of monitors
+    [[nodiscard]] auto Size() const noexcept -> std::size_t;
+
+    /// @brief Check whether the table holds no monitors
+    [[nodiscard]] auto Empty() const noexcept -> bool;
+
+    /// @brief Gets all monitors in index order
+    [[nodiscard]] auto Monitors() const noexcept -> std::span<const X11Monitor>;
+
+    /// @brief Gets the monitor at `index`, nullptr if out of range.
+    [[nodiscard]] auto At(std::size_t index) const noexcept -> const X11Monitor *;
+
+    /// @brief Gets the primary monitor, the first one if none is marked primary, nullptr if empty.
+    [[nodiscard]] auto Primary() const noexcept -> const X11Monitor *;
+
+    /// @brief Gets the index of the monitor containing `point`, the first in index order where monitors overlap.
+    [[nodiscard]] auto IndexAt(const Point &point) const noexcept -> std::optional<std::size_t>;
+
+    /// @brief Replaces every monitor.
+    auto Assign(std::span<const X11Monitor> monitors) noexcept -> void;
+
+    /// @brief Moves or resizes the monitor driven by `crtc`, adding it if the CRTC is new.
+    ///
+    /// @returns true if the listed monitors changed, a mirror moving onto a listed monitor changes nothing.
+    auto UpdateCrtc(XID crtc, const Rect &geometry) noexcept -> bool;
+
+    /// @brief Removes the monitor driven by `crtc`, once the CRTC is disabled.
+    ///
+    /// @returns true if the listed monitors changed.
+    auto RemoveCrtc(XID crtc) noexcept -> bool;
+
+    /// @brief Records which output a CRTC drives.
+    ///
+    /// @returns true if the listed monitors changed.
+    auto SetCrtcOutput(XID crtc, XID output) noexcept -> bool;
+
+    /// @brief Marks the monitor of `output` as primary, None clears it.
+    ///
+    /// @returns true if the listed monitors changed.
+    auto SetPrimaryOutput(XID output) noexcept -> bool;
+
+  private:
+    static constexpr std::size_t kMaxEdges = kMaxMonitors * 2;
+    static constexpr std::uint8_t kNoMonitor = 0xFF;
+
+    [[nodiscard]] auto Find(XID crtc) noexcept -> X11Monitor *;
+    auto Insert(const X11Monitor &monitor) noexcept -> bool;
+
+    /// @brief Lists the CRTCs without mirrors, sorted, and rebuilds the lookup grid.
+    ///
+    /// @returns true if the listed monitors changed.
+    auto Reindex() noexcept -> bool;
+
+  private:
+    /// @brief Every known CRTC including mirrors, in insertion order.
+    std::array<X11Monitor, kMaxMonitors> m_crtcs{};
+    std::size_t m_crtc_count{};
+    /// @brief The listed monitors, what Monitors() returns.
+    std::array<X11Monitor, kMaxMonitors> m_monitors{};
+    std::size_t m_count{};
+    XID m_primary_output{};
+    std::array<std::int32_t, kMaxEdges> m_x_edges{};
+    std::size_t m_x_edge_count{};
+    std::array<std::int32_t, kMaxEdges> m_y_edges{};
+    std::size_t m_y_edge_count{};
+    /// @brief Row major, one row per span between adjacent y edges.
+    std::array<std::uint8_t, (kMaxEdges - 1) * (kMaxEdges - 1)> m_cells{};
+};
+
+} // namespace Tilebox
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/utils/flat_map.hpp"
+#include "tilebox/x11/display.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <xcb/xproto.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace Tilebox
+{
+
+////////////////////////////////////
+// Decoded values
+////////////////////////////////////
+
+/// @brief WM_CLASS, instance and class name.
+struct TILEBOX_EXPORT X11ClassHint
+{
+    std::string instance;
+    std::string name;
+};
+
+/// @brief The parts of WM_HINTS a window manager acts on.
+struct TILEBOX_EXPORT X11WmHints
+{
+    /// @brief InputHint, StateHint, XUrgencyHint, etc.
+    std::uint32_t flags{};
+    bool input{true};
+    std::int32_t initial_state{NormalState};
+    Window window_group{};
+
+    [[nodiscard]] auto IsUrgent() const noexcept -> bool
+    {
+        return (flags & XUrgencyHint) != 0;
+    }
+};
+
+/// @brief WM_NORMAL_HINTS, fields whose flag is unset are zero.
+struct TILEBOX_EXPORT X11SizeHints
+{
+    /// @brief PMinSize, PMaxSize, PResizeInc, PAspect, PBaseSize, PWinGravity.
+    std::uint32_t flags{};
+    std::int32_t min_width{};
+    std::int32_t min_height{};
+    std::int32_t max_width{};
+    std::int32_t max_height{};
+    std::int32_t width_inc{};
+    std::int32_t height_inc{};
+    std::int32_t min_aspect_num{};
+    std::int32_t min_aspect_den{};
+    std::int32_t max_aspect_num{};
+    std::int32_t max_aspect_den{};
+    std::int32_t base_width{};
+    std::int32_t base_height{};
+    std::int32_t win_gravity{NorthWestGravity};
+};
+
+/// @brief Decoded property, std::monostate when the window does not have it.
+using X11PropertyValue = std::variant<std::monostate, std::string, X11ClassHint, X11WmHints, X11SizeHints,
+                                      std::vector<Atom>>;
+
+/// @brief Atoms that are not predefined, interned by the window manager.
+struct TILEBOX_EXPORT X11PropertyAtoms
+{
+    Atom net_wm_name{};
+    Atom net_wm_state{};
+
+    /// @brief The only type _NET_WM_NAME is decoded from, EWMH requires it.
+    Atom utf8_string{};
+};
+
+/// @brief Counters describing how well the property cache works.
+struct TILEBOX_EXPORT X11PropertyCacheStats
+{
+    /// @brief Lookups answered without a request.
+    std::uint64_t hits{};
+
+    /// @brief Properties fetched from the server, by lookups or Prefetch.
+    std::uint64_t misses{};
+
+    /// @brief Entries dropped by PropertyNotify or window destruction.
+    std::uint64_t invalidations{};
+
+    /// @brief Entries dropped to make room.
+    std::uint64_t evictions{};
+};
+
+////////////////////////////////////
+// Cache
+////////////////////////////////////
+
+/// @brief Decoded window properties keyed by (Window, Atom), refilled lazily after PropertyNotify.
+///
+/// @details Caches WM_NAME, _NET_WM_NAME, WM_CLASS, WM_HINTS, WM_NORMAL_HINTS and _NET_WM_STATE, other properties
+/// are ignored. Memory is bounded by the entry capacity and by truncating text and atom lists. Once full, entries
+/// are recycled in CLOCK order, so recently read properties survive. A PropertyNotify with NewValue drops the entry,
+/// one with Delete records the property as absent without a round trip.
+///
+/// @code
+/// X11PropertyCache cache(dpy, atoms);
+/// loop.SetPropertyCache(&cache); // fed PropertyNotify and DestroyNotify ahead of every handler
+/// cache.Prefetch(window); // one round trip for every property
+/// const std::string_view title = cache.Title(window);
+/// @endcode
+class TILEBOX_EXPORT X11PropertyCache
+{
+  public:
+    static constexpr std::size_t kDefaultCapacity = 1024;
+
+    /// @brief Longest text kept, in 32 bit units as requested from the server.
+    static constexpr std::uint32_t kMaxTextUnits = 256;
+
+    /// @brief Most atoms kept of an atom list.
+    static constexpr std::uint32_t kMaxAtoms = 32;
+
+  public:
+    X11PropertyCache(X11DisplaySharedResource dpy, const X11PropertyAtoms &atoms,
+                     std::size_t capacity = kDefaultCapacity);
+
+  public:
+    /// @brief Gets a decoded property, fetching it on a miss.
+    ///
+    /// @details The reference is valid until the next call that can fetch or invalidate.
+    [[nodiscard]] auto Get(Window window, Atom property) -> const X11PropertyValue &;
+
+    /// @brief Fetches every supported property of `window` not cached yet, pipelined into a single round trip.
+    auto Prefetch(Window window) -> void;
+
+    /// @brief Gets the title, _NET_WM_NAME falling back to WM_NAME, empty if neither is set.
+    [[nodiscard]] auto Title(Window window) -> std::string_view;
+
+    /// @brief Gets WM_CLASS, nullptr if unset.
+    [[nodiscard]] auto Class(Window window) -> const X11ClassHint *;
+
+    /// @brief Gets WM_HINTS, nullptr if unset.
+    [[nodiscard]] auto WmHints(Window window) -> const X11WmHints *;
+
+    /// @brief Gets WM_NORMAL_HINTS, nullptr if unset.
+    [[nodiscard]] auto SizeHints(Window window) -> const X11SizeHints *;
+
+    /// @brief Gets _NET_WM_STATE, empty if unset.
+    [[nodiscard]] auto NetWmState(Window window) -> std::span<const Atom>;
+
+    /// @brief Applies PropertyNotify and DestroyNotify, every other event is ignored.
+    auto HandleEvent(const XEvent &event) -> void;
+
+    /// @brief Drops one cached property.
+    auto Invalidate(Window window, Atom property) -> void;
+
+    /// @brief Drops every cached property of a window.
+    auto Forget(Window window) -> void;
+
+    /// @brief Stores a decoded value as if it was fetched, for replays and tests.
+    auto Store(Window window, Atom property, X11PropertyValue value) -> void;
+
+    /// @brief Check whether a property is cached
+    [[nodiscard]] auto Contains(Window window, Atom property) const noexcept -> bool;
+
+    /// @brief Gets the number of cached properties
+    [[nodiscard]] auto Size() const noexcept -> std::size_t;
+
+    /// @brief Gets the counters accumulated since construction or the last ResetStats call.
+    [[nodiscard]] auto Stats() const noexcept -> const X11PropertyCacheStats &;
+
+    /// @brief Zeroes all counters.
+    auto ResetStats() noexcept -> void;
+
+    /// @brief Check whether a property is one this cache stores
+    [[nodiscard]] auto IsCached(Atom property) const noexcept -> bool;
+
+    /// @brief Decodes a GetProperty reply of a supported property, std::monostate if it is unset or malformed.
+    [[nodiscard]] auto Decode(Atom property, const xcb_get_property_reply_t *reply) const -> X11PropertyValue;
+
+  private:
+    struct Entry
+    {
+        FlatMap<std::uint32_t>::Key key{};
+        X11PropertyValue value;
+        bool referenced{};
+    };
+
+    static constexpr std::size_t kPropertyCount = 6;
+
+    [[nodiscard]] static auto Key(Window window, Atom property) noexcept -> std::uint64_t;
+    [[nodiscard]] auto Properties() const noexcept -> std::array<Atom, kPropertyCount>;
+    [[nodiscard]] auto FetchLength(Atom property) const noexcept -> std::uint32_t;
+    [[nodiscard]] auto Fetch(Window window, Atom property) -> X11PropertyValue;
+    auto Insert(std::uint64_t key, X11PropertyValue value) -> Entry &;
+    auto Release(std::uint32_t slot) -> void;
+
+  private:
+    X11DisplaySharedResource m_dpy;
+    X11PropertyAtoms m_atoms;
+    std::size_t m_capacity;
+    FlatMap<std::uint32_t> m_slots;
+    std::vector<Entry> m_entries;
+    std::vector<std::uint32_t> m_free;
+    std::size_t m_hand{};
+    X11PropertyCacheStats m_stats;
+};
+
+} // namespace Tilebox
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/xcb.hpp"
+
+#include <xcb/xproto.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Tilebox
+{
+
+class X11RequestBatch;
+
+/// @brief How a request batch learns about errors caused by its requests.
+enum class X11BatchErrors : std::uint8_t
+{
+    /// @brief Errors reach the error handler whenever Xlib reads them, End only flushes.
+    Unchecked,
+
+    /// @brief End waits for the server with XSync, the error count is final afterwards. Costs one round trip.
+    Sync,
+
+    /// @brief End only flushes, the error count is final once Settled reports that Xlib read past the batch.
+    Async,
+};
+
+namespace Detail
+{
+
+/// @brief Batches open on a display, shared with the error hook of the display.
+struct TILEBOX_EXPORT X11BatchRegistry
+{
+    /// @brief Number of open batches, Flush and Sync of the display are deferred while non zero.
+    std::uint32_t depth{};
+
+    /// @brief Set by a Sync deferred in a batch, the outermost batch syncs when it ends.
+    bool sync_deferred{};
+
+    /// @brief Checked batches whose errors may still arrive.
+    std::vector<X11RequestBatch *> checked;
+};
+
+} // namespace Detail
+
+/// @brief Scope sending every request made inside it to the server in one write.
+///
+/// @details While any batch is open X11Display::Flush is a no-op and X11Display::Sync is deferred to the end of the
+/// outermost batch, which flushes exactly once, so a relayout, restack or focus change goes out in one write no
+/// matter how many helpers it calls. Xlib still flushes on its own when its 16 KiB buffer fills up or a request needs
+/// a reply, keep replies out of batches. Errors of checked batches are counted by the batch instead of reaching the
+/// error handler, matching the requests by sequence number.
+///
+/// @code
+/// X11RequestBatch batch(dpy, X11BatchErrors::Async);
+/// for (const Client &client : clients) { XMoveResizeWindow(dpy->Raw(), client.window, ...); }
+/// batch.End(); // one write, no round trip
+/// ...
+/// if (batch.Settled() && batch.Errors() > 0) { ... } // later, e.g. from idle work
+/// @endcode
+class TILEBOX_EXPORT X11RequestBatch
+{
+  public:
+    explicit X11RequestBatch(X11DisplaySharedResource dpy, X11BatchErrors errors = X11BatchErrors::Unchecked);
+
+    /// @brief Ends the batch if End was not called.
+    ~X11RequestBatch();
+
+    X11RequestBatch(const X11RequestBatch &other) = delete;
+    auto operator=(const X11RequestBatch &other) -> X11RequestBatch & = delete;
+    X11RequestBatch(X11RequestBatch &&other) noexcept = delete;
+    auto operator=(X11RequestBatch &&other) noexcept -> X11RequestBatch & = delete;
+
+  public:
+    /// @brief Ends the batch, later calls do nothing.
+    ///
+    /// @details Nested batches only close their request range, the outermost one flushes, or syncs for Sync batches
+    /// and when a Sync was deferred.
+    auto End() -> void;
+
+    /// @brief Check whether the batch has been ended
+    [[nodiscard]] auto IsEnded() const noexcept -> bool;
+
+    /// @brief Check whether the error count is final, without blocking.
+    ///
+    /// @details Unchecked batches settle when ended, the others once Xlib processed a reply, event or error past
+    /// their last request, which for Sync batches is the sync itself. Any event arriving later does for Async
+    /// batches, a busy window manager sees one right away. If none has when Settled is called outside of a batch, a
+    /// GetInputFocus fence is sent, and the batch settles once its reply is in and Xlib's event queue is empty, so
+    /// Xlib has read every error sent before it.
+    [[nodiscard]] auto Settled() -> bool;
+
+    /// @brief Gets the number of errors caused by requests of the batch so far, always zero for Unchecked.
+    [[nodiscard]] auto Errors() const noexcept -> std::uint32_t;
+
+    /// @brief Gets the sequence number of the first request the batch may contain.
+    [[nodiscard]] auto FirstRequest() const noexcept -> std::uint64_t;
+
+    /// @brief Gets the sequence number of the last request of the batch, zero until ended.
+    [[nodiscard]] auto LastRequest() const noexcept -> std::uint64_t;
+
+    /// @brief Counts an error if its request belongs to the batch, called by the error hook of the display.
+    ///
+    /// @returns true if the error was counted.
+    auto OnError(std::uint64_t sequence) noexcept -> bool;
+
+  private:
+    auto Settle() noexcept -> void;
+    auto Unregister() noexcept -> void;
+
+  private:
+    X11DisplaySharedResource m_dpy;
+    X11BatchErrors m_mode;
+    std::uint64_t m_first_request{};
+    std::uint64_t m_last_request{};
+    std::uint32_t m_errors{};
+    bool m_ended{};
+    bool m_settled{};
+    bool m_fence_answered{};
+    X11Cookie<xcb_get_input_focus_reply_t> m_fence;
+};
+
+} // namespace Tilebox
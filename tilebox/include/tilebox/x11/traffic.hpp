@@ -0,0 +1,105 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/x11/events.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Tilebox
+{
+
+/// @brief Protocol traffic of one display connection, or the difference between two snapshots of it.
+///
+/// @details See X11Display::Traffic. Subtracting the snapshot taken before a code path from the one taken after
+/// tells how many requests and round trips it cost, a path doing N round trips where one would do stands out.
+struct TILEBOX_EXPORT X11Traffic
+{
+    /// @brief Requests issued, Xlib and XCB alike as they share one sequence counter.
+    std::uint64_t requests{};
+
+    /// @brief Requests the server is known to have processed, lags `requests` by what is in flight.
+    std::uint64_t processed{};
+
+    /// @brief Times the client blocked on the server, in X11Display::Sync or an X11Cookie whose reply was not in yet.
+    ///
+    /// @details Only those two are counted. Xlib calls with a reply, e.g. XGetWindowProperty, XQueryTree, XRRGet* or
+    /// XIQueryDevice, block inside Xlib where they cannot be observed, they show up in `requests` only.
+    std::uint64_t round_trips{};
+
+    /// @brief Times buffered requests were pushed to the connection, by Xlib or X11XcbConnection::Flush.
+    std::uint64_t flushes{};
+
+    /// @brief Bytes of Xlib requests pushed to the connection, XCB requests are only counted in `requests`.
+    std::uint64_t bytes_flushed{};
+
+    /// @brief Gets the number of requests not yet known to be processed.
+    [[nodiscard]] auto InFlight() const noexcept -> std::uint64_t
+    {
+        return requests - processed;
+    }
+
+    [[nodiscard]] auto operator-(const X11Traffic &rhs) const noexcept -> X11Traffic;
+    auto operator+=(const X11Traffic &rhs) noexcept -> X11Traffic &;
+    [[nodiscard]] auto operator==(const X11Traffic &rhs) const noexcept -> bool = default;
+};
+
+namespace Detail
+{
+
+/// @brief Counters shared by a display, the XCB connection handles it gives out and their cookies.
+struct TILEBOX_EXPORT X11TrafficCounters
+{
+    std::uint64_t round_trips{};
+    std::uint64_t flushes{};
+    std::uint64_t bytes_flushed{};
+
+    /// @brief Xlib's last request number at the last counted Xlib flush, one flush can arrive in several chunks.
+    std::uint64_t flushed_request{};
+
+    /// @brief Sequence of the last request issued through X11XcbConnection, Xlib only learns of those lazily.
+    std::uint32_t xcb_sequence{};
+
+    /// @brief `xcb_sequence` at the last counted X11XcbConnection::Flush.
+    std::uint32_t xcb_flushed_sequence{};
+};
+
+} // namespace Detail
+
+/// @brief Protocol traffic caused by event handlers, per event type, collected by X11EventLoop.
+///
+/// @details Each handler call is bracketed by two snapshots, so requests are attributed exactly. Round trips are
+/// attributed as far as X11Traffic::round_trips counts them, a handler blocking in an Xlib call with a reply shows
+/// its request but no round trip. Bytes are attributed to whoever flushed them, requests a handler leaves in the
+/// buffer are usually flushed by the loop itself before it sleeps and show up in no handler.
+class TILEBOX_EXPORT X11EventTraffic
+{
+  public:
+    static constexpr std::size_t kEventTableSize = static_cast<std::size_t>(X11EventType::X11LASTEvent);
+
+  public:
+    /// @brief Adds the traffic of one handler call.
+    auto Record(std::size_t event_index, const X11Traffic &delta) noexcept -> void;
+
+    /// @brief Gets the summed traffic of every handler call for an event type.
+    [[nodiscard]] auto Handler(X11EventType event_type) const noexcept -> const X11Traffic &;
+
+    /// @brief Gets the number of handler calls recorded for an event type.
+    [[nodiscard]] auto Calls(X11EventType event_type) const noexcept -> std::uint64_t;
+
+    /// @brief Clears every counter.
+    auto Reset() noexcept -> void;
+
+    /// @brief Formats calls, requests and round trips per call and flushed bytes for every event type that had a
+    /// handler called, one per line.
+    [[nodiscard]] auto Report() const -> std::string;
+
+  private:
+    X11Traffic m_empty;
+    std::array<X11Traffic, kEventTableSize> m_handler{};
+    std::array<std::uint64_t, kEventTableSize> m_calls{};
+};
+
+} // namespace Tilebox
@@ -1,19 +1,50 @@
 #pragma once
 
+#include "tilebox/geometry.hpp"
 #include "tilebox/utils/attributes.hpp"
 #include "tilebox/x11/display.hpp"
 
 #include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <cstdint>
+#include <optional>
 
 namespace Tilebox
 {
 
-class Rect;
+/// @brief Position of a window in the stacking order, as sent in a ConfigureWindow request.
+struct TILEBOX_EXPORT X11Stacking
+{
+    /// @brief Sibling the window is stacked relative to, None for the whole stack.
+    Window sibling{None};
+
+    /// @brief Above, Below, TopIf, BottomIf or Opposite.
+    std::int32_t mode{Above};
+
+    [[nodiscard]] auto operator==(const X11Stacking &rhs) const noexcept -> bool = default;
+};
+
+/// @brief Geometry, border width and stacking of a window.
+struct TILEBOX_EXPORT X11WindowConfig
+{
+    Rect rect;
+    std::uint32_t border_width{};
+
+    /// @brief Stacking to request, or the last one requested or reported. nullopt leaves the stacking alone, or
+    /// means it is unknown.
+    std::optional<X11Stacking> stacking;
+};
 
 class TILEBOX_EXPORT X11Window
 {
   public:
     explicit X11Window(X11DisplaySharedResource dpy) noexcept;
+
+    /// @brief Wraps a window created by another client, e.g. one being managed, the destructor leaves it alone.
+    ///
+    /// @param config Geometry and border width the window has now, as reported by a MapRequest's attributes.
+    X11Window(X11DisplaySharedResource dpy, Window id, const X11WindowConfig &config) noexcept;
     ~X11Window();
     X11Window(const X11Window &rhs) noexcept = default;
     X11Window(X11Window &&rhs) noexcept = default;
@@ -47,12 +78,55 @@ class TILEBOX_EXPORT X11Window
     ///
     /// @details Does not free any memory e.g. XDestroyWindow is not called,
     /// that happens in the Destructor
-    auto Unmap() const noexcept -> void;
+    auto Unmap() noexcept -> void;
+
+    /// @brief Check whether the window was mapped through Map and not unmapped since
+    [[nodiscard]] auto IsMapped() const noexcept -> bool;
+
+    /// @brief Gets the configuration last sent to the server, or reported by it.
+    [[nodiscard]] auto Shadow() const noexcept -> const X11WindowConfig &;
+
+    /// @brief Reconfigures the window, sending only the geometry and border width that differ from the shadow state.
+    ///
+    /// @details Nothing is sent when nothing changed and no stacking is given, a relayout can configure every client
+    /// without making clients repaint that kept their geometry. Stacking is sent whenever it is set: raising another
+    /// window over this one sends this one no ConfigureNotify, and TopIf, BottomIf and Opposite depend on the current
+    /// stack, so the shadow cannot tell whether a restack would be a no-op.
+    ///
+    /// @returns the `XConfigureWindow` value mask sent, 0 if no request was needed.
+    auto Configure(const X11WindowConfig &config) noexcept -> std::uint32_t;
+
+    /// @brief Moves and resizes the window, keeping border width and stacking.
+    auto Configure(const Rect &rect) noexcept -> std::uint32_t;
+
+    /// @brief Answers a ConfigureRequest of the window.
+    ///
+    /// @details Windows whose geometry the window manager decides, e.g. tiled ones, are not reconfigured. They get a
+    /// synthetic ConfigureNotify with their current geometry instead, as ICCCM 4.1.5 asks for. Other windows get the
+    /// requested fields applied through Configure. A request granted without changing the window is answered with a
+    /// synthetic ConfigureNotify as well, the server sends none then.
+    ///
+    /// @returns the `XConfigureWindow` value mask sent, 0 if the window was not reconfigured and a synthetic
+    /// ConfigureNotify was sent instead.
+    auto HandleConfigureRequest(const XConfigureRequestEvent &request, bool tiled) noexcept -> std::uint32_t;
+
+    /// @brief Updates the shadow state from a ConfigureNotify of the window.
+    ///
+    /// @details Events generated before the last Configure are ignored, they describe a state already replaced.
+    auto HandleConfigureNotify(const XConfigureEvent &event) noexcept -> void;
+
+    /// @brief Sends the window a synthetic ConfigureNotify describing its shadow state.
+    auto SendConfigureNotify() const noexcept -> void;
 
   private:
     X11DisplaySharedResource m_dpy;
     bool m_is_mapped{};
+    bool m_owned{true};
     Window m_id{};
+    X11WindowConfig m_shadow;
+
+    /// @brief Request number of the last ConfigureWindow request sent.
+    std::uint64_t m_configure_request{};
 };
 
 } // namespace Tilebox
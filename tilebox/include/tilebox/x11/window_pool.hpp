@@ -0,0 +1,171 @@
+#pragma once
+
+#include "tilebox/geometry.hpp"
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/window.hpp"
+
+#include <X11/X.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Tilebox
+{
+
+class X11WindowPool;
+
+/// @brief Creation parameters shared by interchangeable pooled windows.
+///
+/// @details Every pooled window is override redirect. Zero for depth, visual and colormap means CopyFromParent.
+struct TILEBOX_EXPORT X11WindowPoolKey
+{
+    std::int32_t depth{CopyFromParent};
+    VisualID visual{CopyFromParent};
+    Colormap colormap{CopyFromParent};
+    std::int64_t event_mask{};
+    std::uint64_t background_pixel{};
+    std::uint64_t border_pixel{};
+    bool save_under{};
+
+    [[nodiscard]] auto operator==(const X11WindowPoolKey &rhs) const noexcept -> bool = default;
+};
+
+/// @brief Counters of one key of a window pool, or of all of them.
+struct TILEBOX_EXPORT X11WindowPoolStats
+{
+    /// @brief Windows created with XCreateWindow, by Acquire or Prewarm.
+    std::uint64_t created{};
+
+    /// @brief Acquires served by a released window.
+    std::uint64_t reused{};
+
+    /// @brief Released windows destroyed because enough were idle already.
+    std::uint64_t destroyed{};
+
+    /// @brief Idle windows destroyed by Trim.
+    std::uint64_t trimmed{};
+
+    /// @brief Windows handed out right now.
+    std::uint64_t in_use{};
+
+    /// @brief Windows waiting to be handed out.
+    std::uint64_t idle{};
+
+    /// @brief Most windows handed out at once, what a Prewarm should cover.
+    std::uint64_t high_water{};
+};
+
+/// @brief A window handed out by X11WindowPool, released back into it when destroyed.
+///
+/// @details The window comes unmapped, with the geometry it was acquired for. Map, restack and draw it freely, the
+/// pool unmaps it on release.
+class TILEBOX_EXPORT X11PooledWindow
+{
+  public:
+    X11PooledWindow() noexcept = default;
+    ~X11PooledWindow();
+
+    X11PooledWindow(const X11PooledWindow &other) = delete;
+    auto operator=(const X11PooledWindow &other) -> X11PooledWindow & = delete;
+    X11PooledWindow(X11PooledWindow &&other) noexcept;
+    auto operator=(X11PooledWindow &&other) noexcept -> X11PooledWindow &;
+
+  public:
+    /// @brief Check whether a window is held
+    [[nodiscard]] auto IsValid() const noexcept -> bool;
+
+    /// @brief Fetch the underlying window id, 0 if none is held
+    [[nodiscard]] auto id() const noexcept -> Window;
+
+    /// @brief Gets the held window, only valid while IsValid.
+    [[nodiscard]] auto Get() noexcept -> X11Window &;
+
+    [[nodiscard]] auto operator->() noexcept -> X11Window *;
+
+    /// @brief Hands the window back to the pool early, later calls do nothing.
+    auto Release() noexcept -> void;
+
+  private:
+    friend class X11WindowPool;
+
+    X11PooledWindow(X11WindowPool *pool, std::size_t bucket, X11Window &&window) noexcept;
+
+  private:
+    X11WindowPool *m_pool{};
+    std::size_t m_bucket{};
+    std::optional<X11Window> m_window;
+};
+
+/// @brief Recycles override redirect windows for menus, tooltips, OSDs, drag outlines and the like.
+///
+/// @details Creating and destroying such windows each time they come and go costs requests, server resources and the
+/// server's work of setting them up. Released windows are unmapped and kept per X11WindowPoolKey instead, an Acquire
+/// of a matching key only moves and resizes one, and only if its geometry differs. The pool must outlive the windows
+/// it hands out.
+class TILEBOX_EXPORT X11WindowPool
+{
+  public:
+    static constexpr std::size_t kDefaultMaxIdle = 8;
+
+  public:
+    /// @param max_idle Released windows kept per key, further ones are destroyed.
+    explicit X11WindowPool(X11DisplaySharedResource dpy, std::size_t max_idle = kDefaultMaxIdle) noexcept;
+
+    /// @brief Destroys every idle window.
+    ~X11WindowPool();
+
+    X11WindowPool(const X11WindowPool &other) = delete;
+    auto operator=(const X11WindowPool &other) -> X11WindowPool & = delete;
+    X11WindowPool(X11WindowPool &&other) noexcept = delete;
+    auto operator=(X11WindowPool &&other) noexcept -> X11WindowPool & = delete;
+
+  public:
+    /// @brief Hands out an unmapped window of `key` with the geometry `rect`, reusing an idle one if any.
+    ///
+    /// @returns an invalid X11PooledWindow if not connected.
+    [[nodiscard]] auto Acquire(const X11WindowPoolKey &key, const Rect &rect) -> X11PooledWindow;
+
+    /// @brief Creates idle windows of `key` until `count` are idle, e.g. the high water mark of a previous run.
+    auto Prewarm(const X11WindowPoolKey &key, std::size_t count) -> void;
+
+    /// @brief Destroys every idle window, windows in use are left alone.
+    auto Trim() noexcept -> void;
+
+    /// @brief Gets the counters of one key, zero for keys never used.
+    [[nodiscard]] auto Stats(const X11WindowPoolKey &key) const noexcept -> X11WindowPoolStats;
+
+    /// @brief Gets the counters summed over every key, the high water mark being the sum of the per key ones.
+    [[nodiscard]] auto Stats() const noexcept -> X11WindowPoolStats;
+
+    /// @brief Formats the counters of every key used, one per line.
+    [[nodiscard]] auto Report() const -> std::string;
+
+  private:
+    friend class X11PooledWindow;
+
+    struct Bucket
+    {
+        X11WindowPoolKey key;
+        std::vector<X11Window> idle;
+        X11WindowPoolStats stats;
+    };
+
+  private:
+    [[nodiscard]] auto FindBucket(const X11WindowPoolKey &key) const noexcept -> std::optional<std::size_t>;
+    [[nodiscard]] auto BucketFor(const X11WindowPoolKey &key) -> Bucket &;
+    [[nodiscard]] auto CreatePooledWindow(const X11WindowPoolKey &key, const Rect &rect) const noexcept -> Window;
+    auto Release(std::size_t bucket, X11Window &&window) noexcept -> void;
+
+  private:
+    X11DisplaySharedResource m_dpy;
+    std::size_t m_max_idle;
+
+    /// @brief Few distinct keys are in use at once, a linear search beats hashing them.
+    std::vector<Bucket> m_buckets;
+};
+
+} // namespace Tilebox
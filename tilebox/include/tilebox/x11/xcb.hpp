@@ -0,0 +1,246 @@
+#pragma once
+
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/x11/traffic.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+#include <xcb/xproto.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace Tilebox
+{
+
+////////////////////////////////////
+// Replies
+////////////////////////////////////
+
+/// @brief Frees replies allocated by xcb.
+struct TILEBOX_EXPORT X11ReplyDeleter
+{
+    auto operator()(void *reply) const noexcept -> void
+    {
+        std::free(reply); // NOLINT(cppcoreguidelines-no-malloc)
+    }
+};
+
+/// @brief Owning pointer to an xcb reply, variable length data (property values, children) lives in the same block.
+template <typename Reply> using X11ReplyPtr = std::unique_ptr<Reply, X11ReplyDeleter>;
+
+namespace Detail
+{
+
+/// @brief Blocks until the reply for `sequence` arrived, nullptr if the server answered with an error.
+///
+/// @param traffic Counts a round trip if the reply had not arrived yet, may be nullptr.
+TILEBOX_EXPORT auto X11WaitForReply(xcb_connection_t *connection, std::uint32_t sequence,
+                                    X11TrafficCounters *traffic = nullptr) noexcept -> void *;
+
+/// @brief Fetches the reply for `sequence` without blocking.
+///
+/// @returns false if the reply has not arrived yet, otherwise `reply` holds it or nullptr on a server error.
+TILEBOX_EXPORT auto X11PollForReply(xcb_connection_t *connection, std::uint32_t sequence, void *&reply) noexcept
+    -> bool;
+
+/// @brief Tells xcb to drop the reply for `sequence` whenever it arrives.
+TILEBOX_EXPORT auto X11DiscardReply(xcb_connection_t *connection, std::uint32_t sequence) noexcept -> void;
+
+} // namespace Detail
+
+////////////////////////////////////
+// Cookies
+////////////////////////////////////
+
+/// @brief Handle to the reply of a request that has been queued but not necessarily answered.
+///
+/// @details Holding several cookies before calling Get on the first pipelines the requests, they all share a single
+/// round trip. A cookie that is destroyed without being fetched discards its reply, so nothing leaks inside xcb.
+template <typename Reply> class [[nodiscard]] X11Cookie
+{
+  public:
+    X11Cookie() noexcept = default;
+
+    X11Cookie(xcb_connection_t *connection, const std::uint32_t sequence,
+              Detail::X11TrafficCounters *traffic = nullptr) noexcept
+        : m_connection(connection), m_sequence(sequence), m_traffic(traffic)
+    {
+    }
+
+    ~X11Cookie()
+    {
+        Discard();
+    }
+
+    X11Cookie(X11Cookie &&rhs) noexcept
+        : m_connection(std::exchange(rhs.m_connection, nullptr)), m_sequence(rhs.m_sequence),
+          m_traffic(rhs.m_traffic)
+    {
+    }
+
+    X11Cookie(const X11Cookie &rhs) = delete;
+
+  public:
+    auto operator=(X11Cookie &&rhs) noexcept -> X11Cookie &
+    {
+        if (this != &rhs)
+        {
+            Discard();
+            m_connection = std::exchange(rhs.m_connection, nullptr);
+            m_sequence = rhs.m_sequence;
+            m_traffic = rhs.m_traffic;
+        }
+        return *this;
+    }
+
+    auto operator=(const X11Cookie &rhs) -> X11Cookie & = delete;
+
+  public:
+    /// @brief Check whether the cookie still refers to an unfetched reply
+    [[nodiscard]] auto IsValid() const noexcept -> bool
+    {
+        return m_connection != nullptr;
+    }
+
+    /// @brief Gets the sequence number of the request
+    [[nodiscard]] auto Sequence() const noexcept -> std::uint32_t
+    {
+        return m_sequence;
+    }
+
+    /// @brief Blocks until the reply arrived, flushing the request queue if needed.
+    ///
+    /// @returns nullptr if the server answered with an error, or the cookie was already used.
+    [[nodiscard]] auto Get() noexcept -> X11ReplyPtr<Reply>
+    {
+        if (m_connection == nullptr)
+        {
+            return nullptr;
+        }
+        return X11ReplyPtr<Reply>(static_cast<Reply *>(
+            Detail::X11WaitForReply(std::exchange(m_connection, nullptr), m_sequence, m_traffic)));
+    }
+
+    /// @brief Fetches the reply if it has already arrived, without blocking or flushing.
+    ///
+    /// @returns false if the reply has not arrived yet, the cookie stays valid in that case.
+    [[nodiscard]] auto Poll(X11ReplyPtr<Reply> &reply) noexcept -> bool
+    {
+        if (m_connection == nullptr)
+        {
+            reply.reset();
+            return true;
+        }
+
+        void *raw = nullptr;
+        if (!Detail::X11PollForReply(m_connection, m_sequence, raw))
+        {
+            return false;
+        }
+        m_connection = nullptr;
+        reply.reset(static_cast<Reply *>(raw));
+        return true;
+    }
+
+    /// @brief Drops the reply, the request itself is not cancelled.
+    auto Discard() noexcept -> void
+    {
+        if (m_connection != nullptr)
+        {
+            Detail::X11DiscardReply(std::exchange(m_connection, nullptr), m_sequence);
+        }
+    }
+
+    /// @brief Hands responsibility for the reply to the caller, who must fetch or discard it.
+    [[nodiscard]] auto Release() noexcept -> std::uint32_t
+    {
+        m_connection = nullptr;
+        return m_sequence;
+    }
+
+  private:
+    xcb_connection_t *m_connection{};
+    std::uint32_t m_sequence{};
+    Detail::X11TrafficCounters *m_traffic{};
+};
+
+////////////////////////////////////
+// Connection
+////////////////////////////////////
+
+/// @brief Cookie based requests on the XCB connection underneath an Xlib display.
+///
+/// @details Xlib blocks on every request with a reply, XCB only blocks when the reply is fetched. Both share one
+/// socket and sequence counter, so requests can be mixed freely with Xlib and Xft calls and Xlib keeps owning the
+/// event queue. The connection is not owned, it lives as long as the X11Display it came from.
+///
+/// @code
+/// auto xcb = dpy->Xcb();
+/// auto attributes = xcb.GetWindowAttributes(window);
+/// auto geometry = xcb.GetGeometry(window);
+/// if (auto reply = attributes.Get(); reply != nullptr && !reply->override_redirect) { ... }
+/// @endcode
+class TILEBOX_EXPORT X11XcbConnection
+{
+  public:
+    X11XcbConnection() noexcept = default;
+
+    explicit X11XcbConnection(xcb_connection_t *connection) noexcept;
+
+    /// @brief Wraps the XCB connection of an open Xlib display
+    ///
+    /// @param traffic Counts the requests, flushes and blocking replies of this handle and its cookies, may be
+    /// nullptr. Must outlive both, X11Display::Xcb passes the counters of the display.
+    explicit X11XcbConnection(Display *dpy, Detail::X11TrafficCounters *traffic = nullptr) noexcept;
+
+  public:
+    /// @brief Check whether a connection is attached
+    [[nodiscard]] auto IsConnected() const noexcept -> bool;
+
+    /// @brief Gets the raw connection
+    [[nodiscard]] auto Raw() const noexcept -> xcb_connection_t *;
+
+    /// @brief Gets the traffic counters, for replies fetched through Detail::X11WaitForReply. May be nullptr.
+    [[nodiscard]] auto Traffic() const noexcept -> Detail::X11TrafficCounters *;
+
+    /// @brief Sends every queued request to the server.
+    auto Flush() const noexcept -> void;
+
+    ///////////////////////////////////////
+    /// Requests
+    ///////////////////////////////////////
+
+    [[nodiscard]] auto GetWindowAttributes(Window window) const noexcept
+        -> X11Cookie<xcb_get_window_attributes_reply_t>;
+
+    [[nodiscard]] auto GetGeometry(Drawable drawable) const noexcept -> X11Cookie<xcb_get_geometry_reply_t>;
+
+    /// @param long_offset Offset into the property data in 32 bit units.
+    /// @param long_length Number of 32 bit units to fetch.
+    [[nodiscard]] auto GetProperty(Window window, Atom property, Atom type, std::uint32_t long_offset,
+                                   std::uint32_t long_length) const noexcept -> X11Cookie<xcb_get_property_reply_t>;
+
+    [[nodiscard]] auto InternAtom(std::string_view name, bool only_if_exists = false) const noexcept
+        -> X11Cookie<xcb_intern_atom_reply_t>;
+
+    [[nodiscard]] auto QueryTree(Window window) const noexcept -> X11Cookie<xcb_query_tree_reply_t>;
+
+    /// @brief The cheapest request with a reply, its arrival proves every earlier request was processed.
+    [[nodiscard]] auto GetInputFocus() const noexcept -> X11Cookie<xcb_get_input_focus_reply_t>;
+
+  private:
+    /// @brief Wraps the sequence of a request just issued into a cookie, noting it for the traffic counters.
+    template <typename Reply>
+    [[nodiscard]] auto MakeCookie(std::uint32_t sequence) const noexcept -> X11Cookie<Reply>;
+
+  private:
+    xcb_connection_t *m_connection{};
+    Detail::X11TrafficCounters *m_traffic{};
+};
+
+} // namespace Tilebox
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "tilebox/error.hpp"
+#include "tilebox/utils/attributes.hpp"
+#include "tilebox/utils/inplace_function.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/event_loop.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XInput2.h>
+#include <etl.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Tilebox
+{
+
+////////////////////////////////////
+// Events
+////////////////////////////////////
+
+/// @brief Unaccelerated relative pointer motion, summed over every XI_RawMotion since the last delivery.
+struct TILEBOX_EXPORT X11RawMotion
+{
+    std::int32_t device;
+    std::int32_t source;
+    double dx;
+    double dy;
+    /// @brief Server time of the latest folded in event.
+    Time time;
+    /// @brief Number of XI events folded into this one.
+    std::uint32_t coalesced;
+};
+
+/// @brief Smooth scrolling, summed over every XI_Motion carrying scroll valuators since the last delivery.
+struct TILEBOX_EXPORT X11SmoothScroll
+{
+    std::int32_t device;
+    std::int32_t source;
+    Window window;
+    /// @brief Horizontal distance in scroll increments, one is a classic wheel click. Positive scrolls right.
+    double dx;
+    /// @brief Vertical distance in scroll increments, one is a classic wheel click. Positive scrolls down.
+    double dy;
+    /// @brief Server time of the latest folded in event.
+    Time time;
+    /// @brief Number of XI events folded into this one.
+    std::uint32_t coalesced;
+};
+
+/// @brief Pointer event of one master device, with subpixel positions.
+struct TILEBOX_EXPORT X11DeviceEvent
+{
+    /// @brief XI_Motion, XI_ButtonPress or XI_ButtonRelease.
+    std::int32_t evtype;
+    std::int32_t device;
+    std::int32_t source;
+    /// @brief The button for button events.
+    std::int32_t detail;
+    Window window;
+    Window child;
+    double root_x;
+    double root_y;
+    double event_x;
+    double event_y;
+    /// @brief Effective modifier state.
+    std::uint32_t modifiers;
+    Time time;
+    /// @brief Number of XI events folded into this one, only motion is coalesced.
+    std::uint32_t coalesced;
+};
+
+using X11RawMotionCallback = InplaceFunction<void(const X11RawMotion &motion)>;
+using X11SmoothScrollCallback = InplaceFunction<void(const X11SmoothScroll &scroll)>;
+using X11DeviceEventCallback = InplaceFunction<void(const X11DeviceEvent &event)>;
+
+////////////////////////////////////
+// XInput2
+////////////////////////////////////
+
+/// @brief XInput2 raw motion, smooth scrolling and per device pointer events on top of an X11EventLoop.
+///
+/// @details Registers GenericEvent handlers with the loop, which fetches and frees the cookie data around each call,
+/// so no event is ever copied or allocated by tilebox. High frequency events are coalesced per device: raw motion and
+/// scroll deltas are summed and only the latest motion is kept, then delivered once the X queue is drained through
+/// the loop's idle work. Button events deliver whatever is pending first, so ordering per device is preserved.
+/// Button presses that the server emulates from smooth scrolling are dropped, use OnScroll instead.
+///
+/// @code
+/// X11XInput xinput(dpy);
+/// if (xinput.Attach(loop).is_ok() && xinput.SelectRawMotion().is_ok())
+/// {
+///     xinput.OnRawMotion([&](const X11RawMotion &motion) -> void { drag.Move(motion.dx, motion.dy); });
+/// }
+/// @endcode
+class TILEBOX_EXPORT X11XInput
+{
+  public:
+    /// @brief Idle key coalesced events are delivered under, do not schedule other idle work with it.
+    static constexpr X11IdleKey kIdleKey = 0x5849'3200'0000'0001ULL;
+
+    /// @brief Smooth scrolling needs XInput 2.1.
+    static constexpr std::int32_t kMinimumMinorVersion = 1;
+
+    /// @brief Scroll valuators tracked per device, touchpads have two.
+    static constexpr std::size_t kMaxScrollAxes = 4;
+
+  public:
+    explicit X11XInput(X11DisplaySharedResource dpy) noexcept;
+
+    /// @brief Unregisters from the loop, pending coalesced events are dropped.
+    ~X11XInput();
+
+    X11XInput(const X11XInput &rhs) = delete;
+    X11XInput(X11XInput &&rhs) = delete;
+
+  public:
+    auto operator=(const X11XInput &rhs) -> X11XInput & = delete;
+    auto operator=(X11XInput &&rhs) -> X11XInput & = delete;
+
+  public:
+    /// @brief Checks for XInput 2.1, loads the scroll valuators of every master device and registers with `loop`.
+    ///
+    /// @details Handlers are registered only once the hierarchy selection succeeded, a failed Attach leaves `loop`
+    /// untouched and may be retried.
+    ///
+    /// @param loop Must outlive this object.
+    [[nodiscard]] auto Attach(X11EventLoop &loop) -> etl::Result<etl::Void, X11XInputError>;
+
+    /// @brief Gets the major opcode of the extension, zero before Attach
+    [[nodiscard]] auto Opcode() const noexcept -> std::int32_t;
+
+    /// @brief Selects raw motion of every master pointer on the root window, delivered regardless of grabs.
+    [[nodiscard]] auto SelectRawMotion() -> etl::Result<etl::Void, X11XInputError>;
+
+    /// @brief Selects motion, button and scroll events of every master pointer on `window`.
+    [[nodiscard]] auto SelectWindowEvents(Window window) -> etl::Result<etl::Void, X11XInputError>;
+
+    auto OnRawMotion(X11RawMotionCallback callback) -> void;
+    auto OnScroll(X11SmoothScrollCallback callback) -> void;
+    auto OnDeviceEvent(X11DeviceEventCallback callback) -> void;
+
+    /// @brief Translates one XI2 event whose cookie data has been fetched, the loop calls this.
+    ///
+    /// @details Exposed for tests and replays, events of other extensions must not be passed in.
+    auto HandleEvent(const XGenericEventCookie &cookie) -> void;
+
+    /// @brief Delivers every pending coalesced event, the loop calls this once its queue is drained.
+    auto Flush() -> void;
+
+  private:
+    struct ScrollAxis
+    {
+        std::int32_t number;
+        std::int32_t scroll_type;
+        double increment;
+        double last_value;
+        bool has_last_value;
+    };
+
+    struct DeviceState
+    {
+        std::array<ScrollAxis, kMaxScrollAxes> scroll_axes{};
+        std::size_t scroll_axis_count{};
+        X11RawMotion raw{};
+        X11SmoothScroll scroll{};
+        X11DeviceEvent motion{};
+    };
+
+    [[nodiscard]] auto Device(std::int32_t device_id) -> DeviceState *;
+    auto RefreshDevices() -> void;
+    auto UpdateScrollAxes(std::int32_t device_id, XIAnyClassInfo **classes, std::int32_t class_count) -> void;
+    auto HandleRawMotion(const XIRawEvent &event) -> void;
+    auto HandleMotion(const XIDeviceEvent &event) -> void;
+    auto HandleButton(const XIDeviceEvent &event) -> void;
+    auto ScheduleFlush() -> void;
+    [[nodiscard]] auto Select(Window window, std::int32_t device_id, std::span<const std::int32_t> evtypes)
+        -> etl::Result<etl::Void, X11XInputError>;
+
+  private:
+    X11DisplaySharedResource m_dpy;
+    X11EventLoop *m_loop{};
+    std::int32_t m_opcode{};
+    std::vector<DeviceState> m_devices;
+    /// @brief Root window selections accumulate, XISelectEvents replaces the mask of a window and device.
+    std::array<unsigned char, XIMaskLen(XI_LASTEVENT)> m_root_master_mask{};
+    std::array<unsigned char, XIMaskLen(XI_LASTEVENT)> m_root_device_mask{};
+    X11RawMotionCallback m_on_raw_motion;
+    X11SmoothScrollCallback m_on_scroll;
+    X11DeviceEventCallback m_on_device_event;
+};
+
+} // namespace Tilebox
@@ -0,0 +1,259 @@
+#include "tilebox/layout.hpp"
+
+#include "tilebox/geometry.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+constexpr std::uint32_t kPermille = 1000;
+
+/// @brief A stretch of one axis.
+struct Segment
+{
+    std::int32_t start{};
+    std::uint32_t length{};
+};
+
+/// @brief Splits `whole` into `parts` segments `gap` apart and gets the one at `index`.
+///
+/// @details The remainder of the division goes one pixel each to the first segments, every segment gets at least one
+/// pixel.
+auto Split(const Segment &whole, const std::uint32_t gap, const std::uint32_t parts, const std::uint32_t index)
+    -> Segment
+{
+    const std::uint64_t gaps = static_cast<std::uint64_t>(gap) * (parts - 1);
+    const std::uint32_t usable =
+        whole.length > gaps + parts ? static_cast<std::uint32_t>(whole.length - gaps) : parts;
+    const std::uint32_t base = usable / parts;
+    const std::uint32_t extra = usable % parts;
+
+    return {
+        .start = whole.start + static_cast<std::int32_t>(index * (base + gap) + std::min(index, extra)),
+        .length = base + (index < extra ? 1 : 0),
+    };
+}
+
+/// @brief Gets the length of the master area out of `usable`, leaving at least a pixel to each of `others` areas.
+auto MasterLength(const std::uint32_t usable, const std::uint32_t permille, const std::uint32_t others)
+    -> std::uint32_t
+{
+    if (usable <= others)
+    {
+        return 1;
+    }
+
+    const auto length = static_cast<std::uint32_t>(static_cast<std::uint64_t>(usable) * permille / kPermille);
+    return std::clamp<std::uint32_t>(length, 1, usable - others);
+}
+
+auto Shorten(const std::uint32_t length, const std::uint32_t by) -> std::uint32_t
+{
+    return length > by ? length - by : 1;
+}
+
+auto Cell(const Segment &column, const Segment &row) -> Rect
+{
+    return {Point(X(column.start), Y(row.start)), Width(column.length), Height(row.length)};
+}
+
+/// @brief Gets the smallest number of columns whose square holds `count` tiles.
+auto GridColumns(const std::uint32_t count) -> std::uint32_t
+{
+    std::uint32_t columns = 1;
+    while (columns * columns < count)
+    {
+        ++columns;
+    }
+    return columns;
+}
+
+/// @brief Groups of client counts sharing the same master geometry, in layouts with a master area.
+auto MasterShape(const LayoutKind kind, const std::size_t count, const std::uint32_t masters) -> std::uint32_t
+{
+    if (masters == 0 || count <= masters)
+    {
+        return 0;
+    }
+    if (kind == LayoutKind::CenteredMaster && count - masters >= 2)
+    {
+        return 2;
+    }
+    return 1;
+}
+
+} // namespace
+
+TilingLayout::TilingLayout(const LayoutKind kind, const LayoutParams &params) noexcept : m_kind(kind), m_params(params)
+{
+}
+
+auto TilingLayout::Kind() const noexcept -> LayoutKind
+{
+    return m_kind;
+}
+
+auto TilingLayout::Params() const noexcept -> const LayoutParams &
+{
+    return m_params;
+}
+
+auto TilingLayout::SetKind(const LayoutKind kind) noexcept -> void
+{
+    if (kind != m_kind)
+    {
+        m_kind = kind;
+        m_valid = false;
+    }
+}
+
+auto TilingLayout::SetParams(const LayoutParams &params) noexcept -> void
+{
+    if (params != m_params)
+    {
+        m_params = params;
+        m_valid = false;
+    }
+}
+
+auto TilingLayout::Invalidate() noexcept -> void
+{
+    m_valid = false;
+}
+
+auto TilingLayout::Arrange(std::span<Rect> tiles) noexcept -> LayoutChange
+{
+    const std::size_t count = tiles.size();
+    const std::size_t first = m_valid ? std::min(FirstAffected(m_count, count), count) : 0;
+    for (std::size_t i = first; i < count; ++i)
+    {
+        tiles[i] = TileOf(i, count);
+    }
+
+    m_count = count;
+    m_valid = true;
+    return {.first = first, .count = count - first};
+}
+
+auto TilingLayout::TileOf(const std::size_t index, const std::size_t count) const noexcept -> Rect
+{
+    // Split divides by the client count, there is no tile to compute for a client that is not there
+    if (index >= count)
+    {
+        return {};
+    }
+
+    const std::uint32_t gap = m_params.gap;
+    const Rect &area = m_params.area;
+    const Segment horizontal{.start = area.GetX() + static_cast<std::int32_t>(gap),
+                             .length = Shorten(area.GetW(), 2 * gap)};
+    const Segment vertical{.start = area.GetY() + static_cast<std::int32_t>(gap),
+                           .length = Shorten(area.GetH(), 2 * gap)};
+
+    const auto n = static_cast<std::uint32_t>(count);
+    const auto i = static_cast<std::uint32_t>(index);
+    const std::uint32_t masters = std::min(m_params.masters, n);
+
+    Rect cell;
+    switch (m_kind)
+    {
+    case LayoutKind::Monocle:
+        cell = Cell(horizontal, vertical);
+        break;
+
+    case LayoutKind::Columns:
+        cell = Cell(Split(horizontal, gap, n, i), vertical);
+        break;
+
+    case LayoutKind::Grid: {
+        const std::uint32_t columns = GridColumns(n);
+        const std::uint32_t rows = (n + columns - 1) / columns;
+        const std::uint32_t row = i / columns;
+        const std::uint32_t in_row = row + 1 == rows ? n - (row * columns) : columns;
+        cell = Cell(Split(horizontal, gap, in_row, i % columns), Split(vertical, gap, rows, row));
+        break;
+    }
+
+    case LayoutKind::MasterStack:
+    case LayoutKind::CenteredMaster: {
+        const std::uint32_t shape = MasterShape(m_kind, n, masters);
+        if (shape == 0)
+        {
+            cell = Cell(horizontal, Split(vertical, gap, n, i));
+            break;
+        }
+
+        const std::uint32_t stack = n - masters;
+        if (shape == 1)
+        {
+            const std::uint32_t usable = Shorten(horizontal.length, gap);
+            const std::uint32_t master = MasterLength(usable, m_params.master_permille, 1);
+            const Segment master_column{.start = horizontal.start, .length = master};
+            const Segment stack_column{.start = horizontal.start + static_cast<std::int32_t>(master + gap),
+                                       .length = Shorten(usable, master)};
+            cell = i < masters ? Cell(master_column, Split(vertical, gap, masters, i))
+                               : Cell(stack_column, Split(vertical, gap, stack, i - masters));
+            break;
+        }
+
+        // Masters in the middle, stack clients alternate right and left, starting on the right
+        const std::uint32_t usable = Shorten(horizontal.length, 2 * gap);
+        const std::uint32_t master = MasterLength(usable, m_params.master_permille, 2);
+        const std::uint32_t left = (usable - master) / 2;
+        const Segment left_column{.start = horizontal.start, .length = std::max<std::uint32_t>(left, 1)};
+        const Segment master_column{.start = horizontal.start + static_cast<std::int32_t>(left + gap),
+                                    .length = master};
+        const Segment right_column{.start = master_column.start + static_cast<std::int32_t>(master + gap),
+                                   .length = usable - master - left};
+        if (i < masters)
+        {
+            cell = Cell(master_column, Split(vertical, gap, masters, i));
+            break;
+        }
+
+        const std::uint32_t j = i - masters;
+        cell = j % 2 == 0 ? Cell(right_column, Split(vertical, gap, (stack + 1) / 2, j / 2))
+                          : Cell(left_column, Split(vertical, gap, stack / 2, j / 2));
+        break;
+    }
+    }
+
+    return cell.ShrinkIn(m_params.border);
+}
+
+/// Private
+
+auto TilingLayout::FirstAffected(const std::size_t before, const std::size_t after) const noexcept -> std::size_t
+{
+    if (before == after)
+    {
+        return after;
+    }
+
+    switch (m_kind)
+    {
+    case LayoutKind::Monocle:
+        return std::min(before, after);
+
+    case LayoutKind::MasterStack:
+    case LayoutKind::CenteredMaster: {
+        // Masters keep their tiles as long as the master area keeps its shape, only the stack moves
+        const std::uint32_t shape = MasterShape(m_kind, after, m_params.masters);
+        return shape != 0 && shape == MasterShape(m_kind, before, m_params.masters) ? m_params.masters : 0;
+    }
+
+    case LayoutKind::Grid:
+    case LayoutKind::Columns:
+        break;
+    }
+    return 0;
+}
+
+} // namespace Tilebox
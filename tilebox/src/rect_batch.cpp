@@ -0,0 +1,443 @@
+#include "tilebox/rect_batch.hpp"
+
+#include "tilebox/geometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Tilebox
+{
+
+namespace
+{
+
+////////////////////////////////////
+/// Scalar kernels, used for the remainder of vectorized loops and on targets without SSE2
+////////////////////////////////////
+
+auto ContainsRectScalar(const RectBatch &batch, const Rect &other, std::span<std::uint8_t> out, std::size_t begin)
+    -> std::size_t
+{
+    const std::int32_t ox = other.GetX();
+    const std::int32_t oy = other.GetY();
+    const std::int32_t oright = ox + static_cast<std::int32_t>(other.GetW());
+    const std::int32_t obottom = oy + static_cast<std::int32_t>(other.GetH());
+
+    std::size_t hits = 0;
+    for (std::size_t i = begin; i < batch.Size(); ++i)
+    {
+        const std::int32_t x = batch.Xs()[i];
+        const std::int32_t y = batch.Ys()[i];
+        const bool hit = ox >= x && oy >= y && oright <= x + static_cast<std::int32_t>(batch.Widths()[i]) &&
+                         obottom <= y + static_cast<std::int32_t>(batch.Heights()[i]);
+        out[i] = static_cast<std::uint8_t>(hit);
+        hits += static_cast<std::size_t>(hit);
+    }
+    return hits;
+}
+
+auto ContainsPointScalar(const RectBatch &batch, const Point &point, std::span<std::uint8_t> out, std::size_t begin)
+    -> std::size_t
+{
+    const std::int32_t px = point.x.value;
+    const std::int32_t py = point.y.value;
+
+    std::size_t hits = 0;
+    for (std::size_t i = begin; i < batch.Size(); ++i)
+    {
+        const std::int32_t x = batch.Xs()[i];
+        const std::int32_t y = batch.Ys()[i];
+        const bool hit = x <= px && px <= x + static_cast<std::int32_t>(batch.Widths()[i]) && y <= py &&
+                         py <= y + static_cast<std::int32_t>(batch.Heights()[i]);
+        out[i] = static_cast<std::uint8_t>(hit);
+        hits += static_cast<std::size_t>(hit);
+    }
+    return hits;
+}
+
+auto FindContainingScalar(const RectBatch &batch, const Point &point, std::size_t begin) -> std::optional<std::size_t>
+{
+    const std::int32_t px = point.x.value;
+    const std::int32_t py = point.y.value;
+
+    for (std::size_t i = begin; i < batch.Size(); ++i)
+    {
+        const std::int32_t x = batch.Xs()[i];
+        const std::int32_t y = batch.Ys()[i];
+        if (x <= px && px <= x + static_cast<std::int32_t>(batch.Widths()[i]) && y <= py &&
+            py <= y + static_cast<std::int32_t>(batch.Heights()[i]))
+        {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+auto ShrinkScalar(std::span<std::uint32_t> sizes, const std::uint32_t border, std::size_t begin) -> void
+{
+    const std::uint32_t both = 2 * border;
+    for (std::size_t i = begin; i < sizes.size(); ++i)
+    {
+        sizes[i] = sizes[i] <= both ? 1 : sizes[i] - both;
+    }
+}
+
+auto ScaleScalar(std::span<std::uint32_t> sizes, const double factor, std::size_t begin) -> void
+{
+    for (std::size_t i = begin; i < sizes.size(); ++i)
+    {
+        sizes[i] = static_cast<std::uint32_t>(std::floor(sizes[i] * factor));
+    }
+}
+
+/// @brief Clamps one axis, sizes to the bounds' size and positions so the rect ends inside the bounds.
+auto ClampScalar(std::span<std::int32_t> positions, std::span<std::uint32_t> sizes, const std::int32_t low,
+                 const std::uint32_t size, std::size_t begin) -> void
+{
+    for (std::size_t i = begin; i < sizes.size(); ++i)
+    {
+        sizes[i] = std::min(sizes[i], size);
+        const std::int32_t high = low + static_cast<std::int32_t>(size) - static_cast<std::int32_t>(sizes[i]);
+        positions[i] = std::max(low, std::min(positions[i], high));
+    }
+}
+
+#if defined(__SSE2__)
+
+////////////////////////////////////
+/// SSE2 kernels, four rects per iteration
+////////////////////////////////////
+
+constexpr std::size_t kLanes = 4;
+
+auto Load(const void *source) -> __m128i
+{
+    return _mm_load_si128(static_cast<const __m128i *>(source));
+}
+
+auto Store(void *destination, const __m128i value) -> void
+{
+    _mm_store_si128(static_cast<__m128i *>(destination), value);
+}
+
+/// @brief Picks `a` where `mask` is set and `b` elsewhere, SSE2 has no blend.
+auto Select(const __m128i mask, const __m128i a, const __m128i b) -> __m128i
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/// @brief Unsigned greater than, SSE2 only compares signed, so both sides are flipped into signed order.
+auto GreaterU32(const __m128i a, const __m128i b) -> __m128i
+{
+    const __m128i sign = _mm_set1_epi32(static_cast<std::int32_t>(0x80000000U));
+    return _mm_cmpgt_epi32(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+}
+
+auto MinU32(const __m128i a, const __m128i b) -> __m128i
+{
+    return Select(GreaterU32(a, b), b, a);
+}
+
+auto MinI32(const __m128i a, const __m128i b) -> __m128i
+{
+    return Select(_mm_cmpgt_epi32(a, b), b, a);
+}
+
+auto MaxI32(const __m128i a, const __m128i b) -> __m128i
+{
+    return Select(_mm_cmpgt_epi32(a, b), a, b);
+}
+
+/// @brief Writes one byte per lane of an all ones or all zeros mask, returning the number of set lanes.
+auto StoreMask(std::uint8_t *destination, const __m128i mask) -> std::size_t
+{
+    const auto bits = static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+    for (std::size_t lane = 0; lane < kLanes; ++lane)
+    {
+        destination[lane] = static_cast<std::uint8_t>((bits >> lane) & 1U);
+    }
+    return static_cast<std::size_t>(__builtin_popcount(bits));
+}
+
+/// @brief Mask of the lanes whose rect contains the point, edges included.
+auto PointMask(const std::int32_t *xs, const std::int32_t *ys, const std::uint32_t *ws, const std::uint32_t *hs,
+               const __m128i px, const __m128i py) -> __m128i
+{
+    const __m128i x = Load(xs);
+    const __m128i y = Load(ys);
+    const __m128i right = _mm_add_epi32(x, Load(ws));
+    const __m128i bottom = _mm_add_epi32(y, Load(hs));
+
+    __m128i outside = _mm_cmpgt_epi32(x, px);
+    outside = _mm_or_si128(outside, _mm_cmpgt_epi32(px, right));
+    outside = _mm_or_si128(outside, _mm_cmpgt_epi32(y, py));
+    outside = _mm_or_si128(outside, _mm_cmpgt_epi32(py, bottom));
+    return _mm_andnot_si128(outside, _mm_set1_epi32(-1));
+}
+
+auto ShrinkVector(std::span<std::uint32_t> sizes, const std::uint32_t border, const std::size_t end) -> void
+{
+    const __m128i both = _mm_set1_epi32(static_cast<std::int32_t>(2 * border));
+    const __m128i one = _mm_set1_epi32(1);
+    for (std::size_t i = 0; i < end; i += kLanes)
+    {
+        const __m128i size = Load(&sizes[i]);
+        Store(&sizes[i], Select(GreaterU32(size, both), _mm_sub_epi32(size, both), one));
+    }
+}
+
+/// @brief Scales two lanes at a time in double precision, truncation equals floor for the non negative products.
+///
+/// @details Sizes are converted as signed, which is exact below 2^31, the same range Rect adds them to positions in.
+auto ScaleVector(std::span<std::uint32_t> sizes, const double factor, const std::size_t end) -> void
+{
+    const __m128d scale = _mm_set1_pd(factor);
+    for (std::size_t i = 0; i < end; i += kLanes)
+    {
+        const __m128i size = Load(&sizes[i]);
+        const __m128i low = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(size), scale));
+        const __m128i high = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(size, 8)), scale));
+        Store(&sizes[i], _mm_unpacklo_epi64(low, high));
+    }
+}
+
+auto ClampVector(std::span<std::int32_t> positions, std::span<std::uint32_t> sizes, const std::int32_t low,
+                 const std::uint32_t size, const std::size_t end) -> void
+{
+    const __m128i lows = _mm_set1_epi32(low);
+    const __m128i bound = _mm_set1_epi32(static_cast<std::int32_t>(size));
+    const __m128i end_of_bounds = _mm_set1_epi32(low + static_cast<std::int32_t>(size));
+    for (std::size_t i = 0; i < end; i += kLanes)
+    {
+        const __m128i clamped = MinU32(Load(&sizes[i]), bound);
+        const __m128i high = _mm_sub_epi32(end_of_bounds, clamped);
+        Store(&sizes[i], clamped);
+        Store(&positions[i], MaxI32(lows, MinI32(Load(&positions[i]), high)));
+    }
+}
+
+/// @brief Gets the end of the part of `count` elements the vector kernels cover.
+auto VectorEnd(const std::size_t count) -> std::size_t
+{
+    return count - (count % kLanes);
+}
+
+#endif
+
+} // namespace
+
+RectBatch::RectBatch(const std::size_t capacity)
+{
+    Reserve(capacity);
+}
+
+auto RectBatch::Size() const noexcept -> std::size_t
+{
+    return m_x.size();
+}
+
+auto RectBatch::Empty() const noexcept -> bool
+{
+    return m_x.empty();
+}
+
+auto RectBatch::Reserve(const std::size_t capacity) -> void
+{
+    m_x.reserve(capacity);
+    m_y.reserve(capacity);
+    m_w.reserve(capacity);
+    m_h.reserve(capacity);
+}
+
+auto RectBatch::Clear() noexcept -> void
+{
+    m_x.clear();
+    m_y.clear();
+    m_w.clear();
+    m_h.clear();
+}
+
+auto RectBatch::Push(const Rect &rect) -> std::size_t
+{
+    m_x.push_back(rect.GetX());
+    m_y.push_back(rect.GetY());
+    m_w.push_back(rect.GetW());
+    m_h.push_back(rect.GetH());
+    return m_x.size() - 1;
+}
+
+auto RectBatch::Set(const std::size_t index, const Rect &rect) noexcept -> void
+{
+    m_x[index] = rect.GetX();
+    m_y[index] = rect.GetY();
+    m_w[index] = rect.GetW();
+    m_h[index] = rect.GetH();
+}
+
+auto RectBatch::Get(const std::size_t index) const noexcept -> Rect
+{
+    return {Point(X(m_x[index]), Y(m_y[index])), Width(m_w[index]), Height(m_h[index])};
+}
+
+auto RectBatch::Xs() const noexcept -> std::span<const std::int32_t>
+{
+    return m_x;
+}
+
+auto RectBatch::Ys() const noexcept -> std::span<const std::int32_t>
+{
+    return m_y;
+}
+
+auto RectBatch::Widths() const noexcept -> std::span<const std::uint32_t>
+{
+    return m_w;
+}
+
+auto RectBatch::Heights() const noexcept -> std::span<const std::uint32_t>
+{
+    return m_h;
+}
+
+auto RectBatch::ContainsRect(const Rect &other, std::span<std::uint8_t> out) const noexcept -> std::size_t
+{
+    std::size_t begin = 0;
+    std::size_t hits = 0;
+
+#if defined(__SSE2__)
+    const __m128i ox = _mm_set1_epi32(other.GetX());
+    const __m128i oy = _mm_set1_epi32(other.GetY());
+    const __m128i oright = _mm_set1_epi32(other.GetX() + static_cast<std::int32_t>(other.GetW()));
+    const __m128i obottom = _mm_set1_epi32(other.GetY() + static_cast<std::int32_t>(other.GetH()));
+
+    begin = VectorEnd(Size());
+    for (std::size_t i = 0; i < begin; i += kLanes)
+    {
+        const __m128i x = Load(&m_x[i]);
+        const __m128i y = Load(&m_y[i]);
+        const __m128i right = _mm_add_epi32(x, Load(&m_w[i]));
+        const __m128i bottom = _mm_add_epi32(y, Load(&m_h[i]));
+
+        __m128i outside = _mm_cmpgt_epi32(x, ox);
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(y, oy));
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(oright, right));
+        outside = _mm_or_si128(outside, _mm_cmpgt_epi32(obottom, bottom));
+        hits += StoreMask(&out[i], _mm_andnot_si128(outside, _mm_set1_epi32(-1)));
+    }
+#endif
+
+    return hits + ContainsRectScalar(*this, other, out, begin);
+}
+
+auto RectBatch::ContainsPoint(const Point &point, std::span<std::uint8_t> out) const noexcept -> std::size_t
+{
+    std::size_t begin = 0;
+    std::size_t hits = 0;
+
+#if defined(__SSE2__)
+    const __m128i px = _mm_set1_epi32(point.x.value);
+    const __m128i py = _mm_set1_epi32(point.y.value);
+
+    begin = VectorEnd(Size());
+    for (std::size_t i = 0; i < begin; i += kLanes)
+    {
+        hits += StoreMask(&out[i], PointMask(&m_x[i], &m_y[i], &m_w[i], &m_h[i], px, py));
+    }
+#endif
+
+    return hits + ContainsPointScalar(*this, point, out, begin);
+}
+
+auto RectBatch::FindContaining(const Point &point) const noexcept -> std::optional<std::size_t>
+{
+    std::size_t begin = 0;
+
+#if defined(__SSE2__)
+    const __m128i px = _mm_set1_epi32(point.x.value);
+    const __m128i py = _mm_set1_epi32(point.y.value);
+
+    begin = VectorEnd(Size());
+    for (std::size_t i = 0; i < begin; i += kLanes)
+    {
+        const int bits = _mm_movemask_ps(_mm_castsi128_ps(PointMask(&m_x[i], &m_y[i], &m_w[i], &m_h[i], px, py)));
+        if (bits != 0)
+        {
+            return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(bits)));
+        }
+    }
+#endif
+
+    return FindContainingScalar(*this, point, begin);
+}
+
+auto RectBatch::ShrinkIn(const std::uint32_t border) noexcept -> void
+{
+    std::size_t begin = 0;
+
+#if defined(__SSE2__)
+    begin = VectorEnd(Size());
+    ShrinkVector(m_w, border, begin);
+    ShrinkVector(m_h, border, begin);
+#endif
+
+    ShrinkScalar(m_w, border, begin);
+    ShrinkScalar(m_h, border, begin);
+}
+
+auto RectBatch::ScaleWidth(const double factor) noexcept -> void
+{
+    if (factor == 1.0)
+    {
+        return;
+    }
+
+    std::size_t begin = 0;
+
+#if defined(__SSE2__)
+    begin = VectorEnd(Size());
+    ScaleVector(m_w, factor, begin);
+#endif
+
+    ScaleScalar(m_w, factor, begin);
+}
+
+auto RectBatch::ScaleHeight(const double factor) noexcept -> void
+{
+    if (factor == 1.0)
+    {
+        return;
+    }
+
+    std::size_t begin = 0;
+
+#if defined(__SSE2__)
+    begin = VectorEnd(Size());
+    ScaleVector(m_h, factor, begin);
+#endif
+
+    ScaleScalar(m_h, factor, begin);
+}
+
+auto RectBatch::ClampTo(const Rect &bounds) noexcept -> void
+{
+    std::size_t begin = 0;
+
+#if defined(__SSE2__)
+    begin = VectorEnd(Size());
+    ClampVector(m_x, m_w, bounds.GetX(), bounds.GetW(), begin);
+    ClampVector(m_y, m_h, bounds.GetY(), bounds.GetH(), begin);
+#endif
+
+    ClampScalar(m_x, m_w, bounds.GetX(), bounds.GetW(), begin);
+    ClampScalar(m_y, m_h, bounds.GetY(), bounds.GetH(), begin);
+}
+
+} // namespace Tilebox
@@ -0,0 +1,532 @@
+#include "tilebox/region.hpp"
+
+#include "tilebox/geometry.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+auto Overlaps(const RegionBox &lhs, const RegionBox &rhs) noexcept -> bool
+{
+    return lhs.x1 < rhs.x2 && rhs.x1 < lhs.x2 && lhs.y1 < rhs.y2 && rhs.y1 < lhs.y2;
+}
+
+/// @brief Gets the end of the band starting at `box`.
+auto BandEnd(const RegionBox *box, const RegionBox *end) noexcept -> const RegionBox *
+{
+    const std::int32_t y1 = box->y1;
+    while (box != end && box->y1 == y1)
+    {
+        ++box;
+    }
+    return box;
+}
+
+} // namespace
+
+auto RegionBox::ToRect() const noexcept -> Rect
+{
+    return {Point(X(x1), Y(y1)), Width(static_cast<std::uint32_t>(x2 - x1)),
+            Height(static_cast<std::uint32_t>(y2 - y1))};
+}
+
+Region::Region(const Rect &rect) noexcept
+{
+    if (rect.GetW() == 0 || rect.GetH() == 0)
+    {
+        return;
+    }
+
+    m_extents = {
+        .x1 = rect.GetX(),
+        .y1 = rect.GetY(),
+        .x2 = rect.GetX() + static_cast<std::int32_t>(rect.GetW()),
+        .y2 = rect.GetY() + static_cast<std::int32_t>(rect.GetH()),
+    };
+    m_inline[0] = m_extents;
+    m_size = 1;
+}
+
+Region::Region(const Region &other)
+    : m_size(other.m_size), m_last_band(other.m_last_band), m_extents(other.m_extents)
+{
+    if (other.m_size > kInlineBoxes)
+    {
+        m_heap = std::make_unique<RegionBox[]>(other.m_size);
+        m_capacity = other.m_size;
+    }
+    std::copy_n(other.Data(), other.m_size, Data());
+}
+
+auto Region::operator=(const Region &other) -> Region &
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    if (other.m_size > m_capacity)
+    {
+        m_heap = std::make_unique<RegionBox[]>(other.m_size);
+        m_capacity = other.m_size;
+    }
+    std::copy_n(other.Data(), other.m_size, Data());
+    m_size = other.m_size;
+    m_last_band = other.m_last_band;
+    m_extents = other.m_extents;
+    return *this;
+}
+
+Region::Region(Region &&other) noexcept
+    : m_size(other.m_size), m_last_band(other.m_last_band), m_extents(other.m_extents)
+{
+    if (other.m_heap)
+    {
+        m_heap = std::move(other.m_heap);
+        m_capacity = other.m_capacity;
+        other.m_capacity = kInlineBoxes;
+    }
+    else
+    {
+        m_inline = other.m_inline;
+    }
+    other.Clear();
+}
+
+auto Region::operator=(Region &&other) noexcept -> Region &
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    if (other.m_heap)
+    {
+        m_heap = std::move(other.m_heap);
+        m_capacity = other.m_capacity;
+        other.m_capacity = kInlineBoxes;
+    }
+    else
+    {
+        // Fits inline, keep any heap storage of this region for later growth
+        std::copy_n(other.m_inline.data(), other.m_size, Data());
+    }
+    m_size = other.m_size;
+    m_last_band = other.m_last_band;
+    m_extents = other.m_extents;
+    other.Clear();
+    return *this;
+}
+
+auto Region::Empty() const noexcept -> bool
+{
+    return m_size == 0;
+}
+
+auto Region::Boxes() const noexcept -> std::span<const RegionBox>
+{
+    return {Data(), m_size};
+}
+
+auto Region::Extents() const noexcept -> const RegionBox &
+{
+    return m_extents;
+}
+
+auto Region::Area() const noexcept -> std::uint64_t
+{
+    std::uint64_t area = 0;
+    for (const RegionBox &box : Boxes())
+    {
+        area += static_cast<std::uint64_t>(box.x2 - box.x1) * static_cast<std::uint64_t>(box.y2 - box.y1);
+    }
+    return area;
+}
+
+auto Region::Clear() noexcept -> void
+{
+    m_size = 0;
+    m_last_band = 0;
+    m_extents = {};
+}
+
+auto Region::Union(const Region &other) -> Region &
+{
+    *this = Combine(*this, other, Operation::Union);
+    return *this;
+}
+
+auto Region::Union(const Rect &rect) -> Region &
+{
+    return Union(Region(rect));
+}
+
+auto Region::Intersect(const Region &other) -> Region &
+{
+    *this = Combine(*this, other, Operation::Intersect);
+    return *this;
+}
+
+auto Region::Intersect(const Rect &rect) -> Region &
+{
+    return Intersect(Region(rect));
+}
+
+auto Region::Subtract(const Region &other) -> Region &
+{
+    *this = Combine(*this, other, Operation::Subtract);
+    return *this;
+}
+
+auto Region::Subtract(const Rect &rect) -> Region &
+{
+    return Subtract(Region(rect));
+}
+
+auto Region::Translate(const std::int32_t dx, const std::int32_t dy) noexcept -> void
+{
+    if (Empty())
+    {
+        return;
+    }
+
+    RegionBox *boxes = Data();
+    for (std::uint32_t i = 0; i < m_size; ++i)
+    {
+        boxes[i] = {.x1 = boxes[i].x1 + dx, .y1 = boxes[i].y1 + dy, .x2 = boxes[i].x2 + dx, .y2 = boxes[i].y2 + dy};
+    }
+    m_extents = {.x1 = m_extents.x1 + dx, .y1 = m_extents.y1 + dy, .x2 = m_extents.x2 + dx, .y2 = m_extents.y2 + dy};
+}
+
+auto Region::ContainsPoint(const Point &point) const noexcept -> bool
+{
+    const RegionBox pixel{.x1 = point.x.value, .y1 = point.y.value, .x2 = point.x.value + 1, .y2 = point.y.value + 1};
+    if (Empty() || !Overlaps(m_extents, pixel))
+    {
+        return false;
+    }
+
+    for (const RegionBox &box : Boxes())
+    {
+        if (box.y1 > pixel.y1)
+        {
+            break;
+        }
+        if (Overlaps(box, pixel))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto Region::ContainsRect(const Rect &rect) const -> bool
+{
+    return Region(rect).Subtract(*this).Empty();
+}
+
+auto Region::Intersects(const Rect &rect) const noexcept -> bool
+{
+    const Region area(rect);
+    if (Empty() || area.Empty() || !Overlaps(m_extents, area.m_extents))
+    {
+        return false;
+    }
+
+    for (const RegionBox &box : Boxes())
+    {
+        if (box.y1 >= area.m_extents.y2)
+        {
+            break;
+        }
+        if (Overlaps(box, area.m_extents))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto Region::operator==(const Region &rhs) const noexcept -> bool
+{
+    // Banding makes the representation unique, equal pixel sets have equal boxes
+    return std::ranges::equal(Boxes(), rhs.Boxes());
+}
+
+/// Private
+
+auto Region::Combine(const Region &lhs, const Region &rhs, const Operation operation) -> Region
+{
+    switch (operation)
+    {
+    case Operation::Union:
+        if (lhs.Empty() || (rhs.m_size == 1 && rhs.ContainsRect(lhs.m_extents.ToRect())))
+        {
+            return rhs;
+        }
+        if (rhs.Empty() || (lhs.m_size == 1 && lhs.ContainsRect(rhs.m_extents.ToRect())))
+        {
+            return lhs;
+        }
+        break;
+    case Operation::Intersect:
+        if (lhs.Empty() || rhs.Empty() || !Overlaps(lhs.m_extents, rhs.m_extents))
+        {
+            return {};
+        }
+        break;
+    case Operation::Subtract:
+        if (lhs.Empty() || rhs.Empty() || !Overlaps(lhs.m_extents, rhs.m_extents))
+        {
+            return lhs;
+        }
+        break;
+    }
+
+    Region result;
+
+    // Part of the bands of both regions spanning [y1, y2), boxes of each band sorted by x
+    const auto overlap = [&result, operation](const RegionBox *a, const RegionBox *a_end, const RegionBox *b,
+                                              const RegionBox *b_end, const std::int32_t y1, const std::int32_t y2) {
+        const std::size_t band = result.m_size;
+        const auto push = [&result, y1, y2](const std::int32_t x1, const std::int32_t x2) {
+            result.Push({.x1 = x1, .y1 = y1, .x2 = x2, .y2 = y2});
+        };
+
+        switch (operation)
+        {
+        case Operation::Union: {
+            // Merge by left edge, joining spans that overlap or touch
+            bool open = false;
+            std::int32_t x1 = 0;
+            std::int32_t x2 = 0;
+            while (a != a_end || b != b_end)
+            {
+                const RegionBox &box = (b == b_end || (a != a_end && a->x1 < b->x1)) ? *a++ : *b++;
+                if (open && box.x1 <= x2)
+                {
+                    x2 = std::max(x2, box.x2);
+                    continue;
+                }
+                if (open)
+                {
+                    push(x1, x2);
+                }
+                x1 = box.x1;
+                x2 = box.x2;
+                open = true;
+            }
+            if (open)
+            {
+                push(x1, x2);
+            }
+            break;
+        }
+
+        case Operation::Intersect:
+            while (a != a_end && b != b_end)
+            {
+                const std::int32_t x1 = std::max(a->x1, b->x1);
+                const std::int32_t x2 = std::min(a->x2, b->x2);
+                if (x1 < x2)
+                {
+                    push(x1, x2);
+                }
+                const std::int32_t a_x2 = a->x2;
+                const std::int32_t b_x2 = b->x2;
+                a += a_x2 <= b_x2 ? 1 : 0;
+                b += b_x2 <= a_x2 ? 1 : 0;
+            }
+            break;
+
+        case Operation::Subtract: {
+            // x1 is the left edge of what is left of the current lhs box
+            std::int32_t x1 = a->x1;
+            while (a != a_end)
+            {
+                if (b == b_end || b->x1 >= a->x2)
+                {
+                    push(x1, a->x2);
+                    if (++a != a_end)
+                    {
+                        x1 = a->x1;
+                    }
+                }
+                else if (b->x2 <= x1)
+                {
+                    ++b;
+                }
+                else
+                {
+                    if (b->x1 > x1)
+                    {
+                        push(x1, b->x1);
+                    }
+                    if (b->x2 < a->x2)
+                    {
+                        x1 = b->x2;
+                        ++b;
+                    }
+                    else if (++a != a_end)
+                    {
+                        x1 = a->x1;
+                    }
+                }
+            }
+            break;
+        }
+        }
+
+        result.Coalesce(band);
+    };
+
+    const bool keep_lhs = operation != Operation::Intersect;
+    const bool keep_rhs = operation == Operation::Union;
+
+    const RegionBox *a = lhs.Data();
+    const RegionBox *a_end = a + lhs.m_size;
+    const RegionBox *b = rhs.Data();
+    const RegionBox *b_end = b + rhs.m_size;
+
+    // Everything above ybot is done, bands straddling it are only partly consumed
+    std::int32_t ybot = std::min(a->y1, b->y1);
+    while (a != a_end && b != b_end)
+    {
+        const RegionBox *a_band = BandEnd(a, a_end);
+        const RegionBox *b_band = BandEnd(b, b_end);
+
+        // Part of a band above the other region's band is covered by one region only
+        std::int32_t ytop = a->y1;
+        if (a->y1 < b->y1)
+        {
+            const std::int32_t top = std::max(a->y1, ybot);
+            const std::int32_t bottom = std::min(a->y2, b->y1);
+            if (keep_lhs && top < bottom)
+            {
+                result.AppendBand({a, a_band}, top, bottom);
+            }
+            ytop = b->y1;
+        }
+        else if (b->y1 < a->y1)
+        {
+            const std::int32_t top = std::max(b->y1, ybot);
+            const std::int32_t bottom = std::min(b->y2, a->y1);
+            if (keep_rhs && top < bottom)
+            {
+                result.AppendBand({b, b_band}, top, bottom);
+            }
+            ytop = a->y1;
+        }
+
+        ybot = std::min(a->y2, b->y2);
+        if (ytop < ybot)
+        {
+            overlap(a, a_band, b, b_band, ytop, ybot);
+        }
+
+        const std::int32_t a_y2 = a->y2;
+        const std::int32_t b_y2 = b->y2;
+        a = a_y2 == ybot ? a_band : a;
+        b = b_y2 == ybot ? b_band : b;
+    }
+
+    for (; keep_lhs && a != a_end; a = BandEnd(a, a_end))
+    {
+        result.AppendBand({a, BandEnd(a, a_end)}, std::max(a->y1, ybot), a->y2);
+    }
+    for (; keep_rhs && b != b_end; b = BandEnd(b, b_end))
+    {
+        result.AppendBand({b, BandEnd(b, b_end)}, std::max(b->y1, ybot), b->y2);
+    }
+
+    result.UpdateExtents();
+    return result;
+}
+
+auto Region::Data() noexcept -> RegionBox *
+{
+    return m_heap ? m_heap.get() : m_inline.data();
+}
+
+auto Region::Data() const noexcept -> const RegionBox *
+{
+    return m_heap ? m_heap.get() : m_inline.data();
+}
+
+auto Region::Push(const RegionBox &box) -> void
+{
+    if (m_size == m_capacity)
+    {
+        const std::uint32_t capacity = m_capacity * 2;
+        auto heap = std::make_unique<RegionBox[]>(capacity);
+        std::copy_n(Data(), m_size, heap.get());
+        m_heap = std::move(heap);
+        m_capacity = capacity;
+    }
+    Data()[m_size++] = box;
+}
+
+auto Region::AppendBand(const std::span<const RegionBox> spans, const std::int32_t y1, const std::int32_t y2) -> void
+{
+    const std::size_t band = m_size;
+    for (const RegionBox &span : spans)
+    {
+        Push({.x1 = span.x1, .y1 = y1, .x2 = span.x2, .y2 = y2});
+    }
+    Coalesce(band);
+}
+
+auto Region::Coalesce(const std::size_t band) noexcept -> void
+{
+    if (m_size == band)
+    {
+        return;
+    }
+
+    RegionBox *boxes = Data();
+    const std::size_t previous = m_last_band;
+    const std::size_t count = m_size - band;
+    const bool mergeable = band != 0 && band - previous == count && boxes[previous].y2 == boxes[band].y1 &&
+                           std::equal(boxes + previous, boxes + band, boxes + band,
+                                      [](const RegionBox &lhs, const RegionBox &rhs) {
+                                          return lhs.x1 == rhs.x1 && lhs.x2 == rhs.x2;
+                                      });
+    if (!mergeable)
+    {
+        m_last_band = static_cast<std::uint32_t>(band);
+        return;
+    }
+
+    for (std::size_t i = previous; i < band; ++i)
+    {
+        boxes[i].y2 = boxes[band].y2;
+    }
+    m_size = static_cast<std::uint32_t>(band);
+}
+
+auto Region::UpdateExtents() noexcept -> void
+{
+    if (Empty())
+    {
+        m_extents = {};
+        return;
+    }
+
+    const std::span<const RegionBox> boxes = Boxes();
+    m_extents = {.x1 = boxes.front().x1, .y1 = boxes.front().y1, .x2 = boxes.front().x2, .y2 = boxes.back().y2};
+    for (const RegionBox &box : boxes)
+    {
+        m_extents.x1 = std::min(m_extents.x1, box.x1);
+        m_extents.x2 = std::max(m_extents.x2, box.x2);
+    }
+}
+
+} // namespace Tilebox
@@ -0,0 +1,293 @@
+#include "tilebox/spatial_index.hpp"
+
+#include "tilebox/geometry.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Tilebox
+{
+
+SpatialIndex::SpatialIndex(const Rect &bounds, const std::uint32_t cell_size) : m_bounds(bounds), m_cell_size(1)
+{
+    Rebuild(bounds, cell_size);
+}
+
+auto SpatialIndex::Size() const noexcept -> std::size_t
+{
+    return m_by_id.Size();
+}
+
+auto SpatialIndex::Bounds() const noexcept -> const Rect &
+{
+    return m_bounds;
+}
+
+auto SpatialIndex::Insert(const Id id, const Rect &rect, const std::uint32_t layer) -> bool
+{
+    if (id == FlatMap<std::uint32_t>::kEmptyKey || m_by_id.Contains(id))
+    {
+        return false;
+    }
+
+    std::uint32_t slot = 0;
+    if (m_free.empty())
+    {
+        slot = static_cast<std::uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    else
+    {
+        slot = m_free.back();
+        m_free.pop_back();
+    }
+
+    Entry &entry = m_entries[slot];
+    entry.id = id;
+    entry.rect = rect;
+    entry.layer = layer;
+    entry.stamp = ++m_stamp;
+    m_by_id.InsertOrAssign(id, slot);
+    Link(slot);
+    return true;
+}
+
+auto SpatialIndex::Move(const Id id, const Rect &rect) -> bool
+{
+    const std::uint32_t *slot = m_by_id.Find(id);
+    if (slot == nullptr)
+    {
+        return false;
+    }
+
+    Entry &entry = m_entries[*slot];
+    Entry moved = entry;
+    moved.rect = rect;
+    Cover(moved);
+
+    // Moves within the same cells, the common case of small drags and resizes, leave the cell lists alone
+    if (moved.first_column == entry.first_column && moved.last_column == entry.last_column &&
+        moved.first_row == entry.first_row && moved.last_row == entry.last_row && moved.overflow == entry.overflow)
+    {
+        entry.rect = rect;
+        return true;
+    }
+
+    Unlink(*slot);
+    entry.rect = rect;
+    Link(*slot);
+    return true;
+}
+
+auto SpatialIndex::Restack(const Id id, const std::uint32_t layer) noexcept -> bool
+{
+    const std::uint32_t *slot = m_by_id.Find(id);
+    if (slot == nullptr)
+    {
+        return false;
+    }
+
+    m_entries[*slot].layer = layer;
+    m_entries[*slot].stamp = ++m_stamp;
+    return true;
+}
+
+auto SpatialIndex::Remove(const Id id) -> bool
+{
+    const std::uint32_t *slot = m_by_id.Find(id);
+    if (slot == nullptr)
+    {
+        return false;
+    }
+
+    const std::uint32_t freed = *slot;
+    Unlink(freed);
+    m_entries[freed] = {};
+    m_free.push_back(freed);
+    m_by_id.Erase(id);
+    return true;
+}
+
+auto SpatialIndex::Clear() -> void
+{
+    for (std::vector<std::uint32_t> &cell : m_cells)
+    {
+        cell.clear();
+    }
+    m_overflow.clear();
+    m_entries.clear();
+    m_free.clear();
+    m_by_id.Clear();
+}
+
+auto SpatialIndex::Rebuild(const Rect &bounds, const std::uint32_t cell_size) -> void
+{
+    m_bounds = bounds;
+    m_cell_size = std::max<std::uint32_t>(cell_size, 1);
+
+    // Points on the right and bottom edge are inside, so an exact multiple of the cell size needs one more cell
+    m_columns = bounds.GetW() / m_cell_size + 1;
+    m_rows = bounds.GetH() / m_cell_size + 1;
+
+    m_cells.assign(static_cast<std::size_t>(m_columns) * m_rows, {});
+    m_overflow.clear();
+    for (std::uint32_t slot = 0; slot < m_entries.size(); ++slot)
+    {
+        if (m_entries[slot].id != FlatMap<std::uint32_t>::kEmptyKey)
+        {
+            Link(slot);
+        }
+    }
+}
+
+auto SpatialIndex::Contains(const Id id) const noexcept -> bool
+{
+    return m_by_id.Contains(id);
+}
+
+auto SpatialIndex::Find(const Id id) const noexcept -> std::optional<Rect>
+{
+    const std::uint32_t *slot = m_by_id.Find(id);
+    if (slot == nullptr)
+    {
+        return std::nullopt;
+    }
+    return m_entries[*slot].rect;
+}
+
+auto SpatialIndex::TopmostAt(const Point &point) const noexcept -> std::optional<Id>
+{
+    const Entry *topmost = nullptr;
+    for (const std::uint32_t slot : Candidates(point))
+    {
+        const Entry &entry = m_entries[slot];
+        if (entry.rect.ContainsPoint(point) && (topmost == nullptr || IsAbove(entry, *topmost)))
+        {
+            topmost = &entry;
+        }
+    }
+
+    if (topmost == nullptr)
+    {
+        return std::nullopt;
+    }
+    return topmost->id;
+}
+
+auto SpatialIndex::QueryPoint(const Point &point, std::vector<Id> &out) const -> void
+{
+    std::vector<const Entry *> hits;
+    for (const std::uint32_t slot : Candidates(point))
+    {
+        if (m_entries[slot].rect.ContainsPoint(point))
+        {
+            hits.push_back(&m_entries[slot]);
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const Entry *lhs, const Entry *rhs) { return IsAbove(*lhs, *rhs); });
+
+    out.clear();
+    for (const Entry *entry : hits)
+    {
+        out.push_back(entry->id);
+    }
+}
+
+/// Private
+
+auto SpatialIndex::CellOf(const Point &point) const noexcept -> std::optional<std::size_t>
+{
+    const std::int64_t column = static_cast<std::int64_t>(point.x.value) - m_bounds.GetX();
+    const std::int64_t row = static_cast<std::int64_t>(point.y.value) - m_bounds.GetY();
+    if (column < 0 || row < 0 || column > m_bounds.GetW() || row > m_bounds.GetH())
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<std::size_t>(row / m_cell_size) * m_columns + static_cast<std::size_t>(column / m_cell_size);
+}
+
+auto SpatialIndex::Candidates(const Point &point) const noexcept -> const std::vector<std::uint32_t> &
+{
+    const std::optional<std::size_t> cell = CellOf(point);
+    return cell ? m_cells[*cell] : m_overflow;
+}
+
+auto SpatialIndex::IsAbove(const Entry &lhs, const Entry &rhs) noexcept -> bool
+{
+    return lhs.layer != rhs.layer ? lhs.layer > rhs.layer : lhs.stamp > rhs.stamp;
+}
+
+auto SpatialIndex::Link(const std::uint32_t slot) -> void
+{
+    Entry &entry = m_entries[slot];
+    Cover(entry);
+    for (std::uint32_t row = entry.first_row; row <= entry.last_row; ++row)
+    {
+        for (std::uint32_t column = entry.first_column; column <= entry.last_column; ++column)
+        {
+            m_cells[static_cast<std::size_t>(row) * m_columns + column].push_back(slot);
+        }
+    }
+    if (entry.overflow)
+    {
+        m_overflow.push_back(slot);
+    }
+}
+
+auto SpatialIndex::Unlink(const std::uint32_t slot) noexcept -> void
+{
+    // Order within a cell does not matter, stacking is decided by layer and stamp
+    const auto erase = [slot](std::vector<std::uint32_t> &slots) {
+        const auto it = std::find(slots.begin(), slots.end(), slot);
+        if (it != slots.end())
+        {
+            *it = slots.back();
+            slots.pop_back();
+        }
+    };
+
+    const Entry &entry = m_entries[slot];
+    for (std::uint32_t row = entry.first_row; row <= entry.last_row; ++row)
+    {
+        for (std::uint32_t column = entry.first_column; column <= entry.last_column; ++column)
+        {
+            erase(m_cells[static_cast<std::size_t>(row) * m_columns + column]);
+        }
+    }
+    if (entry.overflow)
+    {
+        erase(m_overflow);
+    }
+}
+
+auto SpatialIndex::Cover(Entry &entry) const noexcept -> void
+{
+    // Relative to the bounds, in 64 bits so rects far outside can not overflow
+    const std::int64_t left = static_cast<std::int64_t>(entry.rect.GetX()) - m_bounds.GetX();
+    const std::int64_t top = static_cast<std::int64_t>(entry.rect.GetY()) - m_bounds.GetY();
+    const std::int64_t right = left + entry.rect.GetW();
+    const std::int64_t bottom = top + entry.rect.GetH();
+    const std::int64_t width = m_bounds.GetW();
+    const std::int64_t height = m_bounds.GetH();
+
+    entry.overflow = left < 0 || top < 0 || right > width || bottom > height;
+    if (right < 0 || bottom < 0 || left > width || top > height)
+    {
+        entry.first_column = 1;
+        entry.last_column = 0;
+        entry.first_row = 1;
+        entry.last_row = 0;
+        return;
+    }
+
+    entry.first_column = static_cast<std::uint32_t>(std::max<std::int64_t>(left, 0) / m_cell_size);
+    entry.last_column = static_cast<std::uint32_t>(std::min(right, width) / m_cell_size);
+    entry.first_row = static_cast<std::uint32_t>(std::max<std::int64_t>(top, 0) / m_cell_size);
+    entry.last_row = static_cast<std::uint32_t>(std::min(bottom, height) / m_cell_size);
+}
+
+} // namespace Tilebox
@@ -0,0 +1,233 @@
+#include "tilebox/x11/async.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/xcb.hpp"
+
+#include <X11/X.h>
+#include <xcb/xcb.h>
+#include <xcb/xproto.h>
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+/// @brief Orders sequence numbers, tolerating the 32 bit wrap around.
+auto SequenceBefore(const std::uint32_t lhs, const std::uint32_t rhs) noexcept -> bool
+{
+    return static_cast<std::int32_t>(lhs - rhs) < 0;
+}
+
+} // namespace
+
+////////////////////////////////////
+// Detail::X11PendingReply
+////////////////////////////////////
+
+Detail::X11PendingReply::X11PendingReply(X11AsyncConnection *connection, const std::uint32_t sequence) noexcept
+    : m_connection(connection), m_sequence(sequence)
+{
+}
+
+Detail::X11PendingReply::~X11PendingReply()
+{
+    if (m_resolved)
+    {
+        std::free(m_reply); // NOLINT(cppcoreguidelines-no-malloc)
+    }
+    else if (m_connection != nullptr)
+    {
+        // Only happens when the awaiting coroutine is destroyed while suspended, or the request was never awaited
+        m_connection->Forget(this);
+        Detail::X11DiscardReply(m_connection->Raw(), m_sequence);
+    }
+}
+
+Detail::X11PendingReply::X11PendingReply(X11PendingReply &&rhs) noexcept
+    : m_connection(std::exchange(rhs.m_connection, nullptr)), m_sequence(rhs.m_sequence),
+      m_reply(std::exchange(rhs.m_reply, nullptr)), m_resolved(std::exchange(rhs.m_resolved, true))
+{
+}
+
+auto Detail::X11PendingReply::await_suspend(const std::coroutine_handle<> awaiting) -> void
+{
+    m_connection->Enqueue(this, awaiting);
+}
+
+auto Detail::X11PendingReply::TakeReply() noexcept -> void *
+{
+    return std::exchange(m_reply, nullptr);
+}
+
+////////////////////////////////////
+// X11AsyncConnection
+////////////////////////////////////
+
+X11AsyncConnection::X11AsyncConnection(X11DisplaySharedResource dpy) noexcept
+    : m_dpy(std::move(dpy)), m_xcb(m_dpy != nullptr ? m_dpy->Xcb() : X11XcbConnection())
+{
+}
+
+X11AsyncConnection::~X11AsyncConnection()
+{
+    // Destroying a suspended task destroys its awaitables, which discard their replies and forget themselves.
+    m_tasks.clear();
+
+    // Whatever is left belongs to coroutines not owned by us
+    for (const Pending &pending : m_pending)
+    {
+        pending.reply->m_connection = nullptr;
+        Detail::X11DiscardReply(m_xcb.Raw(), pending.sequence);
+    }
+}
+
+auto X11AsyncConnection::Raw() const noexcept -> xcb_connection_t *
+{
+    return m_xcb.Raw();
+}
+
+auto X11AsyncConnection::Spawn(X11Task<void> task) -> void
+{
+    task.Start();
+    if (task.Done())
+    {
+        task.RethrowIfFailed();
+        return;
+    }
+    m_tasks.push_back(std::move(task));
+}
+
+auto X11AsyncConnection::RunningTasks() const noexcept -> std::size_t
+{
+    return m_tasks.size();
+}
+
+auto X11AsyncConnection::PendingReplies() const noexcept -> std::size_t
+{
+    return m_pending.size();
+}
+
+auto X11AsyncConnection::ProcessReplies() -> bool
+{
+    bool resumed = false;
+
+    // Replies arrive in request order, once the oldest awaited one is missing so are all later ones.
+    while (!m_pending.empty())
+    {
+        void *reply = nullptr;
+        if (!Detail::X11PollForReply(m_xcb.Raw(), m_pending.front().sequence, reply))
+        {
+            break;
+        }
+        Resume(0, reply);
+        resumed = true;
+    }
+
+    if (resumed)
+    {
+        ReapTasks();
+    }
+    return resumed;
+}
+
+auto X11AsyncConnection::Flush() const noexcept -> void
+{
+    m_xcb.Flush();
+}
+
+auto X11AsyncConnection::Drain() -> void
+{
+    while (!m_pending.empty())
+    {
+        Resume(0, Detail::X11WaitForReply(m_xcb.Raw(), m_pending.front().sequence, m_xcb.Traffic()));
+    }
+    ReapTasks();
+}
+
+auto X11AsyncConnection::GetWindowAttributes(const Window window) -> X11ReplyAwaiter<xcb_get_window_attributes_reply_t>
+{
+    return {this, m_xcb.GetWindowAttributes(window).Release()};
+}
+
+auto X11AsyncConnection::GetGeometry(const Drawable drawable) -> X11ReplyAwaiter<xcb_get_geometry_reply_t>
+{
+    return {this, m_xcb.GetGeometry(drawable).Release()};
+}
+
+auto X11AsyncConnection::GetProperty(const Window window, const Atom property, const Atom type,
+                                     const std::uint32_t long_offset, const std::uint32_t long_length)
+    -> X11ReplyAwaiter<xcb_get_property_reply_t>
+{
+    return {this, m_xcb.GetProperty(window, property, type, long_offset, long_length).Release()};
+}
+
+auto X11AsyncConnection::InternAtom(const std::string_view name, const bool only_if_exists)
+    -> X11ReplyAwaiter<xcb_intern_atom_reply_t>
+{
+    return {this, m_xcb.InternAtom(name, only_if_exists).Release()};
+}
+
+auto X11AsyncConnection::QueryTree(const Window window) -> X11ReplyAwaiter<xcb_query_tree_reply_t>
+{
+    return {this, m_xcb.QueryTree(window).Release()};
+}
+
+/// Private
+
+auto X11AsyncConnection::Enqueue(Detail::X11PendingReply *reply, const std::coroutine_handle<> awaiting) -> void
+{
+    // Usually appends, awaiting out of request order inserts further up.
+    const auto iter = std::upper_bound(m_pending.begin(), m_pending.end(), reply->m_sequence,
+                                       [](const std::uint32_t sequence, const Pending &pending) -> bool {
+                                           return SequenceBefore(sequence, pending.sequence);
+                                       });
+    m_pending.insert(iter, {reply->m_sequence, reply, awaiting});
+}
+
+auto X11AsyncConnection::Forget(const Detail::X11PendingReply *reply) noexcept -> void
+{
+    std::erase_if(m_pending, [&](const Pending &pending) -> bool { return pending.reply == reply; });
+}
+
+auto X11AsyncConnection::Resume(const std::size_t index, void *reply) -> void
+{
+    const Pending pending = m_pending[index];
+    m_pending.erase(m_pending.begin() + static_cast<std::ptrdiff_t>(index));
+
+    pending.reply->m_reply = reply;
+    pending.reply->m_resolved = true;
+    pending.handle.resume();
+}
+
+auto X11AsyncConnection::ReapTasks() -> void
+{
+    std::exception_ptr failure;
+    std::erase_if(m_tasks, [&](const X11Task<void> &task) -> bool {
+        if (!task.Done())
+        {
+            return false;
+        }
+        if (!failure && task.m_handle.promise().exception)
+        {
+            failure = task.m_handle.promise().exception;
+        }
+        return true;
+    });
+
+    if (failure)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace Tilebox
@@ -0,0 +1,53 @@
+#include "tilebox/x11/atoms.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/xcb.hpp"
+
+#include <X11/X.h>
+#include <xcb/xproto.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Tilebox
+{
+
+auto Detail::X11InternAtoms(const X11DisplaySharedResource &dpy, const std::span<const char *const> names,
+                            const std::span<Atom> atoms) -> bool
+{
+    std::ranges::fill(atoms, None);
+    if (names.empty())
+    {
+        return true;
+    }
+    if (dpy == nullptr || !dpy->IsConnected())
+    {
+        return false;
+    }
+
+    // Every request is sent before the first reply is read, so the wait for it is the only round trip. Going through
+    // X11Cookie rather than XInternAtoms counts that wait in X11Display::Traffic.
+    const X11XcbConnection xcb = dpy->Xcb();
+    std::vector<X11Cookie<xcb_intern_atom_reply_t>> cookies;
+    cookies.reserve(names.size());
+    for (const char *name : names)
+    {
+        cookies.push_back(xcb.InternAtom(name));
+    }
+
+    bool interned = true;
+    for (std::size_t i = 0; i < cookies.size(); ++i)
+    {
+        const X11ReplyPtr<xcb_intern_atom_reply_t> reply = cookies[i].Get();
+        if (reply == nullptr)
+        {
+            interned = false;
+            continue;
+        }
+        atoms[i] = reply->atom;
+    }
+    return interned;
+}
+
+} // namespace Tilebox
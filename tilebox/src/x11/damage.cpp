@@ -0,0 +1,228 @@
+#include "tilebox/x11/damage.hpp"
+#include "tilebox/geometry.hpp"
+
+#include <X11/X.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+template <typename Box> auto Area(const Box &box) noexcept -> std::int64_t
+{
+    return (box.x1 - box.x0) * (box.y1 - box.y0);
+}
+
+template <typename Box> auto Union(const Box &a, const Box &b) noexcept -> Box
+{
+    return {std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+}
+
+/// @brief Pixels the bounding box of `a` and `b` covers that neither of them does.
+template <typename Box> auto Waste(const Box &a, const Box &b) noexcept -> std::int64_t
+{
+    const std::int64_t overlap_w = std::max<std::int64_t>(0, std::min(a.x1, b.x1) - std::max(a.x0, b.x0));
+    const std::int64_t overlap_h = std::max<std::int64_t>(0, std::min(a.y1, b.y1) - std::max(a.y0, b.y0));
+    return Area(Union(a, b)) - (Area(a) + Area(b) - overlap_w * overlap_h);
+}
+
+} // namespace
+
+auto X11DamageTracker::Track(const Window window, X11DamageCallback callback) -> void
+{
+    if (window == None || !callback)
+    {
+        return;
+    }
+
+    Untrack(window);
+    WindowDamage damage;
+    damage.callback = std::move(callback);
+    m_windows.InsertOrAssign(window, std::move(damage));
+}
+
+auto X11DamageTracker::Untrack(const Window window) -> void
+{
+    if (const WindowDamage *damage = m_windows.Find(window); damage != nullptr && damage->count > 0)
+    {
+        --m_pending_windows;
+    }
+    m_windows.Erase(window);
+}
+
+auto X11DamageTracker::IsTracked(const Window window) const noexcept -> bool
+{
+    return m_windows.Contains(window);
+}
+
+auto X11DamageTracker::Empty() const noexcept -> bool
+{
+    return m_windows.Empty();
+}
+
+auto X11DamageTracker::SetBounds(const Window window, const std::uint32_t width, const std::uint32_t height) noexcept
+    -> void
+{
+    WindowDamage *damage = m_windows.Find(window);
+    if (damage == nullptr)
+    {
+        return;
+    }
+
+    damage->width = width;
+    damage->height = height;
+    damage->has_bounds = true;
+
+    // A shrinking window takes pending damage with it
+    const std::size_t before = damage->count;
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < damage->count; ++i)
+    {
+        Box box = damage->boxes[i];
+        if (Clip(box, *damage))
+        {
+            damage->boxes[kept++] = box;
+        }
+    }
+    damage->count = kept;
+    if (before > 0 && kept == 0)
+    {
+        --m_pending_windows;
+    }
+}
+
+auto X11DamageTracker::Add(const Window window, const Rect &rect) noexcept -> bool
+{
+    WindowDamage *damage = m_windows.Find(window);
+    if (damage == nullptr)
+    {
+        return false;
+    }
+
+    Box box{rect.GetX(), rect.GetY(), static_cast<std::int64_t>(rect.GetX()) + rect.GetW(),
+            static_cast<std::int64_t>(rect.GetY()) + rect.GetH()};
+    if (!Clip(box, *damage))
+    {
+        return true;
+    }
+
+    if (damage->count == 0)
+    {
+        ++m_pending_windows;
+    }
+    damage->boxes[damage->count++] = box;
+    Simplify(*damage);
+    return true;
+}
+
+auto X11DamageTracker::Pending(const Window window) const noexcept -> std::size_t
+{
+    const WindowDamage *damage = m_windows.Find(window);
+    return damage != nullptr ? damage->count : 0;
+}
+
+auto X11DamageTracker::HasPending() const noexcept -> bool
+{
+    return m_pending_windows > 0;
+}
+
+auto X11DamageTracker::Flush(const Window window) -> void
+{
+    WindowDamage *damage = m_windows.Find(window);
+    if (damage == nullptr || damage->count == 0)
+    {
+        return;
+    }
+
+    std::array<Rect, kMaxDamageRects> rects;
+    const std::size_t count = std::exchange(damage->count, 0);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const Box &box = damage->boxes[i];
+        rects[i] = Rect(Point(X(static_cast<std::int32_t>(box.x0)), Y(static_cast<std::int32_t>(box.y0))),
+                        Width(static_cast<std::uint32_t>(box.x1 - box.x0)),
+                        Height(static_cast<std::uint32_t>(box.y1 - box.y0)));
+    }
+    --m_pending_windows;
+
+    // Invoke a copy, the callback may (un)track windows and move the map slots around.
+    const X11DamageCallback callback = damage->callback;
+    callback(window, std::span<const Rect>(rects.data(), count));
+}
+
+auto X11DamageTracker::FlushAll() -> void
+{
+    if (m_pending_windows == 0)
+    {
+        return;
+    }
+
+    m_flush_scratch.clear();
+    m_windows.ForEach([&](const std::uint64_t window, const WindowDamage &damage) -> void {
+        if (damage.count > 0)
+        {
+            m_flush_scratch.push_back(static_cast<Window>(window));
+        }
+    });
+
+    for (const Window window : m_flush_scratch)
+    {
+        Flush(window);
+    }
+}
+
+/// Private
+
+auto X11DamageTracker::Clip(Box &box, const WindowDamage &damage) noexcept -> bool
+{
+    constexpr std::int64_t kUnbounded = std::numeric_limits<std::int64_t>::max();
+    const std::int64_t right = damage.has_bounds ? damage.width : kUnbounded;
+    const std::int64_t bottom = damage.has_bounds ? damage.height : kUnbounded;
+    box.x0 = std::max<std::int64_t>(box.x0, 0);
+    box.y0 = std::max<std::int64_t>(box.y0, 0);
+    box.x1 = std::min(box.x1, right);
+    box.y1 = std::min(box.y1, bottom);
+    return box.x0 < box.x1 && box.y0 < box.y1;
+}
+
+auto X11DamageTracker::Simplify(WindowDamage &damage) noexcept -> void
+{
+    // Merging free pairs first keeps the region exact for as long as possible, at most a handful of boxes are compared.
+    while (damage.count > 1)
+    {
+        std::size_t best_i = 0;
+        std::size_t best_j = 1;
+        std::int64_t best_waste = std::numeric_limits<std::int64_t>::max();
+        for (std::size_t i = 0; i < damage.count; ++i)
+        {
+            for (std::size_t j = i + 1; j < damage.count; ++j)
+            {
+                if (const std::int64_t waste = Waste(damage.boxes[i], damage.boxes[j]); waste < best_waste)
+                {
+                    best_i = i;
+                    best_j = j;
+                    best_waste = waste;
+                }
+            }
+        }
+
+        if (best_waste > 0 && damage.count <= kMaxDamageRects)
+        {
+            return;
+        }
+
+        damage.boxes[best_i] = Union(damage.boxes[best_i], damage.boxes[best_j]);
+        damage.boxes[best_j] = damage.boxes[--damage.count];
+    }
+}
+
+} // namespace Tilebox
@@ -1,10 +1,22 @@
 #include "tilebox/x11/display.hpp"
 #include "tilebox/geometry.hpp"
+#include "tilebox/x11/monitors.hpp"
+#include "tilebox/x11/request_batch.hpp"
+#include "tilebox/x11/traffic.hpp"
+#include "tilebox/x11/xcb.hpp"
 
 #include <X11/X.h>
 #include <X11/Xlib.h>
+#include <X11/Xlibint.h>
+#include <X11/extensions/Xinerama.h>
+#include <X11/extensions/Xrandr.h>
+#include <X11/extensions/randr.h>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <span>
 #include <memory>
 #include <optional>
 #include <string>
@@ -13,6 +25,104 @@
 namespace Tilebox
 {
 
+namespace
+{
+
+/// @brief Widens the 32 bit sequence of the last XCB request against Xlib's 64 bit request number.
+auto LastRequest(const std::uint64_t xlib_last, const std::uint32_t xcb_last) noexcept -> std::uint64_t
+{
+    // Xlib learns of XCB requests when it next takes the socket, until then the XCB sequence may be ahead.
+    const std::uint32_t ahead = xcb_last - static_cast<std::uint32_t>(xlib_last);
+    return ahead < 0x8000'0000U ? xlib_last + ahead : xlib_last;
+}
+
+/// @brief Finds the payload a client side extension of the display carries for its hooks.
+template <typename Payload> auto FindHookPayload(Display *dpy, const std::int32_t extension) noexcept -> Payload *
+{
+    XEDataObject object{};
+    object.display = dpy;
+    XExtData *data = XFindOnExtensionList(XEHeadOfExtensionList(object), extension);
+    return data != nullptr ? reinterpret_cast<Payload *>(data->private_data) : nullptr;
+}
+
+/// @brief Payloads are owned by the X11Display, Xlib only frees the list node.
+auto KeepHookPayload(XExtData * /*data*/) -> int
+{
+    return 0;
+}
+
+/// @brief Adds a client side only extension carrying `payload`, hooks registered for it find the payload again.
+///
+/// @returns nullptr if Xlib is out of memory.
+auto AddHookExtension(Display *dpy, void *payload) noexcept -> XExtCodes *
+{
+    XExtCodes *codes = XAddExtension(dpy);
+    auto *data = static_cast<XExtData *>(std::calloc(1, sizeof(XExtData))); // NOLINT(cppcoreguidelines-no-malloc)
+    if (codes == nullptr || data == nullptr)
+    {
+        std::free(data); // NOLINT(cppcoreguidelines-no-malloc)
+        return nullptr;
+    }
+
+    data->number = codes->extension;
+    data->free_private = KeepHookPayload;
+    data->private_data = static_cast<XPointer>(payload);
+    XEDataObject object{};
+    object.display = dpy;
+    XAddToExtensionList(XEHeadOfExtensionList(object), data);
+    return codes;
+}
+
+/// @brief Called by Xlib for every chunk it hands to the connection, the buffer and any appended request data.
+auto CountFlush(Display *dpy, XExtCodes *codes, const char * /*data*/, const long len) -> void
+{
+    auto *traffic = FindHookPayload<Detail::X11TrafficCounters>(dpy, codes->extension);
+    if (traffic == nullptr)
+    {
+        return;
+    }
+
+    // Chunks of one flush share the request number, a later flush always follows at least one new request. Xlib
+    // holds the display lock here, so the number is read directly rather than through the locking XNextRequest.
+    if (const std::uint64_t next = dpy->request; next != traffic->flushed_request)
+    {
+        traffic->flushed_request = next;
+        ++traffic->flushes;
+    }
+    traffic->bytes_flushed += static_cast<std::uint64_t>(len);
+}
+
+/// @brief Batch registry carrying the Xlib async handler that reports errors to it, Xlib keeps a pointer to it.
+struct HookedBatchRegistry : Detail::X11BatchRegistry
+{
+    _XAsyncHandler handler{};
+};
+
+/// @brief Called by Xlib for every reply it did not wait for and every error, before the error handler.
+///
+/// @details Unlike XESetError hooks, which Xlib only calls for errors read while waiting on a reply, async handlers
+/// see errors read along with events too. Returning True for an error skips the error handler.
+auto CountBatchError(Display *dpy, xReply *reply, char * /*buffer*/, int /*length*/, XPointer data) -> Bool
+{
+    if (reply->generic.type != X_Error)
+    {
+        return False;
+    }
+
+    // Xlib has widened the error's 16 bit sequence number into the last processed request by now
+    const std::uint64_t sequence = LastKnownRequestProcessed(dpy);
+
+    // Nested batches overlap, the error counts for each of them
+    bool counted = false;
+    for (X11RequestBatch *batch : reinterpret_cast<HookedBatchRegistry *>(data)->checked)
+    {
+        counted = batch->OnError(sequence) || counted;
+    }
+    return counted ? True : False;
+}
+
+} // namespace
+
 auto DisplayDeleter::operator()(Display *display) const noexcept -> void
 {
     if (display != nullptr)
@@ -22,8 +132,13 @@ auto DisplayDeleter::operator()(Display *display) const noexcept -> void
 }
 
 X11Display::X11Display(const std::optional<std::string> &display_name) noexcept
-    : m_dpy(XOpenDisplay(display_name.has_value() ? display_name->c_str() : nullptr), DisplayDeleter())
+    : m_traffic(std::make_shared<Detail::X11TrafficCounters>()),
+      m_batches(std::make_shared<HookedBatchRegistry>()),
+      m_dpy(XOpenDisplay(display_name.has_value() ? display_name->c_str() : nullptr), DisplayDeleter()),
+      m_xcb(m_dpy.get(), m_traffic.get())
 {
+    WatchTraffic();
+    WatchBatchErrors();
     Refresh();
 }
 
@@ -47,6 +162,26 @@ auto X11Display::Raw() const noexcept -> Display *
     return m_dpy.get();
 }
 
+auto X11Display::Xcb() const noexcept -> X11XcbConnection
+{
+    return m_xcb;
+}
+
+auto X11Display::Traffic() const noexcept -> X11Traffic
+{
+    if (!IsConnected())
+    {
+        return {};
+    }
+
+    Display *dpy = m_dpy.get();
+    return {.requests = LastRequest(XNextRequest(dpy) - 1, m_traffic->xcb_sequence),
+            .processed = LastKnownRequestProcessed(dpy),
+            .round_trips = m_traffic->round_trips,
+            .flushes = m_traffic->flushes,
+            .bytes_flushed = m_traffic->bytes_flushed};
+}
+
 auto X11Display::Refresh() noexcept -> void
 {
     if (IsConnected())
@@ -58,7 +193,88 @@ auto X11Display::Refresh() noexcept -> void
         m_default_root_window = DefaultRootWindow(m_dpy.get());
         m_root_window = RootWindow(m_dpy.get(), m_screen_id);
         m_server_vendor = XServerVendor(m_dpy.get());
+        RefreshMonitors();
+    }
+}
+
+auto X11Display::Monitors() const noexcept -> const X11MonitorTable &
+{
+    return m_monitors;
+}
+
+auto X11Display::RefreshMonitors() noexcept -> void
+{
+    if (!IsConnected() || QueryRandrMonitors() || QueryXineramaMonitors())
+    {
+        return;
+    }
+
+    const std::array<X11Monitor, 1> screen = {X11Monitor{Rect(ScreenWidth(), ScreenHeight()), None, None, true}};
+    m_monitors.Assign(screen);
+}
+
+auto X11Display::SelectMonitorEvents() noexcept -> bool
+{
+    if (!IsConnected() || m_randr_event_base < 0)
+    {
+        return false;
     }
+
+    XRRSelectInput(m_dpy.get(), m_root_window,
+                   RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+    return true;
+}
+
+auto X11Display::HandleMonitorEvent(XEvent *event) noexcept -> bool
+{
+    if (m_randr_event_base < 0 || event == nullptr)
+    {
+        return false;
+    }
+
+    // RandR events are not part of the XEvent union, Xlib hands them out in the same storage.
+    if (event->type == m_randr_event_base + RRScreenChangeNotify)
+    {
+        // Keeps DisplayWidth and DisplayHeight current for everything else using Xlib
+        XRRUpdateConfiguration(event);
+
+        const auto *screen = reinterpret_cast<const XRRScreenChangeNotifyEvent *>(event); // NOLINT
+        const bool resized = screen->width != m_screen_width || screen->height != m_screen_height;
+        m_screen_width = screen->width;
+        m_screen_height = screen->height;
+        const bool primary_changed = m_monitors.SetPrimaryOutput(XRRGetOutputPrimary(m_dpy.get(), m_root_window));
+        return resized || primary_changed;
+    }
+
+    if (event->type != m_randr_event_base + RRNotify)
+    {
+        return false;
+    }
+
+    const auto *notify = reinterpret_cast<const XRRNotifyEvent *>(event); // NOLINT
+    switch (notify->subtype)
+    {
+    case RRNotify_CrtcChange: {
+        const auto *crtc = reinterpret_cast<const XRRCrtcChangeNotifyEvent *>(event); // NOLINT
+        if (crtc->mode == None)
+        {
+            return m_monitors.RemoveCrtc(crtc->crtc);
+        }
+        return m_monitors.UpdateCrtc(crtc->crtc, Rect(Point(X(crtc->x), Y(crtc->y)), Width(crtc->width),
+                                                      Height(crtc->height)));
+    }
+    case RRNotify_OutputChange: {
+        const auto *output = reinterpret_cast<const XRROutputChangeNotifyEvent *>(event); // NOLINT
+        return m_monitors.SetCrtcOutput(output->crtc, output->output);
+    }
+    default:
+        return false;
+    }
+}
+
+auto X11Display::MonitorEventBase() const noexcept -> std::int32_t
+{
+    return m_randr_event_base;
 }
 
 auto X11Display::ScreenId() const noexcept -> std::int32_t
@@ -110,9 +326,149 @@ auto X11Display::Sync(const bool discard) const noexcept -> void
 {
     if (IsConnected())
     {
+        // The batch syncs once it ends, an event queue discard is done right away as Xlib only offers it with a sync
+        if (m_batches->depth > 0 && !discard)
+        {
+            m_batches->sync_deferred = true;
+            return;
+        }
+
         const auto xdiscard = discard ? True : False;
+        ++m_traffic->round_trips;
         XSync(m_dpy.get(), xdiscard);
     }
 }
 
+auto X11Display::Flush() const noexcept -> void
+{
+    if (IsConnected() && m_batches->depth == 0)
+    {
+        XFlush(m_dpy.get());
+    }
+}
+
+/// Private
+
+auto X11Display::WatchTraffic() noexcept -> void
+{
+    if (!IsConnected())
+    {
+        return;
+    }
+
+    if (const XExtCodes *codes = AddHookExtension(m_dpy.get(), m_traffic.get()); codes != nullptr)
+    {
+        XESetBeforeFlush(m_dpy.get(), codes->extension, CountFlush);
+    }
+}
+
+auto X11Display::WatchBatchErrors() noexcept -> void
+{
+    if (!IsConnected())
+    {
+        return;
+    }
+
+    // The registry is destroyed after the connection is closed, so the handler can stay queued for good
+    auto *registry = static_cast<HookedBatchRegistry *>(m_batches.get());
+    registry->handler.handler = CountBatchError;
+    registry->handler.data = reinterpret_cast<XPointer>(registry);
+    registry->handler.next = m_dpy->async_handlers;
+    m_dpy->async_handlers = &registry->handler;
+}
+
+auto X11Display::QueryRandrMonitors() noexcept -> bool
+{
+    Display *dpy = m_dpy.get();
+    std::int32_t event_base = 0;
+    std::int32_t error_base = 0;
+    std::int32_t major = 0;
+    std::int32_t minor = 0;
+    if (XRRQueryExtension(dpy, &event_base, &error_base) == False || XRRQueryVersion(dpy, &major, &minor) == 0 ||
+        (major == 1 && minor < 2))
+    {
+        m_randr_event_base = -1;
+        return false;
+    }
+    m_randr_event_base = event_base;
+
+    // A one time cost of a round trip per CRTC, events keep the table current afterwards.
+    XRRScreenResources *resources = XRRGetScreenResourcesCurrent(dpy, m_root_window);
+    if (resources == nullptr)
+    {
+        return false;
+    }
+
+    const RROutput primary = XRRGetOutputPrimary(dpy, m_root_window);
+    std::array<X11Monitor, X11MonitorTable::kMaxMonitors> monitors{};
+    std::size_t count = 0;
+    for (const RRCrtc crtc : std::span<const RRCrtc>(resources->crtcs, static_cast<std::size_t>(resources->ncrtc)))
+    {
+        XRRCrtcInfo *info = XRRGetCrtcInfo(dpy, resources, crtc);
+        if (info == nullptr)
+        {
+            continue;
+        }
+
+        if (info->mode != None && info->noutput > 0 && count < monitors.size())
+        {
+            const std::span<const RROutput> outputs(info->outputs, static_cast<std::size_t>(info->noutput));
+            bool is_primary = false;
+            for (const RROutput output : outputs)
+            {
+                is_primary = is_primary || output == primary;
+            }
+            monitors[count++] = {Rect(Point(X(info->x), Y(info->y)), Width(info->width), Height(info->height)), crtc,
+                                 is_primary ? primary : outputs.front(), is_primary};
+        }
+        XRRFreeCrtcInfo(info);
+    }
+    XRRFreeScreenResources(resources);
+
+    if (count == 0)
+    {
+        return false;
+    }
+    m_monitors.Assign(std::span<const X11Monitor>(monitors.data(), count));
+    return true;
+}
+
+auto X11Display::QueryXineramaMonitors() noexcept -> bool
+{
+    Display *dpy = m_dpy.get();
+    std::int32_t event_base = 0;
+    std::int32_t error_base = 0;
+    if (XineramaQueryExtension(dpy, &event_base, &error_base) == False || XineramaIsActive(dpy) == False)
+    {
+        return false;
+    }
+
+    std::int32_t count = 0;
+    XineramaScreenInfo *screens = XineramaQueryScreens(dpy, &count);
+    if (screens == nullptr)
+    {
+        return false;
+    }
+
+    std::array<X11Monitor, X11MonitorTable::kMaxMonitors> monitors{};
+    std::size_t used = 0;
+    const std::span<const XineramaScreenInfo> infos(screens, static_cast<std::size_t>(count));
+    for (const XineramaScreenInfo &screen : infos)
+    {
+        if (used == monitors.size())
+        {
+            break;
+        }
+        // Xinerama has no notion of a primary monitor, screen 0 is the conventional choice.
+        const Rect geometry(Point(X(screen.x_org), Y(screen.y_org)), Width(static_cast<std::uint32_t>(screen.width)),
+                            Height(static_cast<std::uint32_t>(screen.height)));
+        monitors[used] = {geometry, None, None, used == 0};
+        ++used;
+    }
+    XFree(screens);
+
+    m_monitors.Assign(std::span<const X11Monitor>(monitors.data(), used));
+    return used > 0;
+}
+
 } // namespace Tilebox
@@ -0,0 +1,164 @@
+#include "tilebox/x11/event_coalescer.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+/// @brief Grows the expose rectangle of `into` to the bounding box of both exposes.
+auto MergeExpose(XExposeEvent &into, const XExposeEvent &from) noexcept -> void
+{
+    const auto right = std::max(into.x + into.width, from.x + from.width);
+    const auto bottom = std::max(into.y + into.height, from.y + from.height);
+    into.x = std::min(into.x, from.x);
+    into.y = std::min(into.y, from.y);
+    into.width = right - into.x;
+    into.height = bottom - into.y;
+    into.count = 0;
+}
+
+} // namespace
+
+auto X11EventCoalescer::Coalesce(const std::span<XEvent> batch) -> std::size_t
+{
+    m_stats.dequeued += batch.size();
+    m_pending.clear();
+    m_dropped.assign(batch.size(), 0);
+
+    // Walk backwards so the first event seen for a (window, type) pair is the one that survives.
+    for (std::size_t i = batch.size(); i-- > 0;)
+    {
+        XEvent &event = batch[i];
+        switch (event.type)
+        {
+        case MotionNotify: {
+            if (FindPending(event.xmotion.window, MotionNotify) != nullptr)
+            {
+                m_dropped[i] = 1;
+                ++m_stats.motion;
+            }
+            else
+            {
+                m_pending.push_back({event.xmotion.window, MotionNotify, i});
+            }
+            break;
+        }
+        case ConfigureNotify: {
+            if (FindPending(event.xconfigure.window, ConfigureNotify) != nullptr)
+            {
+                m_dropped[i] = 1;
+                ++m_stats.configure;
+            }
+            else
+            {
+                m_pending.push_back({event.xconfigure.window, ConfigureNotify, i});
+            }
+            break;
+        }
+        case Expose: {
+            if (!m_merge_expose)
+            {
+                break;
+            }
+            if (const Pending *pending = FindPending(event.xexpose.window, Expose); pending != nullptr)
+            {
+                MergeExpose(batch[pending->index].xexpose, event.xexpose);
+                m_dropped[i] = 1;
+                ++m_stats.expose;
+            }
+            else
+            {
+                m_pending.push_back({event.xexpose.window, Expose, i});
+            }
+            break;
+        }
+        case KeyPress:
+        case KeyRelease:
+        case ButtonPress:
+        case ButtonRelease:
+        case EnterNotify:
+        case LeaveNotify: {
+            DropPendingOfType(MotionNotify);
+            break;
+        }
+        case MapNotify: {
+            DropPending(event.xmap.window);
+            break;
+        }
+        case UnmapNotify: {
+            DropPending(event.xunmap.window);
+            break;
+        }
+        case ReparentNotify: {
+            DropPending(event.xreparent.window);
+            break;
+        }
+        case DestroyNotify: {
+            DropPending(event.xdestroywindow.window);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    std::size_t survivors = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        if (m_dropped[i] == 0)
+        {
+            if (survivors != i)
+            {
+                batch[survivors] = batch[i];
+            }
+            ++survivors;
+        }
+    }
+    return survivors;
+}
+
+auto X11EventCoalescer::SetExposeMerging(const bool enabled) noexcept -> void
+{
+    m_merge_expose = enabled;
+}
+
+auto X11EventCoalescer::Stats() const noexcept -> const X11CoalesceStats &
+{
+    return m_stats;
+}
+
+auto X11EventCoalescer::ResetStats() noexcept -> void
+{
+    m_stats = X11CoalesceStats{};
+}
+
+/// Private
+
+auto X11EventCoalescer::FindPending(const Window window, const std::int32_t type) noexcept -> Pending *
+{
+    const auto iter = std::find_if(m_pending.begin(), m_pending.end(), [&](const Pending &pending) -> bool {
+        return pending.window == window && pending.type == type;
+    });
+    return iter != m_pending.end() ? &(*iter) : nullptr;
+}
+
+auto X11EventCoalescer::DropPending(const Window window) noexcept -> void
+{
+    std::erase_if(m_pending, [&](const Pending &pending) -> bool { return pending.window == window; });
+}
+
+auto X11EventCoalescer::DropPendingOfType(const std::int32_t type) noexcept -> void
+{
+    std::erase_if(m_pending, [&](const Pending &pending) -> bool { return pending.type == type; });
+}
+
+} // namespace Tilebox
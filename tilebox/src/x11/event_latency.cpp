@@ -0,0 +1,155 @@
+#include "tilebox/x11/event_latency.hpp"
+#include "tilebox/utils/latency_histogram.hpp"
+#include "tilebox/x11/events.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fmt/format.h>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+constexpr std::int64_t kNanosecondsPerMillisecond = 1'000'000;
+
+auto AppendHistogram(std::string &out, const std::string_view kind, const X11EventType event_type,
+                     const LatencyHistogram &histogram) -> void
+{
+    if (histogram.Count() == 0)
+    {
+        return;
+    }
+
+    const auto micros = [](const std::uint64_t ns) -> double { return static_cast<double>(ns) / 1000.0; };
+    fmt::format_to(std::back_inserter(out),
+                   "{:<8} {:<18} count={:<10} p50={:.1f}us p90={:.1f}us p99={:.1f}us max={:.1f}us\n", kind,
+                   EventTypeName(event_type), histogram.Count(), micros(histogram.ValueAtPercentile(50.0)),
+                   micros(histogram.ValueAtPercentile(90.0)), micros(histogram.ValueAtPercentile(99.0)),
+                   micros(histogram.Max()));
+}
+
+} // namespace
+
+auto X11ServerClock::QueueLatency(const Time server_time, const std::chrono::steady_clock::time_point dequeued) noexcept
+    -> std::chrono::nanoseconds
+{
+    // Unwrap the 32 bit millisecond counter. Events may arrive slightly out of timestamp order, the signed
+    // difference handles both that and the wrap around.
+    const auto server_time32 = static_cast<std::uint32_t>(server_time);
+    if (!m_synced)
+    {
+        m_synced = true;
+        m_server_ms = server_time32;
+    }
+    else
+    {
+        m_server_ms += static_cast<std::int32_t>(server_time32 - static_cast<std::uint32_t>(m_last_server_time));
+    }
+    m_last_server_time = server_time32;
+
+    const std::int64_t local_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(dequeued.time_since_epoch()).count();
+    const std::int64_t sample = local_ns - (m_server_ms * kNanosecondsPerMillisecond);
+
+    if (m_current_offset_ns == kNoOffset ||
+        local_ns - m_window_start_ns >= std::chrono::nanoseconds(kOffsetWindow).count())
+    {
+        m_previous_offset_ns = m_current_offset_ns;
+        m_current_offset_ns = sample;
+        m_window_start_ns = local_ns;
+    }
+    else
+    {
+        m_current_offset_ns = std::min(m_current_offset_ns, sample);
+    }
+
+    const std::int64_t offset = std::min(m_current_offset_ns, m_previous_offset_ns);
+    return std::chrono::nanoseconds(sample - offset);
+}
+
+auto X11ServerClock::Reset() noexcept -> void
+{
+    *this = X11ServerClock();
+}
+
+auto X11EventLatency::TracksQueueLatency(const std::int32_t xlib_event_type) noexcept -> bool
+{
+    return xlib_event_type >= KeyPress && xlib_event_type <= LeaveNotify;
+}
+
+auto X11EventLatency::RecordDequeue(const XEvent &event, const std::chrono::steady_clock::time_point dequeued) noexcept
+    -> void
+{
+    if (!TracksQueueLatency(event.type) || event.xany.send_event != False)
+    {
+        return;
+    }
+
+    const Time server_time = EventTimeFromXlibEvent(event);
+    if (server_time == CurrentTime)
+    {
+        return;
+    }
+
+    const auto latency = m_clock.QueueLatency(server_time, dequeued);
+    m_queue[static_cast<std::size_t>(event.type) - kFirstQueueType].Record(static_cast<std::uint64_t>(latency.count()));
+}
+
+auto X11EventLatency::RecordHandler(const std::size_t event_index, const std::chrono::nanoseconds elapsed) noexcept
+    -> void
+{
+    if (event_index < m_handler.size())
+    {
+        m_handler[event_index].Record(static_cast<std::uint64_t>(std::max<std::int64_t>(elapsed.count(), 0)));
+    }
+}
+
+auto X11EventLatency::QueueLatency(const X11EventType event_type) const noexcept -> const LatencyHistogram &
+{
+    const auto type = static_cast<std::int32_t>(event_type);
+    return TracksQueueLatency(type) ? m_queue[static_cast<std::size_t>(type) - kFirstQueueType] : m_empty;
+}
+
+auto X11EventLatency::HandlerTime(const X11EventType event_type) const noexcept -> const LatencyHistogram &
+{
+    const auto index = static_cast<std::size_t>(event_type);
+    return index < m_handler.size() ? m_handler[index] : m_empty;
+}
+
+auto X11EventLatency::Reset() noexcept -> void
+{
+    for (auto &histogram : m_queue)
+    {
+        histogram.Reset();
+    }
+    for (auto &histogram : m_handler)
+    {
+        histogram.Reset();
+    }
+}
+
+auto X11EventLatency::Report() const -> std::string
+{
+    std::string out;
+    for (std::size_t i = 0; i < m_queue.size(); ++i)
+    {
+        AppendHistogram(out, "queue", static_cast<X11EventType>(kFirstQueueType + i), m_queue[i]);
+    }
+    for (std::size_t i = 0; i < m_handler.size(); ++i)
+    {
+        AppendHistogram(out, "handler", static_cast<X11EventType>(i), m_handler[i]);
+    }
+    return out;
+}
+
+} // namespace Tilebox
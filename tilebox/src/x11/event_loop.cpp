@@ -1,43 +1,1055 @@
 #include "tilebox/x11/event_loop.hpp"
+#include "tilebox/error.hpp"
+#include "tilebox/geometry.hpp"
+#include "tilebox/utils/unique_fd.hpp"
+#include "tilebox/x11/async.hpp"
+#include "tilebox/x11/damage.hpp"
 #include "tilebox/x11/display.hpp"
+#include "tilebox/x11/event_coalescer.hpp"
+#include "tilebox/x11/event_latency.hpp"
+#include "tilebox/x11/event_recorder.hpp"
 #include "tilebox/x11/events.hpp"
+#include "tilebox/x11/property_cache.hpp"
+#include "tilebox/x11/traffic.hpp"
 
 #include <X11/Xlib.h>
+#include <etl.hpp>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
 #include <cstdint>
+#include <ctime>
 #include <fmt/base.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
 #include <utility>
 
+using namespace etl;
+
 namespace Tilebox
 {
 
-X11EventLoop::X11EventLoop(X11DisplaySharedResource dpy) noexcept : _dpy(std::move(dpy))
+namespace
+{
+
+/// @brief Upper bound of ready descriptors handled per epoll_wait call.
+constexpr std::size_t kMaxPollEvents = 16;
+
+/// @brief Upper bound of posted tasks run per wake up, so a flood of posts cannot starve X event handling.
+constexpr std::size_t kMaxPostedTasksPerWakeUp = 256;
+
+/// @brief Upper bound of X events dispatched before other sources get a look, so a steady stream of events, e.g. a
+/// drag, cannot starve posted tasks, timers or signals. A batch is never split, it counts as a whole.
+constexpr std::size_t kMaxEventsPerDrain = 256;
+
+auto ToTimespec(const std::chrono::milliseconds duration) noexcept -> timespec
+{
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - seconds);
+    return {static_cast<std::time_t>(seconds.count()), static_cast<long>(nanoseconds.count())};
+}
+
+auto ErrnoMessage(const std::string &prefix) -> std::string
+{
+    return prefix + ": " + std::system_category().message(errno);
+}
+
+/// @brief Frees the data of a GenericEvent cookie on scope exit, even if the handler throws.
+class EventDataGuard
+{
+  public:
+    /// @param dpy The connection the data was fetched from, nullptr if someone else frees it.
+    EventDataGuard(Display *dpy, XGenericEventCookie *cookie) noexcept : m_dpy(dpy), m_cookie(cookie)
+    {
+    }
+
+    ~EventDataGuard()
+    {
+        if (m_dpy != nullptr)
+        {
+            XFreeEventData(m_dpy, m_cookie);
+        }
+    }
+
+    EventDataGuard(const EventDataGuard &rhs) = delete;
+    EventDataGuard(EventDataGuard &&rhs) = delete;
+    auto operator=(const EventDataGuard &rhs) -> EventDataGuard & = delete;
+    auto operator=(EventDataGuard &&rhs) -> EventDataGuard & = delete;
+
+  private:
+    Display *m_dpy;
+    XGenericEventCookie *m_cookie;
+};
+
+/// @brief Takes the next event off the Xlib queue, fetching the data of a GenericEvent right away.
+///
+/// @details Every XNextEvent frees the data of earlier cookies nobody fetched, so the GenericEvents of a batch would
+/// lose theirs before being dispatched. The caller frees the data with XFreeEventData.
+auto NextEventWithData(Display *dpy, XEvent &event) -> void
+{
+    XNextEvent(dpy, &event);
+    if (event.type == GenericEvent)
+    {
+        XGetEventData(dpy, &event.xcookie);
+    }
+}
+
+} // namespace
+
+X11EventLoop::X11EventLoop(X11DisplaySharedResource dpy)
+    : _dpy(std::move(dpy)), _posted(std::make_unique<PostedTasks>())
 {
+    // Without the descriptor posted tasks still run, but only once something else wakes the loop.
+    _posted->wakeup_fd.Reset(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
 }
 
 auto X11EventLoop::RegisterEventHandler(const X11EventType event_type, X11EventCallback callback) -> void
 {
-    if (!_event_handlers.contains(event_type))
+    const auto index = static_cast<std::size_t>(event_type);
+    if (index >= _event_handlers.size())
+    {
+        // FIXME: Remove call to fmt::println, return Result<Void, SomeError> instead
+        fmt::println("Could not insert event handler for X11 event type: {}", static_cast<std::int32_t>(event_type));
+        return;
+    }
+
+    if (!_event_handlers[index])
+    {
+        _event_handlers[index] = std::move(callback);
+    }
+}
+
+auto X11EventLoop::RegisterWindowEventHandler(const X11EventType event_type, const Window window,
+                                              X11EventCallback callback) -> void
+{
+    const auto index = static_cast<std::size_t>(event_type);
+    if (index >= _event_handlers.size() || window == None || !callback)
+    {
+        return;
+    }
+
+    const std::uint64_t key = WindowHandlerKey(index, window);
+    if (!_window_handlers.Contains(key))
+    {
+        ++_window_handler_counts[index];
+    }
+    _window_handlers.InsertOrAssign(key, std::move(callback));
+}
+
+auto X11EventLoop::UnregisterWindowEventHandler(const X11EventType event_type, const Window window) -> void
+{
+    const auto index = static_cast<std::size_t>(event_type);
+    if (index < _event_handlers.size() && _window_handlers.Erase(WindowHandlerKey(index, window)))
+    {
+        --_window_handler_counts[index];
+    }
+}
+
+auto X11EventLoop::UnregisterWindowEventHandlers(const Window window) -> void
+{
+    for (std::size_t index = 0; index < _window_handler_counts.size() && !_window_handlers.Empty(); ++index)
+    {
+        if (_window_handler_counts[index] > 0 && _window_handlers.Erase(WindowHandlerKey(index, window)))
+        {
+            --_window_handler_counts[index];
+        }
+    }
+}
+
+auto X11EventLoop::RegisterGenericEventHandler(const std::int32_t extension, const std::int32_t evtype,
+                                               X11GenericEventCallback callback) -> void
+{
+    if (callback)
+    {
+        _generic_handlers.InsertOrAssign(GenericHandlerKey(extension, evtype), std::move(callback));
+    }
+}
+
+auto X11EventLoop::UnregisterGenericEventHandler(const std::int32_t extension, const std::int32_t evtype) -> void
+{
+    _generic_handlers.Erase(GenericHandlerKey(extension, evtype));
+}
+
+auto X11EventLoop::RegisterDamageHandler(const Window window, X11DamageCallback callback) -> void
+{
+    _damage.Track(window, std::move(callback));
+    _coalescer.SetExposeMerging(_damage.Empty());
+}
+
+auto X11EventLoop::UnregisterDamageHandler(const Window window) -> void
+{
+    _damage.Untrack(window);
+    _coalescer.SetExposeMerging(_damage.Empty());
+}
+
+auto X11EventLoop::FlushDamage() -> void
+{
+    _damage.FlushAll();
+}
+
+auto X11EventLoop::WatchMonitors(X11MonitorCallback on_change) -> bool
+{
+    if (_dpy == nullptr || !_dpy->SelectMonitorEvents())
+    {
+        return false;
+    }
+
+    _watching_monitors = true;
+    _on_monitors_changed = std::move(on_change);
+    return true;
+}
+
+auto X11EventLoop::Dispatch(XEvent *event) -> void
+{
+    // X11EventType mirrors the Xlib event numbering, so the raw type doubles as the table index.
+    // Negative values wrap around and fail the bounds check along with extension events.
+    const auto index = static_cast<std::size_t>(event->type);
+    if (index >= _event_handlers.size())
+    {
+        // RandR numbers its events past the core range
+        if (_watching_monitors && _dpy->HandleMonitorEvent(event) && _on_monitors_changed)
+        {
+            const X11MonitorCallback callback = _on_monitors_changed;
+            callback(_dpy->Monitors());
+        }
+        return;
+    }
+
+    // Ahead of every handler, a per window DestroyNotify handler would otherwise hide the destruction from the cache
+    if (_property_cache != nullptr && (event->type == PropertyNotify || event->type == DestroyNotify))
+    {
+        _property_cache->HandleEvent(*event);
+    }
+
+    if (event->type == GenericEvent && !_generic_handlers.Empty() && DispatchGeneric(event))
+    {
+        return;
+    }
+
+    if (!_damage.Empty() && TrackDamage(*event))
     {
-        if (auto [iter, was_inserted] = _event_handlers.emplace(event_type, std::move(callback)); !was_inserted)
+        return;
+    }
+
+    if (_window_handler_counts[index] > 0)
+    {
+        const Window window = EventWindowFromXlibEvent(*event);
+        if (const X11EventCallback *handler = _window_handlers.Find(WindowHandlerKey(index, window));
+            handler != nullptr)
         {
-            // FIXME: Remove call to fmt::println, return Result<Void, SomeError> instead
-            fmt::println("Could not insert event handler for X11 event type: {}",
-                         static_cast<std::int32_t>(event_type));
+            // Invoke a copy, the handler may (un)register window handlers and move the map slots around.
+            const X11EventCallback callback = *handler;
+            InvokeHandler(index, callback, event);
+
+            if (event->type == DestroyNotify)
+            {
+                UnregisterWindowEventHandlers(window);
+            }
+            return;
         }
     }
+
+    if (const auto &handler = _event_handlers[index]; handler)
+    {
+        InvokeHandler(index, handler, event);
+    }
+
+    if (event->type == DestroyNotify && !_window_handlers.Empty())
+    {
+        UnregisterWindowEventHandlers(event->xdestroywindow.window);
+    }
+}
+
+auto X11EventLoop::SetEventBatching(const bool enabled) noexcept -> void
+{
+    _batching = enabled;
+}
+
+auto X11EventLoop::IsEventBatching() const noexcept -> bool
+{
+    return _batching;
+}
+
+auto X11EventLoop::CoalesceStats() const noexcept -> const X11CoalesceStats &
+{
+    return _coalescer.Stats();
+}
+
+auto X11EventLoop::SetLatencyTracking(const bool enabled) -> void
+{
+    if (!enabled)
+    {
+        _latency.reset();
+    }
+    else if (_latency == nullptr)
+    {
+        _latency = std::make_unique<X11EventLatency>();
+    }
+}
+
+auto X11EventLoop::IsLatencyTracking() const noexcept -> bool
+{
+    return _latency != nullptr;
+}
+
+auto X11EventLoop::LatencyStats() const noexcept -> const X11EventLatency *
+{
+    return _latency.get();
+}
+
+auto X11EventLoop::ResetLatencyStats() noexcept -> void
+{
+    if (_latency != nullptr)
+    {
+        _latency->Reset();
+    }
+}
+
+auto X11EventLoop::SetTrafficTracking(const bool enabled) -> void
+{
+    if (!enabled)
+    {
+        _traffic.reset();
+    }
+    else if (_traffic == nullptr)
+    {
+        _traffic = std::make_unique<X11EventTraffic>();
+    }
+}
+
+auto X11EventLoop::IsTrafficTracking() const noexcept -> bool
+{
+    return _traffic != nullptr;
+}
+
+auto X11EventLoop::TrafficStats() const noexcept -> const X11EventTraffic *
+{
+    return _traffic.get();
+}
+
+auto X11EventLoop::ResetTrafficStats() noexcept -> void
+{
+    if (_traffic != nullptr)
+    {
+        _traffic->Reset();
+    }
+}
+
+auto X11EventLoop::SetEventRecorder(X11EventRecorder *recorder) noexcept -> void
+{
+    _recorder = recorder;
+}
+
+auto X11EventLoop::SetPropertyCache(X11PropertyCache *cache) noexcept -> void
+{
+    _property_cache = cache;
+}
+
+auto X11EventLoop::SetAsyncConnection(X11AsyncConnection *async) noexcept -> void
+{
+    _async = async;
+}
+
+auto X11EventLoop::Post(X11PostedTask task) -> void
+{
+    _posted->queue.Push(std::move(task));
+    WakeUp();
+}
+
+auto X11EventLoop::ScheduleIdle(const X11IdleKey key, X11IdleCallback callback) -> void
+{
+    if (key == 0 || !callback)
+    {
+        return;
+    }
+
+    if (const std::size_t *slot = _idle_slots.Find(key); slot != nullptr)
+    {
+        _idle[*slot].callback = std::move(callback);
+        return;
+    }
+
+    _idle_slots.InsertOrAssign(key, _idle.size());
+    _idle.push_back({key, std::move(callback)});
+}
+
+auto X11EventLoop::CancelIdle(const X11IdleKey key) -> void
+{
+    if (const std::size_t *slot = _idle_slots.Find(key); slot != nullptr)
+    {
+        // The slot stays in line empty, and is skipped once reached
+        _idle[*slot].callback = nullptr;
+        _idle_slots.Erase(key);
+    }
+}
+
+auto X11EventLoop::IsIdleScheduled(const X11IdleKey key) const noexcept -> bool
+{
+    return key != 0 && _idle_slots.Contains(key);
+}
+
+auto X11EventLoop::PendingIdleWork() const noexcept -> std::size_t
+{
+    return _idle_slots.Size();
+}
+
+auto X11EventLoop::SetIdleBudget(const std::chrono::microseconds budget) noexcept -> void
+{
+    _idle_budget = budget;
+}
+
+auto X11EventLoop::RunIdleWork() -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + _idle_budget;
+
+    // Work scheduled by the callbacks themselves lands past `end` and waits for the next slice.
+    const std::size_t end = _idle.size();
+    while (_idle_head < end)
+    {
+        IdleTask &task = _idle[_idle_head++];
+        if (!task.callback)
+        {
+            continue;
+        }
+
+        // Moved out first, the callback may schedule idle work and reallocate the queue.
+        const X11IdleCallback callback = std::move(task.callback);
+        _idle_slots.Erase(task.key);
+        callback();
+
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+
+    CompactIdleQueue();
+    return !_idle_slots.Empty();
+}
+
+auto X11EventLoop::Run(const bool &run_flag) -> void
+{
+    Display *dpy = _dpy->Raw();
+    const std::int32_t x_fd = ConnectionNumber(dpy);
+
+    std::size_t dispatched = 0;
+    while (run_flag)
+    {
+        // XPending flushes and reads without blocking, only an empty queue makes it safe to wait on the socket.
+        if (XPending(dpy) == 0)
+        {
+            dispatched = 0;
+
+            // A drained queue ends every expose burst still open, repainting may queue requests or read in more
+            // events so go around again and let XPending flush and look before blocking.
+            if (_damage.HasPending())
+            {
+                _damage.FlushAll();
+                continue;
+            }
+
+            // Idle work runs a slice at a time and keeps the wait from blocking until it is done.
+            std::int32_t timeout_ms = -1;
+            if (!_idle_slots.Empty())
+            {
+                RunIdleWork();
+                timeout_ms = 0;
+            }
+
+            if (WaitForInput(x_fd, timeout_ms))
+            {
+                RunPostedTasks();
+                continue;
+            }
+        }
+
+        // The queue may never drain while events keep coming, so posted tasks are also looked at every so often.
+        dispatched += DispatchNext(run_flag);
+        if (dispatched >= kMaxEventsPerDrain)
+        {
+            dispatched = 0;
+            if (_posted->wakeup_pending.load(std::memory_order_acquire))
+            {
+                RunPostedTasks();
+            }
+        }
+    }
+}
+
+auto X11EventLoop::AddTimer(const std::chrono::milliseconds initial, const std::chrono::milliseconds interval,
+                            X11TimerCallback callback) -> Result<X11TimerId, X11EventLoopError>
+{
+    if (initial.count() <= 0 || interval.count() < 0)
+    {
+        return Result<X11TimerId, X11EventLoopError>(
+            X11EventLoopError("AddTimer: initial delay must be positive and interval non negative", RUNTIME_INFO));
+    }
+
+    UniqueFd timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+    if (!timer_fd.IsValid())
+    {
+        return Result<X11TimerId, X11EventLoopError>(X11EventLoopError(ErrnoMessage("timerfd_create"), RUNTIME_INFO));
+    }
+
+    const itimerspec spec{.it_interval = ToTimespec(interval), .it_value = ToTimespec(initial)};
+    if (timerfd_settime(timer_fd.Get(), 0, &spec, nullptr) != 0)
+    {
+        return Result<X11TimerId, X11EventLoopError>(X11EventLoopError(ErrnoMessage("timerfd_settime"), RUNTIME_INFO));
+    }
+
+    const X11TimerId timer_id = timer_fd.Get();
+    if (!AddPollSource(timer_id, EPOLLIN))
+    {
+        return Result<X11TimerId, X11EventLoopError>(X11EventLoopError(ErrnoMessage("epoll_ctl"), RUNTIME_INFO));
+    }
+
+    _poll_sources.push_back({timer_id, PollSourceKind::Timer, std::move(timer_fd), std::move(callback), nullptr});
+    return Result<X11TimerId, X11EventLoopError>(timer_id);
 }
 
-auto X11EventLoop::Run(const bool &run_flag) const -> void
+auto X11EventLoop::RemoveTimer(const X11TimerId timer_id) -> void
 {
+    if (const PollSource *source = FindPollSource(timer_id); source != nullptr && source->kind == PollSourceKind::Timer)
+    {
+        RemovePollSource(timer_id);
+    }
+}
+
+auto X11EventLoop::WatchSignal(const std::int32_t signal_number, X11SignalCallback callback)
+    -> Result<Void, X11EventLoopError>
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (const auto &watch : _signal_watches)
+    {
+        sigaddset(&mask, watch.signal_number);
+    }
+    if (sigaddset(&mask, signal_number) != 0)
+    {
+        return Result<Void, X11EventLoopError>(X11EventLoopError(ErrnoMessage("sigaddset"), RUNTIME_INFO));
+    }
+
+    // The signal must be blocked, otherwise it is delivered the old fashioned way instead of through the signalfd.
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0)
+    {
+        return Result<Void, X11EventLoopError>(
+            X11EventLoopError("pthread_sigmask: failed to block signal", RUNTIME_INFO));
+    }
+
+    // Passing an existing signalfd replaces its mask, so one descriptor serves every watched signal.
+    const bool is_new = !_signal_fd.IsValid();
+    const std::int32_t signal_fd = signalfd(_signal_fd.Get(), &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd < 0)
+    {
+        return Result<Void, X11EventLoopError>(X11EventLoopError(ErrnoMessage("signalfd"), RUNTIME_INFO));
+    }
+
+    if (is_new)
+    {
+        _signal_fd.Reset(signal_fd);
+        if (!AddPollSource(signal_fd, EPOLLIN))
+        {
+            _signal_fd.Reset();
+            return Result<Void, X11EventLoopError>(X11EventLoopError(ErrnoMessage("epoll_ctl"), RUNTIME_INFO));
+        }
+        _poll_sources.push_back({signal_fd, PollSourceKind::Signal, UniqueFd(), nullptr, nullptr});
+    }
+
+    if (auto iter =
+            std::find_if(_signal_watches.begin(), _signal_watches.end(),
+                         [&](const SignalWatch &watch) -> bool { return watch.signal_number == signal_number; });
+        iter != _signal_watches.end())
+    {
+        iter->callback = std::move(callback);
+    }
+    else
+    {
+        _signal_watches.push_back({signal_number, std::move(callback)});
+    }
+
+    return Result<Void, X11EventLoopError>(Void());
+}
+
+auto X11EventLoop::WatchFileDescriptor(const std::int32_t fd, const std::uint32_t epoll_events, X11FdCallback callback)
+    -> Result<Void, X11EventLoopError>
+{
+    if (FindPollSource(fd) != nullptr)
+    {
+        return Result<Void, X11EventLoopError>(
+            X11EventLoopError("WatchFileDescriptor: descriptor is already watched", RUNTIME_INFO));
+    }
+
+    if (!AddPollSource(fd, epoll_events))
+    {
+        return Result<Void, X11EventLoopError>(X11EventLoopError(ErrnoMessage("epoll_ctl"), RUNTIME_INFO));
+    }
+
+    _poll_sources.push_back({fd, PollSourceKind::FileDescriptor, UniqueFd(), nullptr, std::move(callback)});
+    return Result<Void, X11EventLoopError>(Void());
+}
+
+auto X11EventLoop::UnwatchFileDescriptor(const std::int32_t fd) -> void
+{
+    if (const PollSource *source = FindPollSource(fd);
+        source != nullptr && source->kind == PollSourceKind::FileDescriptor)
+    {
+        RemovePollSource(fd);
+    }
+}
+
+auto X11EventLoop::RunPolled(const bool &run_flag) -> Result<Void, X11EventLoopError>
+{
+    Display *dpy = _dpy->Raw();
+    const std::int32_t x_fd = ConnectionNumber(dpy);
+
+    if (!_x_connection_watched)
+    {
+        if (!AddPollSource(x_fd, EPOLLIN))
+        {
+            return Result<Void, X11EventLoopError>(X11EventLoopError(ErrnoMessage("epoll_ctl"), RUNTIME_INFO));
+        }
+        _x_connection_watched = true;
+    }
+
+    const std::int32_t wakeup_fd = _posted->wakeup_fd.Get();
+    if (!_posted_watched && wakeup_fd >= 0)
+    {
+        if (!AddPollSource(wakeup_fd, EPOLLIN))
+        {
+            return Result<Void, X11EventLoopError>(X11EventLoopError(ErrnoMessage("epoll_ctl"), RUNTIME_INFO));
+        }
+        _posted_watched = true;
+    }
+
+    std::array<epoll_event, kMaxPollEvents> ready{};
+    while (run_flag)
+    {
+        // XPending flushes the output buffer and reads whatever the socket holds without blocking. Events can also
+        // land in Xlib's queue during a round trip made by any callback, so the queue is checked again after every
+        // dispatch. Only once it reports nothing is it safe to sleep on the socket.
+        std::size_t dispatched = 0;
+        bool progressed = true;
+        while (run_flag && progressed && dispatched < kMaxEventsPerDrain)
+        {
+            while (run_flag && dispatched < kMaxEventsPerDrain && XPending(dpy) > 0)
+            {
+                dispatched += DispatchNext(run_flag);
+            }
+
+            // Resumed coroutines may issue requests or cause events, and polling for replies reads the socket
+            // behind Xlib's back, so go around again until neither side has anything left.
+            progressed = run_flag && _async != nullptr && (_async->ProcessReplies() || XPending(dpy) > 0);
+        }
+
+        if (!run_flag)
+        {
+            break;
+        }
+
+        // With the budget spent the queue may never drain while events keep coming. The other sources only get a
+        // non blocking look then, and the queue is read again right after.
+        std::int32_t timeout_ms = 0;
+        if (dispatched < kMaxEventsPerDrain)
+        {
+            // A drained queue ends every expose burst still open, repainting may queue more events so go around
+            // again.
+            if (_damage.HasPending())
+            {
+                _damage.FlushAll();
+                continue;
+            }
+
+            // Idle work runs a slice at a time once nothing else is queued. It may have issued requests or pulled
+            // events into Xlib's queue, so only peek at the other sources and go around again instead of sleeping.
+            timeout_ms = -1;
+            if (!_idle_slots.Empty())
+            {
+                RunIdleWork();
+                timeout_ms = 0;
+            }
+        }
+
+        if (_async != nullptr)
+        {
+            _async->Flush();
+        }
+
+        const std::int32_t count =
+            epoll_wait(_epoll.Get(), ready.data(), static_cast<std::int32_t>(ready.size()), timeout_ms);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return Result<Void, X11EventLoopError>(X11EventLoopError(ErrnoMessage("epoll_wait"), RUNTIME_INFO));
+        }
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(count) && run_flag; ++i)
+        {
+            // The X connection itself needs no work here, the XPending loop above picks it up.
+            if (ready[i].data.fd == wakeup_fd)
+            {
+                RunPostedTasks();
+            }
+            else if (ready[i].data.fd != x_fd)
+            {
+                DispatchPollSource(ready[i].data.fd, ready[i].events);
+            }
+        }
+    }
+
+    return Result<Void, X11EventLoopError>(Void());
+}
+
+/// Private
+
+auto X11EventLoop::WindowHandlerKey(const std::size_t index, const Window window) noexcept -> std::uint64_t
+{
+    // XIDs use at most 29 bits, leaving plenty of room for the event type in the low byte.
+    return (static_cast<std::uint64_t>(window) << 8U) | static_cast<std::uint64_t>(index);
+}
+
+auto X11EventLoop::GenericHandlerKey(const std::int32_t extension, const std::int32_t evtype) noexcept
+    -> std::uint64_t
+{
+    // Extension opcodes start at 128, so the key is never zero.
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(extension)) << 32U) |
+           static_cast<std::uint64_t>(static_cast<std::uint32_t>(evtype));
+}
+
+auto X11EventLoop::AddPollSource(const std::int32_t fd, const std::uint32_t epoll_events) -> bool
+{
+    if (!_epoll.IsValid())
+    {
+        _epoll.Reset(epoll_create1(EPOLL_CLOEXEC));
+        if (!_epoll.IsValid())
+        {
+            return false;
+        }
+    }
+
+    epoll_event event{};
+    event.events = epoll_events;
+    event.data.fd = fd;
+    return epoll_ctl(_epoll.Get(), EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+auto X11EventLoop::FindPollSource(const std::int32_t fd) noexcept -> PollSource *
+{
+    const auto iter = std::find_if(_poll_sources.begin(), _poll_sources.end(),
+                                   [&](const PollSource &source) -> bool { return source.fd == fd; });
+    return iter != _poll_sources.end() ? &(*iter) : nullptr;
+}
+
+auto X11EventLoop::RemovePollSource(const std::int32_t fd) -> void
+{
+    if (_epoll.IsValid())
+    {
+        epoll_ctl(_epoll.Get(), EPOLL_CTL_DEL, fd, nullptr);
+    }
+    std::erase_if(_poll_sources, [&](const PollSource &source) -> bool { return source.fd == fd; });
+}
+
+auto X11EventLoop::DispatchPollSource(const std::int32_t fd, const std::uint32_t epoll_events) -> void
+{
+    const PollSource *source = FindPollSource(fd);
+    if (source == nullptr)
+    {
+        // Removed by an earlier callback in the same wake up
+        return;
+    }
+
+    // Callbacks are copied before being invoked, since they may add or remove sources and
+    // reallocate the source list underneath themselves.
+    switch (source->kind)
+    {
+    case PollSourceKind::Timer: {
+        std::uint64_t expirations = 0;
+        if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations) && source->on_timer)
+        {
+            const X11TimerCallback callback = source->on_timer;
+            callback();
+        }
+        break;
+    }
+    case PollSourceKind::Signal: {
+        DispatchSignals();
+        break;
+    }
+    case PollSourceKind::FileDescriptor: {
+        if (source->on_ready)
+        {
+            const X11FdCallback callback = source->on_ready;
+            callback(epoll_events);
+        }
+        break;
+    }
+    }
+}
+
+auto X11EventLoop::DispatchSignals() -> void
+{
+    signalfd_siginfo info{};
+    while (read(_signal_fd.Get(), &info, sizeof(info)) == sizeof(info))
+    {
+        const auto signal_number = static_cast<std::int32_t>(info.ssi_signo);
+        const auto iter =
+            std::find_if(_signal_watches.begin(), _signal_watches.end(),
+                         [&](const SignalWatch &watch) -> bool { return watch.signal_number == signal_number; });
+        if (iter != _signal_watches.end() && iter->callback)
+        {
+            const X11SignalCallback callback = iter->callback;
+            callback(signal_number);
+        }
+    }
+}
+
+auto X11EventLoop::WakeUp() noexcept -> void
+{
+    if (!_posted->wakeup_pending.exchange(true, std::memory_order_acq_rel) && _posted->wakeup_fd.IsValid())
+    {
+        const std::uint64_t one = 1;
+        static_cast<void>(write(_posted->wakeup_fd.Get(), &one, sizeof(one)));
+    }
+}
+
+auto X11EventLoop::RunPostedTasks() -> void
+{
+    std::uint64_t wake_ups = 0;
+    static_cast<void>(read(_posted->wakeup_fd.Get(), &wake_ups, sizeof(wake_ups)));
+
+    // Cleared before draining, so a post racing with the drain either lands in it or writes a fresh wake up.
+    _posted->wakeup_pending.exchange(false, std::memory_order_acq_rel);
+
+    for (std::size_t i = 0; i < kMaxPostedTasksPerWakeUp; ++i)
+    {
+        auto task = _posted->queue.Pop();
+        if (!task.has_value())
+        {
+            return;
+        }
+        if (*task)
+        {
+            (*task)();
+        }
+    }
+
+    if (!_posted->queue.Empty())
+    {
+        WakeUp();
+    }
+}
+
+auto X11EventLoop::WaitForInput(const std::int32_t x_fd, const std::int32_t timeout_ms) const noexcept -> bool
+{
+    // A negative descriptor is ignored by poll, should the eventfd be missing.
+    std::array<pollfd, 2> fds = {{{x_fd, POLLIN, 0}, {_posted->wakeup_fd.Get(), POLLIN, 0}}};
+    while (poll(fds.data(), fds.size(), timeout_ms) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto X11EventLoop::CompactIdleQueue() -> void
+{
+    if (_idle_head == _idle.size())
+    {
+        _idle.clear();
+        _idle_head = 0;
+        return;
+    }
+
+    // Amortised, slots only move once the consumed prefix is as long as the rest
+    if (_idle_head < _idle.size() - _idle_head)
+    {
+        return;
+    }
+
+    _idle.erase(_idle.begin(), _idle.begin() + static_cast<std::ptrdiff_t>(_idle_head));
+    _idle_head = 0;
+    for (std::size_t i = 0; i < _idle.size(); ++i)
+    {
+        if (_idle[i].callback)
+        {
+            _idle_slots.InsertOrAssign(_idle[i].key, i);
+        }
+    }
+}
+
+auto X11EventLoop::DispatchNext(const bool &run_flag) -> std::size_t
+{
+    if (_batching)
+    {
+        return DispatchBatch(run_flag);
+    }
+
     XEvent event;
-    while (run_flag && (XNextEvent(_dpy->Raw(), &event) == 0))
+    XNextEvent(_dpy->Raw(), &event);
+    OnDequeued(event, std::chrono::steady_clock::now());
+    Dispatch(&event);
+    return 1;
+}
+
+auto X11EventLoop::DispatchBatch(const bool &run_flag) -> std::size_t
+{
+    Display *dpy = _dpy->Raw();
+
+    _batch.resize(1);
+    NextEventWithData(dpy, _batch.front());
+
+    // Only what has already been read off the socket, or can be read without blocking, joins the batch.
+    if (const auto queued = XEventsQueued(dpy, QueuedAfterReading); queued > 0)
+    {
+        _batch.resize(1 + static_cast<std::size_t>(queued));
+        for (std::size_t i = 1; i < _batch.size(); ++i)
+        {
+            NextEventWithData(dpy, _batch[i]);
+        }
+    }
+
+    // Every event of the batch left the queue now, even the ones coalescing is about to drop.
+    const auto dequeued = std::chrono::steady_clock::now();
+    for (const XEvent &event : _batch)
+    {
+        OnDequeued(event, dequeued);
+    }
+
+    // Coalescing never drops GenericEvents, so every fetched cookie is among the survivors.
+    const std::size_t survivors = _coalescer.Coalesce(std::span<XEvent>(_batch));
+    for (std::size_t i = 0; i < survivors && run_flag; ++i)
+    {
+        Dispatch(&_batch[i]);
+    }
+
+    for (std::size_t i = 0; i < survivors; ++i)
     {
-        if (const X11EventType event_type = EventFromXlibEvent(event.type); _event_handlers.contains(event_type))
+        if (_batch[i].type == GenericEvent)
         {
-            _event_handlers.at(event_type)(&event);
+            XFreeEventData(dpy, &_batch[i].xcookie);
         }
     }
+    return _batch.size();
+}
+
+auto X11EventLoop::OnDequeued(const XEvent &event, const std::chrono::steady_clock::time_point dequeued) -> void
+{
+    if (_latency != nullptr)
+    {
+        _latency->RecordDequeue(event, dequeued);
+    }
+    if (_recorder != nullptr)
+    {
+        _recorder->Record(event, dequeued);
+    }
+}
+
+auto X11EventLoop::DispatchGeneric(XEvent *event) -> bool
+{
+    XGenericEventCookie &cookie = event->xcookie;
+    const X11GenericEventCallback *handler = _generic_handlers.Find(GenericHandlerKey(cookie.extension, cookie.evtype));
+    if (handler == nullptr)
+    {
+        return false;
+    }
+
+    // Batched dispatch fetched the data on dequeue and frees it itself. Otherwise it is fetched here, without a
+    // display, e.g. on replay, it can not be and the event is dropped.
+    const bool fetched = cookie.data != nullptr;
+    if (!fetched && (_dpy == nullptr || XGetEventData(_dpy->Raw(), &cookie) == False))
+    {
+        return true;
+    }
+
+    const EventDataGuard guard(fetched ? nullptr : _dpy->Raw(), &cookie);
+    const X11GenericEventCallback callback = *handler;
+    InvokeHandler(static_cast<std::size_t>(GenericEvent), callback, static_cast<const XGenericEventCookie &>(cookie));
+    return true;
+}
+
+auto X11EventLoop::TrackDamage(const XEvent &event) -> bool
+{
+    switch (event.type)
+    {
+    case Expose:
+    case GraphicsExpose: {
+        const bool graphics = event.type == GraphicsExpose;
+        const Window window = graphics ? event.xgraphicsexpose.drawable : event.xexpose.window;
+        const Rect rect = graphics ? Rect(Point(X(event.xgraphicsexpose.x), Y(event.xgraphicsexpose.y)),
+                                          Width(static_cast<std::uint32_t>(event.xgraphicsexpose.width)),
+                                          Height(static_cast<std::uint32_t>(event.xgraphicsexpose.height)))
+                                   : Rect(Point(X(event.xexpose.x), Y(event.xexpose.y)),
+                                          Width(static_cast<std::uint32_t>(event.xexpose.width)),
+                                          Height(static_cast<std::uint32_t>(event.xexpose.height)));
+        if (!_damage.Add(window, rect))
+        {
+            return false;
+        }
+
+        // The server announces how many exposes of the same burst follow, the last one completes the region.
+        const std::int32_t remaining = graphics ? event.xgraphicsexpose.count : event.xexpose.count;
+        if (remaining == 0)
+        {
+            _damage.Flush(window);
+        }
+        return true;
+    }
+    case ConfigureNotify:
+        _damage.SetBounds(event.xconfigure.window, static_cast<std::uint32_t>(event.xconfigure.width),
+                          static_cast<std::uint32_t>(event.xconfigure.height));
+        return false;
+    case DestroyNotify:
+        if (_damage.IsTracked(event.xdestroywindow.window))
+        {
+            UnregisterDamageHandler(event.xdestroywindow.window);
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+template <typename Callback, typename Event>
+auto X11EventLoop::InvokeHandler(const std::size_t index, const Callback &handler, Event &&event) -> void
+{
+    if (_latency == nullptr && _traffic == nullptr)
+    {
+        handler(std::forward<Event>(event));
+        return;
+    }
+
+    const bool track_traffic = _traffic != nullptr && _dpy != nullptr;
+    const X11Traffic traffic = track_traffic ? _dpy->Traffic() : X11Traffic{};
+    const auto start = std::chrono::steady_clock::now();
+    handler(std::forward<Event>(event));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // The handler may have turned tracking off
+    if (_latency != nullptr)
+    {
+        _latency->RecordHandler(index, elapsed);
+    }
+    if (_traffic != nullptr)
+    {
+        _traffic->Record(index, track_traffic ? _dpy->Traffic() - traffic : X11Traffic{});
+    }
 }
 
 } // namespace Tilebox
@@ -0,0 +1,385 @@
+#include "tilebox/x11/event_recorder.hpp"
+#include "tilebox/error.hpp"
+#include "tilebox/utils/unique_fd.hpp"
+#include "tilebox/x11/event_loop.hpp"
+
+#include <X11/Xlib.h>
+#include <etl.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+using namespace etl;
+
+namespace Tilebox
+{
+
+namespace
+{
+
+/// @brief Buffered bytes that trigger a write to the recording file.
+constexpr std::size_t kFlushThreshold = 64 * 1024;
+
+/// @brief Records are padded to this alignment.
+constexpr std::size_t kRecordAlignment = 8;
+
+static_assert(sizeof(X11EventRecordFileHeader) % kRecordAlignment == 0);
+static_assert(sizeof(X11EventRecordHeader) % kRecordAlignment == 0);
+
+auto ErrnoMessage(const std::string &prefix) -> std::string
+{
+    return prefix + ": " + std::system_category().message(errno);
+}
+
+auto AlignRecord(const std::size_t size) noexcept -> std::size_t
+{
+    return (size + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+/// @brief Gets the size of the Xlib struct describing an event type, the whole XEvent for unknown types.
+auto RecordedEventSize(const std::int32_t type) noexcept -> std::size_t
+{
+    switch (type)
+    {
+    case KeyPress:
+    case KeyRelease:
+        return sizeof(XKeyEvent);
+    case ButtonPress:
+    case ButtonRelease:
+        return sizeof(XButtonEvent);
+    case MotionNotify:
+        return sizeof(XMotionEvent);
+    case EnterNotify:
+    case LeaveNotify:
+        return sizeof(XCrossingEvent);
+    case FocusIn:
+    case FocusOut:
+        return sizeof(XFocusChangeEvent);
+    case KeymapNotify:
+        return sizeof(XKeymapEvent);
+    case Expose:
+        return sizeof(XExposeEvent);
+    case GraphicsExpose:
+        return sizeof(XGraphicsExposeEvent);
+    case NoExpose:
+        return sizeof(XNoExposeEvent);
+    case VisibilityNotify:
+        return sizeof(XVisibilityEvent);
+    case CreateNotify:
+        return sizeof(XCreateWindowEvent);
+    case DestroyNotify:
+        return sizeof(XDestroyWindowEvent);
+    case UnmapNotify:
+        return sizeof(XUnmapEvent);
+    case MapNotify:
+        return sizeof(XMapEvent);
+    case MapRequest:
+        return sizeof(XMapRequestEvent);
+    case ReparentNotify:
+        return sizeof(XReparentEvent);
+    case ConfigureNotify:
+        return sizeof(XConfigureEvent);
+    case ConfigureRequest:
+        return sizeof(XConfigureRequestEvent);
+    case GravityNotify:
+        return sizeof(XGravityEvent);
+    case ResizeRequest:
+        return sizeof(XResizeRequestEvent);
+    case CirculateNotify:
+        return sizeof(XCirculateEvent);
+    case CirculateRequest:
+        return sizeof(XCirculateRequestEvent);
+    case PropertyNotify:
+        return sizeof(XPropertyEvent);
+    case SelectionClear:
+        return sizeof(XSelectionClearEvent);
+    case SelectionRequest:
+        return sizeof(XSelectionRequestEvent);
+    case SelectionNotify:
+        return sizeof(XSelectionEvent);
+    case ColormapNotify:
+        return sizeof(XColormapEvent);
+    case ClientMessage:
+        return sizeof(XClientMessageEvent);
+    case MappingNotify:
+        return sizeof(XMappingEvent);
+    default:
+        return sizeof(XEvent);
+    }
+}
+
+} // namespace
+
+////////////////////////////////////
+// X11EventRecorder
+////////////////////////////////////
+
+auto X11EventRecorder::Create(const std::string &path) noexcept -> Result<X11EventRecorder, X11EventRecordError>
+{
+    UniqueFd fd(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644)); // NOLINT
+    if (!fd.IsValid())
+    {
+        return Result<X11EventRecorder, X11EventRecordError>(
+            X11EventRecordError(ErrnoMessage("open " + path), RUNTIME_INFO));
+    }
+
+    X11EventRecorder recorder(std::move(fd));
+
+    const X11EventRecordFileHeader header{X11EventRecordFileHeader::kMagic, X11EventRecordFileHeader::kVersion,
+                                          static_cast<std::uint32_t>(sizeof(XEvent))};
+    recorder.m_buffer.resize(sizeof(header));
+    std::memcpy(recorder.m_buffer.data(), &header, sizeof(header));
+    if (auto res = recorder.Flush(); res.is_err())
+    {
+        return Result<X11EventRecorder, X11EventRecordError>(std::move(*res.err()));
+    }
+
+    return Result<X11EventRecorder, X11EventRecordError>(std::move(recorder));
+}
+
+X11EventRecorder::X11EventRecorder(UniqueFd &&fd) noexcept : m_fd(std::move(fd))
+{
+    m_buffer.reserve(kFlushThreshold + sizeof(X11EventRecordHeader) + sizeof(XEvent));
+}
+
+X11EventRecorder::~X11EventRecorder()
+{
+    static_cast<void>(Flush());
+}
+
+auto X11EventRecorder::operator=(X11EventRecorder &&rhs) noexcept -> X11EventRecorder &
+{
+    if (this != &rhs)
+    {
+        // Do not lose what is still buffered for the file being replaced
+        static_cast<void>(Flush());
+        m_fd = std::move(rhs.m_fd);
+        m_buffer = std::move(rhs.m_buffer);
+        m_start = rhs.m_start;
+        m_recorded = rhs.m_recorded;
+        m_skipped = rhs.m_skipped;
+        m_failed = rhs.m_failed;
+    }
+    return *this;
+}
+
+auto X11EventRecorder::Record(const XEvent &event, const std::chrono::steady_clock::time_point dequeued) -> void
+{
+    if (m_failed || !m_fd.IsValid())
+    {
+        return;
+    }
+
+    // The cookie alone replays as an event without data, which the loop drops.
+    if (event.type == GenericEvent)
+    {
+        ++m_skipped;
+        return;
+    }
+
+    if (!m_start.has_value())
+    {
+        m_start = dequeued;
+    }
+
+    const std::size_t size = RecordedEventSize(event.type);
+    const X11EventRecordHeader header{
+        static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(dequeued - *m_start).count()),
+        static_cast<std::uint32_t>(size), event.type};
+
+    // Padding is zero filled by resize, so recordings of the same session are byte for byte identical.
+    const std::size_t offset = m_buffer.size();
+    m_buffer.resize(offset + sizeof(header) + AlignRecord(size));
+    std::memcpy(m_buffer.data() + offset, &header, sizeof(header));
+    std::memcpy(m_buffer.data() + offset + sizeof(header), &event, size);
+
+    constexpr std::size_t display_offset = offsetof(XAnyEvent, display);
+    std::memset(m_buffer.data() + offset + sizeof(header) + display_offset, 0, sizeof(Display *));
+
+    ++m_recorded;
+    if (m_buffer.size() >= kFlushThreshold)
+    {
+        static_cast<void>(Flush());
+    }
+}
+
+auto X11EventRecorder::Flush() -> Result<Void, X11EventRecordError>
+{
+    if (m_failed)
+    {
+        return Result<Void, X11EventRecordError>(
+            X11EventRecordError("Recording stopped after an earlier write error", RUNTIME_INFO));
+    }
+
+    std::size_t written = 0;
+    while (m_fd.IsValid() && written < m_buffer.size())
+    {
+        const ssize_t res = write(m_fd.Get(), m_buffer.data() + written, m_buffer.size() - written);
+        if (res < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            m_failed = true;
+            m_buffer.clear();
+            return Result<Void, X11EventRecordError>(X11EventRecordError(ErrnoMessage("write"), RUNTIME_INFO));
+        }
+        written += static_cast<std::size_t>(res);
+    }
+
+    m_buffer.clear();
+    return Result<Void, X11EventRecordError>(Void());
+}
+
+auto X11EventRecorder::RecordedEvents() const noexcept -> std::uint64_t
+{
+    return m_recorded;
+}
+
+auto X11EventRecorder::SkippedEvents() const noexcept -> std::uint64_t
+{
+    return m_skipped;
+}
+
+////////////////////////////////////
+// X11EventReplay
+////////////////////////////////////
+
+auto X11EventReplay::Open(const std::string &path) noexcept -> Result<X11EventReplay, X11EventRecordError>
+{
+    const UniqueFd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC)); // NOLINT
+    if (!fd.IsValid())
+    {
+        return Result<X11EventReplay, X11EventRecordError>(
+            X11EventRecordError(ErrnoMessage("open " + path), RUNTIME_INFO));
+    }
+
+    struct stat info{};
+    if (fstat(fd.Get(), &info) != 0)
+    {
+        return Result<X11EventReplay, X11EventRecordError>(X11EventRecordError(ErrnoMessage("fstat"), RUNTIME_INFO));
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    if (size < sizeof(X11EventRecordFileHeader))
+    {
+        return Result<X11EventReplay, X11EventRecordError>(
+            X11EventRecordError(path + " is too small to be an event recording", RUNTIME_INFO));
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.Get(), 0);
+    if (data == MAP_FAILED) // NOLINT
+    {
+        return Result<X11EventReplay, X11EventRecordError>(X11EventRecordError(ErrnoMessage("mmap"), RUNTIME_INFO));
+    }
+    X11EventReplay replay(static_cast<const std::byte *>(data), size);
+
+    X11EventRecordFileHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != X11EventRecordFileHeader::kMagic || header.version != X11EventRecordFileHeader::kVersion)
+    {
+        return Result<X11EventReplay, X11EventRecordError>(
+            X11EventRecordError(path + " is not a supported event recording", RUNTIME_INFO));
+    }
+    if (header.xevent_size != sizeof(XEvent))
+    {
+        return Result<X11EventReplay, X11EventRecordError>(
+            X11EventRecordError(path + " was recorded with a different XEvent layout", RUNTIME_INFO));
+    }
+
+    return Result<X11EventReplay, X11EventRecordError>(std::move(replay));
+}
+
+X11EventReplay::X11EventReplay(const std::byte *data, const std::size_t size) noexcept
+    : m_data(data), m_size(size), m_offset(sizeof(X11EventRecordFileHeader))
+{
+}
+
+X11EventReplay::~X11EventReplay()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<std::byte *>(m_data), m_size); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+}
+
+X11EventReplay::X11EventReplay(X11EventReplay &&rhs) noexcept
+    : m_data(std::exchange(rhs.m_data, nullptr)), m_size(std::exchange(rhs.m_size, 0)),
+      m_offset(std::exchange(rhs.m_offset, 0))
+{
+}
+
+auto X11EventReplay::operator=(X11EventReplay &&rhs) noexcept -> X11EventReplay &
+{
+    if (this != &rhs)
+    {
+        X11EventReplay old(std::move(*this));
+        m_data = std::exchange(rhs.m_data, nullptr);
+        m_size = std::exchange(rhs.m_size, 0);
+        m_offset = std::exchange(rhs.m_offset, 0);
+    }
+    return *this;
+}
+
+auto X11EventReplay::Next(XEvent &event, std::chrono::nanoseconds &timestamp) noexcept -> bool
+{
+    if (m_size - m_offset < sizeof(X11EventRecordHeader))
+    {
+        return false;
+    }
+
+    X11EventRecordHeader header{};
+    std::memcpy(&header, m_data + m_offset, sizeof(header));
+
+    const std::size_t payload = AlignRecord(header.size);
+    if (header.size > sizeof(XEvent) || m_size - m_offset - sizeof(header) < payload)
+    {
+        return false;
+    }
+
+    event = XEvent{};
+    std::memcpy(&event, m_data + m_offset + sizeof(header), header.size);
+    timestamp = std::chrono::nanoseconds(header.timestamp_ns);
+    m_offset += sizeof(header) + payload;
+    return true;
+}
+
+auto X11EventReplay::Rewind() noexcept -> void
+{
+    m_offset = sizeof(X11EventRecordFileHeader);
+}
+
+auto X11EventReplay::Play(X11EventLoop &loop, const X11ReplaySpeed speed, const bool &run_flag) -> std::uint64_t
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::uint64_t played = 0;
+
+    XEvent event;
+    std::chrono::nanoseconds timestamp{};
+    while (run_flag && Next(event, timestamp))
+    {
+        if (speed == X11ReplaySpeed::RealTime)
+        {
+            std::this_thread::sleep_until(start + timestamp);
+        }
+        loop.Dispatch(&event);
+        ++played;
+    }
+    return played;
+}
+
+} // namespace Tilebox
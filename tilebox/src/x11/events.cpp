@@ -1,8 +1,10 @@
 #include <tilebox/x11/events.hpp>
 
 #include <X11/X.h>
+#include <X11/Xlib.h>
 
 #include <cstdint>
+#include <string_view>
 
 namespace Tilebox
 {
@@ -292,4 +294,177 @@ auto EventToXlibEvent(const X11EventType event_type) noexcept -> std::int32_t
     return LASTEvent;
 }
 
+auto EventTypeName(const X11EventType event_type) noexcept -> std::string_view
+{
+    switch (event_type)
+    {
+    case X11EventType::X11KeyPress:
+        return "KeyPress";
+    case X11EventType::X11KeyRelease:
+        return "KeyRelease";
+    case X11EventType::X11ButtonPress:
+        return "ButtonPress";
+    case X11EventType::X11ButtonRelease:
+        return "ButtonRelease";
+    case X11EventType::X11MotionNotify:
+        return "MotionNotify";
+    case X11EventType::X11EnterNotify:
+        return "EnterNotify";
+    case X11EventType::X11LeaveNotify:
+        return "LeaveNotify";
+    case X11EventType::X11FocusIn:
+        return "FocusIn";
+    case X11EventType::X11FocusOut:
+        return "FocusOut";
+    case X11EventType::X11KeymapNotify:
+        return "KeymapNotify";
+    case X11EventType::X11Expose:
+        return "Expose";
+    case X11EventType::X11GraphicsExpose:
+        return "GraphicsExpose";
+    case X11EventType::X11NoExpose:
+        return "NoExpose";
+    case X11EventType::X11VisibilityNotify:
+        return "VisibilityNotify";
+    case X11EventType::X11CreateNotify:
+        return "CreateNotify";
+    case X11EventType::X11DestroyNotify:
+        return "DestroyNotify";
+    case X11EventType::X11UnmapNotify:
+        return "UnmapNotify";
+    case X11EventType::X11MapNotify:
+        return "MapNotify";
+    case X11EventType::X11MapRequest:
+        return "MapRequest";
+    case X11EventType::X11ReparentNotify:
+        return "ReparentNotify";
+    case X11EventType::X11ConfigureNotify:
+        return "ConfigureNotify";
+    case X11EventType::X11ConfigureRequest:
+        return "ConfigureRequest";
+    case X11EventType::X11GravityNotify:
+        return "GravityNotify";
+    case X11EventType::X11ResizeRequest:
+        return "ResizeRequest";
+    case X11EventType::X11CirculateNotify:
+        return "CirculateNotify";
+    case X11EventType::X11CirculateRequest:
+        return "CirculateRequest";
+    case X11EventType::X11PropertyNotify:
+        return "PropertyNotify";
+    case X11EventType::X11SelectionClear:
+        return "SelectionClear";
+    case X11EventType::X11SelectionRequest:
+        return "SelectionRequest";
+    case X11EventType::X11SelectionNotify:
+        return "SelectionNotify";
+    case X11EventType::X11ColormapNotify:
+        return "ColormapNotify";
+    case X11EventType::X11ClientMessage:
+        return "ClientMessage";
+    case X11EventType::X11MappingNotify:
+        return "MappingNotify";
+    case X11EventType::X11GenericEvent:
+        return "GenericEvent";
+    case X11EventType::X11LASTEvent:
+        break;
+    }
+    return "Unknown";
+}
+
+auto EventWindowFromXlibEvent(const XEvent &event) noexcept -> Window
+{
+    switch (event.type)
+    {
+    case KeyPress:
+    case KeyRelease:
+        return event.xkey.window;
+    case ButtonPress:
+    case ButtonRelease:
+        return event.xbutton.window;
+    case MotionNotify:
+        return event.xmotion.window;
+    case EnterNotify:
+    case LeaveNotify:
+        return event.xcrossing.window;
+    case FocusIn:
+    case FocusOut:
+        return event.xfocus.window;
+    case Expose:
+        return event.xexpose.window;
+    case GraphicsExpose:
+        return event.xgraphicsexpose.drawable;
+    case NoExpose:
+        return event.xnoexpose.drawable;
+    case VisibilityNotify:
+        return event.xvisibility.window;
+    case CreateNotify:
+        return event.xcreatewindow.window;
+    case DestroyNotify:
+        return event.xdestroywindow.window;
+    case UnmapNotify:
+        return event.xunmap.window;
+    case MapNotify:
+        return event.xmap.window;
+    case MapRequest:
+        return event.xmaprequest.window;
+    case ReparentNotify:
+        return event.xreparent.window;
+    case ConfigureNotify:
+        return event.xconfigure.window;
+    case ConfigureRequest:
+        return event.xconfigurerequest.window;
+    case GravityNotify:
+        return event.xgravity.window;
+    case ResizeRequest:
+        return event.xresizerequest.window;
+    case CirculateNotify:
+        return event.xcirculate.window;
+    case CirculateRequest:
+        return event.xcirculaterequest.window;
+    case PropertyNotify:
+        return event.xproperty.window;
+    case SelectionClear:
+        return event.xselectionclear.window;
+    case SelectionRequest:
+        return event.xselectionrequest.owner;
+    case SelectionNotify:
+        return event.xselection.requestor;
+    case ColormapNotify:
+        return event.xcolormap.window;
+    case ClientMessage:
+        return event.xclient.window;
+    default:
+        return None;
+    }
+}
+
+auto EventTimeFromXlibEvent(const XEvent &event) noexcept -> Time
+{
+    switch (event.type)
+    {
+    case KeyPress:
+    case KeyRelease:
+        return event.xkey.time;
+    case ButtonPress:
+    case ButtonRelease:
+        return event.xbutton.time;
+    case MotionNotify:
+        return event.xmotion.time;
+    case EnterNotify:
+    case LeaveNotify:
+        return event.xcrossing.time;
+    case PropertyNotify:
+        return event.xproperty.time;
+    case SelectionClear:
+        return event.xselectionclear.time;
+    case SelectionRequest:
+        return event.xselectionrequest.time;
+    case SelectionNotify:
+        return event.xselection.time;
+    default:
+        return CurrentTime;
+    }
+}
+
 } // namespace Tilebox
@@ -0,0 +1,278 @@
+#include "tilebox/x11/monitors.hpp"
+#include "tilebox/geometry.hpp"
+
+#include <X11/X.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+auto Right(const Rect &rect) noexcept -> std::int32_t
+{
+    return rect.GetX() + static_cast<std::int32_t>(rect.GetW());
+}
+
+auto Bottom(const Rect &rect) noexcept -> std::int32_t
+{
+    return rect.GetY() + static_cast<std::int32_t>(rect.GetH());
+}
+
+/// @brief Sorts and dedupes the first `count` edges in place, returning the new count.
+template <std::size_t N> auto UniqueEdges(std::array<std::int32_t, N> &edges, const std::size_t count) -> std::size_t
+{
+    const auto begin = edges.begin();
+    const auto end = begin + static_cast<std::ptrdiff_t>(count);
+    std::sort(begin, end);
+    return static_cast<std::size_t>(std::unique(begin, end) - begin);
+}
+
+/// @brief Gets the span between adjacent edges that `value` falls into, half open.
+template <std::size_t N>
+auto EdgeSpan(const std::array<std::int32_t, N> &edges, const std::size_t count, const std::int32_t value) noexcept
+    -> std::optional<std::size_t>
+{
+    const auto begin = edges.begin();
+    const auto end = begin + static_cast<std::ptrdiff_t>(count);
+    const auto upper = std::upper_bound(begin, end, value);
+    if (upper == begin || upper == end)
+    {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(upper - begin) - 1;
+}
+
+} // namespace
+
+auto X11MonitorTable::Size() const noexcept -> std::size_t
+{
+    return m_count;
+}
+
+auto X11MonitorTable::Empty() const noexcept -> bool
+{
+    return m_count == 0;
+}
+
+auto X11MonitorTable::Monitors() const noexcept -> std::span<const X11Monitor>
+{
+    return {m_monitors.data(), m_count};
+}
+
+auto X11MonitorTable::At(const std::size_t index) const noexcept -> const X11Monitor *
+{
+    return index < m_count ? &m_monitors[index] : nullptr;
+}
+
+auto X11MonitorTable::Primary() const noexcept -> const X11Monitor *
+{
+    for (const X11Monitor &monitor : Monitors())
+    {
+        if (monitor.primary)
+        {
+            return &monitor;
+        }
+    }
+    return At(0);
+}
+
+auto X11MonitorTable::IndexAt(const Point &point) const noexcept -> std::optional<std::size_t>
+{
+    const auto column = EdgeSpan(m_x_edges, m_x_edge_count, point.x.value);
+    const auto row = EdgeSpan(m_y_edges, m_y_edge_count, point.y.value);
+    if (!column.has_value() || !row.has_value())
+    {
+        return std::nullopt;
+    }
+
+    const std::uint8_t cell = m_cells[(*row * (m_x_edge_count - 1)) + *column];
+    if (cell == kNoMonitor)
+    {
+        return std::nullopt;
+    }
+    return cell;
+}
+
+auto X11MonitorTable::Assign(const std::span<const X11Monitor> monitors) noexcept -> void
+{
+    m_crtc_count = 0;
+    m_primary_output = None;
+    for (const X11Monitor &monitor : monitors)
+    {
+        if (monitor.primary && monitor.output != None)
+        {
+            m_primary_output = monitor.output;
+        }
+    }
+    for (const X11Monitor &monitor : monitors)
+    {
+        Insert(monitor);
+    }
+    Reindex();
+}
+
+auto X11MonitorTable::UpdateCrtc(const XID crtc, const Rect &geometry) noexcept -> bool
+{
+    if (crtc == None)
+    {
+        return false;
+    }
+
+    if (X11Monitor *monitor = Find(crtc); monitor != nullptr)
+    {
+        if (monitor->geometry == geometry)
+        {
+            return false;
+        }
+        monitor->geometry = geometry;
+    }
+    else if (!Insert({geometry, crtc, None, false}))
+    {
+        return false;
+    }
+
+    return Reindex();
+}
+
+auto X11MonitorTable::RemoveCrtc(const XID crtc) noexcept -> bool
+{
+    X11Monitor *monitor = Find(crtc);
+    if (crtc == None || monitor == nullptr)
+    {
+        return false;
+    }
+
+    const auto begin = m_crtcs.begin();
+    std::move(monitor + 1, begin + static_cast<std::ptrdiff_t>(m_crtc_count), monitor);
+    --m_crtc_count;
+    return Reindex();
+}
+
+auto X11MonitorTable::SetCrtcOutput(const XID crtc, const XID output) noexcept -> bool
+{
+    X11Monitor *monitor = Find(crtc);
+    if (crtc == None || monitor == nullptr || monitor->output == output)
+    {
+        return false;
+    }
+
+    monitor->output = output;
+    monitor->primary = output != None && output == m_primary_output;
+    return Reindex();
+}
+
+auto X11MonitorTable::SetPrimaryOutput(const XID output) noexcept -> bool
+{
+    m_primary_output = output;
+    for (std::size_t i = 0; i < m_crtc_count; ++i)
+    {
+        X11Monitor &monitor = m_crtcs[i];
+        monitor.primary = output != None && monitor.output == output;
+    }
+    return Reindex();
+}
+
+/// Private
+
+auto X11MonitorTable::Find(const XID crtc) noexcept -> X11Monitor *
+{
+    const auto begin = m_crtcs.begin();
+    const auto end = begin + static_cast<std::ptrdiff_t>(m_crtc_count);
+    const auto iter = std::find_if(begin, end, [&](const X11Monitor &monitor) -> bool { return monitor.crtc == crtc; });
+    return iter != end ? &(*iter) : nullptr;
+}
+
+auto X11MonitorTable::Insert(const X11Monitor &monitor) noexcept -> bool
+{
+    if (m_crtc_count == kMaxMonitors || monitor.geometry.GetW() == 0 || monitor.geometry.GetH() == 0)
+    {
+        return false;
+    }
+
+    X11Monitor &inserted = m_crtcs[m_crtc_count++];
+    inserted = monitor;
+    if (m_primary_output != None)
+    {
+        inserted.primary = monitor.output == m_primary_output;
+    }
+    return true;
+}
+
+auto X11MonitorTable::Reindex() noexcept -> bool
+{
+    const std::array<X11Monitor, kMaxMonitors> previous = m_monitors;
+    const std::size_t previous_count = m_count;
+
+    // A mirror shows the same area, a second entry would only duplicate workspaces and bars.
+    m_count = 0;
+    for (std::size_t i = 0; i < m_crtc_count; ++i)
+    {
+        const X11Monitor &crtc = m_crtcs[i];
+        const auto listed = m_monitors.begin() + static_cast<std::ptrdiff_t>(m_count);
+        const auto mirror = std::find_if(m_monitors.begin(), listed, [&](const X11Monitor &monitor) -> bool {
+            return monitor.geometry == crtc.geometry;
+        });
+        if (mirror == listed)
+        {
+            m_monitors[m_count++] = crtc;
+        }
+        else if (crtc.primary && !mirror->primary)
+        {
+            *mirror = crtc;
+        }
+    }
+
+    const auto begin = m_monitors.begin();
+    const auto end = begin + static_cast<std::ptrdiff_t>(m_count);
+    std::stable_sort(begin, end, [](const X11Monitor &lhs, const X11Monitor &rhs) -> bool {
+        return lhs.geometry.GetX() != rhs.geometry.GetX() ? lhs.geometry.GetX() < rhs.geometry.GetX()
+                                                          : lhs.geometry.GetY() < rhs.geometry.GetY();
+    });
+
+    m_x_edge_count = 0;
+    m_y_edge_count = 0;
+    for (const X11Monitor &monitor : Monitors())
+    {
+        m_x_edges[m_x_edge_count++] = monitor.geometry.GetX();
+        m_x_edges[m_x_edge_count++] = Right(monitor.geometry);
+        m_y_edges[m_y_edge_count++] = monitor.geometry.GetY();
+        m_y_edges[m_y_edge_count++] = Bottom(monitor.geometry);
+    }
+    m_x_edge_count = UniqueEdges(m_x_edges, m_x_edge_count);
+    m_y_edge_count = UniqueEdges(m_y_edges, m_y_edge_count);
+
+    // Each cell is named after the first monitor covering its top left corner, cells never straddle a monitor edge.
+    const std::size_t columns = m_x_edge_count > 0 ? m_x_edge_count - 1 : 0;
+    const std::size_t rows = m_y_edge_count > 0 ? m_y_edge_count - 1 : 0;
+    for (std::size_t row = 0; row < rows; ++row)
+    {
+        for (std::size_t column = 0; column < columns; ++column)
+        {
+            const std::int32_t x = m_x_edges[column];
+            const std::int32_t y = m_y_edges[row];
+            std::uint8_t owner = kNoMonitor;
+            for (std::size_t i = 0; i < m_count; ++i)
+            {
+                const Rect &geometry = m_monitors[i].geometry;
+                if (geometry.GetX() <= x && x < Right(geometry) && geometry.GetY() <= y && y < Bottom(geometry))
+                {
+                    owner = static_cast<std::uint8_t>(i);
+                    break;
+                }
+            }
+            m_cells[(row * columns) + column] = owner;
+        }
+    }
+
+    return m_count != previous_count || !std::equal(begin, end, previous.begin());
+}
+
+} // namespace Tilebox
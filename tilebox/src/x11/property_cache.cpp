@@ -0,0 +1,490 @@
+#include "tilebox/x11/property_cache.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/xcb.hpp"
+
+#include <X11/X.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <xcb/xproto.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+/// @brief Returned for properties the cache does not store.
+const X11PropertyValue kAbsent{};
+
+/// @brief Words of the WM_HINTS and WM_NORMAL_HINTS wire formats, see ICCCM 4.1.2.
+constexpr std::uint32_t kWmHintsWords = 9;
+constexpr std::uint32_t kSizeHintsWords = 18;
+
+/// @brief Format 32 property data as 32 bit words, the reply carries them unaligned.
+class Words
+{
+  public:
+    explicit Words(const std::span<const std::uint8_t> bytes) noexcept : m_bytes(bytes)
+    {
+    }
+
+    [[nodiscard]] auto Size() const noexcept -> std::size_t
+    {
+        return m_bytes.size() / sizeof(std::uint32_t);
+    }
+
+    /// @brief Gets word `index`, zero past the end, older clients send shorter hints.
+    [[nodiscard]] auto operator[](const std::size_t index) const noexcept -> std::uint32_t
+    {
+        std::uint32_t word = 0;
+        if (index < Size())
+        {
+            std::memcpy(&word, m_bytes.data() + (index * sizeof(word)), sizeof(word));
+        }
+        return word;
+    }
+
+    [[nodiscard]] auto Signed(const std::size_t index) const noexcept -> std::int32_t
+    {
+        return static_cast<std::int32_t>((*this)[index]);
+    }
+
+  private:
+    std::span<const std::uint8_t> m_bytes;
+};
+
+/// @brief STRING properties are Latin-1, everything handed out is UTF-8.
+auto Latin1ToUtf8(const std::span<const std::uint8_t> bytes) -> std::string
+{
+    std::string text;
+    text.reserve(bytes.size());
+    for (const std::uint8_t byte : bytes)
+    {
+        if (byte < 0x80)
+        {
+            text.push_back(static_cast<char>(byte));
+        }
+        else
+        {
+            text.push_back(static_cast<char>(0xC0 | (byte >> 6)));
+            text.push_back(static_cast<char>(0x80 | (byte & 0x3F)));
+        }
+    }
+    return text;
+}
+
+/// @brief Gets the bytes before the first NUL.
+auto UntilNul(const std::span<const std::uint8_t> bytes) noexcept -> std::span<const std::uint8_t>
+{
+    const auto nul = std::find(bytes.begin(), bytes.end(), std::uint8_t{0});
+    return bytes.first(static_cast<std::size_t>(nul - bytes.begin()));
+}
+
+auto ToString(const std::span<const std::uint8_t> bytes) -> std::string
+{
+    return {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+}
+
+} // namespace
+
+X11PropertyCache::X11PropertyCache(X11DisplaySharedResource dpy, const X11PropertyAtoms &atoms,
+                                   const std::size_t capacity)
+    : m_dpy(std::move(dpy)), m_atoms(atoms), m_capacity(std::max<std::size_t>(capacity, 1)), m_slots(m_capacity)
+{
+}
+
+auto X11PropertyCache::Get(const Window window, const Atom property) -> const X11PropertyValue &
+{
+    if (!IsCached(property))
+    {
+        return kAbsent;
+    }
+
+    const std::uint64_t key = Key(window, property);
+    if (const std::uint32_t *slot = m_slots.Find(key); slot != nullptr)
+    {
+        ++m_stats.hits;
+        Entry &entry = m_entries[*slot];
+        entry.referenced = true;
+        return entry.value;
+    }
+
+    ++m_stats.misses;
+    return Insert(key, Fetch(window, property)).value;
+}
+
+auto X11PropertyCache::Prefetch(const Window window) -> void
+{
+    if (m_dpy == nullptr)
+    {
+        return;
+    }
+
+    struct Pending
+    {
+        Atom property;
+        X11Cookie<xcb_get_property_reply_t> cookie;
+    };
+
+    std::array<Pending, kPropertyCount> pending{};
+    std::size_t count = 0;
+    const X11XcbConnection xcb = m_dpy->Xcb();
+    for (const Atom property : Properties())
+    {
+        if (property != None && !Contains(window, property))
+        {
+            pending[count++] = {property,
+                                xcb.GetProperty(window, property, AnyPropertyType, 0, FetchLength(property))};
+        }
+    }
+
+    for (Pending &request : std::span<Pending>(pending.data(), count))
+    {
+        ++m_stats.misses;
+        const auto reply = request.cookie.Get();
+        Insert(Key(window, request.property), Decode(request.property, reply.get()));
+    }
+}
+
+auto X11PropertyCache::Title(const Window window) -> std::string_view
+{
+    if (m_atoms.net_wm_name != None)
+    {
+        if (const auto *title = std::get_if<std::string>(&Get(window, m_atoms.net_wm_name));
+            title != nullptr && !title->empty())
+        {
+            return *title;
+        }
+    }
+
+    const auto *title = std::get_if<std::string>(&Get(window, XA_WM_NAME));
+    return title != nullptr ? std::string_view(*title) : std::string_view();
+}
+
+auto X11PropertyCache::Class(const Window window) -> const X11ClassHint *
+{
+    return std::get_if<X11ClassHint>(&Get(window, XA_WM_CLASS));
+}
+
+auto X11PropertyCache::WmHints(const Window window) -> const X11WmHints *
+{
+    return std::get_if<X11WmHints>(&Get(window, XA_WM_HINTS));
+}
+
+auto X11PropertyCache::SizeHints(const Window window) -> const X11SizeHints *
+{
+    return std::get_if<X11SizeHints>(&Get(window, XA_WM_NORMAL_HINTS));
+}
+
+auto X11PropertyCache::NetWmState(const Window window) -> std::span<const Atom>
+{
+    if (m_atoms.net_wm_state == None)
+    {
+        return {};
+    }
+
+    const auto *atoms = std::get_if<std::vector<Atom>>(&Get(window, m_atoms.net_wm_state));
+    return atoms != nullptr ? std::span<const Atom>(*atoms) : std::span<const Atom>();
+}
+
+auto X11PropertyCache::HandleEvent(const XEvent &event) -> void
+{
+    switch (event.type)
+    {
+    case PropertyNotify: {
+        const XPropertyEvent &property = event.xproperty;
+        if (!IsCached(property.atom))
+        {
+            return;
+        }
+
+        // A deleted property is known to be absent, no need to ask again
+        if (property.state == PropertyDelete)
+        {
+            if (const std::uint32_t *slot = m_slots.Find(Key(property.window, property.atom)); slot != nullptr)
+            {
+                m_entries[*slot].value = std::monostate();
+                ++m_stats.invalidations;
+            }
+            return;
+        }
+        Invalidate(property.window, property.atom);
+        break;
+    }
+    case DestroyNotify:
+        Forget(event.xdestroywindow.window);
+        break;
+    default:
+        break;
+    }
+}
+
+auto X11PropertyCache::Invalidate(const Window window, const Atom property) -> void
+{
+    if (const std::uint32_t *slot = m_slots.Find(Key(window, property)); slot != nullptr)
+    {
+        Release(*slot);
+        ++m_stats.invalidations;
+    }
+}
+
+auto X11PropertyCache::Forget(const Window window) -> void
+{
+    for (const Atom property : Properties())
+    {
+        if (property != None)
+        {
+            Invalidate(window, property);
+        }
+    }
+}
+
+auto X11PropertyCache::Store(const Window window, const Atom property, X11PropertyValue value) -> void
+{
+    if (IsCached(property))
+    {
+        Insert(Key(window, property), std::move(value));
+    }
+}
+
+auto X11PropertyCache::Contains(const Window window, const Atom property) const noexcept -> bool
+{
+    return m_slots.Contains(Key(window, property));
+}
+
+auto X11PropertyCache::Size() const noexcept -> std::size_t
+{
+    return m_slots.Size();
+}
+
+auto X11PropertyCache::Stats() const noexcept -> const X11PropertyCacheStats &
+{
+    return m_stats;
+}
+
+auto X11PropertyCache::ResetStats() noexcept -> void
+{
+    m_stats = X11PropertyCacheStats{};
+}
+
+auto X11PropertyCache::IsCached(const Atom property) const noexcept -> bool
+{
+    return property != None && (property == XA_WM_NAME || property == XA_WM_CLASS || property == XA_WM_HINTS ||
+                                property == XA_WM_NORMAL_HINTS || property == m_atoms.net_wm_name ||
+                                property == m_atoms.net_wm_state);
+}
+
+auto X11PropertyCache::Decode(const Atom property, const xcb_get_property_reply_t *reply) const -> X11PropertyValue
+{
+    if (reply == nullptr || reply->type == XCB_ATOM_NONE)
+    {
+        return std::monostate();
+    }
+
+    const auto *data = static_cast<const std::uint8_t *>(xcb_get_property_value(reply));
+    const std::span<const std::uint8_t> bytes(data, static_cast<std::size_t>(xcb_get_property_value_length(reply)));
+
+    if (property == XA_WM_NAME || property == m_atoms.net_wm_name)
+    {
+        if (reply->format != 8)
+        {
+            return std::monostate();
+        }
+        // A _NET_WM_NAME of another type is ignored, so Title falls back to WM_NAME
+        if (property == m_atoms.net_wm_name && reply->type != m_atoms.utf8_string)
+        {
+            return std::monostate();
+        }
+        // COMPOUND_TEXT is passed through, its ASCII subset is what titles use in practice.
+        const auto text = UntilNul(bytes);
+        return reply->type == XA_STRING ? Latin1ToUtf8(text) : ToString(text);
+    }
+
+    if (property == XA_WM_CLASS)
+    {
+        if (reply->format != 8)
+        {
+            return std::monostate();
+        }
+        const auto instance = UntilNul(bytes);
+        const auto rest = bytes.subspan(std::min(bytes.size(), instance.size() + 1));
+        return X11ClassHint{Latin1ToUtf8(instance), Latin1ToUtf8(UntilNul(rest))};
+    }
+
+    if (reply->format != 32)
+    {
+        return std::monostate();
+    }
+
+    const Words words(bytes);
+    if (property == XA_WM_HINTS)
+    {
+        X11WmHints hints;
+        hints.flags = words[0];
+        if ((hints.flags & InputHint) != 0)
+        {
+            hints.input = words[1] != 0;
+        }
+        if ((hints.flags & StateHint) != 0)
+        {
+            hints.initial_state = words.Signed(2);
+        }
+        if ((hints.flags & WindowGroupHint) != 0)
+        {
+            hints.window_group = words[8];
+        }
+        return hints;
+    }
+
+    if (property == XA_WM_NORMAL_HINTS)
+    {
+        // Words 1 to 4 are the obsolete position and size fields
+        X11SizeHints hints;
+        hints.flags = words[0];
+        if ((hints.flags & PMinSize) != 0)
+        {
+            hints.min_width = words.Signed(5);
+            hints.min_height = words.Signed(6);
+        }
+        if ((hints.flags & PMaxSize) != 0)
+        {
+            hints.max_width = words.Signed(7);
+            hints.max_height = words.Signed(8);
+        }
+        if ((hints.flags & PResizeInc) != 0)
+        {
+            hints.width_inc = words.Signed(9);
+            hints.height_inc = words.Signed(10);
+        }
+        if ((hints.flags & PAspect) != 0)
+        {
+            hints.min_aspect_num = words.Signed(11);
+            hints.min_aspect_den = words.Signed(12);
+            hints.max_aspect_num = words.Signed(13);
+            hints.max_aspect_den = words.Signed(14);
+        }
+        if ((hints.flags & PBaseSize) != 0)
+        {
+            hints.base_width = words.Signed(15);
+            hints.base_height = words.Signed(16);
+        }
+        if ((hints.flags & PWinGravity) != 0)
+        {
+            hints.win_gravity = words.Signed(17);
+        }
+        return hints;
+    }
+
+    std::vector<Atom> atoms(std::min<std::size_t>(words.Size(), kMaxAtoms));
+    for (std::size_t i = 0; i < atoms.size(); ++i)
+    {
+        atoms[i] = words[i];
+    }
+    return atoms;
+}
+
+/// Private
+
+auto X11PropertyCache::Key(const Window window, const Atom property) noexcept -> std::uint64_t
+{
+    // XIDs and atoms both fit in 29 bits
+    return (static_cast<std::uint64_t>(window) << 32U) | static_cast<std::uint64_t>(property);
+}
+
+auto X11PropertyCache::Properties() const noexcept -> std::array<Atom, kPropertyCount>
+{
+    return {m_atoms.net_wm_name, XA_WM_NAME, XA_WM_CLASS, XA_WM_HINTS, XA_WM_NORMAL_HINTS, m_atoms.net_wm_state};
+}
+
+auto X11PropertyCache::FetchLength(const Atom property) const noexcept -> std::uint32_t
+{
+    if (property == XA_WM_HINTS)
+    {
+        return kWmHintsWords;
+    }
+    if (property == XA_WM_NORMAL_HINTS)
+    {
+        return kSizeHintsWords;
+    }
+    return property == m_atoms.net_wm_state ? kMaxAtoms : kMaxTextUnits;
+}
+
+auto X11PropertyCache::Fetch(const Window window, const Atom property) -> X11PropertyValue
+{
+    if (m_dpy == nullptr)
+    {
+        return std::monostate();
+    }
+
+    auto cookie = m_dpy->Xcb().GetProperty(window, property, AnyPropertyType, 0, FetchLength(property));
+    const auto reply = cookie.Get();
+    return Decode(property, reply.get());
+}
+
+auto X11PropertyCache::Insert(const std::uint64_t key, X11PropertyValue value) -> Entry &
+{
+    if (const std::uint32_t *found = m_slots.Find(key); found != nullptr)
+    {
+        Entry &entry = m_entries[*found];
+        entry.value = std::move(value);
+        entry.referenced = true;
+        return entry;
+    }
+
+    std::uint32_t slot = 0;
+    if (!m_free.empty())
+    {
+        slot = m_free.back();
+        m_free.pop_back();
+    }
+    else if (m_entries.size() < m_capacity)
+    {
+        slot = static_cast<std::uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    else
+    {
+        // CLOCK: sweep past recently read entries, clearing their bit, and recycle the first one not read since.
+        while (m_entries[m_hand].referenced)
+        {
+            m_entries[m_hand].referenced = false;
+            m_hand = (m_hand + 1) % m_entries.size();
+        }
+        slot = static_cast<std::uint32_t>(m_hand);
+        m_hand = (m_hand + 1) % m_entries.size();
+        m_slots.Erase(m_entries[slot].key);
+        ++m_stats.evictions;
+    }
+
+    Entry &entry = m_entries[slot];
+    entry.key = key;
+    entry.value = std::move(value);
+    entry.referenced = true;
+    m_slots.InsertOrAssign(key, slot);
+    return entry;
+}
+
+auto X11PropertyCache::Release(const std::uint32_t slot) -> void
+{
+    Entry &entry = m_entries[slot];
+    m_slots.Erase(entry.key);
+    entry.key = FlatMap<std::uint32_t>::kEmptyKey;
+    entry.value = std::monostate();
+    entry.referenced = false;
+    m_free.push_back(slot);
+}
+
+} // namespace Tilebox
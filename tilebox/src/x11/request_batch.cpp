@@ -0,0 +1,169 @@
+#include "tilebox/x11/request_batch.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/xcb.hpp"
+
+#include <X11/Xlib.h>
+#include <xcb/xproto.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace Tilebox
+{
+
+X11RequestBatch::X11RequestBatch(X11DisplaySharedResource dpy, const X11BatchErrors errors)
+    : m_dpy(std::move(dpy)), m_mode(errors)
+{
+    if (m_dpy == nullptr || !m_dpy->IsConnected())
+    {
+        m_ended = true;
+        m_settled = true;
+        return;
+    }
+
+    m_first_request = m_dpy->Traffic().requests + 1;
+    Detail::X11BatchRegistry &registry = *m_dpy->m_batches;
+    ++registry.depth;
+    if (m_mode != X11BatchErrors::Unchecked)
+    {
+        registry.checked.push_back(this);
+    }
+}
+
+X11RequestBatch::~X11RequestBatch()
+{
+    End();
+    Unregister();
+}
+
+auto X11RequestBatch::End() -> void
+{
+    if (m_ended)
+    {
+        return;
+    }
+
+    m_ended = true;
+    m_last_request = m_dpy->Traffic().requests;
+    Detail::X11BatchRegistry &registry = *m_dpy->m_batches;
+    if (m_mode == X11BatchErrors::Sync)
+    {
+        registry.sync_deferred = true;
+    }
+
+    --registry.depth;
+    if (registry.depth > 0)
+    {
+        return;
+    }
+
+    // Only the outermost batch writes, XSync sends its own request in the same write as the batch.
+    if (std::exchange(registry.sync_deferred, false))
+    {
+        m_dpy->Sync();
+    }
+    else
+    {
+        m_dpy->Flush();
+    }
+}
+
+auto X11RequestBatch::IsEnded() const noexcept -> bool
+{
+    return m_ended;
+}
+
+auto X11RequestBatch::Settled() -> bool
+{
+    if (m_settled || !m_ended)
+    {
+        return m_settled;
+    }
+
+    Display *dpy = m_dpy->Raw();
+    if (m_mode == X11BatchErrors::Unchecked || m_last_request < m_first_request ||
+        LastKnownRequestProcessed(dpy) >= m_last_request)
+    {
+        Settle();
+        return true;
+    }
+
+    if (m_mode != X11BatchErrors::Async || m_dpy->m_batches->depth > 0)
+    {
+        return false;
+    }
+
+    if (!m_fence_answered)
+    {
+        if (!m_fence.IsValid())
+        {
+            const X11XcbConnection xcb = m_dpy->Xcb();
+            m_fence = xcb.GetInputFocus();
+            xcb.Flush();
+        }
+
+        X11ReplyPtr<xcb_get_input_focus_reply_t> reply;
+        if (!m_fence.Poll(reply))
+        {
+            return false;
+        }
+        m_fence_answered = true;
+    }
+
+    // XCB has read every error sent before the fence reply, Xlib picks them up once its own queue is drained.
+    if (XQLength(dpy) > 0)
+    {
+        return false;
+    }
+    XEventsQueued(dpy, QueuedAfterReading);
+    Settle();
+    return true;
+}
+
+auto X11RequestBatch::Errors() const noexcept -> std::uint32_t
+{
+    return m_errors;
+}
+
+auto X11RequestBatch::FirstRequest() const noexcept -> std::uint64_t
+{
+    return m_first_request;
+}
+
+auto X11RequestBatch::LastRequest() const noexcept -> std::uint64_t
+{
+    return m_last_request;
+}
+
+auto X11RequestBatch::OnError(const std::uint64_t sequence) noexcept -> bool
+{
+    if (m_settled || sequence < m_first_request || (m_ended && sequence > m_last_request))
+    {
+        return false;
+    }
+    ++m_errors;
+    return true;
+}
+
+/// Private
+
+auto X11RequestBatch::Settle() noexcept -> void
+{
+    m_settled = true;
+    m_fence.Discard();
+    Unregister();
+}
+
+auto X11RequestBatch::Unregister() noexcept -> void
+{
+    if (m_dpy == nullptr || m_mode == X11BatchErrors::Unchecked)
+    {
+        return;
+    }
+
+    auto &checked = m_dpy->m_batches->checked;
+    checked.erase(std::remove(checked.begin(), checked.end(), this), checked.end());
+}
+
+} // namespace Tilebox
@@ -0,0 +1,82 @@
+#include "tilebox/x11/traffic.hpp"
+#include "tilebox/x11/events.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fmt/format.h>
+#include <iterator>
+#include <string>
+
+namespace Tilebox
+{
+
+auto X11Traffic::operator-(const X11Traffic &rhs) const noexcept -> X11Traffic
+{
+    return {.requests = requests - rhs.requests,
+            .processed = processed - rhs.processed,
+            .round_trips = round_trips - rhs.round_trips,
+            .flushes = flushes - rhs.flushes,
+            .bytes_flushed = bytes_flushed - rhs.bytes_flushed};
+}
+
+auto X11Traffic::operator+=(const X11Traffic &rhs) noexcept -> X11Traffic &
+{
+    requests += rhs.requests;
+    processed += rhs.processed;
+    round_trips += rhs.round_trips;
+    flushes += rhs.flushes;
+    bytes_flushed += rhs.bytes_flushed;
+    return *this;
+}
+
+auto X11EventTraffic::Record(const std::size_t event_index, const X11Traffic &delta) noexcept -> void
+{
+    if (event_index < kEventTableSize)
+    {
+        m_handler[event_index] += delta;
+        ++m_calls[event_index];
+    }
+}
+
+auto X11EventTraffic::Handler(const X11EventType event_type) const noexcept -> const X11Traffic &
+{
+    const auto index = static_cast<std::size_t>(event_type);
+    return index < kEventTableSize ? m_handler[index] : m_empty;
+}
+
+auto X11EventTraffic::Calls(const X11EventType event_type) const noexcept -> std::uint64_t
+{
+    const auto index = static_cast<std::size_t>(event_type);
+    return index < kEventTableSize ? m_calls[index] : 0;
+}
+
+auto X11EventTraffic::Reset() noexcept -> void
+{
+    m_handler.fill(X11Traffic{});
+    m_calls.fill(0);
+}
+
+auto X11EventTraffic::Report() const -> std::string
+{
+    std::string out;
+    for (std::size_t i = 0; i < kEventTableSize; ++i)
+    {
+        if (m_calls[i] == 0)
+        {
+            continue;
+        }
+
+        const X11Traffic &traffic = m_handler[i];
+        const auto per_call = [&](const std::uint64_t total) -> double {
+            return static_cast<double>(total) / static_cast<double>(m_calls[i]);
+        };
+        fmt::format_to(std::back_inserter(out),
+                       "traffic  {:<18} calls={:<10} requests={:.2f}/call round_trips={:.2f}/call flushes={} "
+                       "bytes={}\n",
+                       EventTypeName(static_cast<X11EventType>(i)), m_calls[i], per_call(traffic.requests),
+                       per_call(traffic.round_trips), traffic.flushes, traffic.bytes_flushed);
+    }
+    return out;
+}
+
+} // namespace Tilebox
@@ -5,6 +5,7 @@
 #include <X11/X.h>
 #include <X11/Xlib.h>
 
+#include <cstdint>
 #include <utility>
 
 namespace Tilebox
@@ -14,8 +15,18 @@ X11Window::X11Window(X11DisplaySharedResource dpy) noexcept : m_dpy(std::move(dp
 {
 }
 
+X11Window::X11Window(X11DisplaySharedResource dpy, const Window id, const X11WindowConfig &config) noexcept
+    : m_dpy(std::move(dpy)), m_owned(false), m_id(id), m_shadow(config)
+{
+}
+
 X11Window::~X11Window()
 {
+    if (!m_owned)
+    {
+        return;
+    }
+
     Unmap();
     if (m_id != 0 && m_dpy->IsConnected())
     {
@@ -44,6 +55,7 @@ auto X11Window::Create(const Rect &r) noexcept -> bool
                              DefaultVisual(m_dpy->Raw(), m_dpy->ScreenId()), CWBackPixel | CWBorderPixel | CWEventMask,
                              &wa);
 
+        m_shadow = {.rect = r, .border_width = 0, .stacking = std::nullopt};
         return m_id != BadAlloc && m_id != BadMatch && m_id != BadValue && m_id != BadWindow;
     }
 
@@ -63,12 +75,174 @@ auto X11Window::Map() noexcept -> bool
     return m_is_mapped;
 }
 
-auto X11Window::Unmap() const noexcept -> void
+auto X11Window::Unmap() noexcept -> void
 {
     if (m_is_mapped)
     {
         XUnmapWindow(m_dpy->Raw(), m_id);
+        m_is_mapped = false;
+    }
+}
+
+auto X11Window::IsMapped() const noexcept -> bool
+{
+    return m_is_mapped;
+}
+
+auto X11Window::Shadow() const noexcept -> const X11WindowConfig &
+{
+    return m_shadow;
+}
+
+auto X11Window::Configure(const X11WindowConfig &config) noexcept -> std::uint32_t
+{
+    if (m_id == 0 || m_dpy == nullptr || !m_dpy->IsConnected())
+    {
+        return 0;
+    }
+
+    XWindowChanges changes{};
+    std::uint32_t mask = 0;
+    if (config.rect.GetX() != m_shadow.rect.GetX())
+    {
+        changes.x = config.rect.GetX();
+        mask |= CWX;
+    }
+    if (config.rect.GetY() != m_shadow.rect.GetY())
+    {
+        changes.y = config.rect.GetY();
+        mask |= CWY;
+    }
+    if (config.rect.GetW() != m_shadow.rect.GetW())
+    {
+        changes.width = static_cast<std::int32_t>(config.rect.GetW());
+        mask |= CWWidth;
+    }
+    if (config.rect.GetH() != m_shadow.rect.GetH())
+    {
+        changes.height = static_cast<std::int32_t>(config.rect.GetH());
+        mask |= CWHeight;
+    }
+    if (config.border_width != m_shadow.border_width)
+    {
+        changes.border_width = static_cast<std::int32_t>(config.border_width);
+        mask |= CWBorderWidth;
+    }
+    // Always sent, other windows may have been restacked around this one without it receiving a ConfigureNotify
+    if (config.stacking.has_value())
+    {
+        if (config.stacking->sibling != None)
+        {
+            changes.sibling = config.stacking->sibling;
+            mask |= CWSibling;
+        }
+        changes.stack_mode = config.stacking->mode;
+        mask |= CWStackMode;
+    }
+
+    if (mask == 0)
+    {
+        return 0;
+    }
+
+    m_configure_request = NextRequest(m_dpy->Raw());
+    XConfigureWindow(m_dpy->Raw(), m_id, mask, &changes);
+    m_shadow.rect = config.rect;
+    m_shadow.border_width = config.border_width;
+    if (config.stacking.has_value())
+    {
+        m_shadow.stacking = config.stacking;
+    }
+    return mask;
+}
+
+auto X11Window::Configure(const Rect &rect) noexcept -> std::uint32_t
+{
+    return Configure(X11WindowConfig{.rect = rect, .border_width = m_shadow.border_width, .stacking = std::nullopt});
+}
+
+auto X11Window::HandleConfigureRequest(const XConfigureRequestEvent &request, const bool tiled) noexcept
+    -> std::uint32_t
+{
+    if (tiled)
+    {
+        SendConfigureNotify();
+        return 0;
+    }
+
+    X11WindowConfig config{.rect = m_shadow.rect, .border_width = m_shadow.border_width, .stacking = std::nullopt};
+    if ((request.value_mask & CWX) != 0)
+    {
+        config.rect.point.x = X(request.x);
+    }
+    if ((request.value_mask & CWY) != 0)
+    {
+        config.rect.point.y = Y(request.y);
+    }
+    if ((request.value_mask & CWWidth) != 0)
+    {
+        config.rect.width = Width(static_cast<std::uint32_t>(request.width));
+    }
+    if ((request.value_mask & CWHeight) != 0)
+    {
+        config.rect.height = Height(static_cast<std::uint32_t>(request.height));
+    }
+    if ((request.value_mask & CWBorderWidth) != 0)
+    {
+        config.border_width = static_cast<std::uint32_t>(request.border_width);
+    }
+    if ((request.value_mask & CWStackMode) != 0)
+    {
+        config.stacking = X11Stacking{.sibling = (request.value_mask & CWSibling) != 0 ? request.above : None,
+                                      .mode = request.detail};
+    }
+
+    // A granted request that moves nothing still has to be answered, ICCCM 4.1.5
+    const std::uint32_t mask = Configure(config);
+    if (mask == 0)
+    {
+        SendConfigureNotify();
     }
+    return mask;
+}
+
+auto X11Window::HandleConfigureNotify(const XConfigureEvent &event) noexcept -> void
+{
+    // Synthetic events are sent by clients, including this one, and say nothing about the server's state
+    if (event.window != m_id || event.send_event != False || event.serial < m_configure_request)
+    {
+        return;
+    }
+
+    m_shadow.rect = Rect(Point(X(event.x), Y(event.y)), Width(static_cast<std::uint32_t>(event.width)),
+                         Height(static_cast<std::uint32_t>(event.height)));
+    m_shadow.border_width = static_cast<std::uint32_t>(event.border_width);
+
+    // `above` is the sibling right below the window, None at the bottom of the stack
+    m_shadow.stacking = event.above != None ? X11Stacking{.sibling = event.above, .mode = Above}
+                                            : X11Stacking{.sibling = None, .mode = Below};
+}
+
+auto X11Window::SendConfigureNotify() const noexcept -> void
+{
+    if (m_id == 0 || m_dpy == nullptr || !m_dpy->IsConnected())
+    {
+        return;
+    }
+
+    XConfigureEvent event{};
+    event.type = ConfigureNotify;
+    event.display = m_dpy->Raw();
+    event.event = m_id;
+    event.window = m_id;
+    event.x = m_shadow.rect.GetX();
+    event.y = m_shadow.rect.GetY();
+    event.width = static_cast<std::int32_t>(m_shadow.rect.GetW());
+    event.height = static_cast<std::int32_t>(m_shadow.rect.GetH());
+    event.border_width = static_cast<std::int32_t>(m_shadow.border_width);
+    event.above = None;
+    event.override_redirect = False;
+    XSendEvent(m_dpy->Raw(), m_id, False, StructureNotifyMask, reinterpret_cast<XEvent *>(&event));
 }
 
 } // namespace Tilebox
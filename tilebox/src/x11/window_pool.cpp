@@ -0,0 +1,295 @@
+#include "tilebox/x11/window_pool.hpp"
+#include "tilebox/geometry.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/window.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fmt/format.h>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace Tilebox
+{
+
+namespace
+{
+
+/// @brief Finds the Visual of an id in Xlib's connection setup data, no request is sent.
+auto FindVisual(Display *dpy, const VisualID id) noexcept -> Visual *
+{
+    if (id == CopyFromParent)
+    {
+        return nullptr;
+    }
+
+    XVisualInfo wanted{};
+    wanted.visualid = id;
+    std::int32_t count = 0;
+    XVisualInfo *found = XGetVisualInfo(dpy, VisualIDMask, &wanted, &count);
+    Visual *visual = count > 0 ? found->visual : nullptr;
+    if (found != nullptr)
+    {
+        XFree(found);
+    }
+    return visual;
+}
+
+} // namespace
+
+////////////////////////////////////
+// X11PooledWindow
+////////////////////////////////////
+
+X11PooledWindow::X11PooledWindow(X11WindowPool *pool, const std::size_t bucket, X11Window &&window) noexcept
+    : m_pool(pool), m_bucket(bucket), m_window(std::move(window))
+{
+}
+
+X11PooledWindow::~X11PooledWindow()
+{
+    Release();
+}
+
+X11PooledWindow::X11PooledWindow(X11PooledWindow &&other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr)), m_bucket(other.m_bucket), m_window(std::move(other.m_window))
+{
+    other.m_window.reset();
+}
+
+auto X11PooledWindow::operator=(X11PooledWindow &&other) noexcept -> X11PooledWindow &
+{
+    if (this != &other)
+    {
+        Release();
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_bucket = other.m_bucket;
+        m_window = std::move(other.m_window);
+        other.m_window.reset();
+    }
+    return *this;
+}
+
+auto X11PooledWindow::IsValid() const noexcept -> bool
+{
+    return m_window.has_value();
+}
+
+auto X11PooledWindow::id() const noexcept -> Window
+{
+    return m_window.has_value() ? m_window->id() : Window{};
+}
+
+auto X11PooledWindow::Get() noexcept -> X11Window &
+{
+    return *m_window;
+}
+
+auto X11PooledWindow::operator->() noexcept -> X11Window *
+{
+    return &*m_window;
+}
+
+auto X11PooledWindow::Release() noexcept -> void
+{
+    if (m_pool != nullptr && m_window.has_value())
+    {
+        m_pool->Release(m_bucket, std::move(*m_window));
+    }
+    m_pool = nullptr;
+    m_window.reset();
+}
+
+////////////////////////////////////
+// X11WindowPool
+////////////////////////////////////
+
+X11WindowPool::X11WindowPool(X11DisplaySharedResource dpy, const std::size_t max_idle) noexcept
+    : m_dpy(std::move(dpy)), m_max_idle(max_idle)
+{
+}
+
+X11WindowPool::~X11WindowPool()
+{
+    Trim();
+}
+
+auto X11WindowPool::Acquire(const X11WindowPoolKey &key, const Rect &rect) -> X11PooledWindow
+{
+    if (m_dpy == nullptr || !m_dpy->IsConnected())
+    {
+        return {};
+    }
+
+    Bucket &bucket = BucketFor(key);
+    const auto index = static_cast<std::size_t>(&bucket - m_buckets.data());
+    std::optional<X11Window> window;
+    if (!bucket.idle.empty())
+    {
+        window.emplace(std::move(bucket.idle.back()));
+        bucket.idle.pop_back();
+        window->Configure(rect);
+        ++bucket.stats.reused;
+    }
+    else
+    {
+        const Window id = CreatePooledWindow(key, rect);
+        window.emplace(m_dpy, id, X11WindowConfig{.rect = rect, .border_width = 0, .stacking = std::nullopt});
+        ++bucket.stats.created;
+    }
+
+    bucket.stats.idle = bucket.idle.size();
+    ++bucket.stats.in_use;
+    bucket.stats.high_water = std::max(bucket.stats.high_water, bucket.stats.in_use);
+    return {this, index, std::move(*window)};
+}
+
+auto X11WindowPool::Prewarm(const X11WindowPoolKey &key, const std::size_t count) -> void
+{
+    if (m_dpy == nullptr || !m_dpy->IsConnected())
+    {
+        return;
+    }
+
+    Bucket &bucket = BucketFor(key);
+    const Rect rect;
+    while (bucket.idle.size() < count)
+    {
+        bucket.idle.emplace_back(m_dpy, CreatePooledWindow(key, rect),
+                                 X11WindowConfig{.rect = rect, .border_width = 0, .stacking = std::nullopt});
+        ++bucket.stats.created;
+    }
+    bucket.stats.idle = bucket.idle.size();
+}
+
+auto X11WindowPool::Trim() noexcept -> void
+{
+    const bool connected = m_dpy != nullptr && m_dpy->IsConnected();
+    for (Bucket &bucket : m_buckets)
+    {
+        for (const X11Window &window : bucket.idle)
+        {
+            if (connected)
+            {
+                XDestroyWindow(m_dpy->Raw(), window.id());
+            }
+            ++bucket.stats.trimmed;
+        }
+        bucket.idle.clear();
+        bucket.stats.idle = 0;
+    }
+}
+
+auto X11WindowPool::Stats(const X11WindowPoolKey &key) const noexcept -> X11WindowPoolStats
+{
+    const std::optional<std::size_t> index = FindBucket(key);
+    return index.has_value() ? m_buckets[*index].stats : X11WindowPoolStats{};
+}
+
+auto X11WindowPool::Stats() const noexcept -> X11WindowPoolStats
+{
+    X11WindowPoolStats total;
+    for (const Bucket &bucket : m_buckets)
+    {
+        total.created += bucket.stats.created;
+        total.reused += bucket.stats.reused;
+        total.destroyed += bucket.stats.destroyed;
+        total.trimmed += bucket.stats.trimmed;
+        total.in_use += bucket.stats.in_use;
+        total.idle += bucket.stats.idle;
+        total.high_water += bucket.stats.high_water;
+    }
+    return total;
+}
+
+auto X11WindowPool::Report() const -> std::string
+{
+    std::string out;
+    for (const Bucket &bucket : m_buckets)
+    {
+        const X11WindowPoolStats &stats = bucket.stats;
+        fmt::format_to(std::back_inserter(out),
+                       "windows  depth={:<2} visual={:#x} mask={:#x} high_water={} in_use={} idle={} created={} "
+                       "reused={} destroyed={} trimmed={}\n",
+                       bucket.key.depth, bucket.key.visual, bucket.key.event_mask, stats.high_water, stats.in_use,
+                       stats.idle, stats.created, stats.reused, stats.destroyed, stats.trimmed);
+    }
+    return out;
+}
+
+/// Private
+
+auto X11WindowPool::FindBucket(const X11WindowPoolKey &key) const noexcept -> std::optional<std::size_t>
+{
+    const auto it = std::ranges::find(m_buckets, key, &Bucket::key);
+    return it != m_buckets.end() ? std::optional<std::size_t>(static_cast<std::size_t>(it - m_buckets.begin()))
+                                 : std::nullopt;
+}
+
+auto X11WindowPool::BucketFor(const X11WindowPoolKey &key) -> Bucket &
+{
+    if (const std::optional<std::size_t> index = FindBucket(key); index.has_value())
+    {
+        return m_buckets[*index];
+    }
+    return m_buckets.emplace_back(Bucket{.key = key, .idle = {}, .stats = {}});
+}
+
+auto X11WindowPool::CreatePooledWindow(const X11WindowPoolKey &key, const Rect &rect) const noexcept -> Window
+{
+    Display *dpy = m_dpy->Raw();
+    XSetWindowAttributes wa{};
+    wa.override_redirect = True;
+    wa.save_under = key.save_under ? True : False;
+    wa.event_mask = static_cast<long>(key.event_mask);
+    wa.background_pixel = key.background_pixel;
+    wa.border_pixel = key.border_pixel;
+    wa.colormap = key.colormap;
+
+    std::uint64_t mask = CWOverrideRedirect | CWSaveUnder | CWEventMask | CWBackPixel | CWBorderPixel;
+    if (key.colormap != CopyFromParent)
+    {
+        mask |= CWColormap;
+    }
+    return XCreateWindow(dpy, m_dpy->GetRootWindow(), rect.GetX(), rect.GetY(), rect.GetW(), rect.GetH(), 0,
+                         key.depth, InputOutput, FindVisual(dpy, key.visual), mask, &wa);
+}
+
+auto X11WindowPool::Release(const std::size_t bucket_index, X11Window &&window) noexcept -> void
+{
+    Bucket &bucket = m_buckets[bucket_index];
+    --bucket.stats.in_use;
+
+    const bool connected = m_dpy != nullptr && m_dpy->IsConnected();
+    if (connected && bucket.idle.size() < m_max_idle)
+    {
+        // Windows mapped directly through Xlib are not tracked by X11Window
+        if (window.IsMapped())
+        {
+            window.Unmap();
+        }
+        else
+        {
+            XUnmapWindow(m_dpy->Raw(), window.id());
+        }
+        bucket.idle.push_back(std::move(window));
+    }
+    else
+    {
+        if (connected)
+        {
+            XDestroyWindow(m_dpy->Raw(), window.id());
+        }
+        ++bucket.stats.destroyed;
+    }
+    bucket.stats.idle = bucket.idle.size();
+}
+
+} // namespace Tilebox
@@ -0,0 +1,156 @@
+#include "tilebox/x11/xcb.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib-xcb.h>
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+#include <xcb/xcbext.h>
+#include <xcb/xproto.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+namespace Tilebox
+{
+
+////////////////////////////////////
+// Detail
+////////////////////////////////////
+
+auto Detail::X11WaitForReply(xcb_connection_t *connection, const std::uint32_t sequence,
+                             X11TrafficCounters *traffic) noexcept -> void *
+{
+    void *reply = nullptr;
+    xcb_generic_error_t *error = nullptr;
+    if (traffic != nullptr)
+    {
+        // A pipelined reply may already be in, only a reply that has to be waited for costs a round trip.
+        if (X11PollForReply(connection, sequence, reply))
+        {
+            return reply;
+        }
+        ++traffic->round_trips;
+    }
+
+    reply = xcb_wait_for_reply(connection, sequence, &error);
+    std::free(error); // NOLINT(cppcoreguidelines-no-malloc)
+    return reply;
+}
+
+auto Detail::X11PollForReply(xcb_connection_t *connection, const std::uint32_t sequence, void *&reply) noexcept
+    -> bool
+{
+    xcb_generic_error_t *error = nullptr;
+    if (xcb_poll_for_reply(connection, sequence, &reply, &error) == 0)
+    {
+        return false;
+    }
+    std::free(error); // NOLINT(cppcoreguidelines-no-malloc)
+    return true;
+}
+
+auto Detail::X11DiscardReply(xcb_connection_t *connection, const std::uint32_t sequence) noexcept -> void
+{
+    xcb_discard_reply(connection, sequence);
+}
+
+////////////////////////////////////
+// X11XcbConnection
+////////////////////////////////////
+
+X11XcbConnection::X11XcbConnection(xcb_connection_t *connection) noexcept : m_connection(connection)
+{
+}
+
+X11XcbConnection::X11XcbConnection(Display *dpy, Detail::X11TrafficCounters *traffic) noexcept
+    : m_connection(dpy != nullptr ? XGetXCBConnection(dpy) : nullptr), m_traffic(traffic)
+{
+}
+
+auto X11XcbConnection::IsConnected() const noexcept -> bool
+{
+    return m_connection != nullptr;
+}
+
+auto X11XcbConnection::Raw() const noexcept -> xcb_connection_t *
+{
+    return m_connection;
+}
+
+auto X11XcbConnection::Traffic() const noexcept -> Detail::X11TrafficCounters *
+{
+    return m_traffic;
+}
+
+auto X11XcbConnection::Flush() const noexcept -> void
+{
+    if (m_connection == nullptr)
+    {
+        return;
+    }
+
+    if (m_traffic != nullptr && m_traffic->xcb_flushed_sequence != m_traffic->xcb_sequence)
+    {
+        m_traffic->xcb_flushed_sequence = m_traffic->xcb_sequence;
+        ++m_traffic->flushes;
+    }
+    xcb_flush(m_connection);
+}
+
+auto X11XcbConnection::GetWindowAttributes(const Window window) const noexcept
+    -> X11Cookie<xcb_get_window_attributes_reply_t>
+{
+    const auto cookie = xcb_get_window_attributes(m_connection, static_cast<xcb_window_t>(window));
+    return MakeCookie<xcb_get_window_attributes_reply_t>(cookie.sequence);
+}
+
+auto X11XcbConnection::GetGeometry(const Drawable drawable) const noexcept -> X11Cookie<xcb_get_geometry_reply_t>
+{
+    const auto cookie = xcb_get_geometry(m_connection, static_cast<xcb_drawable_t>(drawable));
+    return MakeCookie<xcb_get_geometry_reply_t>(cookie.sequence);
+}
+
+auto X11XcbConnection::GetProperty(const Window window, const Atom property, const Atom type,
+                                   const std::uint32_t long_offset, const std::uint32_t long_length) const noexcept
+    -> X11Cookie<xcb_get_property_reply_t>
+{
+    const auto cookie = xcb_get_property(m_connection, 0, static_cast<xcb_window_t>(window),
+                                         static_cast<xcb_atom_t>(property), static_cast<xcb_atom_t>(type), long_offset,
+                                         long_length);
+    return MakeCookie<xcb_get_property_reply_t>(cookie.sequence);
+}
+
+auto X11XcbConnection::InternAtom(const std::string_view name, const bool only_if_exists) const noexcept
+    -> X11Cookie<xcb_intern_atom_reply_t>
+{
+    const auto cookie = xcb_intern_atom(m_connection, static_cast<std::uint8_t>(only_if_exists),
+                                        static_cast<std::uint16_t>(name.size()), name.data());
+    return MakeCookie<xcb_intern_atom_reply_t>(cookie.sequence);
+}
+
+auto X11XcbConnection::QueryTree(const Window window) const noexcept -> X11Cookie<xcb_query_tree_reply_t>
+{
+    const auto cookie = xcb_query_tree(m_connection, static_cast<xcb_window_t>(window));
+    return MakeCookie<xcb_query_tree_reply_t>(cookie.sequence);
+}
+
+auto X11XcbConnection::GetInputFocus() const noexcept -> X11Cookie<xcb_get_input_focus_reply_t>
+{
+    const auto cookie = xcb_get_input_focus(m_connection);
+    return MakeCookie<xcb_get_input_focus_reply_t>(cookie.sequence);
+}
+
+/// Private
+
+template <typename Reply>
+auto X11XcbConnection::MakeCookie(const std::uint32_t sequence) const noexcept -> X11Cookie<Reply>
+{
+    if (m_traffic != nullptr)
+    {
+        m_traffic->xcb_sequence = sequence;
+    }
+    return {m_connection, sequence, m_traffic};
+}
+
+} // namespace Tilebox
@@ -0,0 +1,493 @@
+#include "tilebox/x11/xinput.hpp"
+#include "tilebox/error.hpp"
+#include "tilebox/x11/display.hpp"
+#include "tilebox/x11/event_loop.hpp"
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XI2.h>
+#include <X11/extensions/XInput2.h>
+#include <etl.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+using namespace etl;
+
+namespace Tilebox
+{
+
+namespace
+{
+
+/// @brief Every XI2 event type X11XInput registers a loop handler for.
+constexpr std::array<std::int32_t, 7> kHandledEvents = {
+    XI_RawMotion, XI_Motion, XI_ButtonPress, XI_ButtonRelease, XI_Enter, XI_DeviceChanged, XI_HierarchyChanged};
+
+/// @brief Selected per window, XI_DeviceChanged keeps the scroll valuators current.
+constexpr std::array<std::int32_t, 5> kWindowEvents = {XI_Motion, XI_ButtonPress, XI_ButtonRelease, XI_Enter,
+                                                       XI_DeviceChanged};
+
+/// @brief Device ids are small, anything past this is ignored rather than growing the device table.
+constexpr std::int32_t kMaxDeviceId = 256;
+
+/// @brief Calls `fn(number, value)` for every valuator set in the mask, the values are packed in mask order.
+template <typename Fn> auto ForEachValuator(const XIValuatorState &valuators, const double *values, Fn &&fn) -> void
+{
+    std::size_t packed = 0;
+    for (std::int32_t number = 0; number < valuators.mask_len * 8; ++number)
+    {
+        if ((valuators.mask[number >> 3] & (1U << static_cast<std::uint32_t>(number & 7))) != 0)
+        {
+            fn(number, values[packed++]);
+        }
+    }
+}
+
+auto ToDeviceEvent(const XIDeviceEvent &event) noexcept -> X11DeviceEvent
+{
+    return {.evtype = event.evtype,
+            .device = event.deviceid,
+            .source = event.sourceid,
+            .detail = event.detail,
+            .window = event.event,
+            .child = event.child,
+            .root_x = event.root_x,
+            .root_y = event.root_y,
+            .event_x = event.event_x,
+            .event_y = event.event_y,
+            .modifiers = static_cast<std::uint32_t>(event.mods.effective),
+            .time = event.time,
+            .coalesced = 1};
+}
+
+} // namespace
+
+X11XInput::X11XInput(X11DisplaySharedResource dpy) noexcept : m_dpy(std::move(dpy))
+{
+}
+
+X11XInput::~X11XInput()
+{
+    if (m_loop != nullptr)
+    {
+        for (const std::int32_t evtype : kHandledEvents)
+        {
+            m_loop->UnregisterGenericEventHandler(m_opcode, evtype);
+        }
+        m_loop->CancelIdle(kIdleKey);
+    }
+}
+
+auto X11XInput::Attach(X11EventLoop &loop) -> Result<Void, X11XInputError>
+{
+    if (m_dpy == nullptr)
+    {
+        return Result<Void, X11XInputError>(X11XInputError("Attach: no display connection", RUNTIME_INFO));
+    }
+    if (m_loop != nullptr)
+    {
+        return Result<Void, X11XInputError>(X11XInputError("Attach: already attached to a loop", RUNTIME_INFO));
+    }
+
+    std::int32_t opcode = 0;
+    std::int32_t first_event = 0;
+    std::int32_t first_error = 0;
+    if (XQueryExtension(m_dpy->Raw(), "XInputExtension", &opcode, &first_event, &first_error) == False)
+    {
+        return Result<Void, X11XInputError>(X11XInputError("XInputExtension is not available", RUNTIME_INFO));
+    }
+
+    std::int32_t major = XI_2_Major;
+    std::int32_t minor = kMinimumMinorVersion;
+    if (XIQueryVersion(m_dpy->Raw(), &major, &minor) != Success ||
+        (major == XI_2_Major && minor < kMinimumMinorVersion))
+    {
+        return Result<Void, X11XInputError>(X11XInputError("XInput 2.1 is not supported", RUNTIME_INFO));
+    }
+
+    // Devices plugged in later announce themselves through the hierarchy. Selected before any handler is registered,
+    // so a failed Attach leaves nothing behind in the loop.
+    m_opcode = opcode;
+    constexpr std::array<std::int32_t, 1> hierarchy = {XI_HierarchyChanged};
+    if (auto res = Select(m_dpy->GetRootWindow(), XIAllDevices, hierarchy); res.is_err())
+    {
+        m_opcode = 0;
+        return res;
+    }
+
+    m_loop = &loop;
+    for (const std::int32_t evtype : kHandledEvents)
+    {
+        loop.RegisterGenericEventHandler(m_opcode, evtype,
+                                         [this](const XGenericEventCookie &cookie) -> void { HandleEvent(cookie); });
+    }
+
+    RefreshDevices();
+    return Result<Void, X11XInputError>(Void());
+}
+
+auto X11XInput::Opcode() const noexcept -> std::int32_t
+{
+    return m_opcode;
+}
+
+auto X11XInput::SelectRawMotion() -> Result<Void, X11XInputError>
+{
+    if (m_dpy == nullptr)
+    {
+        return Result<Void, X11XInputError>(X11XInputError("SelectRawMotion: no display connection", RUNTIME_INFO));
+    }
+
+    // Raw events are only ever delivered to the root window
+    constexpr std::array<std::int32_t, 1> raw_motion = {XI_RawMotion};
+    return Select(m_dpy->GetRootWindow(), XIAllMasterDevices, raw_motion);
+}
+
+auto X11XInput::SelectWindowEvents(const Window window) -> Result<Void, X11XInputError>
+{
+    return Select(window, XIAllMasterDevices, kWindowEvents);
+}
+
+auto X11XInput::OnRawMotion(X11RawMotionCallback callback) -> void
+{
+    m_on_raw_motion = std::move(callback);
+}
+
+auto X11XInput::OnScroll(X11SmoothScrollCallback callback) -> void
+{
+    m_on_scroll = std::move(callback);
+}
+
+auto X11XInput::OnDeviceEvent(X11DeviceEventCallback callback) -> void
+{
+    m_on_device_event = std::move(callback);
+}
+
+auto X11XInput::HandleEvent(const XGenericEventCookie &cookie) -> void
+{
+    if (cookie.data == nullptr)
+    {
+        return;
+    }
+
+    // XI2 event structs share their leading fields with XIEvent, the evtype picks the actual layout.
+    switch (cookie.evtype)
+    {
+    case XI_RawMotion:
+        HandleRawMotion(*static_cast<const XIRawEvent *>(cookie.data));
+        break;
+    case XI_Motion:
+        HandleMotion(*static_cast<const XIDeviceEvent *>(cookie.data));
+        break;
+    case XI_ButtonPress:
+    case XI_ButtonRelease:
+        HandleButton(*static_cast<const XIDeviceEvent *>(cookie.data));
+        break;
+    case XI_Enter: {
+        // Scroll valuators may have moved while the pointer was elsewhere, the next value is a new baseline.
+        const auto &event = *static_cast<const XIEnterEvent *>(cookie.data);
+        if (DeviceState *state = Device(event.deviceid); state != nullptr)
+        {
+            for (std::size_t i = 0; i < state->scroll_axis_count; ++i)
+            {
+                state->scroll_axes[i].has_last_value = false;
+            }
+        }
+        break;
+    }
+    case XI_DeviceChanged: {
+        const auto &event = *static_cast<const XIDeviceChangedEvent *>(cookie.data);
+        UpdateScrollAxes(event.deviceid, event.classes, event.num_classes);
+        break;
+    }
+    case XI_HierarchyChanged:
+        RefreshDevices();
+        break;
+    default:
+        break;
+    }
+}
+
+auto X11XInput::Flush() -> void
+{
+    // Callbacks are copied before being invoked, they may replace themselves.
+    for (DeviceState &state : m_devices)
+    {
+        if (state.raw.coalesced > 0)
+        {
+            const X11RawMotion raw = std::exchange(state.raw, {});
+            if (const X11RawMotionCallback callback = m_on_raw_motion; callback)
+            {
+                callback(raw);
+            }
+        }
+        if (state.motion.coalesced > 0)
+        {
+            const X11DeviceEvent motion = std::exchange(state.motion, {});
+            if (const X11DeviceEventCallback callback = m_on_device_event; callback)
+            {
+                callback(motion);
+            }
+        }
+        if (state.scroll.coalesced > 0)
+        {
+            const X11SmoothScroll scroll = std::exchange(state.scroll, {});
+            if (const X11SmoothScrollCallback callback = m_on_scroll; callback)
+            {
+                callback(scroll);
+            }
+        }
+    }
+}
+
+/// Private
+
+auto X11XInput::Device(const std::int32_t device_id) -> DeviceState *
+{
+    if (device_id < 0 || device_id >= kMaxDeviceId)
+    {
+        return nullptr;
+    }
+
+    const auto index = static_cast<std::size_t>(device_id);
+    if (index >= m_devices.size())
+    {
+        // Only when a device is seen for the first time
+        m_devices.resize(index + 1);
+    }
+    return &m_devices[index];
+}
+
+auto X11XInput::RefreshDevices() -> void
+{
+    if (m_dpy == nullptr)
+    {
+        return;
+    }
+
+    std::int32_t count = 0;
+    XIDeviceInfo *devices = XIQueryDevice(m_dpy->Raw(), XIAllMasterDevices, &count);
+    if (devices == nullptr)
+    {
+        return;
+    }
+
+    for (const XIDeviceInfo &device : std::span<const XIDeviceInfo>(devices, static_cast<std::size_t>(count)))
+    {
+        UpdateScrollAxes(device.deviceid, device.classes, device.num_classes);
+    }
+    XIFreeDeviceInfo(devices);
+}
+
+auto X11XInput::UpdateScrollAxes(const std::int32_t device_id, XIAnyClassInfo **classes,
+                                 const std::int32_t class_count) -> void
+{
+    DeviceState *state = Device(device_id);
+    if (state == nullptr || classes == nullptr)
+    {
+        return;
+    }
+
+    // Class infos are C style subtypes of XIAnyClassInfo, tagged by their type field.
+    const std::span<XIAnyClassInfo *> infos(classes, static_cast<std::size_t>(class_count));
+    state->scroll_axis_count = 0;
+    for (const XIAnyClassInfo *info : infos)
+    {
+        if (info->type != XIScrollClass || state->scroll_axis_count == state->scroll_axes.size())
+        {
+            continue;
+        }
+
+        const auto *scroll = reinterpret_cast<const XIScrollClassInfo *>(info); // NOLINT
+        if (scroll->increment != 0.0)
+        {
+            state->scroll_axes[state->scroll_axis_count++] = {scroll->number, scroll->scroll_type, scroll->increment,
+                                                              0.0, false};
+        }
+    }
+
+    // Seed the current values, so the first motion after a device change does not scroll by the absolute value.
+    for (const XIAnyClassInfo *info : infos)
+    {
+        if (info->type != XIValuatorClass)
+        {
+            continue;
+        }
+
+        const auto *valuator = reinterpret_cast<const XIValuatorClassInfo *>(info); // NOLINT
+        for (std::size_t i = 0; i < state->scroll_axis_count; ++i)
+        {
+            if (state->scroll_axes[i].number == valuator->number)
+            {
+                state->scroll_axes[i].last_value = valuator->value;
+                state->scroll_axes[i].has_last_value = true;
+            }
+        }
+    }
+}
+
+auto X11XInput::HandleRawMotion(const XIRawEvent &event) -> void
+{
+    DeviceState *state = Device(event.deviceid);
+    if (state == nullptr || !m_on_raw_motion)
+    {
+        return;
+    }
+
+    // Valuators 0 and 1 are the x and y axes of a relative pointer.
+    double dx = 0.0;
+    double dy = 0.0;
+    ForEachValuator(event.valuators, event.raw_values, [&](const std::int32_t number, const double value) -> void {
+        if (number == 0)
+        {
+            dx = value;
+        }
+        else if (number == 1)
+        {
+            dy = value;
+        }
+    });
+
+    X11RawMotion &raw = state->raw;
+    raw.device = event.deviceid;
+    raw.source = event.sourceid;
+    raw.dx += dx;
+    raw.dy += dy;
+    raw.time = event.time;
+    ++raw.coalesced;
+    ScheduleFlush();
+}
+
+auto X11XInput::HandleMotion(const XIDeviceEvent &event) -> void
+{
+    DeviceState *state = Device(event.deviceid);
+    if (state == nullptr)
+    {
+        return;
+    }
+
+    double dx = 0.0;
+    double dy = 0.0;
+    bool scrolled = false;
+    bool moved = false;
+    const auto track = [&](const std::int32_t number, const double value) -> void {
+        for (std::size_t i = 0; i < state->scroll_axis_count; ++i)
+        {
+            ScrollAxis &axis = state->scroll_axes[i];
+            if (axis.number != number)
+            {
+                continue;
+            }
+
+            if (axis.has_last_value)
+            {
+                const double delta = (value - axis.last_value) / axis.increment;
+                (axis.scroll_type == XIScrollTypeVertical ? dy : dx) += delta;
+                scrolled = true;
+            }
+            axis.last_value = value;
+            axis.has_last_value = true;
+            return;
+        }
+        moved = true;
+    };
+    ForEachValuator(event.valuators, event.valuators.values, track);
+
+    if (scrolled && m_on_scroll)
+    {
+        X11SmoothScroll &scroll = state->scroll;
+        if (scroll.coalesced > 0 && scroll.window != event.event)
+        {
+            Flush();
+        }
+        scroll.device = event.deviceid;
+        scroll.source = event.sourceid;
+        scroll.window = event.event;
+        scroll.dx += dx;
+        scroll.dy += dy;
+        scroll.time = event.time;
+        ++scroll.coalesced;
+        ScheduleFlush();
+    }
+
+    // Motion only carrying scroll valuators is reported through OnScroll alone
+    if (moved && m_on_device_event)
+    {
+        if (state->motion.coalesced > 0 && state->motion.window != event.event)
+        {
+            Flush();
+        }
+        const std::uint32_t coalesced = state->motion.coalesced;
+        state->motion = ToDeviceEvent(event);
+        state->motion.coalesced = coalesced + 1;
+        ScheduleFlush();
+    }
+}
+
+auto X11XInput::HandleButton(const XIDeviceEvent &event) -> void
+{
+    // Wheel clicks emulated from smooth scrolling, the scroll itself is delivered through OnScroll.
+    if ((static_cast<std::uint32_t>(event.flags) & static_cast<std::uint32_t>(XIPointerEmulated)) != 0)
+    {
+        return;
+    }
+
+    // Whatever moved before the button must be seen before it
+    Flush();
+    if (const X11DeviceEventCallback callback = m_on_device_event; callback)
+    {
+        callback(ToDeviceEvent(event));
+    }
+}
+
+auto X11XInput::ScheduleFlush() -> void
+{
+    if (m_loop != nullptr && !m_loop->IsIdleScheduled(kIdleKey))
+    {
+        m_loop->ScheduleIdle(kIdleKey, [this]() -> void { Flush(); });
+    }
+}
+
+auto X11XInput::Select(const Window window, const std::int32_t device_id, const std::span<const std::int32_t> evtypes)
+    -> Result<Void, X11XInputError>
+{
+    if (m_dpy == nullptr || m_opcode == 0)
+    {
+        return Result<Void, X11XInputError>(X11XInputError("Select: Attach must succeed first", RUNTIME_INFO));
+    }
+
+    std::array<unsigned char, XIMaskLen(XI_LASTEVENT)> mask{};
+    for (const std::int32_t evtype : evtypes)
+    {
+        mask[static_cast<std::size_t>(evtype >> 3)] |= static_cast<unsigned char>(1U << (evtype & 7));
+    }
+
+    // A selection replaces the previous mask of the same window and device, the root window collects them all. The
+    // collected mask only takes the new events once the server accepted them.
+    const bool is_root = window == m_dpy->GetRootWindow();
+    auto &root_mask = device_id == XIAllMasterDevices ? m_root_master_mask : m_root_device_mask;
+    if (is_root)
+    {
+        for (std::size_t i = 0; i < mask.size(); ++i)
+        {
+            mask[i] |= root_mask[i];
+        }
+    }
+
+    XIEventMask event_mask{device_id, static_cast<std::int32_t>(mask.size()), mask.data()};
+    if (XISelectEvents(m_dpy->Raw(), window, &event_mask, 1) != Success)
+    {
+        return Result<Void, X11XInputError>(X11XInputError("XISelectEvents failed", RUNTIME_INFO));
+    }
+    if (is_root)
+    {
+        root_mask = mask;
+    }
+    return Result<Void, X11XInputError>(Void());
+}
+
+} // namespace Tilebox
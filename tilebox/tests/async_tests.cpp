@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/async.hpp>
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/event_loop.hpp>
+
+#include <X11/X.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+#include <xcb/xproto.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+using namespace Tilebox;
+
+namespace
+{
+auto Constant(const std::int32_t value) -> X11Task<std::int32_t>
+{
+    co_return value;
+}
+
+auto Geometry(X11AsyncConnection &async, const Window window) -> X11Task<std::int32_t>
+{
+    auto reply = co_await async.GetGeometry(window);
+    co_return reply != nullptr ? reply->width : -1;
+}
+} // namespace
+
+TEST(TileboxCoreX11AsyncTestSuite, VerifyTasksCompose)
+{
+    X11AsyncConnection async(nullptr);
+
+    std::int32_t result = 0;
+    auto outer = [&]() -> X11Task<> { result = co_await Constant(20) + co_await Constant(22); };
+
+    X11Task<> task = outer();
+    ASSERT_FALSE(task.Done());
+    ASSERT_EQ(result, 0);
+
+    async.Spawn(std::move(task));
+    ASSERT_EQ(result, 42);
+    ASSERT_EQ(async.RunningTasks(), 0);
+}
+
+TEST(TileboxCoreX11AsyncTestSuite, VerifyExceptionsReachTheAwaiter)
+{
+    X11AsyncConnection async(nullptr);
+
+    auto failing = []() -> X11Task<std::int32_t> {
+        throw std::runtime_error("failed");
+        co_return 0;
+    };
+
+    bool caught = false;
+    auto outer = [&]() -> X11Task<> {
+        try
+        {
+            static_cast<void>(co_await failing());
+        }
+        catch (const std::runtime_error &)
+        {
+            caught = true;
+        }
+    };
+    async.Spawn(outer());
+    ASSERT_TRUE(caught);
+
+    auto escaping = [&]() -> X11Task<> { static_cast<void>(co_await failing()); };
+    ASSERT_THROW(async.Spawn(escaping()), std::runtime_error);
+}
+
+TEST(TileboxCoreX11AsyncTestSuite, VerifyPipelinedRequestsResolve)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    X11AsyncConnection async(dpy);
+
+    bool finished = false;
+    auto manage = [&](const Window root) -> X11Task<> {
+        // All four requests are queued before the first reply is awaited
+        auto attributes = async.GetWindowAttributes(root);
+        auto tree = async.QueryTree(root);
+        auto atom = async.InternAtom("TILEBOX_ASYNC_TEST");
+        auto width = Geometry(async, root);
+        EXPECT_EQ(async.PendingReplies(), 0);
+
+        auto attributes_reply = co_await attributes;
+        EXPECT_NE(attributes_reply, nullptr);
+
+        auto tree_reply = co_await tree;
+        EXPECT_NE(tree_reply, nullptr);
+        if (tree_reply != nullptr)
+        {
+            EXPECT_EQ(tree_reply->root, static_cast<xcb_window_t>(root));
+        }
+
+        auto atom_reply = co_await atom;
+        EXPECT_NE(atom_reply, nullptr);
+        if (atom_reply != nullptr)
+        {
+            EXPECT_NE(atom_reply->atom, XCB_ATOM_NONE);
+        }
+
+        EXPECT_GT(co_await width, 0);
+        finished = true;
+    };
+
+    async.Spawn(manage(dpy->GetRootWindow()));
+    ASSERT_EQ(async.RunningTasks(), 1);
+    ASSERT_EQ(async.PendingReplies(), 1);
+
+    async.Drain();
+    ASSERT_TRUE(finished);
+    ASSERT_EQ(async.RunningTasks(), 0);
+    ASSERT_EQ(async.PendingReplies(), 0);
+}
+
+TEST(TileboxCoreX11AsyncTestSuite, VerifyRunPolledResumesCoroutines)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    X11AsyncConnection async(dpy);
+    X11EventLoop loop(dpy);
+    loop.SetAsyncConnection(&async);
+
+    bool run = true;
+    std::int32_t width = 0;
+    auto fetch = [&]() -> X11Task<> {
+        width = co_await Geometry(async, dpy->GetRootWindow());
+        width += co_await Geometry(async, dpy->GetRootWindow());
+        run = false;
+    };
+    async.Spawn(fetch());
+
+    ASSERT_TRUE(loop.RunPolled(run).is_ok());
+    ASSERT_GT(width, 0);
+    ASSERT_EQ(async.RunningTasks(), 0);
+}
+
+TEST(TileboxCoreX11AsyncTestSuite, VerifyUnfinishedTasksAreDestroyed)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+
+    bool resumed = false;
+    {
+        X11AsyncConnection async(dpy);
+
+        // Never awaited, the reply is discarded
+        static_cast<void>(async.GetGeometry(dpy->GetRootWindow()));
+
+        auto suspended = [&]() -> X11Task<> {
+            auto reply = co_await async.QueryTree(dpy->GetRootWindow());
+            resumed = true;
+        };
+        async.Spawn(suspended());
+        ASSERT_EQ(async.PendingReplies(), 1);
+    }
+    ASSERT_FALSE(resumed);
+
+    // The connection is still usable afterwards
+    XSync(dpy->Raw(), False);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/atoms.hpp>
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/traffic.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+using namespace Tilebox;
+
+namespace
+{
+
+enum class TestNet : std::uint8_t
+{
+    WmName,
+    ActiveWindow,
+    Supported,
+};
+
+enum class TestType : std::uint8_t
+{
+    Utf8String,
+};
+
+constexpr std::array<const char *, 3> kTestNetNames = {"_NET_WM_NAME", "_NET_ACTIVE_WINDOW", "_NET_SUPPORTED"};
+constexpr std::array<const char *, 1> kTestTypeNames = {"UTF8_STRING"};
+
+using TestNetAtoms = X11AtomRegistry<TestNet, kTestNetNames>;
+using TestTypeAtoms = X11AtomRegistry<TestType, kTestTypeNames>;
+
+static_assert(TestNetAtoms::kSize == 3);
+static_assert(TestNetAtoms::Name(TestNet::ActiveWindow) == "_NET_ACTIVE_WINDOW");
+static_assert(!Detail::X11AtomNamesValid(std::array<const char *, 2>{"WM_STATE", "WM_STATE"}));
+static_assert(!Detail::X11AtomNamesValid(std::array<const char *, 1>{""}));
+
+} // namespace
+
+TEST(TileboxCoreX11AtomsTestSuite, VerifyLookupsWithoutServer)
+{
+    TestNetAtoms atoms;
+    ASSERT_EQ(atoms[TestNet::WmName], None);
+    ASSERT_FALSE(atoms.Contains(None));
+
+    // Atoms are not ordered like the names, the reverse lookup still finds them
+    const std::array<Atom, 3> interned = {0x160, 0x120, 0x140};
+    atoms.Assign(interned);
+    ASSERT_EQ(atoms[TestNet::ActiveWindow], 0x120);
+    ASSERT_EQ(atoms.Get(TestNet::Supported), 0x140);
+    ASSERT_EQ(atoms.Find(0x160), TestNet::WmName);
+    ASSERT_EQ(atoms.NameOf(0x140), "_NET_SUPPORTED");
+    ASSERT_TRUE(atoms.NameOf(0x150).empty());
+    ASSERT_FALSE(atoms.Find(0x100).has_value());
+    ASSERT_EQ(atoms.Atoms()[1], 0x120);
+
+    // Without a display nothing is interned
+    TestTypeAtoms types;
+    ASSERT_FALSE(X11InternAtoms(nullptr, atoms, types));
+    ASSERT_EQ(atoms[TestNet::ActiveWindow], None);
+    ASSERT_EQ(types[TestType::Utf8String], None);
+}
+
+TEST(TileboxCoreX11AtomsTestSuite, VerifyInternMatchesServer)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+
+    // Every registry costs one observed round trip together
+    TestNetAtoms atoms;
+    TestTypeAtoms types;
+    const X11Traffic before = dpy->Traffic();
+    ASSERT_TRUE(X11InternAtoms(dpy, atoms, types));
+    const X11Traffic cost = dpy->Traffic() - before;
+    ASSERT_EQ(cost.requests, TestNetAtoms::kSize + TestTypeAtoms::kSize);
+    ASSERT_EQ(cost.round_trips, 1);
+    for (const TestNet atom : {TestNet::WmName, TestNet::ActiveWindow, TestNet::Supported})
+    {
+        ASSERT_EQ(atoms[atom], XInternAtom(dpy->Raw(), TestNetAtoms::Name(atom).data(), False));
+        ASSERT_EQ(atoms.NameOf(atoms[atom]), TestNetAtoms::Name(atom));
+    }
+    ASSERT_NE(types[TestType::Utf8String], None);
+    ASSERT_EQ(types.NameOf(types[TestType::Utf8String]), "UTF8_STRING");
+
+    TestTypeAtoms again;
+    ASSERT_TRUE(again.Intern(dpy));
+    ASSERT_EQ(again[TestType::Utf8String], types[TestType::Utf8String]);
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/geometry.hpp>
+#include <tilebox/x11/damage.hpp>
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/events.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+
+constexpr Window kWindow = 0x200001;
+
+auto MakeRect(const std::int32_t x, const std::int32_t y, const std::uint32_t w, const std::uint32_t h) -> Rect
+{
+    return {Point(X(x), Y(y)), Width(w), Height(h)};
+}
+
+auto MakeExpose(const std::int32_t x, const std::int32_t y, const std::int32_t w, const std::int32_t h,
+                const std::int32_t count) -> XEvent
+{
+    XEvent event{};
+    event.xexpose.type = Expose;
+    event.xexpose.window = kWindow;
+    event.xexpose.x = x;
+    event.xexpose.y = y;
+    event.xexpose.width = w;
+    event.xexpose.height = h;
+    event.xexpose.count = count;
+    return event;
+}
+
+} // namespace
+
+TEST(TileboxCoreX11DamageTestSuite, VerifyContainedAndAdjoiningRectsMerge)
+{
+    X11DamageTracker tracker;
+    std::vector<Rect> delivered;
+    tracker.Track(kWindow, [&](Window, std::span<const Rect> damage) -> void {
+        delivered.assign(damage.begin(), damage.end());
+    });
+
+    ASSERT_FALSE(tracker.Add(kWindow + 1, MakeRect(0, 0, 10, 10)));
+    ASSERT_TRUE(tracker.Add(kWindow, MakeRect(0, 0, 10, 10)));
+    ASSERT_TRUE(tracker.Add(kWindow, MakeRect(10, 0, 10, 10)));
+    ASSERT_TRUE(tracker.Add(kWindow, MakeRect(2, 2, 3, 3)));
+    ASSERT_EQ(tracker.Pending(kWindow), 1);
+    ASSERT_TRUE(tracker.HasPending());
+
+    tracker.Flush(kWindow);
+    ASSERT_FALSE(tracker.HasPending());
+    ASSERT_EQ(delivered.size(), 1);
+    ASSERT_EQ(delivered[0], MakeRect(0, 0, 20, 10));
+}
+
+TEST(TileboxCoreX11DamageTestSuite, VerifyRegionIsBoundedAndClipped)
+{
+    X11DamageTracker tracker;
+    std::vector<Rect> delivered;
+    tracker.Track(kWindow, [&](Window, std::span<const Rect> damage) -> void {
+        delivered.assign(damage.begin(), damage.end());
+    });
+    tracker.SetBounds(kWindow, 100, 100);
+
+    const std::vector<Rect> exposed = {MakeRect(0, 0, 5, 5),   MakeRect(50, 0, 5, 5),  MakeRect(0, 50, 5, 5),
+                                       MakeRect(50, 50, 5, 5), MakeRect(80, 80, 5, 5), MakeRect(90, 0, 5, 5)};
+    for (const Rect &rect : exposed)
+    {
+        ASSERT_TRUE(tracker.Add(kWindow, rect));
+    }
+    ASSERT_EQ(tracker.Pending(kWindow), X11DamageTracker::kMaxDamageRects);
+
+    // Entirely outside the window
+    ASSERT_TRUE(tracker.Add(kWindow, MakeRect(200, 200, 10, 10)));
+    ASSERT_EQ(tracker.Pending(kWindow), X11DamageTracker::kMaxDamageRects);
+
+    tracker.FlushAll();
+    ASSERT_EQ(delivered.size(), X11DamageTracker::kMaxDamageRects);
+    const Rect bounds = MakeRect(0, 0, 100, 100);
+    for (const Rect &rect : exposed)
+    {
+        bool covered = false;
+        for (const Rect &damage : delivered)
+        {
+            ASSERT_TRUE(bounds.Contains(damage));
+            covered = covered || damage.Contains(rect);
+        }
+        ASSERT_TRUE(covered);
+    }
+
+    // Overhanging damage is cut at the window edge, also when the window shrinks later
+    ASSERT_TRUE(tracker.Add(kWindow, MakeRect(90, 90, 50, 50)));
+    tracker.SetBounds(kWindow, 95, 100);
+    tracker.FlushAll();
+    ASSERT_EQ(delivered.size(), 1);
+    ASSERT_EQ(delivered[0], MakeRect(90, 90, 5, 10));
+}
+
+TEST(TileboxCoreX11DamageTestSuite, VerifyLoopDeliversOneRegionPerBurst)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t global_count = 0;
+    std::vector<std::vector<Rect>> deliveries;
+    loop.RegisterEventHandler(X11EventType::X11Expose, [&](XEvent *) -> void { ++global_count; });
+    loop.RegisterDamageHandler(kWindow, [&](Window window, std::span<const Rect> damage) -> void {
+        ASSERT_EQ(window, kWindow);
+        deliveries.emplace_back(damage.begin(), damage.end());
+    });
+
+    XEvent configure{};
+    configure.xconfigure.type = ConfigureNotify;
+    configure.xconfigure.window = kWindow;
+    configure.xconfigure.width = 200;
+    configure.xconfigure.height = 20;
+    loop.Dispatch(&configure);
+
+    for (const XEvent &expose : {MakeExpose(0, 0, 50, 20, 2), MakeExpose(50, 0, 50, 20, 1),
+                                 MakeExpose(150, 10, 100, 100, 0)})
+    {
+        XEvent event = expose;
+        loop.Dispatch(&event);
+    }
+    ASSERT_EQ(deliveries.size(), 1);
+    ASSERT_EQ(deliveries[0].size(), 2);
+    ASSERT_EQ(deliveries[0][0], MakeRect(0, 0, 100, 20));
+    ASSERT_EQ(deliveries[0][1], MakeRect(150, 10, 50, 10));
+
+    // An unfinished burst waits for the queue to drain
+    XEvent partial = MakeExpose(0, 0, 10, 10, 3);
+    loop.Dispatch(&partial);
+    ASSERT_EQ(deliveries.size(), 1);
+    loop.FlushDamage();
+    ASSERT_EQ(deliveries.size(), 2);
+    ASSERT_EQ(global_count, 0);
+
+    // Destroyed windows stop being tracked
+    XEvent destroy{};
+    destroy.xdestroywindow.type = DestroyNotify;
+    destroy.xdestroywindow.window = kWindow;
+    loop.Dispatch(&destroy);
+    XEvent after = MakeExpose(0, 0, 10, 10, 0);
+    loop.Dispatch(&after);
+    ASSERT_EQ(deliveries.size(), 2);
+    ASSERT_EQ(global_count, 1);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/event_coalescer.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+auto Motion(const Window window, const std::int32_t x) -> XEvent
+{
+    XEvent event{};
+    event.xmotion.type = MotionNotify;
+    event.xmotion.window = window;
+    event.xmotion.x = x;
+    return event;
+}
+
+auto Configure(const Window window, const std::int32_t width) -> XEvent
+{
+    XEvent event{};
+    event.xconfigure.type = ConfigureNotify;
+    event.xconfigure.window = window;
+    event.xconfigure.width = width;
+    return event;
+}
+
+auto ExposeRect(const Window window, const std::int32_t x, const std::int32_t y, const std::int32_t w,
+                const std::int32_t h, const std::int32_t count) -> XEvent
+{
+    XEvent event{};
+    event.xexpose.type = Expose;
+    event.xexpose.window = window;
+    event.xexpose.x = x;
+    event.xexpose.y = y;
+    event.xexpose.width = w;
+    event.xexpose.height = h;
+    event.xexpose.count = count;
+    return event;
+}
+
+auto Button(const Window window) -> XEvent
+{
+    XEvent event{};
+    event.xbutton.type = ButtonPress;
+    event.xbutton.window = window;
+    return event;
+}
+} // namespace
+
+TEST(TileboxCoreX11EventCoalescerTestSuite, VerifyKeepsLastMotionPerWindow)
+{
+    std::vector<XEvent> batch = {Motion(1, 10), Motion(2, 20), Motion(1, 11), Motion(1, 12), Motion(2, 21)};
+    X11EventCoalescer coalescer;
+
+    const std::size_t survivors = coalescer.Coalesce(batch);
+
+    ASSERT_EQ(survivors, 2);
+    ASSERT_EQ(batch[0].xmotion.x, 12);
+    ASSERT_EQ(batch[1].xmotion.x, 21);
+    ASSERT_EQ(coalescer.Stats().motion, 3);
+    ASSERT_EQ(coalescer.Stats().dequeued, 5);
+}
+
+TEST(TileboxCoreX11EventCoalescerTestSuite, VerifyInputEventsEndMotionRuns)
+{
+    std::vector<XEvent> batch = {Motion(1, 10), Motion(1, 11), Button(1), Motion(1, 12), Motion(1, 13)};
+    X11EventCoalescer coalescer;
+
+    const std::size_t survivors = coalescer.Coalesce(batch);
+
+    ASSERT_EQ(survivors, 3);
+    ASSERT_EQ(batch[0].xmotion.x, 11);
+    ASSERT_EQ(batch[1].type, ButtonPress);
+    ASSERT_EQ(batch[2].xmotion.x, 13);
+}
+
+TEST(TileboxCoreX11EventCoalescerTestSuite, VerifyKeepsLastConfigureAcrossOtherWindows)
+{
+    std::vector<XEvent> batch = {Configure(1, 100), Configure(2, 50), Configure(1, 200), Button(3)};
+    X11EventCoalescer coalescer;
+
+    const std::size_t survivors = coalescer.Coalesce(batch);
+
+    ASSERT_EQ(survivors, 3);
+    ASSERT_EQ(batch[0].xconfigure.window, 2);
+    ASSERT_EQ(batch[1].xconfigure.width, 200);
+    ASSERT_EQ(batch[2].type, ButtonPress);
+    ASSERT_EQ(coalescer.Stats().configure, 1);
+}
+
+TEST(TileboxCoreX11EventCoalescerTestSuite, VerifyMergesExposeArea)
+{
+    std::vector<XEvent> batch = {ExposeRect(1, 0, 0, 10, 10, 2), ExposeRect(1, 50, 5, 10, 20, 1),
+                                 ExposeRect(1, 20, 40, 5, 5, 0)};
+    X11EventCoalescer coalescer;
+
+    const std::size_t survivors = coalescer.Coalesce(batch);
+
+    ASSERT_EQ(survivors, 1);
+    const XExposeEvent &merged = batch[0].xexpose;
+    ASSERT_EQ(merged.x, 0);
+    ASSERT_EQ(merged.y, 0);
+    ASSERT_EQ(merged.width, 60);
+    ASSERT_EQ(merged.height, 45);
+    ASSERT_EQ(merged.count, 0);
+    ASSERT_EQ(coalescer.Stats().expose, 2);
+    ASSERT_EQ(coalescer.Stats().Coalesced(), 2);
+}
+
+TEST(TileboxCoreX11EventCoalescerTestSuite, VerifyExposeMergingCanBeDisabled)
+{
+    std::vector<XEvent> batch = {ExposeRect(1, 0, 0, 10, 10, 1), Motion(1, 10), ExposeRect(1, 50, 5, 10, 20, 0),
+                                 Motion(1, 11)};
+    X11EventCoalescer coalescer;
+    coalescer.SetExposeMerging(false);
+
+    ASSERT_EQ(coalescer.Coalesce(batch), 3);
+    ASSERT_EQ(batch[0].xexpose.width, 10);
+    ASSERT_EQ(batch[1].xexpose.x, 50);
+    ASSERT_EQ(coalescer.Stats().expose, 0);
+    ASSERT_EQ(coalescer.Stats().motion, 1);
+}
+
+TEST(TileboxCoreX11EventCoalescerTestSuite, VerifyUnmapEndsWindowRuns)
+{
+    XEvent unmap{};
+    unmap.xunmap.type = UnmapNotify;
+    unmap.xunmap.window = 1;
+
+    std::vector<XEvent> batch = {Configure(1, 100), unmap, Configure(1, 200)};
+    X11EventCoalescer coalescer;
+
+    ASSERT_EQ(coalescer.Coalesce(batch), 3);
+    ASSERT_EQ(coalescer.Stats().Coalesced(), 0);
+}
@@ -0,0 +1,448 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/events.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+auto MakeEvent(const std::int32_t type) -> XEvent
+{
+    XEvent event{};
+    event.type = type;
+    return event;
+}
+
+/// @brief Events kept in flight by StreamEvents, enough that the queue never drains while the stream lasts.
+constexpr std::int32_t kStreamInFlight = 64;
+
+/// @brief Keeps a steady stream of ClientMessages coming, every handled one sends the next until `length` were sent.
+///
+/// @details Handling takes a while, so the events in flight arrive faster than they are handled, as during a drag.
+///
+/// @returns The window the events are sent to, created by this client so the server delivers them back to it.
+auto StreamEvents(X11Display &display, X11EventLoop &loop, const std::int32_t length, std::int32_t &handled) -> Window
+{
+    Display *dpy = display.Raw();
+    const Window window = XCreateSimpleWindow(dpy, display.GetRootWindow(), 0, 0, 1, 1, 0, 0, 0);
+    const auto send = [dpy, window]() -> void {
+        XEvent event{};
+        event.xclient.type = ClientMessage;
+        event.xclient.window = window;
+        event.xclient.format = 32;
+        XSendEvent(dpy, window, False, NoEventMask, &event);
+
+        // XPending only flushes once the queue is empty, which is exactly what the stream must never be
+        XFlush(dpy);
+    };
+
+    loop.RegisterEventHandler(X11EventType::X11ClientMessage, [&handled, length, send](XEvent *) -> void {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        if (++handled + kStreamInFlight <= length)
+        {
+            send();
+        }
+    });
+    for (std::int32_t i = 0; i < kStreamInFlight; ++i)
+    {
+        send();
+    }
+    XSync(dpy, False);
+    return window;
+}
+} // namespace
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyDispatchCallsRegisteredHandler)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t motion_count = 0;
+    std::int32_t key_count = 0;
+
+    loop.RegisterEventHandler(X11EventType::X11MotionNotify, [&](XEvent *) -> void { ++motion_count; });
+    loop.RegisterEventHandler(X11EventType::X11KeyPress, [&](XEvent *) -> void { ++key_count; });
+
+    XEvent motion = MakeEvent(MotionNotify);
+    XEvent key = MakeEvent(KeyPress);
+    loop.Dispatch(&motion);
+    loop.Dispatch(&motion);
+    loop.Dispatch(&key);
+
+    ASSERT_EQ(motion_count, 2);
+    ASSERT_EQ(key_count, 1);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyFirstRegisteredHandlerWins)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t first = 0;
+    std::int32_t second = 0;
+
+    loop.RegisterEventHandler(X11EventType::X11Expose, [&](XEvent *) -> void { ++first; });
+    loop.RegisterEventHandler(X11EventType::X11Expose, [&](XEvent *) -> void { ++second; });
+
+    XEvent expose = MakeEvent(Expose);
+    loop.Dispatch(&expose);
+
+    ASSERT_EQ(first, 1);
+    ASSERT_EQ(second, 0);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyUnhandledAndOutOfRangeEventsAreIgnored)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t count = 0;
+
+    loop.RegisterEventHandler(X11EventType::X11LASTEvent, [&](XEvent *) -> void { ++count; });
+    loop.RegisterEventHandler(X11EventType::X11GenericEvent, [&](XEvent *) -> void { ++count; });
+
+    XEvent unhandled = MakeEvent(ButtonPress);
+    XEvent extension = MakeEvent(LASTEvent + 10);
+    XEvent negative = MakeEvent(-1);
+    loop.Dispatch(&unhandled);
+    loop.Dispatch(&extension);
+    loop.Dispatch(&negative);
+    ASSERT_EQ(count, 0);
+
+    XEvent generic = MakeEvent(GenericEvent);
+    loop.Dispatch(&generic);
+    ASSERT_EQ(count, 1);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyWindowHandlersTakePrecedence)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t global = 0;
+    std::int32_t routed = 0;
+
+    loop.RegisterEventHandler(X11EventType::X11ButtonPress, [&](XEvent *) -> void { ++global; });
+    loop.RegisterWindowEventHandler(X11EventType::X11ButtonPress, 0x400001, [&](XEvent *) -> void { ++routed; });
+
+    XEvent press = MakeEvent(ButtonPress);
+    press.xbutton.window = 0x400001;
+    loop.Dispatch(&press);
+    press.xbutton.window = 0x400002;
+    loop.Dispatch(&press);
+
+    ASSERT_EQ(routed, 1);
+    ASSERT_EQ(global, 1);
+
+    loop.UnregisterWindowEventHandler(X11EventType::X11ButtonPress, 0x400001);
+    press.xbutton.window = 0x400001;
+    loop.Dispatch(&press);
+    ASSERT_EQ(routed, 1);
+    ASSERT_EQ(global, 2);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifySubstructureEventsRouteToChild)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t routed = 0;
+
+    loop.RegisterWindowEventHandler(X11EventType::X11MapRequest, 0x400001, [&](XEvent *) -> void { ++routed; });
+
+    XEvent request = MakeEvent(MapRequest);
+    request.xmaprequest.parent = 0x100;
+    request.xmaprequest.window = 0x400001;
+    loop.Dispatch(&request);
+
+    ASSERT_EQ(routed, 1);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyDestroyNotifyRemovesWindowHandlers)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t exposes = 0;
+    std::int32_t destroys = 0;
+
+    loop.RegisterWindowEventHandler(X11EventType::X11Expose, 0x400001, [&](XEvent *) -> void { ++exposes; });
+    loop.RegisterWindowEventHandler(X11EventType::X11DestroyNotify, 0x400001, [&](XEvent *) -> void { ++destroys; });
+
+    XEvent destroy = MakeEvent(DestroyNotify);
+    destroy.xdestroywindow.window = 0x400001;
+    loop.Dispatch(&destroy);
+    loop.Dispatch(&destroy);
+
+    XEvent expose = MakeEvent(Expose);
+    expose.xexpose.window = 0x400001;
+    loop.Dispatch(&expose);
+
+    ASSERT_EQ(destroys, 1);
+    ASSERT_EQ(exposes, 0);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyLatencyTrackingTimesHandlers)
+{
+    X11EventLoop loop(nullptr);
+    loop.RegisterEventHandler(X11EventType::X11KeyPress, [](XEvent *) -> void {});
+
+    XEvent press = MakeEvent(KeyPress);
+    loop.Dispatch(&press);
+    ASSERT_EQ(loop.LatencyStats(), nullptr);
+
+    loop.SetLatencyTracking(true);
+    loop.Dispatch(&press);
+    loop.Dispatch(&press);
+    ASSERT_TRUE(loop.IsLatencyTracking());
+    ASSERT_EQ(loop.LatencyStats()->HandlerTime(X11EventType::X11KeyPress).Count(), 2);
+
+    loop.ResetLatencyStats();
+    ASSERT_EQ(loop.LatencyStats()->HandlerTime(X11EventType::X11KeyPress).Count(), 0);
+
+    loop.SetLatencyTracking(false);
+    ASSERT_EQ(loop.LatencyStats(), nullptr);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyIdleWorkIsDeduplicatedAndOrdered)
+{
+    X11EventLoop loop(nullptr);
+    std::vector<std::int32_t> ran;
+
+    for (std::int32_t i = 0; i < 10; ++i)
+    {
+        loop.ScheduleIdle(1, [&ran, i]() -> void { ran.push_back(i); });
+    }
+    loop.ScheduleIdle(2, [&]() -> void { ran.push_back(100); });
+    loop.ScheduleIdle(3, [&]() -> void { ran.push_back(200); });
+    loop.ScheduleIdle(0, [&]() -> void { ran.push_back(-1); });
+    ASSERT_EQ(loop.PendingIdleWork(), 3);
+
+    loop.CancelIdle(2);
+    ASSERT_FALSE(loop.IsIdleScheduled(2));
+    ASSERT_TRUE(loop.IsIdleScheduled(3));
+
+    // The latest callback for key 1 runs once, in the place of the first request
+    ASSERT_FALSE(loop.RunIdleWork());
+    ASSERT_EQ(ran, (std::vector<std::int32_t>{9, 200}));
+    ASSERT_EQ(loop.PendingIdleWork(), 0);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyIdleWorkRunsInBudgetedSlices)
+{
+    X11EventLoop loop(nullptr);
+    loop.SetIdleBudget(std::chrono::microseconds(0));
+
+    std::int32_t ran = 0;
+    for (X11IdleKey key = 1; key <= 3; ++key)
+    {
+        loop.ScheduleIdle(key, [&]() -> void { ++ran; });
+    }
+
+    // A spent budget still runs one callback per slice
+    ASSERT_TRUE(loop.RunIdleWork());
+    ASSERT_EQ(ran, 1);
+    ASSERT_TRUE(loop.RunIdleWork());
+    ASSERT_EQ(ran, 2);
+
+    // Rescheduling from inside a callback waits for the next slice
+    loop.SetIdleBudget(X11EventLoop::kDefaultIdleBudget);
+    std::int32_t reschedules = 0;
+    X11IdleCallback again = [&]() -> void { ++reschedules; };
+    loop.ScheduleIdle(4, [&]() -> void { loop.ScheduleIdle(4, again); });
+    ASSERT_TRUE(loop.RunIdleWork());
+    ASSERT_EQ(ran, 3);
+    ASSERT_EQ(reschedules, 0);
+    ASSERT_FALSE(loop.RunIdleWork());
+    ASSERT_EQ(reschedules, 1);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyRunPolledCompletesIdleWork)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    X11EventLoop loop(std::move(dpy_opt.value()));
+    loop.SetIdleBudget(std::chrono::microseconds(0));
+
+    bool running = true;
+    std::int32_t ran = 0;
+    for (X11IdleKey key = 1; key <= 16; ++key)
+    {
+        loop.ScheduleIdle(key, [&]() -> void {
+            if (++ran == 16)
+            {
+                running = false;
+            }
+        });
+    }
+
+    // Nothing else ever wakes the loop up, it must not go to sleep with idle work pending
+    ASSERT_TRUE(loop.RunPolled(running).is_ok());
+    ASSERT_EQ(ran, 16);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyRunPolledServicesTimersAndDescriptors)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    X11EventLoop loop(std::move(dpy_opt.value()));
+    std::array<std::int32_t, 2> pipe_fds{};
+    ASSERT_EQ(pipe(pipe_fds.data()), 0);
+
+    bool running = true;
+    std::int32_t ticks = 0;
+    std::int32_t reads = 0;
+
+    auto timer_res = loop.AddTimer(std::chrono::milliseconds(1), std::chrono::milliseconds(1), [&]() -> void {
+        if (++ticks == 3)
+        {
+            const char byte = 'x';
+            ASSERT_EQ(write(pipe_fds[1], &byte, 1), 1);
+        }
+    });
+    ASSERT_TRUE(timer_res.is_ok());
+
+    auto watch_res = loop.WatchFileDescriptor(pipe_fds[0], EPOLLIN, [&](const std::uint32_t events) -> void {
+        char byte = 0;
+        ASSERT_NE(events & EPOLLIN, 0U);
+        ASSERT_EQ(read(pipe_fds[0], &byte, 1), 1);
+        ++reads;
+        running = false;
+    });
+    ASSERT_TRUE(watch_res.is_ok());
+
+    ASSERT_TRUE(loop.RunPolled(running).is_ok());
+    ASSERT_GE(ticks, 3);
+    ASSERT_EQ(reads, 1);
+
+    loop.RemoveTimer(*timer_res.ok());
+    loop.UnwatchFileDescriptor(pipe_fds[0]);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyPostedTasksRunOnLoopThread)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    X11EventLoop loop(std::move(dpy_opt.value()));
+    constexpr std::int32_t kPostsPerWorker = 1000;
+
+    bool running = true;
+    std::int32_t executed = 0;
+    std::atomic<std::int32_t> finished_workers = 0;
+    const auto loop_thread = std::this_thread::get_id();
+
+    std::vector<std::thread> workers;
+    for (std::int32_t w = 0; w < 3; ++w)
+    {
+        workers.emplace_back([&]() -> void {
+            for (std::int32_t i = 0; i < kPostsPerWorker; ++i)
+            {
+                loop.Post([&]() -> void {
+                    EXPECT_EQ(std::this_thread::get_id(), loop_thread);
+                    ++executed;
+                });
+            }
+            if (++finished_workers == 3)
+            {
+                // Runs after every earlier post of this worker, and the other workers are done posting
+                loop.Post([&]() -> void { running = false; });
+            }
+        });
+    }
+
+    ASSERT_TRUE(loop.RunPolled(running).is_ok());
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    ASSERT_EQ(executed, 3 * kPostsPerWorker);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyPostedTaskStopsRun)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    X11EventLoop loop(std::move(dpy_opt.value()));
+    bool running = true;
+
+    // No X event ever arrives, only the posted task can end the loop
+    std::thread worker([&]() -> void {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        loop.Post([&]() -> void { running = false; });
+    });
+    loop.Run(running);
+    worker.join();
+    ASSERT_FALSE(running);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyPostedTasksRunDuringEventStream)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    X11EventLoop loop(*dpy_opt);
+    constexpr std::int32_t kStreamLength = 20000;
+    std::int32_t handled = 0;
+    const Window window = StreamEvents(**dpy_opt, loop, kStreamLength, handled);
+
+    // The queue never drains while the stream lasts, the stop must not wait for it to end
+    bool running = true;
+    std::thread worker([&]() -> void {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        loop.Post([&]() -> void { running = false; });
+    });
+    loop.Run(running);
+    worker.join();
+    ASSERT_LT(handled, kStreamLength);
+
+    XDestroyWindow((*dpy_opt)->Raw(), window);
+}
+
+TEST(TileboxCoreX11EventLoopTestSuite, VerifyRunPolledServicesTimersDuringEventStream)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    X11EventLoop loop(*dpy_opt);
+    loop.SetEventBatching(true);
+    constexpr std::int32_t kStreamLength = 20000;
+    std::int32_t handled = 0;
+    const Window window = StreamEvents(**dpy_opt, loop, kStreamLength, handled);
+
+    bool running = true;
+    auto timer_res =
+        loop.AddTimer(std::chrono::milliseconds(10), std::chrono::milliseconds(0), [&]() -> void { running = false; });
+    ASSERT_TRUE(timer_res.is_ok());
+
+    ASSERT_TRUE(loop.RunPolled(running).is_ok());
+    ASSERT_LT(handled, kStreamLength);
+
+    XDestroyWindow((*dpy_opt)->Raw(), window);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/event_recorder.hpp>
+#include <tilebox/x11/events.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Tilebox;
+using namespace std::chrono_literals;
+
+namespace
+{
+auto TempPath(const std::string &name) -> std::string
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+auto RecordSession(const std::string &path, const std::vector<XEvent> &events) -> void
+{
+    auto res = X11EventRecorder::Create(path);
+    ASSERT_TRUE(res.is_ok());
+    X11EventRecorder recorder = std::move(*res.ok());
+
+    const std::chrono::steady_clock::time_point base{10s};
+    for (std::size_t i = 0; i < events.size(); ++i)
+    {
+        recorder.Record(events[i], base + (i * 1ms));
+    }
+    ASSERT_EQ(recorder.RecordedEvents(), events.size());
+    ASSERT_TRUE(recorder.Flush().is_ok());
+}
+
+auto SampleEvents() -> std::vector<XEvent>
+{
+    std::vector<XEvent> events(3);
+    events[0].type = MotionNotify;
+    events[0].xmotion.window = 0x400001;
+    events[0].xmotion.x = 17;
+    events[0].xmotion.display = reinterpret_cast<Display *>(0x1234); // NOLINT
+    events[1].type = ConfigureRequest;
+    events[1].xconfigurerequest.window = 0x400002;
+    events[1].xconfigurerequest.width = 640;
+    events[2].type = ClientMessage;
+    events[2].xclient.window = 0x400003;
+    events[2].xclient.data.l[4] = 99;
+    return events;
+}
+} // namespace
+
+TEST(TileboxCoreX11EventRecorderTestSuite, VerifyRecordingRoundTrips)
+{
+    const std::string path = TempPath("tilebox_event_recorder_roundtrip.bin");
+    const std::vector<XEvent> events = SampleEvents();
+    RecordSession(path, events);
+
+    auto res = X11EventReplay::Open(path);
+    ASSERT_TRUE(res.is_ok());
+    X11EventReplay replay = std::move(*res.ok());
+
+    XEvent event;
+    std::chrono::nanoseconds timestamp{};
+    ASSERT_TRUE(replay.Next(event, timestamp));
+    ASSERT_EQ(timestamp, 0ns);
+    ASSERT_EQ(event.type, MotionNotify);
+    ASSERT_EQ(event.xmotion.window, 0x400001);
+    ASSERT_EQ(event.xmotion.x, 17);
+    ASSERT_EQ(event.xmotion.display, nullptr);
+
+    ASSERT_TRUE(replay.Next(event, timestamp));
+    ASSERT_EQ(timestamp, 1ms);
+    ASSERT_EQ(event.xconfigurerequest.width, 640);
+
+    ASSERT_TRUE(replay.Next(event, timestamp));
+    ASSERT_EQ(timestamp, 2ms);
+    ASSERT_EQ(event.xclient.data.l[4], 99);
+
+    ASSERT_FALSE(replay.Next(event, timestamp));
+
+    replay.Rewind();
+    ASSERT_TRUE(replay.Next(event, timestamp));
+    ASSERT_EQ(event.type, MotionNotify);
+
+    std::filesystem::remove(path);
+}
+
+TEST(TileboxCoreX11EventRecorderTestSuite, VerifyPlayDispatchesThroughHandlers)
+{
+    const std::string path = TempPath("tilebox_event_recorder_play.bin");
+    RecordSession(path, SampleEvents());
+
+    auto res = X11EventReplay::Open(path);
+    ASSERT_TRUE(res.is_ok());
+    X11EventReplay replay = std::move(*res.ok());
+
+    X11EventLoop loop(nullptr);
+    std::vector<std::int32_t> seen;
+    for (const auto type : {X11EventType::X11MotionNotify, X11EventType::X11ConfigureRequest,
+                            X11EventType::X11ClientMessage})
+    {
+        loop.RegisterEventHandler(type, [&](XEvent *event) -> void { seen.push_back(event->type); });
+    }
+
+    const bool run = true;
+    ASSERT_EQ(replay.Play(loop, X11ReplaySpeed::RealTime, run), 3);
+    ASSERT_EQ(seen, (std::vector<std::int32_t>{MotionNotify, ConfigureRequest, ClientMessage}));
+
+    replay.Rewind();
+    ASSERT_EQ(replay.Play(loop, X11ReplaySpeed::AsFastAsPossible, run), 3);
+    ASSERT_EQ(seen.size(), 6);
+
+    std::filesystem::remove(path);
+}
+
+TEST(TileboxCoreX11EventRecorderTestSuite, VerifyGenericEventsAreSkipped)
+{
+    const std::string path = TempPath("tilebox_event_recorder_generic.bin");
+    {
+        auto res = X11EventRecorder::Create(path);
+        ASSERT_TRUE(res.is_ok());
+        X11EventRecorder recorder = std::move(*res.ok());
+
+        std::vector<XEvent> events = SampleEvents();
+        XEvent generic{};
+        generic.xcookie.type = GenericEvent;
+        generic.xcookie.extension = 131;
+        events.insert(events.begin() + 1, generic);
+
+        const std::chrono::steady_clock::time_point base{10s};
+        for (const XEvent &event : events)
+        {
+            recorder.Record(event, base);
+        }
+        ASSERT_EQ(recorder.RecordedEvents(), 3);
+        ASSERT_EQ(recorder.SkippedEvents(), 1);
+    }
+
+    auto res = X11EventReplay::Open(path);
+    ASSERT_TRUE(res.is_ok());
+    X11EventReplay replay = std::move(*res.ok());
+
+    X11EventLoop loop(nullptr);
+    std::vector<std::int32_t> seen;
+    for (const auto type : {X11EventType::X11MotionNotify, X11EventType::X11ConfigureRequest})
+    {
+        loop.RegisterEventHandler(type, [&](XEvent *event) -> void { seen.push_back(event->type); });
+    }
+
+    const bool run = true;
+    ASSERT_EQ(replay.Play(loop, X11ReplaySpeed::AsFastAsPossible, run), 3);
+    ASSERT_EQ(seen, (std::vector<std::int32_t>{MotionNotify, ConfigureRequest}));
+
+    std::filesystem::remove(path);
+}
+
+TEST(TileboxCoreX11EventRecorderTestSuite, VerifyInvalidRecordingsAreRejected)
+{
+    ASSERT_TRUE(X11EventReplay::Open(TempPath("tilebox_event_recorder_missing.bin")).is_err());
+
+    const std::string path = TempPath("tilebox_event_recorder_invalid.bin");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "definitely not an event recording";
+    }
+    ASSERT_TRUE(X11EventReplay::Open(path).is_err());
+
+    // A recording cut off in the middle of a record still replays every complete record
+    RecordSession(path, SampleEvents());
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+
+    auto res = X11EventReplay::Open(path);
+    ASSERT_TRUE(res.is_ok());
+    X11EventReplay replay = std::move(*res.ok());
+
+    X11EventLoop loop(nullptr);
+    const bool run = true;
+    ASSERT_EQ(replay.Play(loop, X11ReplaySpeed::AsFastAsPossible, run), 2);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/utils/flat_map.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+
+using namespace Tilebox;
+
+TEST(TileboxUtilsFlatMapTestSuite, VerifyInsertFindErase)
+{
+    FlatMap<std::int32_t> map;
+
+    ASSERT_TRUE(map.Empty());
+    ASSERT_EQ(map.Find(42), nullptr);
+
+    ASSERT_NE(map.InsertOrAssign(42, 1), nullptr);
+    ASSERT_NE(map.InsertOrAssign(43, 2), nullptr);
+    ASSERT_EQ(map.Size(), 2);
+    ASSERT_EQ(*map.Find(42), 1);
+
+    map.InsertOrAssign(42, 3);
+    ASSERT_EQ(map.Size(), 2);
+    ASSERT_EQ(*map.Find(42), 3);
+
+    ASSERT_TRUE(map.Erase(42));
+    ASSERT_FALSE(map.Erase(42));
+    ASSERT_FALSE(map.Contains(42));
+    ASSERT_TRUE(map.Contains(43));
+    ASSERT_EQ(map.Size(), 1);
+}
+
+TEST(TileboxUtilsFlatMapTestSuite, VerifyEmptyKeyIsRejected)
+{
+    FlatMap<std::int32_t> map;
+
+    ASSERT_EQ(map.InsertOrAssign(FlatMap<std::int32_t>::kEmptyKey, 1), nullptr);
+    ASSERT_TRUE(map.Empty());
+}
+
+TEST(TileboxUtilsFlatMapTestSuite, VerifyMatchesReferenceUnderChurn)
+{
+    FlatMap<std::uint64_t> map;
+    std::unordered_map<std::uint64_t, std::uint64_t> reference;
+
+    // Sequential XID like keys with interleaved erases exercise growth and backward shift deletion.
+    std::uint64_t state = 0x12345678;
+    for (std::uint64_t i = 0; i < 20000; ++i)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const std::uint64_t key = 0x400000 + ((state >> 33U) % 3000);
+        if ((state >> 20U) % 3 == 0)
+        {
+            ASSERT_EQ(map.Erase(key), reference.erase(key) == 1);
+        }
+        else
+        {
+            map.InsertOrAssign(key, i);
+            reference[key] = i;
+        }
+    }
+
+    ASSERT_EQ(map.Size(), reference.size());
+    for (const auto &[key, value] : reference)
+    {
+        ASSERT_NE(map.Find(key), nullptr);
+        ASSERT_EQ(*map.Find(key), value);
+    }
+
+    std::size_t visited = 0;
+    map.ForEach([&](const std::uint64_t key, const std::uint64_t value) -> void {
+        ASSERT_EQ(reference.at(key), value);
+        ++visited;
+    });
+    ASSERT_EQ(visited, reference.size());
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/utils/inplace_function.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+using namespace Tilebox;
+
+TEST(TileboxUtilsInplaceFunctionTestSuite, VerifyEmptyByDefault)
+{
+    const InplaceFunction<void()> fn;
+    const InplaceFunction<void()> null_fn(nullptr);
+
+    ASSERT_FALSE(fn);
+    ASSERT_FALSE(null_fn);
+}
+
+TEST(TileboxUtilsInplaceFunctionTestSuite, VerifyInvokeWithCaptures)
+{
+    std::int32_t base = 10;
+    const InplaceFunction<std::int32_t(std::int32_t)> fn = [&base](const std::int32_t v) -> std::int32_t {
+        return base + v;
+    };
+
+    ASSERT_TRUE(fn);
+    ASSERT_EQ(fn(5), 15);
+    base = 20;
+    ASSERT_EQ(fn(5), 25);
+}
+
+TEST(TileboxUtilsInplaceFunctionTestSuite, VerifyCopyAndMoveKeepState)
+{
+    auto counter = std::make_shared<std::int32_t>(0);
+    InplaceFunction<void()> fn = [counter]() -> void { ++(*counter); };
+    ASSERT_EQ(counter.use_count(), 2);
+
+    const InplaceFunction<void()> copy = fn;
+    ASSERT_EQ(counter.use_count(), 3);
+
+    InplaceFunction<void()> moved = std::move(fn);
+    ASSERT_EQ(counter.use_count(), 3);
+    ASSERT_FALSE(fn); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+
+    copy();
+    moved();
+    ASSERT_EQ(*counter, 2);
+
+    moved = nullptr;
+    ASSERT_FALSE(moved);
+    ASSERT_EQ(counter.use_count(), 2);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/utils/latency_histogram.hpp>
+#include <tilebox/x11/event_latency.hpp>
+#include <tilebox/x11/events.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using namespace Tilebox;
+using namespace std::chrono_literals;
+
+TEST(TileboxUtilsLatencyHistogramTestSuite, VerifyBucketsBoundTheirValues)
+{
+    for (std::uint64_t value = 0; value < (1ULL << 20U); value += 7)
+    {
+        const std::size_t index = LatencyHistogram::BucketIndex(value);
+        ASSERT_LT(index, LatencyHistogram::kBucketCount);
+        ASSERT_GE(LatencyHistogram::BucketUpperBound(index), value);
+        if (index > 0)
+        {
+            ASSERT_LT(LatencyHistogram::BucketUpperBound(index - 1), value);
+        }
+    }
+
+    ASSERT_EQ(LatencyHistogram::BucketIndex(~0ULL), LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(TileboxUtilsLatencyHistogramTestSuite, VerifyPercentiles)
+{
+    LatencyHistogram histogram;
+    ASSERT_EQ(histogram.ValueAtPercentile(50.0), 0);
+
+    for (std::uint64_t value = 1; value <= 1000; ++value)
+    {
+        histogram.Record(value * 1000);
+    }
+
+    ASSERT_EQ(histogram.Count(), 1000);
+    ASSERT_EQ(histogram.Min(), 1000);
+    ASSERT_EQ(histogram.Max(), 1'000'000);
+    ASSERT_EQ(histogram.Mean(), 500'500);
+
+    // Log-linear buckets keep every percentile within 1/16 of the exact value
+    const auto p50 = static_cast<double>(histogram.ValueAtPercentile(50.0));
+    const auto p99 = static_cast<double>(histogram.ValueAtPercentile(99.0));
+    ASSERT_NEAR(p50, 500'000.0, 500'000.0 / 16);
+    ASSERT_NEAR(p99, 990'000.0, 990'000.0 / 16);
+    ASSERT_EQ(histogram.ValueAtPercentile(100.0), 1'000'000);
+
+    histogram.Reset();
+    ASSERT_EQ(histogram.Count(), 0);
+}
+
+TEST(TileboxCoreX11EventLatencyTestSuite, VerifyServerClockCalibration)
+{
+    X11ServerClock clock;
+    const std::chrono::steady_clock::time_point base{100s};
+
+    // The first sample defines the offset, later ones measure against it
+    ASSERT_EQ(clock.QueueLatency(5000, base), 0ns);
+    ASSERT_EQ(clock.QueueLatency(5010, base + 13ms), 3ms);
+
+    // A faster delivery lowers the offset estimate
+    ASSERT_EQ(clock.QueueLatency(5020, base + 19ms), 0ns);
+    ASSERT_EQ(clock.QueueLatency(5030, base + 30ms), 1ms);
+}
+
+TEST(TileboxCoreX11EventLatencyTestSuite, VerifyServerClockUnwrapsTimestamps)
+{
+    X11ServerClock clock;
+    const std::chrono::steady_clock::time_point base{100s};
+
+    ASSERT_EQ(clock.QueueLatency(0xFFFFFFF0, base), 0ns);
+    ASSERT_EQ(clock.QueueLatency(0x10, base + 32ms + 2ms), 2ms);
+}
+
+TEST(TileboxCoreX11EventLatencyTestSuite, VerifyOnlyRealInputEventsAreQueued)
+{
+    X11EventLatency latency;
+    const std::chrono::steady_clock::time_point base{100s};
+
+    XEvent motion{};
+    motion.type = MotionNotify;
+    motion.xmotion.time = 1000;
+    latency.RecordDequeue(motion, base);
+    motion.xmotion.time = 1004;
+    latency.RecordDequeue(motion, base + 9ms);
+
+    XEvent synthetic = motion;
+    synthetic.xany.send_event = True;
+    latency.RecordDequeue(synthetic, base + 10ms);
+
+    XEvent property{};
+    property.type = PropertyNotify;
+    property.xproperty.time = 1005;
+    latency.RecordDequeue(property, base + 10ms);
+
+    const LatencyHistogram &queue = latency.QueueLatency(X11EventType::X11MotionNotify);
+    ASSERT_EQ(queue.Count(), 2);
+    ASSERT_EQ(queue.Max(), 5'000'000);
+    ASSERT_EQ(latency.QueueLatency(X11EventType::X11PropertyNotify).Count(), 0);
+
+    latency.RecordHandler(MotionNotify, 2us);
+    ASSERT_EQ(latency.HandlerTime(X11EventType::X11MotionNotify).Count(), 1);
+    ASSERT_NE(latency.Report().find("MotionNotify"), std::string::npos);
+
+    latency.Reset();
+    ASSERT_EQ(queue.Count(), 0);
+    ASSERT_TRUE(latency.Report().empty());
+}
@@ -0,0 +1,151 @@
+#include <tilebox/geometry.hpp>
+#include <tilebox/layout.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+
+constexpr LayoutKind kKinds[] = {
+    LayoutKind::MasterStack, LayoutKind::Grid,           LayoutKind::Monocle,
+    LayoutKind::Columns,     LayoutKind::CenteredMaster,
+};
+
+auto Tile(const std::int32_t x, const std::int32_t y, const std::uint32_t w, const std::uint32_t h) -> Rect
+{
+    return {Point(X(x), Y(y)), Width(w), Height(h)};
+}
+
+} // namespace
+
+TEST(TileboxCoreLayoutTestSuite, VerifyMasterStackTiles)
+{
+    TilingLayout layout(LayoutKind::MasterStack,
+                        {.area = Tile(0, 0, 1920, 1080), .masters = 1, .master_permille = 500, .gap = 0, .border = 0});
+
+    std::vector<Rect> tiles(3);
+    const LayoutChange change = layout.Arrange(tiles);
+    ASSERT_EQ(change.first, 0U);
+    ASSERT_EQ(change.count, 3U);
+    ASSERT_EQ(tiles[0], Tile(0, 0, 960, 1080));
+    ASSERT_EQ(tiles[1], Tile(960, 0, 960, 540));
+    ASSERT_EQ(tiles[2], Tile(960, 540, 960, 540));
+
+    // A single client takes the whole area, less gaps and borders
+    layout.SetParams({.area = Tile(0, 0, 1920, 1080), .masters = 1, .master_permille = 500, .gap = 10, .border = 2});
+    tiles.resize(1);
+    layout.Arrange(tiles);
+    ASSERT_EQ(tiles[0], Tile(10, 10, 1896, 1056));
+}
+
+TEST(TileboxCoreLayoutTestSuite, VerifyTileOfMissingClientIsDefault)
+{
+    for (const LayoutKind kind : kKinds)
+    {
+        const TilingLayout layout(kind, {.area = Tile(0, 0, 1920, 1080), .gap = 10});
+        ASSERT_EQ(layout.TileOf(0, 0), Rect());
+        ASSERT_EQ(layout.TileOf(3, 3), Rect());
+    }
+}
+
+TEST(TileboxCoreLayoutTestSuite, VerifyLeftoverPixelsAreDistributed)
+{
+    TilingLayout layout(LayoutKind::Columns, {.area = Tile(0, 0, 1001, 500), .gap = 10});
+
+    std::vector<Rect> tiles(3);
+    layout.Arrange(tiles);
+
+    // 1001 less two outer and two inner gaps leaves 961 pixels, the first column gets the remaining one
+    ASSERT_EQ(tiles[0], Tile(10, 10, 321, 480));
+    ASSERT_EQ(tiles[1], Tile(341, 10, 320, 480));
+    ASSERT_EQ(tiles[2], Tile(671, 10, 320, 480));
+    ASSERT_EQ(tiles[2].GetX() + static_cast<std::int32_t>(tiles[2].GetW()) + 10, 1001);
+}
+
+TEST(TileboxCoreLayoutTestSuite, VerifyCenteredMasterAlternatesStacks)
+{
+    TilingLayout layout(LayoutKind::CenteredMaster,
+                        {.area = Tile(0, 0, 1000, 600), .masters = 1, .master_permille = 500});
+
+    std::vector<Rect> tiles(4);
+    layout.Arrange(tiles);
+    ASSERT_EQ(tiles[0], Tile(250, 0, 500, 600));
+    ASSERT_EQ(tiles[1], Tile(750, 0, 250, 300));
+    ASSERT_EQ(tiles[2], Tile(0, 0, 250, 600));
+    ASSERT_EQ(tiles[3], Tile(750, 300, 250, 300));
+}
+
+TEST(TileboxCoreLayoutTestSuite, VerifyTilesCoverTheArea)
+{
+    const Rect area = Tile(100, 20, 1917, 1063);
+    for (const LayoutKind kind : kKinds)
+    {
+        if (kind == LayoutKind::Monocle)
+        {
+            continue;
+        }
+
+        TilingLayout layout(kind, {.area = area, .masters = 2, .master_permille = 600});
+        std::vector<Rect> tiles;
+        for (std::size_t count = 1; count <= 17; ++count)
+        {
+            tiles.resize(count);
+            layout.Arrange(tiles);
+
+            std::uint64_t covered = 0;
+            for (const Rect &tile : tiles)
+            {
+                ASSERT_TRUE(area.Contains(tile));
+                covered += static_cast<std::uint64_t>(tile.GetW()) * tile.GetH();
+            }
+            ASSERT_EQ(covered, static_cast<std::uint64_t>(area.GetW()) * area.GetH());
+        }
+    }
+}
+
+TEST(TileboxCoreLayoutTestSuite, VerifyIncrementalArrangeMatchesFullArrange)
+{
+    const LayoutParams params{.area = Tile(0, 0, 2560, 1440), .masters = 2, .gap = 8, .border = 1};
+    const std::vector<std::size_t> counts = {1, 2, 3, 4, 5, 9, 8, 3, 2, 6, 7, 1, 0, 4};
+
+    for (const LayoutKind kind : kKinds)
+    {
+        TilingLayout layout(kind, params);
+        std::vector<Rect> tiles;
+        for (const std::size_t count : counts)
+        {
+            tiles.resize(count);
+            const LayoutChange change = layout.Arrange(tiles);
+            ASSERT_EQ(change.first + change.count, count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                ASSERT_EQ(tiles[i], layout.TileOf(i, count));
+            }
+        }
+    }
+
+    // Joining the stack only touches the stack
+    TilingLayout layout(LayoutKind::MasterStack, params);
+    std::vector<Rect> tiles(3);
+    layout.Arrange(tiles);
+    tiles.resize(4);
+    LayoutChange change = layout.Arrange(tiles);
+    ASSERT_EQ(change.first, 2U);
+    ASSERT_EQ(change.count, 2U);
+
+    change = layout.Arrange(tiles);
+    ASSERT_EQ(change.count, 0U);
+
+    layout.SetKind(LayoutKind::Monocle);
+    change = layout.Arrange(tiles);
+    ASSERT_EQ(change.first, 0U);
+    tiles.resize(6);
+    change = layout.Arrange(tiles);
+    ASSERT_EQ(change.first, 4U);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/geometry.hpp>
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/monitors.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <array>
+#include <cstdint>
+
+using namespace Tilebox;
+
+namespace
+{
+
+auto MakeRect(const std::int32_t x, const std::int32_t y, const std::uint32_t w, const std::uint32_t h) -> Rect
+{
+    return {Point(X(x), Y(y)), Width(w), Height(h)};
+}
+
+auto At(const std::int32_t x, const std::int32_t y) -> Point
+{
+    return {X(x), Y(y)};
+}
+
+} // namespace
+
+TEST(TileboxCoreX11MonitorsTestSuite, VerifyPointLookupFollowsLayout)
+{
+    // Given out of order: a portrait monitor right of a primary 1440p one, right of a 1080p one
+    const std::array<X11Monitor, 3> monitors = {X11Monitor{MakeRect(4480, 200, 1080, 1920), 0x63, 0x45, false},
+                                                X11Monitor{MakeRect(1920, 0, 2560, 1440), 0x62, 0x44, true},
+                                                X11Monitor{MakeRect(0, 0, 1920, 1080), 0x61, 0x43, false}};
+    X11MonitorTable table;
+    table.Assign(monitors);
+
+    ASSERT_EQ(table.Size(), 3);
+    ASSERT_EQ(table.At(0)->crtc, 0x61);
+    ASSERT_EQ(table.At(1)->crtc, 0x62);
+    ASSERT_EQ(table.At(2)->crtc, 0x63);
+    ASSERT_EQ(table.At(3), nullptr);
+    ASSERT_EQ(table.Primary()->crtc, 0x62);
+
+    ASSERT_EQ(table.IndexAt(At(0, 0)), 0);
+    ASSERT_EQ(table.IndexAt(At(1919, 1079)), 0);
+    ASSERT_EQ(table.IndexAt(At(1920, 0)), 1);
+    ASSERT_EQ(table.IndexAt(At(4479, 1439)), 1);
+    ASSERT_EQ(table.IndexAt(At(4480, 2119)), 2);
+
+    // Gaps and the outside belong to no monitor
+    ASSERT_FALSE(table.IndexAt(At(100, 1200)).has_value());
+    ASSERT_FALSE(table.IndexAt(At(4500, 100)).has_value());
+    ASSERT_FALSE(table.IndexAt(At(-1, 0)).has_value());
+    ASSERT_FALSE(table.IndexAt(At(5560, 300)).has_value());
+}
+
+TEST(TileboxCoreX11MonitorsTestSuite, VerifyCrtcChangesUpdateInPlace)
+{
+    X11MonitorTable table;
+    ASSERT_EQ(table.Primary(), nullptr);
+    ASSERT_FALSE(table.IndexAt(At(0, 0)).has_value());
+
+    ASSERT_TRUE(table.UpdateCrtc(0x61, MakeRect(0, 0, 1920, 1080)));
+    ASSERT_FALSE(table.UpdateCrtc(0x61, MakeRect(0, 0, 1920, 1080)));
+    ASSERT_TRUE(table.UpdateCrtc(0x62, MakeRect(1920, 0, 1920, 1080)));
+    ASSERT_EQ(table.Primary()->crtc, 0x61);
+
+    // Mirrors and disabled CRTCs add nothing
+    ASSERT_FALSE(table.UpdateCrtc(0x63, MakeRect(0, 0, 1920, 1080)));
+    ASSERT_FALSE(table.UpdateCrtc(None, MakeRect(0, 1080, 1920, 1080)));
+    ASSERT_FALSE(table.RemoveCrtc(0x64));
+    ASSERT_EQ(table.Size(), 2);
+
+    ASSERT_TRUE(table.SetCrtcOutput(0x62, 0x44));
+    ASSERT_TRUE(table.SetPrimaryOutput(0x44));
+    ASSERT_EQ(table.Primary()->crtc, 0x62);
+
+    // Moving the primary left of the other reorders the table and the lookup
+    ASSERT_TRUE(table.UpdateCrtc(0x62, MakeRect(-1920, 0, 1920, 1080)));
+    ASSERT_EQ(table.At(0)->crtc, 0x62);
+    ASSERT_TRUE(table.At(0)->primary);
+    ASSERT_EQ(table.IndexAt(At(-1, 10)), 0);
+    ASSERT_EQ(table.IndexAt(At(0, 10)), 1);
+    ASSERT_FALSE(table.IndexAt(At(1920, 10)).has_value());
+
+    ASSERT_TRUE(table.RemoveCrtc(0x62));
+    ASSERT_EQ(table.Size(), 1);
+    ASSERT_EQ(table.Primary()->crtc, 0x61);
+    ASSERT_EQ(table.IndexAt(At(10, 10)), 0);
+    ASSERT_FALSE(table.IndexAt(At(-1, 10)).has_value());
+}
+
+TEST(TileboxCoreX11MonitorsTestSuite, VerifyMirrorsOutliveTheListedCrtc)
+{
+    X11MonitorTable table;
+    ASSERT_TRUE(table.UpdateCrtc(0x61, MakeRect(0, 0, 1920, 1080)));
+    ASSERT_FALSE(table.UpdateCrtc(0x62, MakeRect(0, 0, 1920, 1080)));
+    ASSERT_EQ(table.Size(), 1);
+    ASSERT_EQ(table.At(0)->crtc, 0x61);
+
+    // The primary one of two mirrors is listed
+    ASSERT_TRUE(table.SetCrtcOutput(0x61, 0x43));
+    ASSERT_FALSE(table.SetCrtcOutput(0x62, 0x44));
+    ASSERT_TRUE(table.SetPrimaryOutput(0x44));
+    ASSERT_EQ(table.Size(), 1);
+    ASSERT_EQ(table.At(0)->crtc, 0x62);
+    ASSERT_TRUE(table.SetPrimaryOutput(None));
+    ASSERT_EQ(table.At(0)->crtc, 0x61);
+
+    // Disabling the listed CRTC hands its area to the mirror
+    ASSERT_TRUE(table.RemoveCrtc(0x61));
+    ASSERT_EQ(table.Size(), 1);
+    ASSERT_EQ(table.At(0)->crtc, 0x62);
+    ASSERT_EQ(table.IndexAt(At(10, 10)), 0);
+
+    // Moving onto another monitor's area makes it a mirror, moving away lists it again
+    ASSERT_TRUE(table.UpdateCrtc(0x63, MakeRect(1920, 0, 1920, 1080)));
+    ASSERT_EQ(table.Size(), 2);
+    ASSERT_TRUE(table.UpdateCrtc(0x63, MakeRect(0, 0, 1920, 1080)));
+    ASSERT_EQ(table.Size(), 1);
+    ASSERT_FALSE(table.IndexAt(At(1920, 10)).has_value());
+    ASSERT_TRUE(table.UpdateCrtc(0x62, MakeRect(0, 1080, 1920, 1080)));
+    ASSERT_EQ(table.Size(), 2);
+    ASSERT_EQ(table.At(0)->crtc, 0x63);
+    ASSERT_EQ(table.IndexAt(At(10, 1090)), 1);
+}
+
+TEST(TileboxCoreX11MonitorsTestSuite, VerifyDisplayQueriesMonitors)
+{
+    X11EventLoop detached(nullptr);
+    ASSERT_FALSE(detached.WatchMonitors());
+
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const X11MonitorTable &monitors = dpy->Monitors();
+    ASSERT_FALSE(monitors.Empty());
+    ASSERT_NE(monitors.Primary(), nullptr);
+
+    // Every monitor lies on the screen, whichever source they came from
+    const Rect screen(dpy->ScreenWidth(), dpy->ScreenHeight());
+    for (const X11Monitor &monitor : monitors.Monitors())
+    {
+        ASSERT_TRUE(screen.Contains(monitor.geometry));
+    }
+    ASSERT_TRUE(monitors.IndexAt(At(0, 0)).has_value());
+
+    XEvent motion{};
+    motion.type = MotionNotify;
+    ASSERT_FALSE(dpy->HandleMonitorEvent(&motion));
+
+    X11EventLoop loop(dpy);
+    ASSERT_EQ(loop.WatchMonitors(), dpy->MonitorEventBase() >= 0);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/utils/mpsc_queue.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Tilebox;
+
+TEST(TileboxUtilsMpscQueueTestSuite, VerifyFifoOrder)
+{
+    MpscQueue<std::unique_ptr<std::int32_t>> queue;
+    ASSERT_TRUE(queue.Empty());
+    ASSERT_FALSE(queue.Pop().has_value());
+
+    for (std::int32_t i = 0; i < 8; ++i)
+    {
+        queue.Push(std::make_unique<std::int32_t>(i));
+    }
+    ASSERT_FALSE(queue.Empty());
+
+    for (std::int32_t i = 0; i < 8; ++i)
+    {
+        auto value = queue.Pop();
+        ASSERT_TRUE(value.has_value());
+        ASSERT_EQ(**value, i);
+    }
+    ASSERT_TRUE(queue.Empty());
+
+    // Leftovers are freed by the destructor
+    queue.Push(std::make_unique<std::int32_t>(8));
+}
+
+TEST(TileboxUtilsMpscQueueTestSuite, VerifyConcurrentProducers)
+{
+    constexpr std::size_t kProducers = 4;
+    constexpr std::uint32_t kPerProducer = 20000;
+
+    struct Item
+    {
+        std::size_t producer;
+        std::uint32_t sequence;
+    };
+    MpscQueue<Item> queue;
+
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < kProducers; ++p)
+    {
+        producers.emplace_back([&queue, p]() -> void {
+            for (std::uint32_t i = 0; i < kPerProducer; ++i)
+            {
+                queue.Push({p, i});
+            }
+        });
+    }
+
+    // Consume while producing, every producer's items must come out in its own order
+    std::array<std::uint32_t, kProducers> next{};
+    std::size_t received = 0;
+    while (received < kProducers * kPerProducer)
+    {
+        if (auto item = queue.Pop(); item.has_value())
+        {
+            ASSERT_EQ(item->sequence, next[item->producer]);
+            ++next[item->producer];
+            ++received;
+        }
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    ASSERT_TRUE(queue.Empty());
+}
@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/events.hpp>
+#include <tilebox/x11/property_cache.hpp>
+
+#include <X11/X.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <xcb/xproto.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+
+constexpr Window kWindow = 0x200001;
+constexpr X11PropertyAtoms kAtoms{.net_wm_name = 0x150, .net_wm_state = 0x151, .utf8_string = 0x152};
+
+/// @brief A GetProperty reply as it arrives from the server, header followed by the value.
+auto MakeReply(const Atom type, const std::uint8_t format, const std::span<const std::uint8_t> value)
+    -> std::vector<std::uint32_t>
+{
+    const std::size_t words = (sizeof(xcb_get_property_reply_t) + value.size() + 3) / 4;
+    std::vector<std::uint32_t> buffer(words);
+    auto *reply = reinterpret_cast<xcb_get_property_reply_t *>(buffer.data());
+    reply->response_type = XCB_GET_PROPERTY;
+    reply->format = format;
+    reply->type = static_cast<xcb_atom_t>(type);
+    reply->value_len = format != 0 ? static_cast<std::uint32_t>(value.size() / (format / 8U)) : 0;
+    reply->length = static_cast<std::uint32_t>(words - (sizeof(xcb_get_property_reply_t) / 4));
+    if (!value.empty())
+    {
+        std::memcpy(reply + 1, value.data(), value.size());
+    }
+    return buffer;
+}
+
+auto MakeTextReply(const Atom type, const std::string &text) -> std::vector<std::uint32_t>
+{
+    return MakeReply(type, 8, {reinterpret_cast<const std::uint8_t *>(text.data()), text.size()});
+}
+
+auto MakeWordsReply(const Atom type, const std::span<const std::uint32_t> words) -> std::vector<std::uint32_t>
+{
+    return MakeReply(type, 32, {reinterpret_cast<const std::uint8_t *>(words.data()), words.size_bytes()});
+}
+
+auto AsReply(const std::vector<std::uint32_t> &buffer) -> const xcb_get_property_reply_t *
+{
+    return reinterpret_cast<const xcb_get_property_reply_t *>(buffer.data());
+}
+
+auto MakePropertyNotify(const Window window, const Atom atom, const int state) -> XEvent
+{
+    XEvent event{};
+    event.xproperty.type = PropertyNotify;
+    event.xproperty.window = window;
+    event.xproperty.atom = atom;
+    event.xproperty.state = state;
+    return event;
+}
+
+} // namespace
+
+TEST(TileboxCoreX11PropertyCacheTestSuite, VerifyPropertyNotifyInvalidatesPrecisely)
+{
+    X11PropertyCache cache(nullptr, kAtoms);
+    cache.Store(kWindow, kAtoms.net_wm_name, std::string("editor"));
+    cache.Store(kWindow, XA_WM_CLASS, X11ClassHint{"emacs", "Emacs"});
+    cache.Store(kWindow, kAtoms.net_wm_state, std::vector<Atom>{0x160});
+
+    // Unsupported properties are neither stored nor fetched
+    cache.Store(kWindow, XA_CUT_BUFFER0, std::string("ignored"));
+    ASSERT_FALSE(cache.IsCached(XA_CUT_BUFFER0));
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(cache.Get(kWindow, XA_CUT_BUFFER0)));
+    ASSERT_EQ(cache.Size(), 3);
+
+    ASSERT_EQ(cache.Title(kWindow), "editor");
+    ASSERT_EQ(cache.Class(kWindow)->name, "Emacs");
+    ASSERT_EQ(cache.NetWmState(kWindow).size(), 1);
+    ASSERT_EQ(cache.Stats().hits, 3);
+    ASSERT_EQ(cache.Stats().misses, 0);
+
+    // A new title drops only the title, the next read refills it
+    XEvent event = MakePropertyNotify(kWindow, kAtoms.net_wm_name, PropertyNewValue);
+    cache.HandleEvent(event);
+    ASSERT_FALSE(cache.Contains(kWindow, kAtoms.net_wm_name));
+    ASSERT_TRUE(cache.Contains(kWindow, XA_WM_CLASS));
+    ASSERT_EQ(cache.Stats().invalidations, 1);
+
+    // Without a display a miss reads as absent and is cached as such
+    ASSERT_TRUE(cache.Title(kWindow).empty());
+    ASSERT_EQ(cache.Stats().misses, 2);
+    ASSERT_TRUE(cache.Contains(kWindow, kAtoms.net_wm_name));
+
+    // A deleted property is recorded absent without a round trip
+    event = MakePropertyNotify(kWindow, kAtoms.net_wm_state, PropertyDelete);
+    cache.HandleEvent(event);
+    ASSERT_TRUE(cache.Contains(kWindow, kAtoms.net_wm_state));
+    ASSERT_TRUE(cache.NetWmState(kWindow).empty());
+
+    // Other windows and properties are left alone
+    event = MakePropertyNotify(kWindow + 1, XA_WM_CLASS, PropertyNewValue);
+    cache.HandleEvent(event);
+    event = MakePropertyNotify(kWindow, XA_CUT_BUFFER0, PropertyNewValue);
+    cache.HandleEvent(event);
+    ASSERT_TRUE(cache.Contains(kWindow, XA_WM_CLASS));
+
+    XEvent destroy{};
+    destroy.xdestroywindow.type = DestroyNotify;
+    destroy.xdestroywindow.window = kWindow;
+    cache.HandleEvent(destroy);
+    ASSERT_EQ(cache.Size(), 0);
+
+    cache.ResetStats();
+    ASSERT_EQ(cache.Stats().hits, 0);
+    ASSERT_EQ(cache.Stats().invalidations, 0);
+}
+
+TEST(TileboxCoreX11PropertyCacheTestSuite, VerifyLoopFeedsCacheAheadOfHandlers)
+{
+    X11PropertyCache cache(nullptr, kAtoms);
+    cache.Store(kWindow, XA_WM_NAME, std::string("first"));
+    cache.Store(kWindow, XA_WM_CLASS, X11ClassHint{"xterm", "XTerm"});
+
+    X11EventLoop loop(nullptr);
+    loop.SetPropertyCache(&cache);
+
+    // Handlers claiming the events do not keep them from the cache
+    int handled = 0;
+    loop.RegisterEventHandler(X11EventType::X11PropertyNotify, [&](XEvent *) -> void { ++handled; });
+    loop.RegisterWindowEventHandler(X11EventType::X11DestroyNotify, kWindow, [&](XEvent *) -> void { ++handled; });
+
+    XEvent event = MakePropertyNotify(kWindow, XA_WM_NAME, PropertyNewValue);
+    loop.Dispatch(&event);
+    ASSERT_FALSE(cache.Contains(kWindow, XA_WM_NAME));
+    ASSERT_TRUE(cache.Contains(kWindow, XA_WM_CLASS));
+
+    XEvent destroy{};
+    destroy.xdestroywindow.type = DestroyNotify;
+    destroy.xdestroywindow.window = kWindow;
+    loop.Dispatch(&destroy);
+    ASSERT_EQ(handled, 2);
+    ASSERT_EQ(cache.Size(), 0);
+
+    // Detached, the cache sees nothing
+    cache.Store(kWindow, XA_WM_NAME, std::string("reused"));
+    loop.SetPropertyCache(nullptr);
+    loop.Dispatch(&destroy);
+    ASSERT_TRUE(cache.Contains(kWindow, XA_WM_NAME));
+}
+
+TEST(TileboxCoreX11PropertyCacheTestSuite, VerifyCapacityEvictsUnreferencedFirst)
+{
+    X11PropertyCache cache(nullptr, kAtoms, 3);
+    cache.Store(kWindow, XA_WM_NAME, std::string("first"));
+    cache.Store(kWindow + 1, XA_WM_NAME, std::string("second"));
+    cache.Store(kWindow + 2, XA_WM_NAME, std::string("third"));
+
+    // The first insert sweeps every fresh entry once, then recycles the oldest
+    cache.Store(kWindow + 3, XA_WM_NAME, std::string("fourth"));
+    ASSERT_EQ(cache.Size(), 3);
+    ASSERT_EQ(cache.Stats().evictions, 1);
+    ASSERT_FALSE(cache.Contains(kWindow, XA_WM_NAME));
+
+    // A read since the last sweep protects the entry, the unread one goes next
+    ASSERT_EQ(std::get<std::string>(cache.Get(kWindow + 1, XA_WM_NAME)), "second");
+    cache.Store(kWindow + 4, XA_WM_NAME, std::string("fifth"));
+    ASSERT_TRUE(cache.Contains(kWindow + 1, XA_WM_NAME));
+    ASSERT_FALSE(cache.Contains(kWindow + 2, XA_WM_NAME));
+    ASSERT_EQ(cache.Stats().evictions, 2);
+
+    // Invalidated slots are reused before anything is evicted
+    cache.Invalidate(kWindow + 3, XA_WM_NAME);
+    cache.Store(kWindow + 5, XA_WM_NAME, std::string("sixth"));
+    ASSERT_EQ(cache.Size(), 3);
+    ASSERT_EQ(cache.Stats().evictions, 2);
+}
+
+TEST(TileboxCoreX11PropertyCacheTestSuite, VerifyDecodeFollowsWireFormats)
+{
+    const X11PropertyCache cache(nullptr, kAtoms);
+
+    // STRING is Latin-1, UTF8_STRING passes through
+    const auto latin1 = MakeTextReply(XA_STRING, "caf\xE9");
+    ASSERT_EQ(std::get<std::string>(cache.Decode(XA_WM_NAME, AsReply(latin1))), "caf\xC3\xA9");
+    const auto utf8 = MakeTextReply(kAtoms.utf8_string, "caf\xC3\xA9");
+    ASSERT_EQ(std::get<std::string>(cache.Decode(kAtoms.net_wm_name, AsReply(utf8))), "caf\xC3\xA9");
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(cache.Decode(kAtoms.net_wm_name, AsReply(latin1))));
+
+    const auto wm_class = MakeTextReply(XA_STRING, std::string("xterm\0XTerm\0", 12));
+    const auto hint = std::get<X11ClassHint>(cache.Decode(XA_WM_CLASS, AsReply(wm_class)));
+    ASSERT_EQ(hint.instance, "xterm");
+    ASSERT_EQ(hint.name, "XTerm");
+
+    const std::array<std::uint32_t, 9> wm_hints = {InputHint | XUrgencyHint, 0, 0, 0, 0, 0, 0, 0, 0};
+    const auto hints_reply = MakeWordsReply(XA_WM_HINTS, wm_hints);
+    const auto hints = std::get<X11WmHints>(cache.Decode(XA_WM_HINTS, AsReply(hints_reply)));
+    ASSERT_FALSE(hints.input);
+    ASSERT_TRUE(hints.IsUrgent());
+    ASSERT_EQ(hints.initial_state, NormalState);
+
+    // Pre ICCCM clients send 15 words, everything past them reads as zero
+    std::array<std::uint32_t, 15> normal_hints{};
+    normal_hints[0] = PMinSize | PResizeInc;
+    normal_hints[5] = 200;
+    normal_hints[6] = 100;
+    normal_hints[9] = 8;
+    normal_hints[10] = 16;
+    const auto size_reply = MakeWordsReply(XA_WM_SIZE_HINTS, normal_hints);
+    const auto size = std::get<X11SizeHints>(cache.Decode(XA_WM_NORMAL_HINTS, AsReply(size_reply)));
+    ASSERT_EQ(size.min_width, 200);
+    ASSERT_EQ(size.min_height, 100);
+    ASSERT_EQ(size.height_inc, 16);
+    ASSERT_EQ(size.max_width, 0);
+    ASSERT_EQ(size.win_gravity, NorthWestGravity);
+
+    const std::array<std::uint32_t, 2> state = {0x160, 0x161};
+    const auto state_reply = MakeWordsReply(XA_ATOM, state);
+    ASSERT_EQ(std::get<std::vector<Atom>>(cache.Decode(kAtoms.net_wm_state, AsReply(state_reply))).size(), 2);
+
+    // Unset and malformed properties read as absent
+    const auto unset = MakeReply(None, 0, {});
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(cache.Decode(XA_WM_NAME, AsReply(unset))));
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(cache.Decode(XA_WM_HINTS, AsReply(latin1))));
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(cache.Decode(XA_WM_NAME, nullptr)));
+}
+
+TEST(TileboxCoreX11PropertyCacheTestSuite, VerifyFetchesFromServer)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const Window window = XCreateSimpleWindow(dpy->Raw(), dpy->GetRootWindow(), 0, 0, 10, 10, 0, 0, 0);
+    const std::string title = "terminal";
+    XChangeProperty(dpy->Raw(), window, XA_WM_NAME, XA_STRING, 8, PropModeReplace,
+                    reinterpret_cast<const unsigned char *>(title.data()), static_cast<int>(title.size()));
+    XSync(dpy->Raw(), False);
+
+    // Atoms the server has not interned are simply never cached
+    X11PropertyCache cache(dpy, X11PropertyAtoms{});
+    cache.Prefetch(window);
+    ASSERT_EQ(cache.Stats().misses, 4);
+    ASSERT_EQ(cache.Title(window), title);
+    ASSERT_EQ(cache.Class(window), nullptr);
+    ASSERT_EQ(cache.Stats().misses, 4);
+
+    XDestroyWindow(dpy->Raw(), window);
+    XSync(dpy->Raw(), False);
+}
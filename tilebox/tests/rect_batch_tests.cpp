@@ -0,0 +1,142 @@
+#include <tilebox/geometry.hpp>
+#include <tilebox/rect_batch.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+
+/// @brief An odd count, so the scalar remainder runs next to the vector kernels.
+constexpr std::size_t kRects = 37;
+
+auto RandomRects(const std::uint32_t seed) -> std::vector<Rect>
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::int32_t> position(-200, 2000);
+    std::uniform_int_distribution<std::uint32_t> size(1, 1200);
+
+    std::vector<Rect> rects;
+    for (std::size_t i = 0; i < kRects; ++i)
+    {
+        rects.emplace_back(Point(X(position(rng)), Y(position(rng))), Width(size(rng)), Height(size(rng)));
+    }
+    return rects;
+}
+
+auto BatchOf(const std::vector<Rect> &rects) -> RectBatch
+{
+    RectBatch batch(rects.size());
+    for (const Rect &rect : rects)
+    {
+        batch.Push(rect);
+    }
+    return batch;
+}
+
+} // namespace
+
+TEST(TileboxCoreRectBatchTestSuite, VerifyQueriesMatchRect)
+{
+    const std::vector<Rect> rects = RandomRects(7);
+    const RectBatch batch = BatchOf(rects);
+    ASSERT_EQ(batch.Size(), kRects);
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<std::int32_t> coordinate(-300, 3000);
+    std::uniform_int_distribution<std::uint32_t> size(1, 400);
+    std::vector<std::uint8_t> out(kRects);
+
+    for (int round = 0; round < 200; ++round)
+    {
+        const Point point(X(coordinate(rng)), Y(coordinate(rng)));
+        const Rect other(Point(X(coordinate(rng)), Y(coordinate(rng))), Width(size(rng)), Height(size(rng)));
+
+        std::size_t point_hits = 0;
+        std::optional<std::size_t> first;
+        const std::size_t hits = batch.ContainsPoint(point, out);
+        for (std::size_t i = 0; i < kRects; ++i)
+        {
+            ASSERT_EQ(out[i] != 0, rects[i].ContainsPoint(point));
+            point_hits += out[i];
+            if (!first && out[i] != 0)
+            {
+                first = i;
+            }
+        }
+        ASSERT_EQ(hits, point_hits);
+        ASSERT_EQ(batch.FindContaining(point), first);
+
+        std::size_t rect_hits = 0;
+        const std::size_t contained = batch.ContainsRect(other, out);
+        for (std::size_t i = 0; i < kRects; ++i)
+        {
+            ASSERT_EQ(out[i] != 0, rects[i].Contains(other));
+            rect_hits += out[i];
+        }
+        ASSERT_EQ(contained, rect_hits);
+    }
+
+    ASSERT_FALSE(RectBatch().FindContaining(Point(X(0), Y(0))).has_value());
+}
+
+TEST(TileboxCoreRectBatchTestSuite, VerifyFindContainingIncludesEdges)
+{
+    // Side by side columns, the fifth one is handled by the scalar remainder
+    RectBatch batch;
+    for (std::int32_t i = 0; i < 5; ++i)
+    {
+        batch.Push(Rect(Point(X(i * 200), Y(0)), Width(100), Height(100)));
+    }
+
+    ASSERT_EQ(batch.FindContaining(Point(X(300), Y(100))), 1U);
+    ASSERT_EQ(batch.FindContaining(Point(X(800), Y(0))), 4U);
+    ASSERT_EQ(batch.FindContaining(Point(X(900), Y(50))), 4U);
+    ASSERT_FALSE(batch.FindContaining(Point(X(150), Y(50))).has_value());
+    ASSERT_FALSE(batch.FindContaining(Point(X(50), Y(101))).has_value());
+}
+
+TEST(TileboxCoreRectBatchTestSuite, VerifyTransformsMatchRect)
+{
+    const std::vector<Rect> rects = RandomRects(3);
+
+    RectBatch shrunk = BatchOf(rects);
+    shrunk.ShrinkIn(250);
+    RectBatch scaled = BatchOf(rects);
+    scaled.ScaleWidth(0.3);
+    scaled.ScaleHeight(1.7);
+
+    for (std::size_t i = 0; i < kRects; ++i)
+    {
+        ASSERT_EQ(shrunk.Get(i), rects[i].ShrinkIn(250));
+        ASSERT_EQ(scaled.Get(i), rects[i].ScaleWidth(0.3).ScaleHeight(1.7));
+    }
+
+    const Rect bounds(Point(X(100), Y(50)), Width(800), Height(600));
+    RectBatch clamped = BatchOf(rects);
+    clamped.ClampTo(bounds);
+    for (std::size_t i = 0; i < kRects; ++i)
+    {
+        const Rect rect = clamped.Get(i);
+        ASSERT_TRUE(bounds.Contains(rect));
+        ASSERT_EQ(rect.GetW(), std::min(rects[i].GetW(), bounds.GetW()));
+        ASSERT_EQ(rect.GetH(), std::min(rects[i].GetH(), bounds.GetH()));
+        if (rects[i].GetW() <= bounds.GetW() && bounds.Contains(rects[i]))
+        {
+            ASSERT_EQ(rect, rects[i]);
+        }
+    }
+
+    RectBatch one;
+    one.Push(Rect(Point(X(-40), Y(900)), Width(300), Height(100)));
+    one.ClampTo(bounds);
+    ASSERT_EQ(one.Get(0), Rect(Point(X(100), Y(550)), Width(300), Height(100)));
+}
@@ -0,0 +1,171 @@
+#include <tilebox/geometry.hpp>
+#include <tilebox/region.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+
+using namespace Tilebox;
+
+namespace
+{
+
+constexpr std::int32_t kSide = 48;
+
+/// @brief Pixels of a kSide square, the reference the banded regions are checked against.
+using Bitmap = std::array<std::array<bool, kSide>, kSide>;
+
+auto Paint(const Region &region) -> Bitmap
+{
+    Bitmap bitmap{};
+    for (std::int32_t y = 0; y < kSide; ++y)
+    {
+        for (std::int32_t x = 0; x < kSide; ++x)
+        {
+            bitmap[static_cast<std::size_t>(y)][static_cast<std::size_t>(x)] = region.ContainsPoint(Point(X(x), Y(y)));
+        }
+    }
+    return bitmap;
+}
+
+/// @brief Checks that boxes are banded: non empty, sorted into bands, and not touching within a band.
+auto ExpectBanded(const Region &region) -> void
+{
+    const auto boxes = region.Boxes();
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+    {
+        ASSERT_LT(boxes[i].x1, boxes[i].x2);
+        ASSERT_LT(boxes[i].y1, boxes[i].y2);
+        if (i == 0)
+        {
+            continue;
+        }
+
+        const RegionBox &previous = boxes[i - 1];
+        if (previous.y1 == boxes[i].y1)
+        {
+            ASSERT_EQ(previous.y2, boxes[i].y2);
+            ASSERT_LT(previous.x2, boxes[i].x1);
+        }
+        else
+        {
+            ASSERT_LE(previous.y2, boxes[i].y1);
+        }
+    }
+}
+
+auto RandomRegion(std::mt19937 &rng) -> Region
+{
+    std::uniform_int_distribution<std::int32_t> position(0, kSide - 20);
+    std::uniform_int_distribution<std::uint32_t> size(1, 20);
+    std::uniform_int_distribution<int> count(0, 6);
+
+    Region region;
+    for (int i = count(rng); i > 0; --i)
+    {
+        region.Union(Rect(Point(X(position(rng)), Y(position(rng))), Width(size(rng)), Height(size(rng))));
+    }
+    return region;
+}
+
+} // namespace
+
+TEST(TileboxCoreRegionTestSuite, VerifyBasicOperations)
+{
+    Region region(Rect(Point(X(0), Y(0)), Width(100), Height(100)));
+    ASSERT_EQ(region.Boxes().size(), 1U);
+    ASSERT_EQ(region.Area(), 10000U);
+
+    // A hole in the middle splits the square into three bands
+    region.Subtract(Rect(Point(X(25), Y(25)), Width(50), Height(50)));
+    ASSERT_EQ(region.Boxes().size(), 4U);
+    ASSERT_EQ(region.Area(), 7500U);
+    ASSERT_TRUE(region.ContainsPoint(Point(X(10), Y(50))));
+    ASSERT_FALSE(region.ContainsPoint(Point(X(50), Y(50))));
+    ASSERT_FALSE(region.ContainsPoint(Point(X(100), Y(50))));
+    ASSERT_FALSE(region.ContainsRect(Rect(Point(X(20), Y(20)), Width(10), Height(10))));
+    ASSERT_TRUE(region.ContainsRect(Rect(Point(X(0), Y(0)), Width(100), Height(25))));
+    ASSERT_TRUE(region.Intersects(Rect(Point(X(20), Y(20)), Width(10), Height(10))));
+    ASSERT_FALSE(region.Intersects(Rect(Point(X(30), Y(30)), Width(10), Height(10))));
+
+    // Filling the hole coalesces back into one box
+    region.Union(Rect(Point(X(25), Y(25)), Width(50), Height(50)));
+    ASSERT_EQ(region, Region(Rect(Point(X(0), Y(0)), Width(100), Height(100))));
+
+    region.Translate(10, -5);
+    ASSERT_EQ(region.Extents(), (RegionBox{.x1 = 10, .y1 = -5, .x2 = 110, .y2 = 95}));
+    ASSERT_EQ(region.Boxes()[0].ToRect(), Rect(Point(X(10), Y(-5)), Width(100), Height(100)));
+
+    region.Intersect(Rect(Point(X(200), Y(200)), Width(5), Height(5)));
+    ASSERT_TRUE(region.Empty());
+    ASSERT_TRUE(Region(Rect(Width(0), Height(5))).Empty());
+}
+
+TEST(TileboxCoreRegionTestSuite, VerifyOperationsMatchBitmaps)
+{
+    std::mt19937 rng(1);
+    for (int round = 0; round < 300; ++round)
+    {
+        const Region lhs = RandomRegion(rng);
+        const Region rhs = RandomRegion(rng);
+        const Bitmap a = Paint(lhs);
+        const Bitmap b = Paint(rhs);
+
+        Region united = lhs;
+        united.Union(rhs);
+        Region intersected = lhs;
+        intersected.Intersect(rhs);
+        Region subtracted = lhs;
+        subtracted.Subtract(rhs);
+
+        ExpectBanded(united);
+        ExpectBanded(intersected);
+        ExpectBanded(subtracted);
+
+        const Bitmap u = Paint(united);
+        const Bitmap i = Paint(intersected);
+        const Bitmap s = Paint(subtracted);
+        std::uint64_t area = 0;
+        for (std::size_t y = 0; y < kSide; ++y)
+        {
+            for (std::size_t x = 0; x < kSide; ++x)
+            {
+                ASSERT_EQ(u[y][x], a[y][x] || b[y][x]);
+                ASSERT_EQ(i[y][x], a[y][x] && b[y][x]);
+                ASSERT_EQ(s[y][x], a[y][x] && !b[y][x]);
+                area += static_cast<std::uint64_t>(i[y][x]);
+            }
+        }
+        ASSERT_EQ(intersected.Area(), area);
+
+        // Union is commutative, and banding makes equal pixel sets compare equal
+        Region reversed = rhs;
+        reversed.Union(lhs);
+        ASSERT_EQ(united, reversed);
+    }
+}
+
+TEST(TileboxCoreRegionTestSuite, VerifyStorageGrowsPastInlineBoxes)
+{
+    // A checkerboard row needs one box per square
+    Region region;
+    for (std::int32_t i = 0; i < 40; ++i)
+    {
+        region.Union(Rect(Point(X(i * 4), Y(0)), Width(2), Height(2)));
+    }
+    ASSERT_EQ(region.Boxes().size(), 40U);
+    ExpectBanded(region);
+
+    const Region copy = region;
+    Region moved = std::move(region);
+    ASSERT_EQ(copy, moved);
+    ASSERT_TRUE(region.Empty()); // NOLINT(bugprone-use-after-move)
+
+    moved.Subtract(Rect(Point(X(0), Y(0)), Width(80), Height(2)));
+    ASSERT_EQ(moved.Boxes().size(), 20U);
+    ASSERT_EQ(moved.Area(), 80U);
+}
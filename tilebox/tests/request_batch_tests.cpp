@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/request_batch.hpp>
+#include <tilebox/x11/traffic.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace Tilebox;
+
+namespace
+{
+
+constexpr Window kMissingWindow = 0x1FFFFFF;
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::int32_t g_handled_errors = 0;
+
+auto CountingErrorHandler(Display * /*dpy*/, XErrorEvent * /*ee*/) -> std::int32_t
+{
+    ++g_handled_errors;
+    return 0;
+}
+
+} // namespace
+
+TEST(TileboxCoreX11RequestBatchTestSuite, VerifyNestedBatchesFlushOnce)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const Window window = XCreateSimpleWindow(dpy->Raw(), dpy->GetRootWindow(), 0, 0, 10, 10, 0, 0, 0);
+    dpy->Sync();
+
+    const X11Traffic before = dpy->Traffic();
+    {
+        X11RequestBatch outer(dpy);
+        XMoveWindow(dpy->Raw(), window, 1, 1);
+        {
+            X11RequestBatch inner(dpy, X11BatchErrors::Sync);
+            XMoveWindow(dpy->Raw(), window, 2, 2);
+            dpy->Flush();
+            dpy->Sync();
+            inner.End();
+            ASSERT_EQ(inner.LastRequest() - inner.FirstRequest(), 0);
+            ASSERT_FALSE(inner.Settled());
+        }
+        XMoveWindow(dpy->Raw(), window, 3, 3);
+        dpy->Flush();
+        ASSERT_EQ(dpy->Traffic().flushes, before.flushes);
+        ASSERT_EQ(dpy->Traffic().round_trips, before.round_trips);
+    }
+
+    // The deferred Sync of the inner batch went out with the outer one
+    const X11Traffic delta = dpy->Traffic() - before;
+    ASSERT_EQ(delta.flushes, 1);
+    ASSERT_EQ(delta.round_trips, 1);
+    ASSERT_EQ(delta.InFlight(), 0);
+
+    XDestroyWindow(dpy->Raw(), window);
+    dpy->Sync();
+}
+
+TEST(TileboxCoreX11RequestBatchTestSuite, VerifyCheckedBatchesCountTheirErrors)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    auto *previous = XSetErrorHandler(CountingErrorHandler);
+    g_handled_errors = 0;
+
+    // Unchecked batches leave errors to the handler
+    X11RequestBatch unchecked(dpy);
+    XMapWindow(dpy->Raw(), kMissingWindow);
+    unchecked.End();
+    dpy->Sync();
+    ASSERT_TRUE(unchecked.Settled());
+    ASSERT_EQ(unchecked.Errors(), 0);
+    ASSERT_EQ(g_handled_errors, 1);
+
+    X11RequestBatch checked(dpy, X11BatchErrors::Sync);
+    XMapWindow(dpy->Raw(), kMissingWindow);
+    XUnmapWindow(dpy->Raw(), kMissingWindow);
+    checked.End();
+    ASSERT_TRUE(checked.Settled());
+    ASSERT_EQ(checked.Errors(), 2);
+    ASSERT_EQ(g_handled_errors, 1);
+
+    // Async batches settle without a sync, errors after the batch reach the handler again
+    const X11Traffic before = dpy->Traffic();
+    X11RequestBatch async(dpy, X11BatchErrors::Async);
+    XMapWindow(dpy->Raw(), kMissingWindow);
+    async.End();
+    XUnmapWindow(dpy->Raw(), kMissingWindow);
+    ASSERT_EQ((dpy->Traffic() - before).round_trips, 0);
+    for (std::int32_t attempt = 0; attempt < 1000 && !async.Settled(); ++attempt)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(async.Settled());
+    ASSERT_EQ(async.Errors(), 1);
+    dpy->Sync();
+    ASSERT_EQ(g_handled_errors, 2);
+
+    // Without a display a batch is ended and settled right away
+    X11RequestBatch empty(nullptr, X11BatchErrors::Sync);
+    ASSERT_TRUE(empty.IsEnded());
+    ASSERT_TRUE(empty.Settled());
+
+    XSetErrorHandler(previous);
+}
@@ -0,0 +1,133 @@
+#include <tilebox/geometry.hpp>
+#include <tilebox/spatial_index.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace Tilebox;
+
+TEST(TileboxCoreSpatialIndexTestSuite, VerifyTopmostFollowsLayersAndRestacking)
+{
+    SpatialIndex index(Rect(Width(1920), Height(1080)), 128);
+
+    const Rect tiled(Point(X(0), Y(0)), Width(960), Height(1080));
+    ASSERT_TRUE(index.Insert(1, tiled));
+    ASSERT_TRUE(index.Insert(2, Rect(Point(X(960), Y(0)), Width(960), Height(1080))));
+    ASSERT_TRUE(index.Insert(3, Rect(Point(X(800), Y(400)), Width(300), Height(200)), 1));
+    ASSERT_FALSE(index.Insert(3, tiled));
+    ASSERT_FALSE(index.Insert(0, tiled));
+    ASSERT_EQ(index.Size(), 3U);
+
+    ASSERT_EQ(index.TopmostAt(Point(X(100), Y(100))), 1U);
+    ASSERT_EQ(index.TopmostAt(Point(X(900), Y(500))), 3U);
+    ASSERT_EQ(index.TopmostAt(Point(X(1000), Y(500))), 3U);
+
+    // Edges are shared, the later insert is on top within a layer until the other is raised
+    ASSERT_EQ(index.TopmostAt(Point(X(960), Y(0))), 2U);
+    ASSERT_TRUE(index.Restack(1, 0));
+    ASSERT_EQ(index.TopmostAt(Point(X(960), Y(0))), 1U);
+
+    std::vector<SpatialIndex::Id> hits;
+    index.QueryPoint(Point(X(960), Y(500)), hits);
+    ASSERT_EQ(hits, (std::vector<SpatialIndex::Id>{3, 1, 2}));
+
+    // A drag to another monitor, past the bounds of the grid
+    ASSERT_TRUE(index.Move(3, Rect(Point(X(1800), Y(900)), Width(300), Height(200))));
+    ASSERT_EQ(index.TopmostAt(Point(X(900), Y(500))), 1U);
+    ASSERT_EQ(index.TopmostAt(Point(X(2000), Y(1000))), 3U);
+    ASSERT_EQ(index.TopmostAt(Point(X(1850), Y(950))), 3U);
+    ASSERT_EQ(index.Find(3), Rect(Point(X(1800), Y(900)), Width(300), Height(200)));
+
+    ASSERT_TRUE(index.Remove(3));
+    ASSERT_FALSE(index.Remove(3));
+    ASSERT_FALSE(index.Move(3, tiled));
+    ASSERT_FALSE(index.TopmostAt(Point(X(2000), Y(1000))).has_value());
+    ASSERT_EQ(index.TopmostAt(Point(X(1850), Y(950))), 2U);
+
+    index.Rebuild(Rect(Width(3840), Height(1080)), 512);
+    ASSERT_EQ(index.TopmostAt(Point(X(1850), Y(950))), 2U);
+    ASSERT_EQ(index.TopmostAt(Point(X(10), Y(10))), 1U);
+
+    index.Clear();
+    ASSERT_EQ(index.Size(), 0U);
+    ASSERT_FALSE(index.TopmostAt(Point(X(10), Y(10))).has_value());
+}
+
+TEST(TileboxCoreSpatialIndexTestSuite, VerifyQueriesMatchLinearScan)
+{
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<std::int32_t> position(-300, 2100);
+    std::uniform_int_distribution<std::uint32_t> size(1, 900);
+    std::uniform_int_distribution<std::uint32_t> layer(0, 2);
+    std::uniform_int_distribution<SpatialIndex::Id> id(1, 60);
+
+    SpatialIndex index(Rect(Point(X(0), Y(0)), Width(1920), Height(1080)), 100);
+
+    // Reference: id -> (layer, order, rect), scanned linearly
+    std::map<SpatialIndex::Id, std::tuple<std::uint32_t, std::uint64_t, Rect>> reference;
+    std::uint64_t order = 0;
+
+    const auto random_rect = [&] {
+        return Rect(Point(X(position(rng)), Y(position(rng))), Width(size(rng)), Height(size(rng)));
+    };
+
+    for (int step = 0; step < 2000; ++step)
+    {
+        const SpatialIndex::Id key = id(rng);
+        const Rect rect = random_rect();
+        switch (step % 4)
+        {
+        case 0: {
+            const std::uint32_t l = layer(rng);
+            ASSERT_EQ(index.Insert(key, rect, l), !reference.contains(key));
+            reference.try_emplace(key, l, ++order, rect);
+            break;
+        }
+        case 1:
+            ASSERT_EQ(index.Move(key, rect), reference.contains(key));
+            if (reference.contains(key))
+            {
+                std::get<2>(reference[key]) = rect;
+            }
+            break;
+        case 2: {
+            const std::uint32_t l = layer(rng);
+            ASSERT_EQ(index.Restack(key, l), reference.contains(key));
+            if (reference.contains(key))
+            {
+                std::get<0>(reference[key]) = l;
+                std::get<1>(reference[key]) = ++order;
+            }
+            break;
+        }
+        default:
+            if (step % 8 == 3)
+            {
+                ASSERT_EQ(index.Remove(key), reference.erase(key) == 1);
+            }
+            break;
+        }
+
+        const Point point(X(position(rng)), Y(position(rng)));
+        std::optional<SpatialIndex::Id> expected;
+        std::tuple<std::uint32_t, std::uint64_t> best{};
+        for (const auto &[candidate, value] : reference)
+        {
+            const auto &[l, o, r] = value;
+            if (r.ContainsPoint(point) && (!expected || std::tie(l, o) > best))
+            {
+                expected = candidate;
+                best = {l, o};
+            }
+        }
+        ASSERT_EQ(index.TopmostAt(point), expected);
+    }
+    ASSERT_EQ(index.Size(), reference.size());
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/events.hpp>
+#include <tilebox/x11/traffic.hpp>
+#include <tilebox/x11/xcb.hpp>
+
+#include <X11/X.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+
+#include <string>
+
+using namespace Tilebox;
+
+TEST(TileboxCoreX11TrafficTestSuite, VerifyHandlerTrafficIsSummedPerEventType)
+{
+    const X11Traffic before{.requests = 10, .processed = 8, .round_trips = 1, .flushes = 2, .bytes_flushed = 64};
+    const X11Traffic after{.requests = 13, .processed = 12, .round_trips = 2, .flushes = 3, .bytes_flushed = 100};
+    const X11Traffic delta = after - before;
+    ASSERT_EQ(delta, (X11Traffic{.requests = 3, .processed = 4, .round_trips = 1, .flushes = 1, .bytes_flushed = 36}));
+    ASSERT_EQ(after.InFlight(), 1);
+
+    X11EventTraffic table;
+    table.Record(ConfigureRequest, delta);
+    table.Record(ConfigureRequest, delta);
+    table.Record(X11EventTraffic::kEventTableSize, delta);
+    ASSERT_EQ(table.Calls(X11EventType::X11ConfigureRequest), 2);
+    ASSERT_EQ(table.Handler(X11EventType::X11ConfigureRequest).requests, 6);
+    ASSERT_EQ(table.Handler(X11EventType::X11ConfigureRequest).round_trips, 2);
+    ASSERT_EQ(table.Calls(X11EventType::X11MapRequest), 0);
+
+    const std::string report = table.Report();
+    ASSERT_NE(report.find("requests=3.00/call round_trips=1.00/call"), std::string::npos);
+    ASSERT_EQ(report.find('\n'), report.size() - 1);
+
+    table.Reset();
+    ASSERT_EQ(table.Calls(X11EventType::X11ConfigureRequest), 0);
+    ASSERT_TRUE(table.Report().empty());
+
+    // Without a display handler calls are still counted
+    X11EventLoop loop(nullptr);
+    loop.RegisterEventHandler(X11EventType::X11MapRequest, [](XEvent *) -> void {});
+    XEvent map{};
+    map.type = MapRequest;
+    loop.Dispatch(&map);
+    ASSERT_EQ(loop.TrafficStats(), nullptr);
+
+    loop.SetTrafficTracking(true);
+    loop.Dispatch(&map);
+    ASSERT_TRUE(loop.IsTrafficTracking());
+    ASSERT_EQ(loop.TrafficStats()->Calls(X11EventType::X11MapRequest), 1);
+    loop.ResetTrafficStats();
+    ASSERT_EQ(loop.TrafficStats()->Calls(X11EventType::X11MapRequest), 0);
+    loop.SetTrafficTracking(false);
+    ASSERT_EQ(loop.TrafficStats(), nullptr);
+}
+
+TEST(TileboxCoreX11TrafficTestSuite, VerifyDisplayCountsRequestsAndRoundTrips)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const Window root = dpy->GetRootWindow();
+    dpy->Sync();
+
+    // Fetching each reply before the next request costs one round trip apiece
+    X11Traffic start = dpy->Traffic();
+    const X11XcbConnection xcb = dpy->Xcb();
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT_NE(xcb.GetGeometry(root).Get(), nullptr);
+    }
+    X11Traffic delta = dpy->Traffic() - start;
+    ASSERT_EQ(delta.requests, 3);
+    ASSERT_EQ(delta.round_trips, 3);
+
+    // Pipelined cookies share at most one, replies already in cost nothing
+    start = dpy->Traffic();
+    auto geometry = xcb.GetGeometry(root);
+    auto tree = xcb.QueryTree(root);
+    auto attributes = xcb.GetWindowAttributes(root);
+    ASSERT_EQ((dpy->Traffic() - start).requests, 3);
+    ASSERT_NE(geometry.Get(), nullptr);
+    ASSERT_NE(tree.Get(), nullptr);
+    ASSERT_NE(attributes.Get(), nullptr);
+    ASSERT_LE((dpy->Traffic() - start).round_trips, 1);
+
+    // Xlib requests are buffered until flushed, then their bytes are counted
+    start = dpy->Traffic();
+    XChangeProperty(dpy->Raw(), root, XA_CUT_BUFFER7, XA_STRING, 8, PropModeReplace,
+                    reinterpret_cast<const unsigned char *>("tilebox"), 7);
+    XDeleteProperty(dpy->Raw(), root, XA_CUT_BUFFER7);
+    delta = dpy->Traffic() - start;
+    ASSERT_EQ(delta.requests, 2);
+    ASSERT_EQ(delta.flushes, 0);
+
+    dpy->Flush();
+    dpy->Flush();
+    delta = dpy->Traffic() - start;
+    ASSERT_EQ(delta.flushes, 1);
+    ASSERT_EQ(delta.bytes_flushed, 24 + 8 + 12);
+    ASSERT_EQ(delta.round_trips, 0);
+
+    dpy->Sync();
+    const X11Traffic synced = dpy->Traffic();
+    ASSERT_EQ((synced - start).round_trips, 1);
+    ASSERT_EQ(synced.InFlight(), 0);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/geometry.hpp>
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/traffic.hpp>
+#include <tilebox/x11/window_pool.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <string>
+#include <utility>
+
+using namespace Tilebox;
+
+TEST(TileboxCoreX11WindowPoolTestSuite, VerifyReleasedWindowsAreRecycled)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    X11WindowPool pool(dpy, 1);
+    const X11WindowPoolKey tooltip{.event_mask = ExposureMask};
+    const X11WindowPoolKey menu{.event_mask = ExposureMask | ButtonPressMask};
+    const Rect rect(Point(X(10), Y(10)), Width(200), Height(20));
+
+    X11PooledWindow first = pool.Acquire(tooltip, rect);
+    ASSERT_TRUE(first.IsValid());
+    const Window id = first.id();
+    ASSERT_TRUE(first->Map());
+    first.Release();
+    ASSERT_FALSE(first.IsValid());
+
+    // The same key and geometry come back without a single request
+    const std::uint64_t requests = dpy->Traffic().requests;
+    X11PooledWindow again = pool.Acquire(tooltip, rect);
+    ASSERT_EQ(again.id(), id);
+    ASSERT_EQ(dpy->Traffic().requests, requests);
+    ASSERT_FALSE(again->IsMapped());
+    ASSERT_TRUE(again->Map());
+
+    // Other keys get their own windows
+    X11PooledWindow other = pool.Acquire(menu, rect);
+    ASSERT_NE(other.id(), id);
+    {
+        X11PooledWindow second = pool.Acquire(tooltip, rect);
+        X11PooledWindow moved = std::move(second);
+        ASSERT_FALSE(second.IsValid());
+        ASSERT_EQ(pool.Stats(tooltip).in_use, 2);
+    }
+
+    // Only one idle window is kept per key, the second release destroys its window
+    again.Release();
+    ASSERT_EQ(pool.Stats(tooltip).idle, 1);
+    ASSERT_EQ(pool.Stats(tooltip).created, 2);
+    ASSERT_EQ(pool.Stats(tooltip).reused, 1);
+    ASSERT_EQ(pool.Stats(tooltip).destroyed, 1);
+    ASSERT_EQ(pool.Stats(tooltip).high_water, 2);
+    ASSERT_EQ(pool.Stats().in_use, 1);
+    ASSERT_EQ(pool.Stats().high_water, 3);
+    ASSERT_NE(pool.Report().find("high_water=2"), std::string::npos);
+
+    pool.Prewarm(menu, 1);
+    ASSERT_EQ(pool.Stats(menu).idle, 1);
+    pool.Trim();
+    ASSERT_EQ(pool.Stats().idle, 0);
+    ASSERT_EQ(pool.Stats(menu).trimmed, 1);
+    ASSERT_EQ(pool.Stats(tooltip).trimmed, 1);
+    ASSERT_EQ(pool.Stats(tooltip).destroyed, 1);
+    other.Release();
+    dpy->Sync();
+}
+
+TEST(TileboxCoreX11WindowPoolTestSuite, VerifyPoolWithoutDisplay)
+{
+    X11WindowPool pool(nullptr);
+    X11PooledWindow window = pool.Acquire({}, Rect());
+    ASSERT_FALSE(window.IsValid());
+    ASSERT_EQ(window.id(), 0);
+    ASSERT_TRUE(pool.Report().empty());
+}
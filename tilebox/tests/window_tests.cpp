@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/geometry.hpp>
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/traffic.hpp>
+#include <tilebox/x11/window.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+
+#include <cstdint>
+
+using namespace Tilebox;
+
+namespace
+{
+
+auto MakeRect(const std::int32_t x, const std::int32_t y, const std::uint32_t w, const std::uint32_t h) -> Rect
+{
+    return {Point(X(x), Y(y)), Width(w), Height(h)};
+}
+
+} // namespace
+
+TEST(TileboxCoreX11WindowTestSuite, VerifyConfigureSendsOnlyChanges)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const Window id = XCreateSimpleWindow(dpy->Raw(), dpy->GetRootWindow(), 0, 0, 100, 100, 1, 0, 0);
+    const X11WindowConfig initial{.rect = MakeRect(0, 0, 100, 100), .border_width = 1, .stacking = std::nullopt};
+    X11Window window(dpy, id, initial);
+
+    // Configuring the current state sends nothing
+    std::uint64_t requests = dpy->Traffic().requests;
+    ASSERT_EQ(window.Configure(initial), 0);
+    ASSERT_EQ(window.Configure(MakeRect(0, 0, 100, 100)), 0);
+    ASSERT_EQ(dpy->Traffic().requests, requests);
+
+    ASSERT_EQ(window.Configure(MakeRect(10, 0, 100, 50)), CWX | CWHeight);
+    ASSERT_EQ(dpy->Traffic().requests, requests + 1);
+    ASSERT_EQ(window.Shadow().rect.GetH(), 50);
+
+    // Stacking is sent every time, the stack may have changed around the window since the last one
+    const X11Stacking lowest{.sibling = None, .mode = Below};
+    X11WindowConfig config = window.Shadow();
+    config.border_width = 2;
+    config.stacking = lowest;
+    ASSERT_EQ(window.Configure(config), CWBorderWidth | CWStackMode);
+    config.rect = MakeRect(10, 20, 100, 50);
+    ASSERT_EQ(window.Configure(config), CWY | CWStackMode);
+    ASSERT_EQ(window.Configure(config), CWStackMode);
+    ASSERT_EQ(window.Shadow().stacking, lowest);
+    config.stacking = std::nullopt;
+    ASSERT_EQ(window.Configure(config), 0);
+    ASSERT_EQ(window.Shadow().stacking, lowest);
+
+    // A notify generated before the last Configure is stale
+    requests = dpy->Traffic().requests;
+    XConfigureEvent notify{};
+    notify.type = ConfigureNotify;
+    notify.window = id;
+    notify.serial = requests - 1;
+    notify.width = 300;
+    notify.height = 200;
+    window.HandleConfigureNotify(notify);
+    ASSERT_EQ(window.Shadow().rect.GetW(), 100);
+
+    notify.serial = requests;
+    notify.above = 0x400001;
+    window.HandleConfigureNotify(notify);
+    ASSERT_EQ(window.Shadow().rect.GetW(), 300);
+    ASSERT_EQ(window.Shadow().rect.GetX(), 0);
+    ASSERT_EQ(window.Shadow().border_width, 0);
+    ASSERT_EQ(window.Shadow().stacking, (X11Stacking{.sibling = 0x400001, .mode = Above}));
+
+    XDestroyWindow(dpy->Raw(), id);
+    dpy->Sync();
+}
+
+TEST(TileboxCoreX11WindowTestSuite, VerifyConfigureRequestOfTiledWindowIsDenied)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const Window id = XCreateSimpleWindow(dpy->Raw(), dpy->GetRootWindow(), 0, 0, 100, 100, 0, 0, 0);
+    XSelectInput(dpy->Raw(), id, StructureNotifyMask);
+    X11Window window(dpy, id, {.rect = MakeRect(0, 0, 100, 100), .border_width = 0, .stacking = std::nullopt});
+    dpy->Sync();
+
+    XConfigureRequestEvent request{};
+    request.type = ConfigureRequest;
+    request.window = id;
+    request.value_mask = CWX | CWWidth | CWStackMode;
+    request.x = 50;
+    request.width = 400;
+    request.detail = Above;
+
+    // Tiled windows keep their geometry and are told so
+    ASSERT_EQ(window.HandleConfigureRequest(request, true), 0);
+    dpy->Sync();
+    XEvent event{};
+    ASSERT_TRUE(XCheckTypedWindowEvent(dpy->Raw(), id, ConfigureNotify, &event));
+    ASSERT_TRUE(event.xconfigure.send_event);
+    ASSERT_EQ(event.xconfigure.width, 100);
+    window.HandleConfigureNotify(event.xconfigure);
+    ASSERT_EQ(window.Shadow().rect.GetW(), 100);
+
+    // Floating windows get what they asked for, minus the geometry they already have
+    ASSERT_EQ(window.HandleConfigureRequest(request, false), CWX | CWWidth | CWStackMode);
+    ASSERT_EQ(window.HandleConfigureRequest(request, false), CWStackMode);
+    dpy->Sync();
+    while (XCheckTypedWindowEvent(dpy->Raw(), id, ConfigureNotify, &event))
+    {
+    }
+
+    // A granted request that changes nothing is still answered
+    request.value_mask = CWX | CWWidth;
+    ASSERT_EQ(window.HandleConfigureRequest(request, false), 0);
+    dpy->Sync();
+    ASSERT_TRUE(XCheckTypedWindowEvent(dpy->Raw(), id, ConfigureNotify, &event));
+    ASSERT_TRUE(event.xconfigure.send_event);
+    ASSERT_EQ(event.xconfigure.x, 50);
+    ASSERT_EQ(event.xconfigure.width, 400);
+    ASSERT_EQ(window.Shadow().rect.GetX(), 50);
+    ASSERT_EQ(window.Shadow().rect.GetW(), 400);
+
+    XDestroyWindow(dpy->Raw(), id);
+    dpy->Sync();
+}
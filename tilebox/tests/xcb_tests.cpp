@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/xcb.hpp>
+
+#include <X11/X.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <xcb/xcb.h>
+#include <xcb/xproto.h>
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+using namespace Tilebox;
+
+TEST(TileboxCoreX11XcbTestSuite, VerifyEmptyCookiesAreInert)
+{
+    X11Cookie<xcb_get_geometry_reply_t> cookie;
+    ASSERT_FALSE(cookie.IsValid());
+    ASSERT_EQ(cookie.Get(), nullptr);
+
+    X11ReplyPtr<xcb_get_geometry_reply_t> reply;
+    ASSERT_TRUE(cookie.Poll(reply));
+    ASSERT_EQ(reply, nullptr);
+    cookie.Discard();
+
+    const X11XcbConnection xcb;
+    ASSERT_FALSE(xcb.IsConnected());
+    xcb.Flush();
+}
+
+TEST(TileboxCoreX11XcbTestSuite, VerifyPipelinedCookiesResolve)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const X11XcbConnection xcb = dpy->Xcb();
+    ASSERT_TRUE(xcb.IsConnected());
+
+    const Window root = dpy->GetRootWindow();
+    auto attributes = xcb.GetWindowAttributes(root);
+    auto geometry = xcb.GetGeometry(root);
+    auto tree = xcb.QueryTree(root);
+    auto atom = xcb.InternAtom("TILEBOX_XCB_TEST");
+    ASSERT_TRUE(attributes.IsValid());
+    ASSERT_LT(attributes.Sequence(), geometry.Sequence());
+
+    // Fetched out of request order on purpose
+    const auto tree_reply = tree.Get();
+    ASSERT_NE(tree_reply, nullptr);
+    ASSERT_EQ(tree_reply->root, static_cast<xcb_window_t>(root));
+    ASSERT_FALSE(tree.IsValid());
+
+    ASSERT_NE(attributes.Get(), nullptr);
+
+    const auto geometry_reply = geometry.Get();
+    ASSERT_NE(geometry_reply, nullptr);
+    ASSERT_GT(geometry_reply->width, 0);
+
+    const auto atom_reply = atom.Get();
+    ASSERT_NE(atom_reply, nullptr);
+    ASSERT_EQ(static_cast<Atom>(atom_reply->atom), XInternAtom(dpy->Raw(), "TILEBOX_XCB_TEST", True));
+}
+
+TEST(TileboxCoreX11XcbTestSuite, VerifyCookiesMixWithXlib)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+    const X11DisplaySharedResource dpy = *dpy_opt;
+    const X11XcbConnection xcb = dpy->Xcb();
+    const Window root = dpy->GetRootWindow();
+
+    constexpr std::string_view value = "tilebox";
+    const Atom property = XInternAtom(dpy->Raw(), "TILEBOX_XCB_PROPERTY", False);
+    XChangeProperty(dpy->Raw(), root, property, XA_STRING, 8, PropModeReplace,
+                    reinterpret_cast<const unsigned char *>(value.data()), static_cast<int>(value.size()));
+
+    // Dropped cookies discard their replies, later requests still match up
+    {
+        auto dropped = xcb.GetGeometry(root);
+        static_cast<void>(xcb.QueryTree(root));
+    }
+
+    auto cookie = xcb.GetProperty(root, property, XA_STRING, 0, 16);
+    XWindowAttributes attributes{};
+    ASSERT_NE(XGetWindowAttributes(dpy->Raw(), root, &attributes), 0);
+
+    X11ReplyPtr<xcb_get_property_reply_t> reply;
+    ASSERT_TRUE(cookie.Poll(reply));
+    ASSERT_NE(reply, nullptr);
+    ASSERT_EQ(static_cast<std::size_t>(xcb_get_property_value_length(reply.get())), value.size());
+    ASSERT_EQ(std::memcmp(xcb_get_property_value(reply.get()), value.data(), value.size()), 0);
+}
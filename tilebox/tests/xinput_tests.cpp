@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+
+#include <tilebox/x11/display.hpp>
+#include <tilebox/x11/event_loop.hpp>
+#include <tilebox/x11/events.hpp>
+#include <tilebox/x11/xinput.hpp>
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XI2.h>
+#include <X11/extensions/XInput2.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace Tilebox;
+
+namespace
+{
+
+constexpr std::int32_t kMasterPointer = 2;
+constexpr std::int32_t kSlavePointer = 8;
+constexpr Window kWindow = 0x400001;
+
+/// @brief An XI2 event with its valuators, backed by arrays the test owns.
+struct Valuators
+{
+    std::array<unsigned char, 1> mask{};
+    std::array<double, 4> values{};
+    std::int32_t count{};
+
+    auto Set(const std::int32_t number, const double value) -> Valuators &
+    {
+        mask[0] |= static_cast<unsigned char>(1U << static_cast<std::uint32_t>(number));
+        values[static_cast<std::size_t>(count++)] = value;
+        return *this;
+    }
+
+    auto State() -> XIValuatorState
+    {
+        return {static_cast<std::int32_t>(mask.size()), mask.data(), values.data()};
+    }
+};
+
+auto MakeCookie(const std::int32_t evtype, void *data) -> XGenericEventCookie
+{
+    XGenericEventCookie cookie{};
+    cookie.type = GenericEvent;
+    cookie.extension = 131;
+    cookie.evtype = evtype;
+    cookie.data = data;
+    return cookie;
+}
+
+auto MakeDeviceEvent(const std::int32_t evtype, Valuators &valuators) -> XIDeviceEvent
+{
+    XIDeviceEvent event{};
+    event.evtype = evtype;
+    event.deviceid = kMasterPointer;
+    event.sourceid = kSlavePointer;
+    event.event = kWindow;
+    event.valuators = valuators.State();
+    return event;
+}
+
+/// @brief Announces a touchpad with a vertical scroll valuator 3 and a horizontal one 2, both at 120 per click.
+auto AnnounceTouchpad(X11XInput &xinput) -> void
+{
+    XIScrollClassInfo vertical{};
+    vertical.type = XIScrollClass;
+    vertical.number = 3;
+    vertical.scroll_type = XIScrollTypeVertical;
+    vertical.increment = 120.0;
+
+    XIScrollClassInfo horizontal{};
+    horizontal.type = XIScrollClass;
+    horizontal.number = 2;
+    horizontal.scroll_type = XIScrollTypeHorizontal;
+    horizontal.increment = 120.0;
+
+    XIValuatorClassInfo vertical_value{};
+    vertical_value.type = XIValuatorClass;
+    vertical_value.number = 3;
+    vertical_value.value = 1000.0;
+
+    std::array<XIAnyClassInfo *, 3> classes = {reinterpret_cast<XIAnyClassInfo *>(&vertical),
+                                               reinterpret_cast<XIAnyClassInfo *>(&horizontal),
+                                               reinterpret_cast<XIAnyClassInfo *>(&vertical_value)};
+    XIDeviceChangedEvent changed{};
+    changed.evtype = XI_DeviceChanged;
+    changed.deviceid = kMasterPointer;
+    changed.num_classes = static_cast<std::int32_t>(classes.size());
+    changed.classes = classes.data();
+
+    const XGenericEventCookie cookie = MakeCookie(XI_DeviceChanged, &changed);
+    xinput.HandleEvent(cookie);
+}
+
+} // namespace
+
+TEST(TileboxCoreX11XInputTestSuite, VerifyRawMotionIsSummedUntilFlush)
+{
+    X11XInput xinput(nullptr);
+    std::vector<X11RawMotion> delivered;
+    xinput.OnRawMotion([&](const X11RawMotion &motion) -> void { delivered.push_back(motion); });
+
+    for (const double dx : {1.5, 2.0, -0.5})
+    {
+        Valuators valuators;
+        valuators.Set(0, dx).Set(1, 1.0);
+        XIRawEvent raw{};
+        raw.evtype = XI_RawMotion;
+        raw.deviceid = kMasterPointer;
+        raw.sourceid = kSlavePointer;
+        raw.valuators = valuators.State();
+        raw.raw_values = valuators.values.data();
+
+        const XGenericEventCookie cookie = MakeCookie(XI_RawMotion, &raw);
+        xinput.HandleEvent(cookie);
+    }
+    ASSERT_TRUE(delivered.empty());
+
+    xinput.Flush();
+    ASSERT_EQ(delivered.size(), 1);
+    ASSERT_DOUBLE_EQ(delivered[0].dx, 3.0);
+    ASSERT_DOUBLE_EQ(delivered[0].dy, 3.0);
+    ASSERT_EQ(delivered[0].device, kMasterPointer);
+    ASSERT_EQ(delivered[0].source, kSlavePointer);
+    ASSERT_EQ(delivered[0].coalesced, 3);
+
+    // Nothing left pending
+    xinput.Flush();
+    ASSERT_EQ(delivered.size(), 1);
+}
+
+TEST(TileboxCoreX11XInputTestSuite, VerifyScrollValuatorsBecomeIncrements)
+{
+    X11XInput xinput(nullptr);
+    AnnounceTouchpad(xinput);
+
+    std::vector<X11SmoothScroll> scrolls;
+    std::vector<X11DeviceEvent> motions;
+    xinput.OnScroll([&](const X11SmoothScroll &scroll) -> void { scrolls.push_back(scroll); });
+    xinput.OnDeviceEvent([&](const X11DeviceEvent &event) -> void { motions.push_back(event); });
+
+    // Vertical is seeded at 1000, horizontal has no baseline yet and only records one
+    Valuators first;
+    first.Set(2, 500.0).Set(3, 1060.0);
+    XIDeviceEvent first_event = MakeDeviceEvent(XI_Motion, first);
+    XGenericEventCookie cookie = MakeCookie(XI_Motion, &first_event);
+    xinput.HandleEvent(cookie);
+
+    Valuators second;
+    second.Set(2, 740.0).Set(3, 1000.0);
+    XIDeviceEvent second_event = MakeDeviceEvent(XI_Motion, second);
+    cookie = MakeCookie(XI_Motion, &second_event);
+    xinput.HandleEvent(cookie);
+
+    xinput.Flush();
+    ASSERT_EQ(scrolls.size(), 1);
+    ASSERT_DOUBLE_EQ(scrolls[0].dy, 0.0);
+    ASSERT_DOUBLE_EQ(scrolls[0].dx, 2.0);
+    ASSERT_EQ(scrolls[0].window, kWindow);
+    ASSERT_EQ(scrolls[0].coalesced, 2);
+
+    // Scroll only motion is not reported as pointer motion
+    ASSERT_TRUE(motions.empty());
+}
+
+TEST(TileboxCoreX11XInputTestSuite, VerifyButtonsFlushPendingMotionAndSkipEmulated)
+{
+    X11XInput xinput(nullptr);
+    std::vector<X11DeviceEvent> events;
+    xinput.OnDeviceEvent([&](const X11DeviceEvent &event) -> void { events.push_back(event); });
+
+    for (const double x : {10.0, 20.0, 30.0})
+    {
+        Valuators valuators;
+        valuators.Set(0, x).Set(1, 5.0);
+        XIDeviceEvent motion = MakeDeviceEvent(XI_Motion, valuators);
+        motion.event_x = x;
+        const XGenericEventCookie cookie = MakeCookie(XI_Motion, &motion);
+        xinput.HandleEvent(cookie);
+    }
+
+    Valuators none;
+    XIDeviceEvent emulated = MakeDeviceEvent(XI_ButtonPress, none);
+    emulated.detail = Button4;
+    emulated.flags = XIPointerEmulated;
+    XGenericEventCookie cookie = MakeCookie(XI_ButtonPress, &emulated);
+    xinput.HandleEvent(cookie);
+    ASSERT_TRUE(events.empty());
+
+    XIDeviceEvent press = MakeDeviceEvent(XI_ButtonPress, none);
+    press.detail = Button1;
+    cookie = MakeCookie(XI_ButtonPress, &press);
+    xinput.HandleEvent(cookie);
+
+    ASSERT_EQ(events.size(), 2);
+    ASSERT_EQ(events[0].evtype, XI_Motion);
+    ASSERT_DOUBLE_EQ(events[0].event_x, 30.0);
+    ASSERT_EQ(events[0].coalesced, 3);
+    ASSERT_EQ(events[1].evtype, XI_ButtonPress);
+    ASSERT_EQ(events[1].detail, Button1);
+}
+
+TEST(TileboxCoreX11XInputTestSuite, VerifyGenericHandlersSwallowEventsWithoutDisplay)
+{
+    X11EventLoop loop(nullptr);
+    std::int32_t generic_count = 0;
+    std::int32_t global_count = 0;
+    loop.RegisterEventHandler(X11EventType::X11GenericEvent, [&](XEvent *) -> void { ++global_count; });
+    loop.RegisterGenericEventHandler(131, XI_RawMotion, [&](const XGenericEventCookie &) -> void { ++generic_count; });
+
+    XEvent event{};
+    event.xcookie = MakeCookie(XI_RawMotion, nullptr);
+    loop.Dispatch(&event);
+    ASSERT_EQ(global_count, 0);
+    ASSERT_EQ(generic_count, 0);
+
+    // Other types still reach the global handler
+    event.xcookie = MakeCookie(XI_Motion, nullptr);
+    loop.Dispatch(&event);
+    ASSERT_EQ(global_count, 1);
+
+    loop.UnregisterGenericEventHandler(131, XI_RawMotion);
+    event.xcookie = MakeCookie(XI_RawMotion, nullptr);
+    loop.Dispatch(&event);
+    ASSERT_EQ(global_count, 2);
+}
+
+TEST(TileboxCoreX11XInputTestSuite, VerifyAttachToServer)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    X11EventLoop loop(*dpy_opt);
+    X11XInput xinput(*dpy_opt);
+    if (auto res = xinput.Attach(loop); res.is_err())
+    {
+        GTEST_SKIP() << "XInput 2.1 is not available";
+    }
+    ASSERT_NE(xinput.Opcode(), 0);
+    ASSERT_TRUE(xinput.SelectRawMotion().is_ok());
+    ASSERT_TRUE(xinput.SelectWindowEvents((*dpy_opt)->GetRootWindow()).is_ok());
+}
+
+TEST(TileboxCoreX11XInputTestSuite, VerifyBatchedDispatchKeepsEventData)
+{
+    auto dpy_opt = X11Display::Create();
+    if (!dpy_opt.has_value())
+    {
+        GTEST_SKIP() << "Could not open x11 display";
+    }
+
+    Display *dpy = (*dpy_opt)->Raw();
+    std::int32_t opcode = 0;
+    std::int32_t first_event = 0;
+    std::int32_t first_error = 0;
+    std::int32_t major = XI_2_Major;
+    std::int32_t minor = 0;
+    std::int32_t pointer = 0;
+    if (XQueryExtension(dpy, "XInputExtension", &opcode, &first_event, &first_error) == False ||
+        XIQueryVersion(dpy, &major, &minor) != Success || XIGetClientPointer(dpy, None, &pointer) == False)
+    {
+        GTEST_SKIP() << "XInput 2 is not available";
+    }
+
+    const Window root = (*dpy_opt)->GetRootWindow();
+    std::array<unsigned char, XIMaskLen(XI_LASTEVENT)> mask{};
+    XISetMask(mask.data(), XI_Motion);
+    XIEventMask event_mask{XIAllMasterDevices, static_cast<std::int32_t>(mask.size()), mask.data()};
+    XISelectEvents(dpy, root, &event_mask, 1);
+
+    X11EventLoop loop(*dpy_opt);
+    loop.SetEventBatching(true);
+
+    bool running = true;
+    std::vector<double> positions;
+    loop.RegisterGenericEventHandler(opcode, XI_Motion, [&](const XGenericEventCookie &cookie) -> void {
+        ASSERT_NE(cookie.data, nullptr);
+        positions.push_back(static_cast<const XIDeviceEvent *>(cookie.data)->root_x);
+        running = positions.size() < 2;
+    });
+    auto timeout = loop.AddTimer(std::chrono::seconds(2), std::chrono::milliseconds(0), [&]() -> void {
+        running = false;
+    });
+    ASSERT_TRUE(timeout.is_ok());
+
+    // Both motions are read into Xlib's queue before the loop runs, so one batch dequeues them together
+    XIWarpPointer(dpy, pointer, None, root, 0, 0, 0, 0, 10, 10);
+    XIWarpPointer(dpy, pointer, None, root, 0, 0, 0, 0, 20, 20);
+    XSync(dpy, False);
+
+    ASSERT_TRUE(loop.RunPolled(running).is_ok());
+    ASSERT_EQ(positions, (std::vector<double>{10.0, 20.0}));
+}